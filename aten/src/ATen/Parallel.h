@@ -115,6 +115,9 @@ CAFFE2_API int get_num_interop_threads();
 // Launches inter-op parallel task
 CAFFE2_API void launch(std::function<void()> func);
 
+// Checks whether the code runs in a task of the inter-op thread pool
+CAFFE2_API bool in_interop_thread_pool();
+
 // Launches intra-op parallel task
 CAFFE2_API void intraop_launch(std::function<void()> func);
 
@@ -84,5 +84,14 @@ void launch(std::function<void()> func) {
 #endif
 }
 
+bool in_interop_thread_pool() {
+#if AT_EXPERIMENTAL_SINGLE_THREAD_POOL
+  return in_parallel_region();
+#else
+  // no task can run before the pool is created
+  return num_interop_threads.load() == CONSUMED && get_pool().inThreadPool();
+#endif
+}
+
 } // namespace at
 #endif
@@ -475,6 +475,7 @@ _(aten, mkldnn_convolution) \
 _(aten, mkldnn_convolution_backward) \
 _(aten, mkldnn_convolution_backward_input) \
 _(aten, mkldnn_convolution_backward_weights) \
+_(aten, mkldnn_linear) \
 _(aten, mm) \
 _(aten, mode) \
 _(aten, mse_loss) \
@@ -676,6 +677,7 @@ _(aten, threshold_backward) \
 _(aten, to) \
 _(aten, to_sparse) \
 _(aten, to_dense) \
+_(aten, to_mkldnn) \
 _(aten, topk) \
 _(aten, trace) \
 _(aten, transpose) \
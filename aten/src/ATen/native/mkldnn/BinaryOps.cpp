@@ -61,6 +61,12 @@ Tensor& mkldnn_add_out(
 }
 
 Tensor mkldnn_add(const Tensor& self, const Tensor& other, Scalar alpha) {
+  // mkldnn sum does not broadcast
+  if (self.sizes() != other.sizes()) {
+    return at::add(
+        self.to_dense(), other.is_mkldnn() ? other.to_dense() : other, alpha)
+        .to_mkldnn();
+  }
   ideep::tensor& x = itensor_from_mkldnn(self);
   ideep::tensor& y = itensor_from_mkldnn(other);
 
@@ -37,6 +37,7 @@ std::tuple<at::Tensor,at::Tensor,at::Tensor> mkldnn_convolution_backward(
 #include <ATen/mkldnn/Runtime.h>
 #include <ATen/native/mkldnn/MKLDNNCommon.h>
 #include <ATen/native/mkldnn/Utils.h>
+#include <ATen/native/mkldnn/WeightCache.h>
 #include <ATen/native/ConvUtils.h>
 
 using namespace mkldnn;
@@ -127,8 +128,14 @@ at::Tensor mkldnn_convolution(
     IntArrayRef stride,
     IntArrayRef dilation,
     int64_t groups) {
-  const ideep::tensor mkldnn_input = get_mkldnn_tensor(input);
-  const ideep::tensor mkldnn_weight = get_mkldnn_tensor(weight);
+  // dense inputs are viewed in place, which ignores their strides
+  const Tensor input_ = input.is_mkldnn() ? input : input.contiguous();
+  const ideep::tensor mkldnn_input = get_mkldnn_tensor(input_);
+  // MKL-DNN weights are expected to be reordered already, see
+  // mkldnn_reorder_conv2d_weight. Dense weights are reordered once and cached.
+  const ideep::tensor mkldnn_weight = weight.is_mkldnn()
+      ? itensor_from_mkldnn(weight)
+      : get_cached_conv2d_weight(weight, padding, stride, dilation, groups);
   c10::optional<ideep::tensor> mkldnn_bias{c10::nullopt};
   if (bias.defined()) {
     mkldnn_bias = get_mkldnn_tensor(bias);
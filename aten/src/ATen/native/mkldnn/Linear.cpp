@@ -20,6 +20,7 @@ Tensor mkldnn_linear(
 #else // AT_MKLDNN_EBABLED
 
 #include <ATen/native/mkldnn/MKLDNNCommon.h>
+#include <ATen/native/mkldnn/WeightCache.h>
 
 namespace at {
 namespace native {
@@ -38,7 +39,7 @@ Tensor mkldnn_linear(
   // reshape first if input dim is greater than 2 and the reshape will cost a memory copy.
   auto self_reshaped = self.dim() > 2 ? self.reshape({-1, self.size(self.dim() - 1)}) : self;
   const ideep::tensor x = itensor_from_mkldnn(self_reshaped);
-  const ideep::tensor w = itensor_from_mkldnn(weight);
+  const ideep::tensor w = get_cached_linear_weight(weight);
 
   ideep::tensor y;
   if (bias.defined()) {
@@ -2,7 +2,7 @@
 #include <ATen/NativeFunctions.h>
 #include <ATen/Config.h>
 #include <ATen/native/mkldnn/MKLDNNCommon.h>
-#include <ATen/native/utils/ParamUtils.h>
+#include <ATen/native/mkldnn/WeightCache.h>
 
 namespace at { namespace native {
 
@@ -51,37 +51,8 @@ Tensor mkldnn_reorder_conv2d_weight(
     IntArrayRef dilation,
     int64_t groups) {
 
-  auto stride_vec = expand_param_if_needed(stride, "stride", 2);
-  auto padding_vec = expand_param_if_needed(padding, "padding", 2);
-  auto dilation_vec = expand_param_if_needed(dilation, "dilation", 2);
-
-  ideep::tensor w = itensor_from_mkldnn(self).as_weights();
-
-  // Legacy mkldnn conv2d jitted module may contain a 5-d weight with an extra
-  // dimension when groups > 1, having dimension [g, o/g, i, h, w] instead of
-  // [o, i, h, w]. Ideally we should reorder the weight back in serialization.
-  // For backward compatibility, we squash the first two dims (g * o/g) back to
-  // its original form.
-  if (w.ndims() == 5) {
-    auto wdims = w.get_dims();
-    w.reshape({wdims[0] * wdims[1], wdims[2], wdims[3], wdims[4]});
-  }
-
-  w.make_group(groups);
-  ideep::tensor::descriptor desc =
-      ideep::convolution_forward::expected_weights_descriptor(
-          w.get_dims(),
-          w.get_data_type(),
-          {stride_vec.cbegin(), stride_vec.cend()},
-          {padding_vec.cbegin(), padding_vec.cend()},
-          {padding_vec.cbegin(), padding_vec.cend()},
-          {dilation_vec.cbegin(), dilation_vec.cend()},
-          groups,
-          ideep::algorithm::convolution_direct);
-  ideep::tensor result;
-  result.init<AllocForMKLDNN>(desc);
-  result.feed_from(w);
-
+  ideep::tensor result = reorder_conv2d_weight(
+      itensor_from_mkldnn(self), padding, stride, dilation, groups);
   return new_with_itensor_mkldnn(std::move(result), self.options());
 }
 
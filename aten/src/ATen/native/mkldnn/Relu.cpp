@@ -15,6 +15,14 @@ Tensor& mkldnn_relu_(Tensor& input) {
   AT_ERROR("mkldnn_relu_: ATen not compiled with MKLDNN support");
 }
 
+Tensor mkldnn_hardtanh(const Tensor& input, Scalar min_val, Scalar max_val) {
+  AT_ERROR("mkldnn_hardtanh: ATen not compiled with MKLDNN support");
+}
+
+Tensor& mkldnn_hardtanh_(Tensor& input, Scalar min_val, Scalar max_val) {
+  AT_ERROR("mkldnn_hardtanh_: ATen not compiled with MKLDNN support");
+}
+
 }}
 
 #else // AT_MKLDNN_EBABLED
@@ -38,6 +46,39 @@ Tensor& mkldnn_relu_(Tensor& input) {
   return input;
 }
 
+// MKL-DNN clips to [0, alpha] (bounded relu), which covers relu6. Other ranges
+// go through a dense round trip.
+static bool use_bounded_relu(float min, float max) {
+  return min == 0 && max > 0;
+}
+
+Tensor mkldnn_hardtanh(const Tensor& input, Scalar min_val, Scalar max_val) {
+  const float min = min_val.to<float>();
+  const float max = max_val.to<float>();
+  if (!use_bounded_relu(min, max)) {
+    return at::hardtanh(input.to_dense(), min_val, max_val).to_mkldnn();
+  }
+  const ideep::tensor& x = itensor_from_mkldnn(input);
+  ideep::tensor y;
+  ideep::eltwise_forward::compute<AllocForMKLDNN>(
+      x, y, ideep::algorithm::eltwise_bounded_relu, ideep::prop_kind::forward_inference, /*alpha*/ max);
+  return new_with_itensor_mkldnn(std::move(y), input.options());
+}
+
+Tensor& mkldnn_hardtanh_(Tensor& input, Scalar min_val, Scalar max_val) {
+  const float min = min_val.to<float>();
+  const float max = max_val.to<float>();
+  ideep::tensor& x = itensor_from_mkldnn(input);
+  if (!use_bounded_relu(min, max)) {
+    x = itensor_from_mkldnn(
+        at::hardtanh(input.to_dense(), min_val, max_val).to_mkldnn());
+    return input;
+  }
+  ideep::eltwise_forward::compute<AllocForMKLDNN>(
+      x, x, ideep::algorithm::eltwise_bounded_relu, ideep::prop_kind::forward_inference, /*alpha*/ max);
+  return input;
+}
+
 }}
 
 #endif // AT_MKLDNN_EBABLED
@@ -28,6 +28,10 @@ Tensor& mkldnn_transpose_(Tensor& self, int64_t dim0, int64_t dim1) {
   AT_ERROR("mkldnn_transpose_: ATen not compiled with MKLDNN support");
 }
 
+Tensor mkldnn_cat(TensorList tensors, int64_t dim) {
+  AT_ERROR("mkldnn_cat: ATen not compiled with MKLDNN support");
+}
+
 } // namespace native
 } // namespace at
 
@@ -79,6 +83,20 @@ Tensor& mkldnn_transpose_(Tensor& self, int64_t dim0, int64_t dim1) {
   AT_ERROR("mkldnn_transpose_: in-place mkldnn operations are not supported yet");
 }
 
+Tensor mkldnn_cat(TensorList tensors, int64_t dim) {
+  TORCH_CHECK(!tensors.empty(), "mkldnn_cat: expects a non-empty list of tensors");
+  const int64_t wrapped_dim = maybe_wrap_dim(dim, tensors[0].dim());
+  std::vector<ideep::tensor> inputs;
+  inputs.reserve(tensors.size());
+  for (const Tensor& t : tensors) {
+    TORCH_CHECK(t.is_mkldnn(), "mkldnn_cat: expects all inputs to be mkldnn tensors");
+    inputs.push_back(itensor_from_mkldnn(t));
+  }
+  ideep::tensor y;
+  ideep::concat::compute<AllocForMKLDNN>(inputs, wrapped_dim, y);
+  return new_with_itensor_mkldnn(std::move(y), tensors[0].options());
+}
+
 } // namespace native
 } // namespace at
 
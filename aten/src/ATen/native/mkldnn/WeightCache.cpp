@@ -0,0 +1,264 @@
+#include <ATen/native/mkldnn/WeightCache.h>
+#include <ATen/native/mkldnn/MKLDNNCommon.h>
+#include <ATen/native/utils/ParamUtils.h>
+
+#if AT_MKLDNN_ENABLED()
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+
+namespace at { namespace native {
+
+namespace {
+
+using WeightOwner = c10::intrusive_ptr_target;
+
+struct CachedWeight {
+  // Keeps the owner's address from being reused while the entry exists; the
+  // owner's data is still freed with its last strong reference.
+  c10::weak_intrusive_ptr<WeightOwner> owner;
+  int64_t storage_offset;
+  std::vector<int64_t> sizes;
+  std::vector<int64_t> params;
+  uint32_t version;
+  // value of WeightCache::gets_ at the last hit, for eviction
+  uint64_t last_use;
+  ideep::tensor weight;
+};
+
+class WeightCache final {
+ public:
+  static WeightCache& instance() {
+    static WeightCache cache;
+    return cache;
+  }
+
+  template <typename Reorder>
+  ideep::tensor get(
+      const Tensor& weight,
+      std::vector<int64_t> params,
+      const Reorder& reorder) {
+    WeightOwner* owner = weight.is_mkldnn()
+        ? static_cast<WeightOwner*>(weight.unsafeGetTensorImpl())
+        : static_cast<WeightOwner*>(weight.storage().unsafeGetStorageImpl());
+    const int64_t storage_offset =
+        weight.is_mkldnn() ? 0 : weight.storage_offset();
+    const uint32_t version =
+        weight.unsafeGetTensorImpl()->version_counter().current_version();
+
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      if (++gets_ % kSweepInterval == 0) {
+        remove_expired();
+      }
+      CachedWeight* entry = find(owner, storage_offset, weight.sizes(), params);
+      if (entry && entry->version == version) {
+        entry->last_use = gets_;
+        return entry->weight;
+      }
+    }
+
+    // Reorders can take long, so other weights are served meanwhile. `weight`
+    // keeps the owner alive until the entry is stored.
+    ideep::tensor reordered = reorder();
+
+    std::lock_guard<std::mutex> guard(mutex_);
+    CachedWeight* entry = find(owner, storage_offset, weight.sizes(), params);
+    if (entry) {
+      entry->version = version;
+      entry->last_use = gets_;
+      entry->weight = reordered;
+      return reordered;
+    }
+    remove_expired();
+    if (num_entries_ >= kMaxEntries) {
+      remove_least_recently_used();
+    }
+    entries_[owner].push_back({
+        c10::weak_intrusive_ptr<WeightOwner>(
+            c10::intrusive_ptr<WeightOwner>::unsafe_reclaim_from_nonowning(owner)),
+        storage_offset,
+        weight.sizes().vec(),
+        std::move(params),
+        version,
+        gets_,
+        reordered});
+    ++num_entries_;
+    return reordered;
+  }
+
+ private:
+  // Entries of freed weights are dropped on a miss and every kSweepInterval
+  // lookups, and the cache holds at most kMaxEntries weights.
+  static constexpr uint64_t kSweepInterval = 256;
+  static constexpr size_t kMaxEntries = 1024;
+
+  WeightCache() = default;
+
+  CachedWeight* find(
+      const WeightOwner* owner,
+      int64_t storage_offset,
+      IntArrayRef sizes,
+      const std::vector<int64_t>& params) {
+    auto it = entries_.find(owner);
+    if (it == entries_.end()) {
+      return nullptr;
+    }
+    for (auto& entry : it->second) {
+      if (entry.storage_offset == storage_offset && entry.sizes == sizes &&
+          entry.params == params) {
+        return &entry;
+      }
+    }
+    return nullptr;
+  }
+
+  void remove_expired() {
+    for (auto it = entries_.begin(); it != entries_.end();) {
+      auto& bucket = it->second;
+      const size_t size = bucket.size();
+      bucket.erase(
+          std::remove_if(
+              bucket.begin(),
+              bucket.end(),
+              [](const CachedWeight& entry) { return entry.owner.expired(); }),
+          bucket.end());
+      num_entries_ -= size - bucket.size();
+      it = bucket.empty() ? entries_.erase(it) : std::next(it);
+    }
+  }
+
+  void remove_least_recently_used() {
+    auto oldest_bucket = entries_.end();
+    size_t oldest = 0;
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+      for (size_t i = 0; i < it->second.size(); ++i) {
+        if (oldest_bucket == entries_.end() ||
+            it->second[i].last_use < oldest_bucket->second[oldest].last_use) {
+          oldest_bucket = it;
+          oldest = i;
+        }
+      }
+    }
+    if (oldest_bucket == entries_.end()) {
+      return;
+    }
+    auto& bucket = oldest_bucket->second;
+    bucket.erase(bucket.begin() + oldest);
+    --num_entries_;
+    if (bucket.empty()) {
+      entries_.erase(oldest_bucket);
+    }
+  }
+
+  std::mutex mutex_;
+  uint64_t gets_ = 0;
+  size_t num_entries_ = 0;
+  std::unordered_map<const WeightOwner*, std::vector<CachedWeight>> entries_;
+};
+
+constexpr uint64_t WeightCache::kSweepInterval;
+constexpr size_t WeightCache::kMaxEntries;
+
+} // namespace
+
+ideep::tensor reorder_conv2d_weight(
+    ideep::tensor weight,
+    IntArrayRef padding,
+    IntArrayRef stride,
+    IntArrayRef dilation,
+    int64_t groups) {
+  auto stride_vec = expand_param_if_needed(stride, "stride", 2);
+  auto padding_vec = expand_param_if_needed(padding, "padding", 2);
+  auto dilation_vec = expand_param_if_needed(dilation, "dilation", 2);
+
+  ideep::tensor w = weight.as_weights();
+
+  // Legacy mkldnn conv2d jitted module may contain a 5-d weight with an extra
+  // dimension when groups > 1, having dimension [g, o/g, i, h, w] instead of
+  // [o, i, h, w]. Ideally we should reorder the weight back in serialization.
+  // For backward compatibility, we squash the first two dims (g * o/g) back to
+  // its original form.
+  if (w.ndims() == 5) {
+    auto wdims = w.get_dims();
+    w.reshape({wdims[0] * wdims[1], wdims[2], wdims[3], wdims[4]});
+  }
+
+  w.make_group(groups);
+  ideep::tensor::descriptor desc =
+      ideep::convolution_forward::expected_weights_descriptor(
+          w.get_dims(),
+          w.get_data_type(),
+          {stride_vec.cbegin(), stride_vec.cend()},
+          {padding_vec.cbegin(), padding_vec.cend()},
+          {padding_vec.cbegin(), padding_vec.cend()},
+          {dilation_vec.cbegin(), dilation_vec.cend()},
+          groups,
+          ideep::algorithm::convolution_direct);
+  ideep::tensor result;
+  result.init<AllocForMKLDNN>(desc);
+  result.feed_from(w);
+  return result;
+}
+
+ideep::tensor reorder_linear_weight(ideep::tensor weight) {
+  ideep::tensor::descriptor desc =
+      ideep::inner_product_forward::expected_weights_descriptor(
+          weight.get_dims(), weight.get_data_type());
+  ideep::tensor result;
+  result.init<AllocForMKLDNN>(desc);
+  result.feed_from(weight.as_weights());
+  return result;
+}
+
+ideep::tensor get_cached_conv2d_weight(
+    const Tensor& weight,
+    IntArrayRef padding,
+    IntArrayRef stride,
+    IntArrayRef dilation,
+    int64_t groups) {
+  // dense weights are viewed in place, which ignores their strides
+  if (!weight.is_mkldnn() && !weight.is_contiguous()) {
+    const Tensor weight_ = weight.contiguous();
+    return reorder_conv2d_weight(
+        itensor_view_from_dense(weight_), padding, stride, dilation, groups);
+  }
+
+  std::vector<int64_t> params;
+  params.insert(params.end(), padding.begin(), padding.end());
+  params.insert(params.end(), stride.begin(), stride.end());
+  params.insert(params.end(), dilation.begin(), dilation.end());
+  params.push_back(groups);
+
+  return WeightCache::instance().get(weight, std::move(params), [&]() {
+    const ideep::tensor w = weight.is_mkldnn()
+        ? itensor_from_mkldnn(weight)
+        : itensor_view_from_dense(weight);
+    return reorder_conv2d_weight(w, padding, stride, dilation, groups);
+  });
+}
+
+ideep::tensor get_cached_linear_weight(const Tensor& weight) {
+  if (weight.is_mkldnn()) {
+    ideep::tensor& w = itensor_from_mkldnn(weight);
+    if (w.get_descriptor() ==
+        ideep::inner_product_forward::expected_weights_descriptor(
+            w.get_dims(), w.get_data_type())) {
+      return w;
+    }
+  } else if (!weight.is_contiguous()) {
+    return reorder_linear_weight(itensor_view_from_dense(weight.contiguous()));
+  }
+
+  return WeightCache::instance().get(weight, {}, [&]() {
+    const ideep::tensor w = weight.is_mkldnn()
+        ? itensor_from_mkldnn(weight)
+        : itensor_view_from_dense(weight);
+    return reorder_linear_weight(w);
+  });
+}
+
+}}
+
+#endif // AT_MKLDNN_ENABLED()
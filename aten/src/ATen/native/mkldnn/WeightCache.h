@@ -0,0 +1,44 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/Config.h>
+
+#if AT_MKLDNN_ENABLED()
+#include <ideep.hpp>
+
+namespace at { namespace native {
+
+// Reorder an ideep conv2d weight to the blocked format the convolution
+// primitive expects for the given parameters.
+ideep::tensor reorder_conv2d_weight(
+    ideep::tensor weight,
+    IntArrayRef padding,
+    IntArrayRef stride,
+    IntArrayRef dilation,
+    int64_t groups);
+
+// Reorder an ideep linear weight to the format the inner product primitive
+// expects.
+ideep::tensor reorder_linear_weight(ideep::tensor weight);
+
+// The functions below return the reordered form of a dense or MKL-DNN weight,
+// caching it across calls. Entries are keyed by the identity of the weight's
+// storage (of the tensor itself for MKL-DNN tensors, which have none), its
+// offset, sizes and the operator parameters, and are recomputed once the
+// weight's version counter moves, i.e. after an in-place update. As with
+// autograd, updates made through `.data` are not tracked. Entries of freed
+// weights are dropped periodically, and the least recently used entry is
+// evicted once the cache holds 1024 weights. Reorders run outside of the
+// cache lock.
+ideep::tensor get_cached_conv2d_weight(
+    const Tensor& weight,
+    IntArrayRef padding,
+    IntArrayRef stride,
+    IntArrayRef dilation,
+    int64_t groups);
+
+ideep::tensor get_cached_linear_weight(const Tensor& weight);
+
+}}
+
+#endif // AT_MKLDNN_ENABLED
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at {
+namespace native {
+
+// Per-channel affine quantize/dequantize. `scales` is a contiguous double
+// tensor and `zero_points` a contiguous int64 tensor, both of length
+// rtensor.size(axis). Both tensors must either be contiguous or, for
+// axis == 1 on a 4D tensor, channels last.
+using quantize_tensor_per_channel_affine_fn = void (*)(
+    Tensor rtensor,
+    Tensor qtensor,
+    Tensor scales,
+    Tensor zero_points,
+    int64_t axis);
+
+using dequantize_tensor_per_channel_affine_fn = void (*)(
+    Tensor qtensor,
+    Tensor rtensor,
+    Tensor scales,
+    Tensor zero_points,
+    int64_t axis);
+
+DECLARE_DISPATCH(
+    quantize_tensor_per_channel_affine_fn,
+    quantize_tensor_per_channel_affine_stub);
+DECLARE_DISPATCH(
+    dequantize_tensor_per_channel_affine_fn,
+    dequantize_tensor_per_channel_affine_stub);
+
+} // namespace native
+} // namespace at
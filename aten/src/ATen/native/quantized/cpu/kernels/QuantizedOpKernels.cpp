@@ -1,9 +1,17 @@
+#ifndef _USE_MATH_DEFINES
+#define _USE_MATH_DEFINES
+#endif
+
 #include <ATen/ATen.h>
 #include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
 #include <ATen/native/TensorIterator.h>
 #include <ATen/native/UpSample.h>
 #include <ATen/native/cpu/Loops.h>
+#include <ATen/native/quantized/affine_quantizer.h>
+#include <ATen/native/quantized/histogram_observer.h>
 #include <ATen/native/quantized/cpu/quantized_ops.h>
+#include <ATen/native/quantized/cpu/sparse_utils.h>
 #include <ATen/quantized/Quantizer.h>
 #include <ATen/native/SortingUtils.h>
 
@@ -1327,6 +1335,490 @@ void q_batch_norm_kernel(
 
 }
 
+void quantized_layer_norm_kernel(
+    const Tensor& X,
+    const Tensor& gamma,
+    const Tensor& beta,
+    double eps,
+    int64_t M,
+    int64_t N,
+    Tensor& Y) {
+  const double x_scale = X.q_scale();
+  const int64_t x_zero_point = X.q_zero_point();
+  const double y_scale = Y.q_scale();
+  const int64_t y_zero_point = Y.q_zero_point();
+
+  // The affine parameters are folded with the output scale once, so every
+  // row only needs one multiply-add per element before requantization.
+  std::vector<float> gamma_data(N, 1.0f);
+  std::vector<float> beta_data(N, 0.0f);
+  const float* gamma_ptr = gamma.defined() ? gamma.data_ptr<float>() : nullptr;
+  const float* beta_ptr = beta.defined() ? beta.data_ptr<float>() : nullptr;
+  for (int64_t j = 0; j < N; ++j) {
+    if (gamma_ptr) {
+      gamma_data[j] = gamma_ptr[j];
+    }
+    if (beta_ptr) {
+      beta_data[j] = beta_ptr[j] / y_scale;
+    }
+  }
+
+  AT_DISPATCH_QINT_TYPES(X.scalar_type(), "quantized_layer_norm", [&]() {
+    using Vec = Vec256<scalar_t>;
+    constexpr int64_t kVLen = Vec256<float>::size();
+    const auto* X_data = X.data_ptr<scalar_t>();
+    auto* Y_data = Y.data_ptr<scalar_t>();
+    const int64_t grain_size =
+        std::max<int64_t>(1, at::internal::GRAIN_SIZE / std::max<int64_t>(1, N));
+    at::parallel_for(0, M, grain_size, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        const scalar_t* X_ptr = X_data + i * N;
+        scalar_t* Y_ptr = Y_data + i * N;
+
+        // Moments of the integer representation are exact in int64_t.
+        int64_t sum = 0;
+        int64_t sum_sq = 0;
+        for (int64_t j = 0; j < N; ++j) {
+          const int64_t v = static_cast<int64_t>(X_ptr[j].val_) - x_zero_point;
+          sum += v;
+          sum_sq += v * v;
+        }
+        const double mean_q = static_cast<double>(sum) / N;
+        const double var_q =
+            std::max(static_cast<double>(sum_sq) / N - mean_q * mean_q, 0.0);
+        const double rstd = 1.0 / std::sqrt(var_q * x_scale * x_scale + eps);
+
+        // y_q = (x_q - x_zp - mean_q) * x_scale * rstd / y_scale * gamma
+        //       + beta / y_scale + y_zp
+        const float alpha = x_scale * rstd / y_scale;
+        const float shift = x_zero_point + mean_q;
+        auto alpha_vec = Vec256<float>(alpha);
+        auto shift_vec = Vec256<float>(shift);
+        auto alpha_neg_shift_premul = alpha_vec * shift_vec.neg();
+
+        int64_t j = 0;
+        for (; j + Vec::size() <= N; j += Vec::size()) {
+          auto vals = Vec::loadu(X_ptr + j).dequantize(
+              alpha_vec, shift_vec, alpha_neg_shift_premul);
+          for (int k = 0; k < Vec::float_num_vecs(); ++k) {
+            vals[k] = vec256::fmadd(
+                vals[k],
+                Vec256<float>::loadu(gamma_data.data() + j + k * kVLen),
+                Vec256<float>::loadu(beta_data.data() + j + k * kVLen));
+          }
+          // Fake scale of 1.0, the output scale is already folded in.
+          Vec::quantize(vals, /*output_scale=*/1.0f, y_zero_point,
+                        /*inv_output_scale=*/1.0f)
+              .store(Y_ptr + j);
+        }
+        for (; j < N; ++j) {
+          const float y =
+              (static_cast<float>(X_ptr[j].val_) - shift) * alpha * gamma_data[j] +
+              beta_data[j];
+          Y_ptr[j] = at::quantize_val<scalar_t>(1.0, y_zero_point, y);
+        }
+      }
+    });
+  });
+}
+
+// An 8-bit input only has 256 distinct values, so GELU is evaluated once per
+// value into a table that maps input codes directly to output codes.
+template <typename T>
+void qgelu_lut_kernel(const Tensor& qx, Tensor& qy) {
+  using underlying_t = typename T::underlying;
+  constexpr int64_t kLutSize = 1 << (8 * sizeof(underlying_t));
+  constexpr int64_t kQMin = std::numeric_limits<underlying_t>::min();
+  const double x_scale = qx.q_scale();
+  const int64_t x_zero_point = qx.q_zero_point();
+  const double y_scale = qy.q_scale();
+  const int64_t y_zero_point = qy.q_zero_point();
+
+  underlying_t lut[kLutSize];
+  for (int64_t i = 0; i < kLutSize; ++i) {
+    const float x = (static_cast<float>(kQMin + i) - x_zero_point) * x_scale;
+    const float y = x * 0.5f * (1.0f + std::erf(x * static_cast<float>(M_SQRT1_2)));
+    lut[i] = at::quantize_val<T>(y_scale, y_zero_point, y).val_;
+  }
+
+  const auto* x_data = reinterpret_cast<const underlying_t*>(qx.data_ptr<T>());
+  auto* y_data = reinterpret_cast<underlying_t*>(qy.data_ptr<T>());
+  at::parallel_for(
+      0, qx.numel(), at::internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          y_data[i] = lut[static_cast<int64_t>(x_data[i]) - kQMin];
+        }
+      });
+}
+
+void qgelu_kernel(const Tensor& qx, Tensor& qy) {
+  if (qx.scalar_type() == kQUInt8) {
+    qgelu_lut_kernel<c10::quint8>(qx, qy);
+  } else if (qx.scalar_type() == kQInt8) {
+    qgelu_lut_kernel<c10::qint8>(qx, qy);
+  } else {
+    TORCH_CHECK(false, "quantized::gelu only supports quint8 and qint8 inputs.");
+  }
+}
+
+// Softmax over the innermost dimension. exp(x_scale * (x_q - max_q)) depends
+// only on max_q - x_q, which lies in [0, 255] for 8-bit inputs, so the
+// exponentials come from a table built once per call.
+template <typename T>
+void qsoftmax_lastdim_kernel(
+    const Tensor& qx,
+    int64_t outer_size,
+    int64_t dim_size,
+    Tensor& qy) {
+  using Vec = Vec256<T>;
+  using underlying_t = typename T::underlying;
+  constexpr int64_t kVLen = Vec256<float>::size();
+  constexpr int64_t kLutSize = 1 << (8 * sizeof(underlying_t));
+  const double x_scale = qx.q_scale();
+  const double y_scale = qy.q_scale();
+  const int64_t y_zero_point = qy.q_zero_point();
+
+  float exp_lut[kLutSize];
+  for (int64_t d = 0; d < kLutSize; ++d) {
+    exp_lut[d] = std::exp(-static_cast<float>(x_scale) * d);
+  }
+
+  const auto* x_data = reinterpret_cast<const underlying_t*>(qx.data_ptr<T>());
+  auto* y_data = qy.data_ptr<T>();
+  const int64_t grain_size =
+      std::max<int64_t>(1, at::internal::GRAIN_SIZE / std::max<int64_t>(1, dim_size));
+  at::parallel_for(0, outer_size, grain_size, [&](int64_t begin, int64_t end) {
+    std::vector<float> exp_vals(dim_size);
+    for (int64_t i = begin; i < end; ++i) {
+      const underlying_t* x_ptr = x_data + i * dim_size;
+      T* y_ptr = y_data + i * dim_size;
+      const int64_t max_q = *std::max_element(x_ptr, x_ptr + dim_size);
+      float sum = 0.0f;
+      for (int64_t j = 0; j < dim_size; ++j) {
+        exp_vals[j] = exp_lut[max_q - x_ptr[j]];
+        sum += exp_vals[j];
+      }
+      // Dividing by the sum is folded into the quantization scale.
+      const float scale = sum * y_scale;
+      const float inv_scale = 1.0f / scale;
+      int64_t j = 0;
+      for (; j + Vec::size() <= dim_size; j += Vec::size()) {
+        typename Vec::float_vec_return_type vals;
+        for (int k = 0; k < Vec::float_num_vecs(); ++k) {
+          vals[k] = Vec256<float>::loadu(exp_vals.data() + j + k * kVLen);
+        }
+        Vec::quantize(vals, scale, y_zero_point, inv_scale).store(y_ptr + j);
+      }
+      for (; j < dim_size; ++j) {
+        y_ptr[j] = at::quantize_val<T>(scale, y_zero_point, exp_vals[j]);
+      }
+    }
+  });
+}
+
+void qsoftmax_kernel(
+    const Tensor& qx,
+    int64_t outer_size,
+    int64_t dim_size,
+    Tensor& qy) {
+  if (qx.scalar_type() == kQUInt8) {
+    qsoftmax_lastdim_kernel<c10::quint8>(qx, outer_size, dim_size, qy);
+  } else if (qx.scalar_type() == kQInt8) {
+    qsoftmax_lastdim_kernel<c10::qint8>(qx, outer_size, dim_size, qy);
+  } else {
+    TORCH_CHECK(false, "quantized::softmax only supports quint8 and qint8 inputs.");
+  }
+}
+
+// Block sparse int8 GEMM. Input rows are taken in tiles of
+// Vec256<int32_t>::size(). Each thread widens and transposes only the tile it
+// is working on, then broadcasts every stored weight against the whole tile
+// for all of its output channels, so the tile is read from cache rather than
+// re-streamed from the input per channel. Rows left over after the last full
+// tile use a scalar loop. Only the last block of a row can run past K, its
+// padding is zero.
+void qlinear_sparse_kernel(
+    const uint8_t* input,
+    int64_t M,
+    int32_t input_zero_point,
+    const PackedLinearWeightSparse& packed,
+    int32_t* output) {
+  using Vec = Vec256<int32_t>;
+  constexpr int64_t kMTile = Vec::size();
+  const int64_t N = packed.N;
+  const int64_t K = packed.K;
+  const int64_t K_padded = divup(K, kSparseBlockSize) * kSparseBlockSize;
+  const int64_t full_tiles = M / kMTile;
+  const int64_t full_col_blocks = K / kSparseBlockSize;
+
+  const int32_t* row_offsets = packed.row_offsets.data();
+  const int32_t* col_block_indices = packed.col_block_indices.data();
+  const int16_t* values = packed.values.data();
+  const int64_t blocks_per_row = divup(row_offsets[N], N);
+  const int64_t work_per_row =
+      std::max<int64_t>(1, M * kSparseBlockSize * blocks_per_row);
+  const int64_t grain_size =
+      std::max<int64_t>(1, at::internal::GRAIN_SIZE / work_per_row);
+  at::parallel_for(0, N, grain_size, [&](int64_t begin, int64_t end) {
+    // x_t[k][i] = input[t * kMTile + i][k], the padding past K stays zero.
+    std::vector<int32_t> x_t(full_tiles > 0 ? K_padded * kMTile : 0, 0);
+    int32_t buf[kMTile];
+    for (int64_t t = 0; t < full_tiles; ++t) {
+      const uint8_t* x = input + t * kMTile * K;
+      for (int64_t i = 0; i < kMTile; ++i) {
+        for (int64_t k = 0; k < K; ++k) {
+          x_t[k * kMTile + i] = x[i * K + k];
+        }
+      }
+      for (int64_t n = begin; n < end; ++n) {
+        Vec acc(-input_zero_point * packed.col_offsets[n]);
+        for (int32_t b = row_offsets[n]; b < row_offsets[n + 1]; ++b) {
+          const int32_t* x_block =
+              x_t.data() + col_block_indices[b] * kSparseBlockSize * kMTile;
+          const int16_t* w = values + b * kSparseBlockSize;
+          for (int64_t j = 0; j < kSparseBlockSize; ++j) {
+            acc = acc +
+                Vec(static_cast<int32_t>(w[j])) *
+                    Vec::loadu(x_block + j * kMTile);
+          }
+        }
+        acc.store(buf);
+        for (int64_t i = 0; i < kMTile; ++i) {
+          output[(t * kMTile + i) * N + n] = buf[i];
+        }
+      }
+    }
+    for (int64_t m = full_tiles * kMTile; m < M; ++m) {
+      const uint8_t* x = input + m * K;
+      for (int64_t n = begin; n < end; ++n) {
+        int32_t acc = -input_zero_point * packed.col_offsets[n];
+        for (int32_t b = row_offsets[n]; b < row_offsets[n + 1]; ++b) {
+          const int64_t col_block = col_block_indices[b];
+          const int64_t k0 = col_block * kSparseBlockSize;
+          const int16_t* w = values + b * kSparseBlockSize;
+          const int64_t len =
+              col_block < full_col_blocks ? kSparseBlockSize : K - k0;
+          for (int64_t j = 0; j < len; ++j) {
+            acc += w[j] * x[k0 + j];
+          }
+        }
+        output[m * N + n] = acc;
+      }
+    }
+  });
+}
+
+// Quantizes one run of values that share a single (scale, zero_point).
+template <typename T>
+void quantize_per_channel_block(
+    const float* src,
+    T* dst,
+    int64_t len,
+    double scale,
+    int64_t zero_point) {
+  using Vec = Vec256<T>;
+  constexpr int64_t kVLen = Vec256<float>::size();
+  const float inv_scale = 1.0f / static_cast<float>(scale);
+  int64_t i = 0;
+  for (; i + Vec::size() <= len; i += Vec::size()) {
+    typename Vec::float_vec_return_type float_vals;
+    for (int j = 0; j < Vec::float_num_vecs(); ++j) {
+      float_vals[j] = Vec256<float>::loadu(src + i + j * kVLen);
+    }
+    Vec::quantize(float_vals, scale, zero_point, inv_scale).store(dst + i);
+  }
+  for (; i < len; ++i) {
+    dst[i] = quantize_val<T>(scale, zero_point, src[i]);
+  }
+}
+
+template <typename T>
+void dequantize_per_channel_block(
+    const T* src,
+    float* dst,
+    int64_t len,
+    double scale,
+    int64_t zero_point) {
+  using Vec = Vec256<T>;
+  constexpr int64_t kVLen = Vec256<float>::size();
+  auto scale_vec = Vec256<float>(scale);
+  auto zero_point_vec = Vec256<float>(static_cast<float>(zero_point));
+  auto scale_neg_zp_premul = scale_vec * zero_point_vec.neg();
+  int64_t i = 0;
+  for (; i + Vec::size() <= len; i += Vec::size()) {
+    auto float_vals = Vec::loadu(src + i).dequantize(
+        scale_vec, zero_point_vec, scale_neg_zp_premul);
+    for (int j = 0; j < Vec::float_num_vecs(); ++j) {
+      float_vals[j].store(dst + i + j * kVLen);
+    }
+  }
+  for (; i < len; ++i) {
+    dst[i] = (static_cast<float>(src[i].val_) - zero_point) * scale;
+  }
+}
+
+inline bool is_nhwc_per_channel(
+    const Tensor& a,
+    const Tensor& b,
+    int64_t axis) {
+  return axis == 1 && a.dim() == 4 &&
+      a.is_contiguous(MemoryFormat::ChannelsLast) &&
+      b.is_contiguous(MemoryFormat::ChannelsLast);
+}
+
+void quantize_tensor_per_channel_affine_cpu(
+    Tensor rtensor,
+    Tensor qtensor,
+    Tensor scales,
+    Tensor zero_points,
+    int64_t axis) {
+  const auto* scales_data = scales.data_ptr<double>();
+  const auto* zero_points_data = zero_points.data_ptr<int64_t>();
+  const float* rdata = rtensor.data_ptr<float>();
+  const int64_t channel = rtensor.size(axis);
+
+  AT_DISPATCH_QINT_TYPES(
+      qtensor.scalar_type(), "quantize_tensor_per_channel_affine_cpu", [&]() {
+        auto* qdata = qtensor.data_ptr<scalar_t>();
+        if (is_nhwc_per_channel(rtensor, qtensor, axis)) {
+          // Channels are innermost: every row of C values needs all of the
+          // per channel parameters, so vectorize across channels instead.
+          constexpr int64_t kVLen = Vec256<float>::size();
+          // float -> int32 cannot be clamped exactly in float, so qint32
+          // takes the scalar path below.
+          constexpr bool kVectorize = sizeof(underlying_t) == 1;
+          const auto qmin_vec = Vec256<float>(
+              static_cast<float>(std::numeric_limits<underlying_t>::min()));
+          const auto qmax_vec = Vec256<float>(
+              static_cast<float>(std::numeric_limits<underlying_t>::max()));
+          std::vector<float> inv_scales(channel);
+          std::vector<float> zero_points_f(channel);
+          for (int64_t c = 0; c < channel; ++c) {
+            inv_scales[c] = 1.0f / static_cast<float>(scales_data[c]);
+            zero_points_f[c] = static_cast<float>(zero_points_data[c]);
+          }
+          const int64_t rows = rtensor.numel() / channel;
+          const int64_t grain_size =
+              std::max<int64_t>(1, at::internal::GRAIN_SIZE / channel);
+          at::parallel_for(0, rows, grain_size, [&](int64_t begin, int64_t end) {
+            for (int64_t r = begin; r < end; ++r) {
+              const float* src = rdata + r * channel;
+              scalar_t* dst = qdata + r * channel;
+              auto* dst_raw = reinterpret_cast<underlying_t*>(dst);
+              int64_t c = 0;
+              if (kVectorize) {
+                for (; c + kVLen <= channel; c += kVLen) {
+                  auto vals = Vec256<float>::loadu(src + c) *
+                          Vec256<float>::loadu(inv_scales.data() + c) +
+                      Vec256<float>::loadu(zero_points_f.data() + c);
+                  vals = vec256::clamp(vals.round(), qmin_vec, qmax_vec);
+                  float buf[kVLen];
+                  vals.store(buf);
+                  for (int64_t j = 0; j < kVLen; ++j) {
+                    dst_raw[c + j] = static_cast<underlying_t>(buf[j]);
+                  }
+                }
+              }
+              for (; c < channel; ++c) {
+                dst[c] = quantize_val<scalar_t>(
+                    scales_data[c], zero_points_data[c], src[c]);
+              }
+            }
+          });
+        } else {
+          TORCH_INTERNAL_ASSERT(rtensor.is_contiguous() && qtensor.is_contiguous());
+          // Each (batch, channel) pair owns a contiguous run of elements
+          // that shares one scale and zero_point.
+          const int64_t batches = size_to_dim_(axis, rtensor.sizes());
+          const int64_t elements_per_channel =
+              size_from_dim_(axis + 1, rtensor.sizes());
+          const int64_t grain_size = std::max<int64_t>(
+              1, at::internal::GRAIN_SIZE / std::max<int64_t>(1, elements_per_channel));
+          at::parallel_for(
+              0, batches * channel, grain_size, [&](int64_t begin, int64_t end) {
+                for (int64_t i = begin; i < end; ++i) {
+                  const int64_t c = i % channel;
+                  quantize_per_channel_block<scalar_t>(
+                      rdata + i * elements_per_channel,
+                      qdata + i * elements_per_channel,
+                      elements_per_channel,
+                      scales_data[c],
+                      zero_points_data[c]);
+                }
+              });
+        }
+      });
+}
+
+void dequantize_tensor_per_channel_affine_cpu(
+    Tensor qtensor,
+    Tensor rtensor,
+    Tensor scales,
+    Tensor zero_points,
+    int64_t axis) {
+  const auto* scales_data = scales.data_ptr<double>();
+  const auto* zero_points_data = zero_points.data_ptr<int64_t>();
+  float* rdata = rtensor.data_ptr<float>();
+  const int64_t channel = qtensor.size(axis);
+
+  AT_DISPATCH_QINT_TYPES(
+      qtensor.scalar_type(), "dequantize_tensor_per_channel_affine_cpu", [&]() {
+        const auto* qdata = qtensor.data_ptr<scalar_t>();
+        if (is_nhwc_per_channel(qtensor, rtensor, axis)) {
+          constexpr int64_t kVLen = Vec256<float>::size();
+          std::vector<float> scales_f(channel);
+          std::vector<float> zero_points_f(channel);
+          for (int64_t c = 0; c < channel; ++c) {
+            scales_f[c] = static_cast<float>(scales_data[c]);
+            zero_points_f[c] = static_cast<float>(zero_points_data[c]);
+          }
+          const int64_t rows = qtensor.numel() / channel;
+          const int64_t grain_size =
+              std::max<int64_t>(1, at::internal::GRAIN_SIZE / channel);
+          at::parallel_for(0, rows, grain_size, [&](int64_t begin, int64_t end) {
+            for (int64_t r = begin; r < end; ++r) {
+              const scalar_t* src = qdata + r * channel;
+              float* dst = rdata + r * channel;
+              int64_t c = 0;
+              for (; c + kVLen <= channel; c += kVLen) {
+                float buf[kVLen];
+                for (int64_t j = 0; j < kVLen; ++j) {
+                  buf[j] = static_cast<float>(src[c + j].val_);
+                }
+                auto vals = (Vec256<float>::loadu(buf) -
+                             Vec256<float>::loadu(zero_points_f.data() + c)) *
+                    Vec256<float>::loadu(scales_f.data() + c);
+                vals.store(dst + c);
+              }
+              for (; c < channel; ++c) {
+                dst[c] = (static_cast<float>(src[c].val_) - zero_points_data[c]) *
+                    scales_data[c];
+              }
+            }
+          });
+        } else {
+          TORCH_INTERNAL_ASSERT(rtensor.is_contiguous() && qtensor.is_contiguous());
+          const int64_t batches = size_to_dim_(axis, qtensor.sizes());
+          const int64_t elements_per_channel =
+              size_from_dim_(axis + 1, qtensor.sizes());
+          const int64_t grain_size = std::max<int64_t>(
+              1, at::internal::GRAIN_SIZE / std::max<int64_t>(1, elements_per_channel));
+          at::parallel_for(
+              0, batches * channel, grain_size, [&](int64_t begin, int64_t end) {
+                for (int64_t i = begin; i < end; ++i) {
+                  const int64_t c = i % channel;
+                  dequantize_per_channel_block<scalar_t>(
+                      qdata + i * elements_per_channel,
+                      rdata + i * elements_per_channel,
+                      elements_per_channel,
+                      scales_data[c],
+                      zero_points_data[c]);
+                }
+              });
+        }
+      });
+}
+
 void fake_quantize_tensor_kernel(
     Tensor& output,
     const Tensor& input,
@@ -1364,28 +1856,250 @@ void fake_quantize_grad_tensor_kernel(
   });
 }
 
+// The inner loops of the per channel fake quant iterators see scale and
+// zero_point either broadcast (the loop stays within one channel) or laid out
+// contiguously (channels last); both are vectorized, anything else is not.
+inline bool fake_quant_per_channel_vectorizable(
+    const int64_t* strides,
+    int num_float_args) {
+  for (int arg = 0; arg < num_float_args; ++arg) {
+    if (strides[arg] != sizeof(float)) {
+      return false;
+    }
+  }
+  const int64_t scale_stride = strides[num_float_args];
+  const int64_t zero_point_stride = strides[num_float_args + 1];
+  return (scale_stride == 0 && zero_point_stride == 0) ||
+      (scale_stride == sizeof(float) && zero_point_stride == sizeof(int64_t));
+}
+
+inline void load_fake_quant_params(
+    const float* scale,
+    const int64_t* zero_point,
+    bool broadcast,
+    Vec256<float>& scale_vec,
+    Vec256<float>& zero_point_vec) {
+  if (broadcast) {
+    scale_vec = Vec256<float>(*scale);
+    zero_point_vec = Vec256<float>(static_cast<float>(*zero_point));
+    return;
+  }
+  float zero_point_buf[Vec256<float>::size()];
+  for (int j = 0; j < Vec256<float>::size(); ++j) {
+    zero_point_buf[j] = static_cast<float>(zero_point[j]);
+  }
+  scale_vec = Vec256<float>::loadu(scale);
+  zero_point_vec = Vec256<float>::loadu(zero_point_buf);
+}
+
 void fake_quant_per_channel_cpu(TensorIterator &iter, int64_t quant_min, int64_t quant_max) {
-  cpu_kernel(iter,
-    [=](float self, float scale, int64_t zero_point) -> float {
-      float inv_scale = 1.0f / scale;
-      return (std::fmin(
-                std::fmax(
-                    static_cast<int64_t>(
-                        std::nearbyint(self * inv_scale + zero_point)),
-                    quant_min),
-                quant_max) -
-            zero_point) *
-        scale;
-    });
+  constexpr int64_t kVLen = Vec256<float>::size();
+  const auto quant_min_vec = Vec256<float>(static_cast<float>(quant_min));
+  const auto quant_max_vec = Vec256<float>(static_cast<float>(quant_max));
+  auto op = [=](float self, float scale, int64_t zero_point) -> float {
+    float inv_scale = 1.0f / scale;
+    return (std::fmin(
+              std::fmax(
+                  static_cast<int64_t>(
+                      std::nearbyint(self * inv_scale + zero_point)),
+                  quant_min),
+              quant_max) -
+          zero_point) *
+      scale;
+  };
+  iter.for_each([&](char** data, const int64_t* strides, int64_t n) {
+    int64_t i = 0;
+    if (fake_quant_per_channel_vectorizable(strides, 2)) {
+      auto* out = reinterpret_cast<float*>(data[0]);
+      const auto* self = reinterpret_cast<const float*>(data[1]);
+      const auto* scale = reinterpret_cast<const float*>(data[2]);
+      const auto* zero_point = reinterpret_cast<const int64_t*>(data[3]);
+      const bool broadcast = strides[2] == 0;
+      for (; i + kVLen <= n; i += kVLen) {
+        Vec256<float> scale_vec, zero_point_vec;
+        load_fake_quant_params(
+            scale + (broadcast ? 0 : i),
+            zero_point + (broadcast ? 0 : i),
+            broadcast,
+            scale_vec,
+            zero_point_vec);
+        auto inv_scale_vec = Vec256<float>(1.0f) / scale_vec;
+        auto xq = vec256::clamp(
+            (Vec256<float>::loadu(self + i) * inv_scale_vec + zero_point_vec).round(),
+            quant_min_vec,
+            quant_max_vec);
+        ((xq - zero_point_vec) * scale_vec).store(out + i);
+      }
+    }
+    for (; i < n; ++i) {
+      *reinterpret_cast<float*>(data[0] + i * strides[0]) = op(
+          *reinterpret_cast<float*>(data[1] + i * strides[1]),
+          *reinterpret_cast<float*>(data[2] + i * strides[2]),
+          *reinterpret_cast<int64_t*>(data[3] + i * strides[3]));
+    }
+  });
 }
 
 void fake_quant_grad_per_channel_cpu(TensorIterator &iter, int64_t quant_min, int64_t quant_max) {
-  cpu_kernel(iter,
-    [=](float x, float dy, float scale, int64_t zero_point) -> float {
-      float inv_scale = 1.0f / scale;
-      int64_t xq = static_cast<int64_t>(std::nearbyint(x * inv_scale + zero_point));
-      return dy * (xq >= quant_min && xq <= quant_max);
-    });
+  constexpr int64_t kVLen = Vec256<float>::size();
+  const auto quant_min_vec = Vec256<float>(static_cast<float>(quant_min));
+  const auto quant_max_vec = Vec256<float>(static_cast<float>(quant_max));
+  auto op = [=](float x, float dy, float scale, int64_t zero_point) -> float {
+    float inv_scale = 1.0f / scale;
+    int64_t xq = static_cast<int64_t>(std::nearbyint(x * inv_scale + zero_point));
+    return dy * (xq >= quant_min && xq <= quant_max);
+  };
+  iter.for_each([&](char** data, const int64_t* strides, int64_t n) {
+    int64_t i = 0;
+    if (fake_quant_per_channel_vectorizable(strides, 3)) {
+      auto* out = reinterpret_cast<float*>(data[0]);
+      const auto* x = reinterpret_cast<const float*>(data[1]);
+      const auto* dy = reinterpret_cast<const float*>(data[2]);
+      const auto* scale = reinterpret_cast<const float*>(data[3]);
+      const auto* zero_point = reinterpret_cast<const int64_t*>(data[4]);
+      const bool broadcast = strides[3] == 0;
+      for (; i + kVLen <= n; i += kVLen) {
+        Vec256<float> scale_vec, zero_point_vec;
+        load_fake_quant_params(
+            scale + (broadcast ? 0 : i),
+            zero_point + (broadcast ? 0 : i),
+            broadcast,
+            scale_vec,
+            zero_point_vec);
+        auto inv_scale_vec = Vec256<float>(1.0f) / scale_vec;
+        auto xq = (Vec256<float>::loadu(x + i) * inv_scale_vec + zero_point_vec).round();
+        auto mask = (xq >= quant_min_vec) & (xq <= quant_max_vec);
+        (Vec256<float>::loadu(dy + i) & mask).store(out + i);
+      }
+    }
+    for (; i < n; ++i) {
+      *reinterpret_cast<float*>(data[0] + i * strides[0]) = op(
+          *reinterpret_cast<float*>(data[1] + i * strides[1]),
+          *reinterpret_cast<float*>(data[2] + i * strides[2]),
+          *reinterpret_cast<float*>(data[3] + i * strides[3]),
+          *reinterpret_cast<int64_t*>(data[4] + i * strides[4]));
+    }
+  });
+}
+
+void histogram_observer_histc_kernel(
+    const Tensor& input,
+    float min,
+    float max,
+    Tensor& histogram) {
+  using Vec = Vec256<float>;
+  const int64_t nbins = histogram.numel();
+  const int64_t numel = input.numel();
+  const float* x = input.data_ptr<float>();
+  // Every chunk counts into its own int64 histogram, so threads never share
+  // a bin and counts stay exact past 2^24.
+  const int64_t num_chunks = std::max<int64_t>(
+      1,
+      std::min<int64_t>(
+          at::get_num_threads(), at::divup(numel, at::internal::GRAIN_SIZE)));
+  const int64_t chunk_size = at::divup(numel, num_chunks);
+  std::vector<int64_t> counts(num_chunks * nbins, 0);
+
+  const Vec min_vec(min);
+  const Vec range_vec(max - min);
+  const Vec nbins_vec(static_cast<float>(nbins));
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    float pos[Vec::size()];
+    for (int64_t c = begin; c < end; ++c) {
+      int64_t* local = counts.data() + c * nbins;
+      auto count = [&](float v, float p) {
+        if (v >= min && v <= max) {
+          local[std::min(static_cast<int64_t>(p), nbins - 1)] += 1;
+        }
+      };
+      const int64_t stop = std::min(numel, (c + 1) * chunk_size);
+      int64_t i = c * chunk_size;
+      for (; i + Vec::size() <= stop; i += Vec::size()) {
+        ((Vec::loadu(x + i) - min_vec) / range_vec * nbins_vec).store(pos);
+        for (int64_t j = 0; j < Vec::size(); ++j) {
+          count(x[i + j], pos[j]);
+        }
+      }
+      for (; i < stop; ++i) {
+        count(x[i], (x[i] - min) / (max - min) * nbins);
+      }
+    }
+  });
+
+  float* hist = histogram.data_ptr<float>();
+  for (int64_t b = 0; b < nbins; ++b) {
+    int64_t total = 0;
+    for (int64_t c = 0; c < num_chunks; ++c) {
+      total += counts[c * nbins + b];
+    }
+    hist[b] += total;
+  }
+}
+
+double histogram_observer_l2_error_kernel(
+    const double* density,
+    int64_t nbins,
+    double bin_width,
+    int64_t start_bin,
+    int64_t end_bin,
+    int64_t dst_nbins) {
+  using Vec = Vec256<double>;
+  const double dst_bin_width =
+      bin_width * (end_bin - start_bin + 1) / dst_nbins;
+  if (dst_bin_width == 0.0) {
+    return 0.0;
+  }
+  // A source bin [b, e) that falls into quantization bins db..de of half
+  // width h has the error
+  //   density * ((h^3 - a^3) + (de - db - 1) * 2h^3 + (d^3 + h^3)) / 3
+  // where a and d are b and e relative to the centers of db and de. This is
+  // density * ((de - db) * 2h^3 + d^3 - a^3) / 3, which also holds for
+  // db == de, so the loop below needs no branches.
+  const double half = dst_bin_width / 2;
+  const double two_half_cube = 2 * half * half * half;
+  const double max_dst_bin = static_cast<double>(dst_nbins - 1);
+
+  const Vec start_vec(static_cast<double>(start_bin));
+  const Vec bin_width_vec(bin_width);
+  const Vec dst_bin_width_vec(dst_bin_width);
+  const Vec half_vec(half);
+  const Vec two_half_cube_vec(two_half_cube);
+  const Vec zero_vec(0.0);
+  const Vec max_dst_bin_vec(max_dst_bin);
+  Vec norm_vec(0.0);
+  int64_t i = 0;
+  for (; i + Vec::size() <= nbins; i += Vec::size()) {
+    const Vec begin =
+        (Vec::arange(static_cast<double>(i)) - start_vec) * bin_width_vec;
+    const Vec end = begin + bin_width_vec;
+    const Vec db = vec256::clamp(
+        (begin / dst_bin_width_vec).floor(), zero_vec, max_dst_bin_vec);
+    const Vec de = vec256::clamp(
+        (end / dst_bin_width_vec).floor(), zero_vec, max_dst_bin_vec);
+    const Vec a = begin - (db * dst_bin_width_vec + half_vec);
+    const Vec d = end - (de * dst_bin_width_vec + half_vec);
+    norm_vec = norm_vec +
+        Vec::loadu(density + i) *
+            ((de - db) * two_half_cube_vec + d * d * d - a * a * a);
+  }
+  double norm_buf[Vec::size()];
+  norm_vec.store(norm_buf);
+  double norm = 0.0;
+  for (int64_t j = 0; j < Vec::size(); ++j) {
+    norm += norm_buf[j];
+  }
+  for (; i < nbins; ++i) {
+    const double begin = (i - start_bin) * bin_width;
+    const double end = begin + bin_width;
+    const double db = std::min(
+        max_dst_bin, std::max(0.0, std::floor(begin / dst_bin_width)));
+    const double de = std::min(
+        max_dst_bin, std::max(0.0, std::floor(end / dst_bin_width)));
+    const double a = begin - (db * dst_bin_width + half);
+    const double d = end - (de * dst_bin_width + half);
+    norm += density[i] * ((de - db) * two_half_cube + d * d * d - a * a * a);
+  }
+  return norm / 3;
 }
 
 } // namespace
@@ -1414,10 +2128,26 @@ REGISTER_DISPATCH(qcat_nhwc_stub, &qcat_nhwc_kernel<false>);
 REGISTER_DISPATCH(qcat_relu_nhwc_stub, &qcat_nhwc_kernel<true>);
 REGISTER_DISPATCH(qtopk_stub, &qtopk_kernel);
 REGISTER_DISPATCH(qbatch_norm_stub, &q_batch_norm_kernel<false>);
+REGISTER_DISPATCH(qlayer_norm_stub, &quantized_layer_norm_kernel);
+REGISTER_DISPATCH(qgelu_stub, &qgelu_kernel);
+REGISTER_DISPATCH(qsoftmax_stub, &qsoftmax_kernel);
+REGISTER_DISPATCH(qlinear_sparse_stub, &qlinear_sparse_kernel);
 REGISTER_DISPATCH(fake_quant_tensor_stub, &fake_quantize_tensor_kernel);
 REGISTER_DISPATCH(fake_quant_grad_tensor_stub, &fake_quantize_grad_tensor_kernel);
 REGISTER_DISPATCH(fake_quant_per_channel_stub, &fake_quant_per_channel_cpu);
 REGISTER_DISPATCH(fake_quant_grad_per_channel_stub, &fake_quant_grad_per_channel_cpu);
+REGISTER_DISPATCH(
+    quantize_tensor_per_channel_affine_stub,
+    &quantize_tensor_per_channel_affine_cpu);
+REGISTER_DISPATCH(
+    dequantize_tensor_per_channel_affine_stub,
+    &dequantize_tensor_per_channel_affine_cpu);
+REGISTER_DISPATCH(
+    histogram_observer_histc_stub,
+    &histogram_observer_histc_kernel);
+REGISTER_DISPATCH(
+    histogram_observer_l2_error_stub,
+    &histogram_observer_l2_error_kernel);
 
 } // namespace native
 } // namespace at
@@ -0,0 +1,372 @@
+#include <ATen/ATen.h>
+#include <ATen/Parallel.h>
+#include <ATen/core/op_registration/op_registration.h>
+
+#ifndef C10_MOBILE
+#include <caffe2/perfkernels/fused_8bit_rowwise_embedding_lookup_idx.h>
+#endif
+
+#include <algorithm>
+#include <vector>
+
+namespace at {
+namespace native {
+namespace {
+
+// Same mode numbering as at::embedding_bag.
+constexpr int64_t MODE_SUM = 0;
+constexpr int64_t MODE_MEAN = 1;
+
+// Returns the bag boundaries as output_size + 1 absolute int64 offsets, the
+// form the perfkernels take, and checks them against the number of indices.
+std::vector<int64_t> make_bag_offsets(
+    const Tensor& offsets,
+    int64_t num_indices,
+    bool include_last_offset) {
+  TORCH_CHECK(offsets.dim() == 1, "offsets has to be a 1D Tensor");
+  const auto offsets_contig = offsets.to(kLong).contiguous();
+  const int64_t* offsets_data = offsets_contig.data_ptr<int64_t>();
+  std::vector<int64_t> bag_offsets(
+      offsets_data, offsets_data + offsets_contig.numel());
+  if (include_last_offset) {
+    TORCH_CHECK(
+        !bag_offsets.empty(),
+        "offsets must have at least one element with include_last_offset");
+    TORCH_CHECK(
+        bag_offsets.back() == num_indices,
+        "the last offset has to equal the number of indices");
+  } else {
+    bag_offsets.push_back(num_indices);
+  }
+  TORCH_CHECK(
+      bag_offsets.front() >= 0, "offsets[0] has to be non-negative");
+  for (size_t i = 1; i < bag_offsets.size(); ++i) {
+    TORCH_CHECK(
+        bag_offsets[i - 1] <= bag_offsets[i],
+        "offsets has to be a non-decreasing sequence");
+  }
+  TORCH_CHECK(
+      bag_offsets.back() <= num_indices,
+      "offsets exceed the number of indices");
+  return bag_offsets;
+}
+
+void check_embedding_bag_args(
+    const char* op_name,
+    const Tensor& packed_weight,
+    const Tensor& indices,
+    int64_t mode,
+    bool sparse,
+    const c10::optional<Tensor>& per_sample_weights) {
+  TORCH_CHECK(
+      packed_weight.dim() == 2 && packed_weight.scalar_type() == kByte,
+      op_name,
+      " expects a 2D uint8 packed weight");
+  TORCH_CHECK(indices.dim() == 1, "indices has to be a 1D Tensor");
+  TORCH_CHECK(
+      indices.scalar_type() == kInt || indices.scalar_type() == kLong,
+      op_name,
+      " expects int32 or int64 indices");
+  TORCH_CHECK(
+      mode == MODE_SUM || mode == MODE_MEAN,
+      op_name,
+      " only supports sum and mean modes, got mode ",
+      mode);
+  TORCH_CHECK(!sparse, op_name, " does not support sparse gradients");
+  if (per_sample_weights.has_value()) {
+    TORCH_CHECK(
+        mode == MODE_SUM,
+        "per_sample_weights is only supported for mode='sum'");
+    TORCH_CHECK(
+        per_sample_weights->scalar_type() == kFloat,
+        "per_sample_weights has to be a float Tensor");
+    TORCH_CHECK(
+        per_sample_weights->dim() == 1 &&
+            per_sample_weights->numel() == indices.numel(),
+        "per_sample_weights has to be 1D with the same size as indices");
+  }
+}
+
+// Bags are split across threads; aim for roughly GRAIN_SIZE output values of
+// work per task.
+int64_t bag_grain_size(int64_t num_bags, int64_t num_indices, int64_t dim) {
+  const int64_t avg_bag_size = std::max<int64_t>(1, num_indices / std::max<int64_t>(1, num_bags));
+  return std::max<int64_t>(
+      1, internal::GRAIN_SIZE / std::max<int64_t>(1, avg_bag_size * dim));
+}
+
+template <typename IndexType>
+void embedding_bag_byte_impl(
+    const uint8_t* weight_data,
+    int64_t num_rows,
+    int64_t dim,
+    const IndexType* indices_data,
+    const std::vector<int64_t>& bag_offsets,
+    const float* per_sample_weights_data,
+    bool normalize_by_lengths,
+    float* output_data) {
+  const int64_t num_bags = bag_offsets.size() - 1;
+  const int64_t num_indices = bag_offsets.back();
+  at::parallel_for(
+      0,
+      num_bags,
+      bag_grain_size(num_bags, num_indices, dim),
+      [&](int64_t start, int64_t end) {
+        const int64_t first = bag_offsets[start];
+        const float* weights = per_sample_weights_data
+            ? per_sample_weights_data + first
+            : nullptr;
+#ifndef C10_MOBILE
+        caffe2::Fused8BitRowwiseEmbeddingLookupIdx<IndexType, uint8_t, float>(
+            /*block_size=*/dim,
+            /*output_size=*/end - start,
+            /*index_size=*/bag_offsets[end] - first,
+            /*data_size=*/num_rows,
+            weight_data,
+            indices_data + first,
+            bag_offsets.data() + start,
+            weights,
+            normalize_by_lengths,
+            output_data + start * dim);
+#else
+        const int64_t row_size = dim + 2 * sizeof(float);
+        for (int64_t bag = start; bag < end; ++bag) {
+          float* out = output_data + bag * dim;
+          std::fill(out, out + dim, 0.f);
+          for (int64_t i = bag_offsets[bag]; i < bag_offsets[bag + 1]; ++i) {
+            const int64_t idx = indices_data[i];
+            TORCH_CHECK(
+                idx >= 0 && idx < num_rows,
+                "index ",
+                idx,
+                " is out of range for ",
+                num_rows,
+                " embedding rows");
+            const uint8_t* row = weight_data + idx * row_size;
+            const float* scale_bias =
+                reinterpret_cast<const float*>(row + dim);
+            const float w = weights ? weights[i - first] : 1.f;
+            const float scale = w * scale_bias[0];
+            const float bias = w * scale_bias[1];
+            for (int64_t d = 0; d < dim; ++d) {
+              out[d] += scale * row[d] + bias;
+            }
+          }
+          const int64_t length = bag_offsets[bag + 1] - bag_offsets[bag];
+          if (normalize_by_lengths && length > 0) {
+            const float inv_length = 1.f / length;
+            for (int64_t d = 0; d < dim; ++d) {
+              out[d] *= inv_length;
+            }
+          }
+        }
+#endif // C10_MOBILE
+      });
+}
+
+template <typename IndexType>
+void embedding_bag_4bit_impl(
+    const uint8_t* weight_data,
+    int64_t num_rows,
+    int64_t dim,
+    const IndexType* indices_data,
+    const std::vector<int64_t>& bag_offsets,
+    const float* per_sample_weights_data,
+    bool normalize_by_lengths,
+    float* output_data) {
+  constexpr int kBitRate = 4;
+  constexpr int kNumElemPerByte = 8 / kBitRate;
+  const int64_t packed_cols = dim / kNumElemPerByte;
+  const int64_t row_size = packed_cols + 2 * sizeof(at::Half);
+  const int64_t num_bags = bag_offsets.size() - 1;
+  const int64_t num_indices = bag_offsets.back();
+  at::parallel_for(
+      0,
+      num_bags,
+      bag_grain_size(num_bags, num_indices, dim),
+      [&](int64_t start, int64_t end) {
+        for (int64_t bag = start; bag < end; ++bag) {
+          float* out = output_data + bag * dim;
+          std::fill(out, out + dim, 0.f);
+          for (int64_t i = bag_offsets[bag]; i < bag_offsets[bag + 1]; ++i) {
+            const int64_t idx = indices_data[i];
+            TORCH_CHECK(
+                idx >= 0 && idx < num_rows,
+                "index ",
+                idx,
+                " is out of range for ",
+                num_rows,
+                " embedding rows");
+            const uint8_t* row = weight_data + idx * row_size;
+            const at::Half* scale_bias =
+                reinterpret_cast<const at::Half*>(row + packed_cols);
+            const float w =
+                per_sample_weights_data ? per_sample_weights_data[i] : 1.f;
+            const float scale = w * static_cast<float>(scale_bias[0]);
+            const float bias = w * static_cast<float>(scale_bias[1]);
+            for (int64_t j = 0; j < packed_cols; ++j) {
+              const uint8_t packed = row[j];
+              out[2 * j] += scale * (packed & 0xF) + bias;
+              out[2 * j + 1] += scale * (packed >> kBitRate) + bias;
+            }
+          }
+          const int64_t length = bag_offsets[bag + 1] - bag_offsets[bag];
+          if (normalize_by_lengths && length > 0) {
+            const float inv_length = 1.f / length;
+            for (int64_t d = 0; d < dim; ++d) {
+              out[d] *= inv_length;
+            }
+          }
+        }
+      });
+}
+
+// Embedding bag lookup on a table packed by
+// quantized::embedding_bag_byte_prepack. Rows are dequantized on the fly and
+// reduced into a float output of shape [num_bags, D].
+class QEmbeddingBagByte final : public c10::OperatorKernel {
+ public:
+  Tensor operator()(
+      Tensor packed_weight,
+      Tensor indices,
+      Tensor offsets,
+      bool /* scale_grad_by_freq */,
+      int64_t mode,
+      bool sparse,
+      c10::optional<Tensor> per_sample_weights,
+      bool include_last_offset) {
+    check_embedding_bag_args(
+        "quantized::embedding_bag_byte",
+        packed_weight,
+        indices,
+        mode,
+        sparse,
+        per_sample_weights);
+    const auto weight_contig = packed_weight.contiguous();
+    const auto indices_contig = indices.contiguous();
+    const int64_t num_rows = weight_contig.size(0);
+    // The last 8 bytes per row are the float scale and bias.
+    const int64_t dim = weight_contig.size(1) - 2 * sizeof(float);
+    TORCH_CHECK(dim >= 0, "packed weight rows must be at least 8 bytes");
+
+    const auto bag_offsets =
+        make_bag_offsets(offsets, indices_contig.numel(), include_last_offset);
+    const int64_t num_bags = bag_offsets.size() - 1;
+    Tensor output =
+        at::empty({num_bags, dim}, packed_weight.options().dtype(kFloat));
+
+    Tensor per_sample_weights_contig;
+    const float* per_sample_weights_data = nullptr;
+    if (per_sample_weights.has_value()) {
+      per_sample_weights_contig = per_sample_weights->contiguous();
+      per_sample_weights_data = per_sample_weights_contig.data_ptr<float>();
+    }
+
+    if (indices_contig.scalar_type() == kInt) {
+      embedding_bag_byte_impl<int32_t>(
+          weight_contig.data_ptr<uint8_t>(),
+          num_rows,
+          dim,
+          indices_contig.data_ptr<int32_t>(),
+          bag_offsets,
+          per_sample_weights_data,
+          mode == MODE_MEAN,
+          output.data_ptr<float>());
+    } else {
+      embedding_bag_byte_impl<int64_t>(
+          weight_contig.data_ptr<uint8_t>(),
+          num_rows,
+          dim,
+          indices_contig.data_ptr<int64_t>(),
+          bag_offsets,
+          per_sample_weights_data,
+          mode == MODE_MEAN,
+          output.data_ptr<float>());
+    }
+    return output;
+  }
+};
+
+// Embedding bag lookup on a table packed by
+// quantized::embedding_bag_4bit_prepack. The output has one column per packed
+// value, i.e. an odd embedding dimension comes back padded by one column.
+class QEmbeddingBag4Bit final : public c10::OperatorKernel {
+ public:
+  Tensor operator()(
+      Tensor packed_weight,
+      Tensor indices,
+      Tensor offsets,
+      bool /* scale_grad_by_freq */,
+      int64_t mode,
+      bool sparse,
+      c10::optional<Tensor> per_sample_weights,
+      bool include_last_offset) {
+    check_embedding_bag_args(
+        "quantized::embedding_bag_4bit",
+        packed_weight,
+        indices,
+        mode,
+        sparse,
+        per_sample_weights);
+    const auto weight_contig = packed_weight.contiguous();
+    const auto indices_contig = indices.contiguous();
+    const int64_t num_rows = weight_contig.size(0);
+    // The last 4 bytes per row are the half precision scale and bias.
+    const int64_t packed_cols = weight_contig.size(1) - 2 * sizeof(at::Half);
+    TORCH_CHECK(packed_cols >= 0, "packed weight rows must be at least 4 bytes");
+    const int64_t dim = packed_cols * 2;
+
+    const auto bag_offsets =
+        make_bag_offsets(offsets, indices_contig.numel(), include_last_offset);
+    const int64_t num_bags = bag_offsets.size() - 1;
+    Tensor output =
+        at::empty({num_bags, dim}, packed_weight.options().dtype(kFloat));
+
+    Tensor per_sample_weights_contig;
+    const float* per_sample_weights_data = nullptr;
+    if (per_sample_weights.has_value()) {
+      per_sample_weights_contig = per_sample_weights->contiguous();
+      per_sample_weights_data = per_sample_weights_contig.data_ptr<float>();
+    }
+
+    if (indices_contig.scalar_type() == kInt) {
+      embedding_bag_4bit_impl<int32_t>(
+          weight_contig.data_ptr<uint8_t>(),
+          num_rows,
+          dim,
+          indices_contig.data_ptr<int32_t>(),
+          bag_offsets,
+          per_sample_weights_data,
+          mode == MODE_MEAN,
+          output.data_ptr<float>());
+    } else {
+      embedding_bag_4bit_impl<int64_t>(
+          weight_contig.data_ptr<uint8_t>(),
+          num_rows,
+          dim,
+          indices_contig.data_ptr<int64_t>(),
+          bag_offsets,
+          per_sample_weights_data,
+          mode == MODE_MEAN,
+          output.data_ptr<float>());
+    }
+    return output;
+  }
+};
+
+static auto registry =
+    c10::RegisterOperators()
+        .op("quantized::embedding_bag_byte(Tensor weight, Tensor indices, Tensor offsets, "
+            "bool scale_grad_by_freq=False, int mode=0, bool sparse=False, "
+            "Tensor? per_sample_weights=None, bool include_last_offset=False) -> Tensor",
+            c10::RegisterOperators::options().kernel<QEmbeddingBagByte>(
+                DispatchKey::CPUTensorId))
+        .op("quantized::embedding_bag_4bit(Tensor weight, Tensor indices, Tensor offsets, "
+            "bool scale_grad_by_freq=False, int mode=0, bool sparse=False, "
+            "Tensor? per_sample_weights=None, bool include_last_offset=False) -> Tensor",
+            c10::RegisterOperators::options().kernel<QEmbeddingBag4Bit>(
+                DispatchKey::CPUTensorId));
+
+} // namespace
+} // namespace native
+} // namespace at
@@ -0,0 +1,158 @@
+#include <ATen/ATen.h>
+#include <ATen/Parallel.h>
+#include <ATen/core/op_registration/op_registration.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace at {
+namespace native {
+namespace {
+
+// Packs a float [N, D] embedding table into rows of D uint8 values followed by
+// a float scale and a float bias (the row minimum). This is the layout used by
+// the caffe2 Fused8BitRowwise ops, so tables can be shared between the two.
+class QEmbeddingPackWeightByte final : public c10::OperatorKernel {
+ public:
+  Tensor operator()(Tensor weight) {
+    TORCH_CHECK(
+        weight.dim() == 2,
+        "quantized::embedding_bag_byte_prepack expects a 2D weight, got ",
+        weight.dim(),
+        "D");
+    TORCH_CHECK(
+        weight.scalar_type() == kFloat,
+        "quantized::embedding_bag_byte_prepack expects a float weight");
+    const auto weight_contig = weight.contiguous();
+    const int64_t embedding_rows = weight_contig.size(0);
+    const int64_t embedding_cols = weight_contig.size(1);
+    // Add 8 bytes per row for the float scale and bias.
+    const int64_t output_columns = embedding_cols + 2 * sizeof(float);
+    Tensor output = at::empty(
+        {embedding_rows, output_columns}, weight.options().dtype(kByte));
+
+    const float* weight_data = weight_contig.data_ptr<float>();
+    uint8_t* output_data = output.data_ptr<uint8_t>();
+
+    at::parallel_for(
+        0,
+        embedding_rows,
+        std::max<int64_t>(1, internal::GRAIN_SIZE / std::max<int64_t>(1, embedding_cols)),
+        [&](int64_t start, int64_t end) {
+          for (int64_t row = start; row < end; ++row) {
+            const float* input_row = weight_data + row * embedding_cols;
+            uint8_t* output_row = output_data + row * output_columns;
+            float* output_row_scale_bias =
+                reinterpret_cast<float*>(output_row + embedding_cols);
+
+            float minimum_element = 0;
+            float maximum_element = 0;
+            if (embedding_cols > 0) {
+              const auto minmax =
+                  std::minmax_element(input_row, input_row + embedding_cols);
+              minimum_element = *minmax.first;
+              maximum_element = *minmax.second;
+            }
+            const float range = maximum_element - minimum_element;
+
+            output_row_scale_bias[0] = range / 255.0f;
+            output_row_scale_bias[1] = minimum_element;
+            const float inverse_scale = 255.0f / (range + 1e-8f);
+            for (int64_t col = 0; col < embedding_cols; ++col) {
+              output_row[col] = static_cast<uint8_t>(std::lrintf(
+                  (input_row[col] - minimum_element) * inverse_scale));
+            }
+          }
+        });
+    return output;
+  }
+};
+
+// Packs a float [N, D] embedding table into rows of ceil(D / 2) bytes holding
+// two 4-bit values each (the even column in the low nibble) followed by a
+// half precision scale and bias, matching caffe2's FloatToFused4BitRowwise.
+class QEmbeddingPackWeight4Bit final : public c10::OperatorKernel {
+ public:
+  Tensor operator()(Tensor weight) {
+    TORCH_CHECK(
+        weight.dim() == 2,
+        "quantized::embedding_bag_4bit_prepack expects a 2D weight, got ",
+        weight.dim(),
+        "D");
+    TORCH_CHECK(
+        weight.scalar_type() == kFloat,
+        "quantized::embedding_bag_4bit_prepack expects a float weight");
+    constexpr int kBitRate = 4;
+    constexpr int kNumElemPerByte = 8 / kBitRate;
+    const auto weight_contig = weight.contiguous();
+    const int64_t embedding_rows = weight_contig.size(0);
+    const int64_t embedding_cols = weight_contig.size(1);
+    const int64_t packed_cols =
+        (embedding_cols + kNumElemPerByte - 1) / kNumElemPerByte;
+    // Add 4 bytes per row for the half precision scale and bias.
+    const int64_t output_columns = packed_cols + 2 * sizeof(at::Half);
+    Tensor output = at::empty(
+        {embedding_rows, output_columns}, weight.options().dtype(kByte));
+
+    const float* weight_data = weight_contig.data_ptr<float>();
+    uint8_t* output_data = output.data_ptr<uint8_t>();
+
+    at::parallel_for(
+        0,
+        embedding_rows,
+        std::max<int64_t>(1, internal::GRAIN_SIZE / std::max<int64_t>(1, embedding_cols)),
+        [&](int64_t start, int64_t end) {
+          for (int64_t row = start; row < end; ++row) {
+            const float* input_row = weight_data + row * embedding_cols;
+            uint8_t* output_row = output_data + row * output_columns;
+            at::Half* output_row_scale_bias =
+                reinterpret_cast<at::Half*>(output_row + packed_cols);
+
+            float Xmin = 0;
+            float Xmax = 0;
+            if (embedding_cols > 0) {
+              const auto minmax =
+                  std::minmax_element(input_row, input_row + embedding_cols);
+              Xmin = *minmax.first;
+              Xmax = *minmax.second;
+            }
+            // Round Xmin to fp16 so quantization matches the fp16 bias used
+            // during dequantization.
+            Xmin = static_cast<at::Half>(Xmin);
+            const float range = Xmax - Xmin;
+            at::Half scale =
+                range == 0 ? 1.0f : range / ((1 << kBitRate) - 1);
+            // A range too small for fp16 would make the scale 0; use 1 so the
+            // inverse stays finite.
+            if (scale == 0) {
+              scale = 1.0f;
+            }
+            const float inverse_scale = 1.0f / scale;
+            output_row_scale_bias[0] = scale;
+            output_row_scale_bias[1] = Xmin;
+
+            std::fill(output_row, output_row + packed_cols, 0);
+            for (int64_t col = 0; col < embedding_cols; ++col) {
+              int quantized = std::lrintf((input_row[col] - Xmin) * inverse_scale);
+              quantized = std::max(0, std::min(quantized, (1 << kBitRate) - 1));
+              output_row[col / kNumElemPerByte] |=
+                  quantized << ((col % kNumElemPerByte) * kBitRate);
+            }
+          }
+        });
+    return output;
+  }
+};
+
+static auto registry =
+    c10::RegisterOperators()
+        .op("quantized::embedding_bag_byte_prepack(Tensor weight) -> Tensor",
+            c10::RegisterOperators::options().kernel<QEmbeddingPackWeightByte>(
+                DispatchKey::CPUTensorId))
+        .op("quantized::embedding_bag_4bit_prepack(Tensor weight) -> Tensor",
+            c10::RegisterOperators::options().kernel<QEmbeddingPackWeight4Bit>(
+                DispatchKey::CPUTensorId));
+
+} // namespace
+} // namespace native
+} // namespace at
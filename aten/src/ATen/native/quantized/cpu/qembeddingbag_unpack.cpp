@@ -0,0 +1,113 @@
+#include <ATen/ATen.h>
+#include <ATen/Parallel.h>
+#include <ATen/core/op_registration/op_registration.h>
+
+#include <algorithm>
+
+namespace at {
+namespace native {
+namespace {
+
+// Inverse of quantized::embedding_bag_byte_prepack.
+class QEmbeddingUnpackWeightByte final : public c10::OperatorKernel {
+ public:
+  Tensor operator()(Tensor packed_weight) {
+    TORCH_CHECK(
+        packed_weight.dim() == 2 && packed_weight.scalar_type() == kByte,
+        "quantized::embedding_bag_byte_unpack expects a 2D uint8 tensor");
+    const auto packed_contig = packed_weight.contiguous();
+    const int64_t input_rows = packed_contig.size(0);
+    const int64_t input_columns = packed_contig.size(1);
+    // The last 8 bytes per row are the float scale and bias.
+    const int64_t output_columns = input_columns - 2 * sizeof(float);
+    TORCH_CHECK(
+        output_columns >= 0,
+        "quantized::embedding_bag_byte_unpack expects rows of at least 8 bytes");
+
+    Tensor output = at::empty(
+        {input_rows, output_columns}, packed_weight.options().dtype(kFloat));
+    const uint8_t* input_data = packed_contig.data_ptr<uint8_t>();
+    float* output_data = output.data_ptr<float>();
+
+    at::parallel_for(
+        0,
+        input_rows,
+        std::max<int64_t>(1, internal::GRAIN_SIZE / std::max<int64_t>(1, output_columns)),
+        [&](int64_t start, int64_t end) {
+          for (int64_t row = start; row < end; ++row) {
+            const uint8_t* input_row = input_data + row * input_columns;
+            const float* input_row_scale_bias =
+                reinterpret_cast<const float*>(input_row + output_columns);
+            float* output_row = output_data + row * output_columns;
+            for (int64_t col = 0; col < output_columns; ++col) {
+              output_row[col] = input_row[col] * input_row_scale_bias[0] +
+                  input_row_scale_bias[1];
+            }
+          }
+        });
+    return output;
+  }
+};
+
+// Inverse of quantized::embedding_bag_4bit_prepack. Each packed row holds an
+// even number of values, so an odd embedding dimension unpacks with one extra
+// trailing column.
+class QEmbeddingUnpackWeight4Bit final : public c10::OperatorKernel {
+ public:
+  Tensor operator()(Tensor packed_weight) {
+    TORCH_CHECK(
+        packed_weight.dim() == 2 && packed_weight.scalar_type() == kByte,
+        "quantized::embedding_bag_4bit_unpack expects a 2D uint8 tensor");
+    constexpr int kBitRate = 4;
+    constexpr int kNumElemPerByte = 8 / kBitRate;
+    const auto packed_contig = packed_weight.contiguous();
+    const int64_t input_rows = packed_contig.size(0);
+    const int64_t input_columns = packed_contig.size(1);
+    // The last 4 bytes per row are the half precision scale and bias.
+    const int64_t packed_cols = input_columns - 2 * sizeof(at::Half);
+    TORCH_CHECK(
+        packed_cols >= 0,
+        "quantized::embedding_bag_4bit_unpack expects rows of at least 4 bytes");
+    const int64_t output_columns = packed_cols * kNumElemPerByte;
+
+    Tensor output = at::empty(
+        {input_rows, output_columns}, packed_weight.options().dtype(kFloat));
+    const uint8_t* input_data = packed_contig.data_ptr<uint8_t>();
+    float* output_data = output.data_ptr<float>();
+
+    at::parallel_for(
+        0,
+        input_rows,
+        std::max<int64_t>(1, internal::GRAIN_SIZE / std::max<int64_t>(1, output_columns)),
+        [&](int64_t start, int64_t end) {
+          for (int64_t row = start; row < end; ++row) {
+            const uint8_t* input_row = input_data + row * input_columns;
+            const at::Half* input_row_scale_bias =
+                reinterpret_cast<const at::Half*>(input_row + packed_cols);
+            const float scale = input_row_scale_bias[0];
+            const float bias = input_row_scale_bias[1];
+            float* output_row = output_data + row * output_columns;
+            for (int64_t col = 0; col < output_columns; ++col) {
+              uint8_t quantized = input_row[col / kNumElemPerByte];
+              quantized >>= (col % kNumElemPerByte) * kBitRate;
+              quantized &= (1 << kBitRate) - 1;
+              output_row[col] = scale * quantized + bias;
+            }
+          }
+        });
+    return output;
+  }
+};
+
+static auto registry =
+    c10::RegisterOperators()
+        .op("quantized::embedding_bag_byte_unpack(Tensor weight) -> Tensor",
+            c10::RegisterOperators::options().kernel<QEmbeddingUnpackWeightByte>(
+                DispatchKey::CPUTensorId))
+        .op("quantized::embedding_bag_4bit_unpack(Tensor weight) -> Tensor",
+            c10::RegisterOperators::options().kernel<QEmbeddingUnpackWeight4Bit>(
+                DispatchKey::CPUTensorId));
+
+} // namespace
+} // namespace native
+} // namespace at
@@ -0,0 +1,39 @@
+#include <ATen/ATen.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/core/op_registration/op_registration.h>
+#include <ATen/native/quantized/cpu/quantized_ops.h>
+
+namespace at {
+namespace native {
+
+DEFINE_DISPATCH(qgelu_stub);
+
+namespace {
+
+class QGelu final : public torch::OperatorKernel {
+ public:
+  Tensor operator()(Tensor qx, double output_scale, int64_t output_zero_point) {
+    TORCH_CHECK(
+        qx.qscheme() == kPerTensorAffine,
+        "quantized::gelu only supports per tensor quantized inputs.");
+    auto memory_format = qx.suggest_memory_format();
+    Tensor qx_contig = qx.contiguous(memory_format);
+    Tensor qy = at::_empty_affine_quantized(
+        qx_contig.sizes(),
+        at::device(kCPU).dtype(qx_contig.scalar_type()),
+        output_scale,
+        output_zero_point,
+        memory_format);
+    qgelu_stub(qx_contig.device().type(), qx_contig, qy);
+    return qy;
+  }
+};
+
+static auto registry = torch::RegisterOperators().op(
+    "quantized::gelu(Tensor qx, float output_scale, int output_zero_point) -> Tensor",
+    torch::RegisterOperators::options().kernel<QGelu>(
+        DispatchKey::QuantizedCPUTensorId));
+
+} // namespace
+} // namespace native
+} // namespace at
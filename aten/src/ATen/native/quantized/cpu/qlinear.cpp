@@ -4,6 +4,7 @@
 #include <ATen/cpp_custom_type_hack.h>
 #include <ATen/native/quantized/cpu/fbgemm_utils.h>
 #include <ATen/native/quantized/cpu/qnnpack_utils.h>
+#include <ATen/native/quantized/cpu/sparse_utils.h>
 #include <caffe2/utils/threadpool/ThreadPoolMobile.h>
 
 #include <algorithm>
@@ -11,6 +12,9 @@
 
 namespace at {
 namespace native {
+
+DEFINE_DISPATCH(qlinear_sparse_stub);
+
 namespace {
 
 template <bool ReluFused>
@@ -326,6 +330,91 @@ class QLinearInt8 final : public torch::OperatorKernel {
     return output;
   }
 #endif
+  at::Tensor sparse_linear(
+      at::Tensor input,
+      at::Tensor packed_weight,
+      double output_scale,
+      int64_t output_zero_point) {
+    TORCH_CHECK(
+        input.dim() >= 2,
+        "quantized::linear(): Input tensor rank should be >= 2");
+    TORCH_CHECK(
+        input.scalar_type() == c10::kQUInt8,
+        "quantized::linear (sparse): Expected input data type ",
+        toString(c10::kQUInt8),
+        " but got ",
+        toString(input.scalar_type()));
+    auto& pack_ptr =
+        cpp_custom_type_hack::cast<PackedLinearWeightSparse>(packed_weight);
+    const int64_t N = pack_ptr.N;
+    const int64_t K = pack_ptr.K;
+    TORCH_CHECK(
+        input.size(input.dim() - 1) == K,
+        "quantized::linear(): input size does not match weight dimension 1 size: "
+        "got ",
+        input.size(input.dim() - 1),
+        ", but weight dimension 1 size is ",
+        K);
+
+    auto input_contig = input.contiguous();
+    const int64_t M = size_to_dim_(input.dim() - 1, input.sizes());
+    std::vector<int64_t> out_sizes = input.sizes().vec();
+    out_sizes.back() = N;
+    auto output = at::_empty_affine_quantized(
+        out_sizes,
+        at::device(kCPU).dtype(kQUInt8),
+        output_scale,
+        output_zero_point);
+    if (M == 0 || N == 0) {
+      return output;
+    }
+
+    std::vector<int32_t> acc(M * N);
+    qlinear_sparse_stub(
+        input.device().type(),
+        reinterpret_cast<uint8_t*>(input_contig.data_ptr<c10::quint8>()),
+        M,
+        input.q_zero_point(),
+        pack_ptr,
+        acc.data());
+
+    // Requantize: Y = (acc * input_scale * w_scale + bias) / Y_scale + Y_zp.
+    const float input_scale = input.q_scale();
+    const float inv_output_scale = 1.0f / output_scale;
+    const float* bias_ptr =
+        pack_ptr.bias.has_value() ? pack_ptr.bias->data_ptr<float>() : nullptr;
+    std::vector<float> multipliers(N);
+    std::vector<float> bias_q(N, 0.0f);
+    for (int64_t n = 0; n < N; ++n) {
+      const float w_scale =
+          pack_ptr.w_scale[pack_ptr.q_scheme == kPerTensorAffine ? 0 : n];
+      multipliers[n] = input_scale * w_scale * inv_output_scale;
+      if (bias_ptr) {
+        bias_q[n] = bias_ptr[n] * inv_output_scale;
+      }
+    }
+    const int32_t qmin = ReluFused ? output_zero_point : 0;
+    const int32_t qmax = std::numeric_limits<uint8_t>::max();
+    auto* output_ptr =
+        reinterpret_cast<uint8_t*>(output.data_ptr<c10::quint8>());
+    at::parallel_for(
+        0,
+        M,
+        std::max<int64_t>(1, at::internal::GRAIN_SIZE / N),
+        [&](int64_t begin, int64_t end) {
+          for (int64_t m = begin; m < end; ++m) {
+            for (int64_t n = 0; n < N; ++n) {
+              const int32_t q = static_cast<int32_t>(output_zero_point) +
+                  static_cast<int32_t>(std::nearbyint(
+                      acc[m * N + n] * multipliers[n] + bias_q[n]));
+              output_ptr[m * N + n] =
+                  static_cast<uint8_t>(std::min(std::max(q, qmin), qmax));
+            }
+          }
+        });
+    return output;
+  }
+
   at::Tensor operator()(
       at::Tensor input,
       at::Tensor packed_weight,
@@ -333,6 +422,11 @@ class QLinearInt8 final : public torch::OperatorKernel {
       int64_t output_zero_point) {
     auto& ctx = at::globalContext();
 
+    // Block sparse weights run the same kernel on every engine.
+    if (cpp_custom_type_hack::isa<PackedLinearWeightSparse>(packed_weight)) {
+      return sparse_linear(
+          input, packed_weight, output_scale, output_zero_point);
+    }
 #ifdef USE_FBGEMM
     if (ctx.qEngine() == at::QEngine::FBGEMM) {
       return fbgemm_linear(
@@ -352,6 +446,190 @@ class QLinearInt8 final : public torch::OperatorKernel {
   }
 };
 
+// Linear with a skip connection, Y = [relu](linear(X) + other). Only FBGEMM
+// exposes the int32 accumulators of its GEMM, which is what lets the add
+// happen before the only requantization. QNNPACK and the convolution kernels
+// requantize their output, and adding the residual to that would round twice
+// through an unobserved intermediate scale, so they have no fused variant.
+template <bool ReluFused>
+class QLinearAddInt8 final : public torch::OperatorKernel {
+ public:
+#ifdef USE_FBGEMM
+  // The GEMM dequantizes its int32 accumulators straight into a float buffer
+  // (ReQuantizeForFloat), and the residual add, relu and the only
+  // requantization happen in a single pass over that buffer.
+  at::Tensor fbgemm_linear_add(
+      at::Tensor input,
+      at::Tensor packed_weight,
+      at::Tensor other,
+      double output_scale,
+      int64_t output_zero_point) {
+    TORCH_CHECK(
+        fbgemm::fbgemmSupportedCPU(), "Your CPU does not support FBGEMM.");
+    TORCH_CHECK(
+        input.dim() >= 2,
+        "The dimension of input tensor should be larger than or equal to 2");
+    auto input_contig = input.contiguous();
+    const auto* input_ptr =
+        reinterpret_cast<uint8_t*>(input_contig.data_ptr<c10::quint8>());
+    int64_t M = size_to_dim_(input.dim() - 1, input.sizes());
+
+    auto& pack_ptr =
+        cpp_custom_type_hack::cast<PackedLinearWeight>(packed_weight);
+    auto packB = pack_ptr.w.get();
+    auto& col_offsets = pack_ptr.col_offsets;
+
+    int64_t N = static_cast<int64_t>(packB->numCols());
+    int64_t K = input.size(input.dim() - 1);
+    TORCH_CHECK(
+        K == static_cast<int64_t>(packB->numRows()),
+        "The number of rows in the packB should be equal to K: " +
+            std::to_string(K));
+
+    const float* bias_ptr = nullptr;
+    at::Tensor bias;
+    if (pack_ptr.bias.has_value()) {
+      bias = pack_ptr.bias.value();
+      bias = bias.contiguous();
+      TORCH_CHECK(bias.dim() == 1, "bias should be a vector (1D Tensor)");
+      TORCH_CHECK(
+          bias.size(0) == N,
+          "bias should have N elements: " + std::to_string(N));
+      bias_ptr = bias.data_ptr<float>();
+    }
+
+    std::vector<int64_t> out_sizes = input.sizes().vec();
+    out_sizes.back() = N;
+    TORCH_CHECK(
+        other.sizes() == IntArrayRef(out_sizes),
+        "quantized::linear_add: other has size ",
+        other.sizes(),
+        " but the linear output has size ",
+        IntArrayRef(out_sizes));
+    auto other_contig = other.contiguous();
+
+    auto output_fp32 = at::empty(out_sizes, input.options().dtype(at::kFloat));
+    auto buffer = at::empty(out_sizes, input.options().dtype(at::kInt));
+
+    const float input_scale_float = input.q_scale();
+    const int32_t input_zero_point_int32 = input.q_zero_point();
+
+    int num_tasks = at::get_num_threads();
+    at::parallel_for(0, num_tasks, 1, [&](int64_t begin, int64_t end) {
+      fbgemm::DoNothing<float, float> doNothingObj{};
+      for (int task_id = begin; task_id < end; ++task_id) {
+        fbgemm::PackAWithRowOffset<uint8_t> packA(
+            /*trans=*/fbgemm::matrix_op_t::NoTranspose,
+            /*nRow=*/M,
+            /*nCol=*/K,
+            /*smat=*/input_ptr,
+            /*ld=*/K,
+            /*pmat=*/nullptr);
+
+        if (pack_ptr.q_scheme == kPerTensorAffine) {
+          fbgemm::ReQuantizeForFloat<false> outputProcObj(
+              /*nextop=*/doNothingObj,
+              /*Aq_scale=*/input_scale_float,
+              /*Bq_scale=*/pack_ptr.w_scale.data(),
+              /*Aq_zero_point=*/input_zero_point_int32,
+              /*Bq_zero_point=*/pack_ptr.w_zp.data(),
+              /*row_offsets=*/packA.getRowOffsetBuffer(),
+              /*col_offsets=*/col_offsets.data(),
+              /*bias=*/bias_ptr,
+              /*nCol=*/N);
+          fbgemm::fbgemmPacked(
+              /*packA=*/packA,
+              /*packB=*/*packB,
+              /*C=*/output_fp32.data_ptr<float>(),
+              /*C_buffer=*/buffer.data_ptr<int32_t>(),
+              /*ldc=*/N,
+              /*outProcess=*/outputProcObj,
+              /*thread_id=*/task_id,
+              /*num_threads=*/num_tasks);
+        } else if (pack_ptr.q_scheme == kPerChannelAffine) {
+          fbgemm::ReQuantizeForFloat<
+              false,
+              fbgemm::QuantizationGranularity::OUT_CHANNEL>
+              outputProcObj(
+                  /*nextop=*/doNothingObj,
+                  /*Aq_scale=*/input_scale_float,
+                  /*Bq_scale=*/pack_ptr.w_scale.data(),
+                  /*Aq_zero_point=*/input_zero_point_int32,
+                  /*Bq_zero_point=*/pack_ptr.w_zp.data(),
+                  /*row_offsets=*/packA.getRowOffsetBuffer(),
+                  /*col_offsets=*/col_offsets.data(),
+                  /*bias=*/bias_ptr,
+                  /*nCol=*/N);
+          fbgemm::fbgemmPacked(
+              /*packA=*/packA,
+              /*packB=*/*packB,
+              /*C=*/output_fp32.data_ptr<float>(),
+              /*C_buffer=*/buffer.data_ptr<int32_t>(),
+              /*ldc=*/N,
+              /*outProcess=*/outputProcObj,
+              /*thread_id=*/task_id,
+              /*num_threads=*/num_tasks);
+        }
+      }
+    });
+
+    auto output = _empty_affine_quantized(
+        out_sizes,
+        at::device(kCPU).dtype(kQUInt8),
+        output_scale,
+        output_zero_point);
+    const float* y_ptr = output_fp32.data_ptr<float>();
+    const uint8_t* other_ptr =
+        reinterpret_cast<uint8_t*>(other_contig.data_ptr<c10::quint8>());
+    uint8_t* output_ptr =
+        reinterpret_cast<uint8_t*>(output.data_ptr<c10::quint8>());
+    const float other_scale = other.q_scale();
+    const int32_t other_zero_point = other.q_zero_point();
+    const float inv_output_scale = 1.0f / static_cast<float>(output_scale);
+    // Relu in the quantized domain clamps at the zero point.
+    const int32_t qmin = ReluFused ? output_zero_point : 0;
+    at::parallel_for(
+        0, M * N, at::internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            const float y = y_ptr[i] +
+                other_scale * (static_cast<int32_t>(other_ptr[i]) -
+                               other_zero_point);
+            const int32_t q = static_cast<int32_t>(
+                                  std::nearbyint(y * inv_output_scale)) +
+                output_zero_point;
+            output_ptr[i] =
+                static_cast<uint8_t>(std::min<int32_t>(255, std::max(qmin, q)));
+          }
+        });
+    return output;
+  }
+#endif
+  at::Tensor operator()(
+      at::Tensor input,
+      at::Tensor packed_weight,
+      at::Tensor other,
+      double output_scale,
+      int64_t output_zero_point) {
+    TORCH_CHECK(
+        other.scalar_type() == kQUInt8 &&
+            other.qscheme() == kPerTensorAffine,
+        "quantized::linear_add: other must be a per tensor quantized quint8 "
+        "tensor");
+    auto& ctx = at::globalContext();
+
+#ifdef USE_FBGEMM
+    if (ctx.qEngine() == at::QEngine::FBGEMM) {
+      return fbgemm_linear_add(
+          input, packed_weight, other, output_scale, output_zero_point);
+    }
+#endif
+    TORCH_CHECK(
+        false,
+        "Didn't find engine for operation quantized::linear_add ",
+        toString(ctx.qEngine()));
+  }
+};
+
 static auto registry =
     torch::RegisterOperators()
         .op("quantized::linear(Tensor X, Tensor W_prepack, float Y_scale_i, int Y_zero_point_i) -> Tensor Y",
@@ -359,6 +637,12 @@ static auto registry =
                 DispatchKey::QuantizedCPUTensorId))
         .op("quantized::linear_relu(Tensor X, Tensor W_prepack, float Y_scale_i, int Y_zero_point_i) -> Tensor Y",
             torch::RegisterOperators::options().kernel<QLinearInt8<true>>(
+                DispatchKey::QuantizedCPUTensorId))
+        .op("quantized::linear_add(Tensor X, Tensor W_prepack, Tensor other, float Y_scale_i, int Y_zero_point_i) -> Tensor Y",
+            torch::RegisterOperators::options().kernel<QLinearAddInt8<false>>(
+                DispatchKey::QuantizedCPUTensorId))
+        .op("quantized::linear_add_relu(Tensor X, Tensor W_prepack, Tensor other, float Y_scale_i, int Y_zero_point_i) -> Tensor Y",
+            torch::RegisterOperators::options().kernel<QLinearAddInt8<true>>(
                 DispatchKey::QuantizedCPUTensorId));
 } // namespace
 } // namespace native
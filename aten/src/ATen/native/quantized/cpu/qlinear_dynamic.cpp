@@ -8,12 +8,51 @@
 #include <caffe2/utils/threadpool/ThreadPoolMobile.h>
 
 #include <algorithm>
+#include <limits>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace at {
 namespace native {
 namespace {
 
+#ifdef USE_FBGEMM
+// fbgemm::FindMinMax is vectorized but runs on a single thread. Large inputs
+// are split into chunks that are scanned in parallel.
+void ParallelFindMinMax(
+    const float* data,
+    int64_t len,
+    float* min,
+    float* max) {
+  if (len <= 0) {
+    *min = 0.0f;
+    *max = 0.0f;
+    return;
+  }
+  using MinMax = std::pair<float, float>;
+  const MinMax result = at::parallel_reduce(
+      0,
+      len,
+      at::internal::GRAIN_SIZE,
+      MinMax(
+          std::numeric_limits<float>::max(),
+          std::numeric_limits<float>::lowest()),
+      [&](int64_t begin, int64_t end, MinMax ident) {
+        float chunk_min, chunk_max;
+        fbgemm::FindMinMax(data + begin, &chunk_min, &chunk_max, end - begin);
+        return MinMax(
+            std::min(ident.first, chunk_min),
+            std::max(ident.second, chunk_max));
+      },
+      [](MinMax a, MinMax b) {
+        return MinMax(std::min(a.first, b.first), std::max(a.second, b.second));
+      });
+  *min = result.first;
+  *max = result.second;
+}
+#endif // USE_FBGEMM
+
 template <bool ReluFused>
 class QLinearDynamicInt8 final : public torch::OperatorKernel {
  public:
@@ -56,11 +95,11 @@ class QLinearDynamicInt8 final : public torch::OperatorKernel {
 
     // Calculate statistics for quantization of the input Tensor
     float x_min, x_max;
-    fbgemm::FindMinMax(
-        /*m=*/input_ptr,
+    ParallelFindMinMax(
+        /*data=*/input_ptr,
+        /*len=*/input_contig.numel(),
         /*min=*/&x_min,
-        /*max=*/&x_max,
-        /*len=*/input.numel());
+        /*max=*/&x_max);
 
     // Input tensor is quantized as 8-bit unsigned values
     static constexpr int precision = 8;
@@ -336,6 +375,191 @@ class QLinearDynamicInt8 final : public torch::OperatorKernel {
   }
 };
 
+// Dynamic quantization with one scale and zero point per row (token) of the
+// input, so that a few outlier tokens do not cost the resolution of all the
+// others.
+//
+// The GEMM runs with an input scale of 1 and zero point 0, which leaves
+// w_scale[n] * (acc - w_zp[n] * row_offset[m]) in the output. The per-row
+// scale and the a_zp[m] * col_offsets[n] term are separable, so they are
+// applied together with the bias and relu in one pass afterwards.
+template <bool ReluFused>
+class QLinearDynamicPerTokenInt8 final : public torch::OperatorKernel {
+ public:
+#ifdef USE_FBGEMM
+  at::Tensor operator()(at::Tensor input, at::Tensor packed_weight) {
+    TORCH_CHECK(
+        fbgemm::fbgemmSupportedCPU(), "Your CPU does not support FBGEMM.");
+    TORCH_CHECK(
+        at::globalContext().qEngine() == at::QEngine::FBGEMM,
+        "quantized::linear_dynamic_per_token is only supported by the FBGEMM "
+        "engine");
+    TORCH_CHECK(
+        input.dim() >= 2,
+        "The dimension of input tensor should be larger than or equal to 2");
+    auto input_contig = input.contiguous();
+    const float* input_ptr = input_contig.data_ptr<float>();
+    const int64_t M = size_to_dim_(input.dim() - 1, input.sizes());
+
+    auto& pack_ptr =
+        cpp_custom_type_hack::cast<PackedLinearWeight>(packed_weight);
+    auto packB = pack_ptr.w.get();
+    auto& col_offsets = pack_ptr.col_offsets;
+
+    const int64_t N = static_cast<int64_t>(packB->numCols());
+    const int64_t K = input.size(input.dim() - 1);
+    TORCH_CHECK(
+        K == static_cast<int64_t>(packB->numRows()),
+        "The number of rows in the packB should be equal to K: " +
+            std::to_string(K));
+
+    const float* bias_ptr = nullptr;
+    at::Tensor bias_contig;
+    if (pack_ptr.bias.has_value()) {
+      TORCH_CHECK(
+          pack_ptr.bias->dim() == 1, "bias should be a vector (1D Tensor)");
+      TORCH_CHECK(
+          pack_ptr.bias->size(0) == N,
+          "bias should have N elements: " + std::to_string(N));
+      bias_contig = pack_ptr.bias->contiguous();
+      bias_ptr = bias_contig.data_ptr<float>();
+    }
+
+    // Find the range of every row and quantize it in the same pass, while the
+    // row is still in cache.
+    std::vector<uint8_t> input_q(M * K);
+    std::vector<float> row_scales(M);
+    std::vector<int32_t> row_zero_points(M);
+    at::parallel_for(
+        0,
+        M,
+        std::max<int64_t>(1, at::internal::GRAIN_SIZE / std::max<int64_t>(1, K)),
+        [&](int64_t begin, int64_t end) {
+          for (int64_t m = begin; m < end; ++m) {
+            const float* row = input_ptr + m * K;
+            float x_min, x_max;
+            fbgemm::FindMinMax(row, &x_min, &x_max, K);
+            auto q_params = quant_utils::ChooseQuantizationParams(
+                /*min=*/x_min,
+                /*max=*/x_max,
+                /*qmin=*/0,
+                /*qmax=*/255);
+            fbgemm::TensorQuantizationParams row_qparams;
+            row_qparams.scale = q_params.scale;
+            row_qparams.zero_point = q_params.zero_point;
+            row_qparams.precision = 8;
+            fbgemm::Quantize<uint8_t>(row, input_q.data() + m * K, K, row_qparams);
+            row_scales[m] = q_params.scale;
+            row_zero_points[m] = q_params.zero_point;
+          }
+        });
+
+    std::vector<int64_t> out_sizes = input.sizes().vec();
+    out_sizes.back() = N;
+    auto output = at::empty(out_sizes, input.options().dtype(at::kFloat));
+    auto buffer = at::empty(out_sizes, input.options().dtype(at::kInt));
+    float* output_ptr = output.data_ptr<float>();
+
+    // The unit input scale and zero point of the GEMM (see above).
+    const float kUnitScale = 1.0f;
+    const int32_t kZeroZeroPoint = 0;
+    int num_tasks = at::get_num_threads();
+    at::parallel_for(0, num_tasks, 1, [&](int64_t begin, int64_t end) {
+      fbgemm::DoNothing<float, float> doNothingObj{};
+      for (int task_id = begin; task_id < end; ++task_id) {
+        fbgemm::PackAWithRowOffset<uint8_t> packA(
+            /*trans=*/fbgemm::matrix_op_t::NoTranspose,
+            /*nRow=*/M,
+            /*nCol=*/K,
+            /*smat=*/input_q.data(),
+            /*ld=*/K,
+            /*pmat=*/nullptr);
+
+        if (pack_ptr.q_scheme == kPerTensorAffine) {
+          fbgemm::ReQuantizeForFloat<false> outputProcObj(
+              /*nextop=*/doNothingObj,
+              /*Aq_scale=*/kUnitScale,
+              /*Bq_scale=*/pack_ptr.w_scale.data(),
+              /*Aq_zero_point=*/kZeroZeroPoint,
+              /*Bq_zero_point=*/pack_ptr.w_zp.data(),
+              /*row_offsets=*/packA.getRowOffsetBuffer(),
+              /*col_offsets=*/col_offsets.data(),
+              /*bias=*/nullptr,
+              /*nCol=*/N);
+          fbgemm::fbgemmPacked(
+              /*packA=*/packA,
+              /*packB=*/*packB,
+              /*C=*/output_ptr,
+              /*C_buffer=*/buffer.data_ptr<int32_t>(),
+              /*ldc=*/N,
+              /*outProcess=*/outputProcObj,
+              /*thread_id=*/task_id,
+              /*num_threads=*/num_tasks);
+        } else if (pack_ptr.q_scheme == kPerChannelAffine) {
+          fbgemm::ReQuantizeForFloat<
+              false,
+              fbgemm::QuantizationGranularity::OUT_CHANNEL>
+              outputProcObj(
+                  /*nextop=*/doNothingObj,
+                  /*Aq_scale=*/kUnitScale,
+                  /*Bq_scale=*/pack_ptr.w_scale.data(),
+                  /*Aq_zero_point=*/kZeroZeroPoint,
+                  /*Bq_zero_point=*/pack_ptr.w_zp.data(),
+                  /*row_offsets=*/packA.getRowOffsetBuffer(),
+                  /*col_offsets=*/col_offsets.data(),
+                  /*bias=*/nullptr,
+                  /*nCol=*/N);
+          fbgemm::fbgemmPacked(
+              /*packA=*/packA,
+              /*packB=*/*packB,
+              /*C=*/output_ptr,
+              /*C_buffer=*/buffer.data_ptr<int32_t>(),
+              /*ldc=*/N,
+              /*outProcess=*/outputProcObj,
+              /*thread_id=*/task_id,
+              /*num_threads=*/num_tasks);
+        }
+      }
+    });
+
+    // w_scale[n] * col_offsets[n], shared by every row.
+    const bool per_channel = pack_ptr.q_scheme == kPerChannelAffine;
+    std::vector<float> scaled_col_offsets(N);
+    for (int64_t n = 0; n < N; ++n) {
+      scaled_col_offsets[n] =
+          pack_ptr.w_scale[per_channel ? n : 0] * col_offsets[n];
+    }
+    at::parallel_for(
+        0,
+        M,
+        std::max<int64_t>(1, at::internal::GRAIN_SIZE / std::max<int64_t>(1, N)),
+        [&](int64_t begin, int64_t end) {
+          for (int64_t m = begin; m < end; ++m) {
+            float* out_row = output_ptr + m * N;
+            const float row_scale = row_scales[m];
+            const float row_zero_point = row_zero_points[m];
+            for (int64_t n = 0; n < N; ++n) {
+              float y = row_scale *
+                  (out_row[n] - row_zero_point * scaled_col_offsets[n]);
+              if (bias_ptr) {
+                y += bias_ptr[n];
+              }
+              out_row[n] = ReluFused ? std::max(y, 0.0f) : y;
+            }
+          }
+        });
+    return output;
+  }
+#else // USE_FBGEMM
+  at::Tensor operator()(
+      at::Tensor /* input */,
+      at::Tensor /* packed_weight */) {
+    TORCH_CHECK(
+        false, "This PyTorch installation was not built with FBGEMM operators");
+  }
+#endif // USE_FBGEMM
+};
+
 template <bool ReluFused>
 class QLinearDynamicFp16 final : public torch::OperatorKernel {
  public:
@@ -406,6 +630,12 @@ static auto registry =
         .op("quantized::linear_relu_dynamic(Tensor X, Tensor W_prepack) -> Tensor Y",
             torch::RegisterOperators::options()
                 .kernel<QLinearDynamicInt8<true>>(DispatchKey::CPUTensorId))
+        .op("quantized::linear_dynamic_per_token(Tensor X, Tensor W_prepack) -> Tensor Y",
+            torch::RegisterOperators::options()
+                .kernel<QLinearDynamicPerTokenInt8<false>>(DispatchKey::CPUTensorId))
+        .op("quantized::linear_relu_dynamic_per_token(Tensor X, Tensor W_prepack) -> Tensor Y",
+            torch::RegisterOperators::options()
+                .kernel<QLinearDynamicPerTokenInt8<true>>(DispatchKey::CPUTensorId))
         .op("quantized::linear_dynamic_fp16(Tensor X, Tensor W_prepack) -> Tensor Y",
             torch::RegisterOperators::options()
                 .kernel<QLinearDynamicFp16<false>>(DispatchKey::CPUTensorId));
@@ -1,14 +1,18 @@
 #include <ATen/ATen.h>
+#include <ATen/Parallel.h>
 #include <ATen/core/op_registration/op_registration.h>
 #include <ATen/cpp_custom_type_hack.h>
 #include <ATen/native/quantized/cpu/fbgemm_utils.h>
 #include <ATen/native/quantized/cpu/init_qnnpack.h>
 #include <ATen/native/quantized/cpu/qnnpack_utils.h>
+#include <ATen/native/quantized/cpu/sparse_utils.h>
 #include <ATen/quantized/Quantizer.h>
 #include <algorithm>
 #include <vector>
 
 namespace caffe2 {
+// Required for cpp_custom_type_hack to work
+CAFFE_KNOWN_TYPE(PackedLinearWeightSparse);
 #ifdef USE_FBGEMM
 // Required for cpp_custom_type_hack to work
 CAFFE_KNOWN_TYPE(PackedLinearWeight);
@@ -193,6 +197,109 @@ class QLinearPackWeightInt8 final : public c10::OperatorKernel {
   }
 };
 
+// Packs a pruned weight in the block sparse format of sparse_utils.h. The
+// sparse kernel only beats the dense engines when most blocks are zero, so
+// when more than max_density of the 1 x kSparseBlockSize blocks are nonzero
+// this falls back to the dense prepacking of the current engine.
+class QLinearPackWeightSparseInt8 final : public c10::OperatorKernel {
+ public:
+  at::Tensor operator()(
+      at::Tensor weight,
+      c10::optional<Tensor> bias,
+      double max_density) {
+    TORCH_CHECK(
+        weight.dim() == 2,
+        "quantized::linear_prepack_sparse: Weight tensor rank should be == 2");
+    TORCH_CHECK(
+        weight.scalar_type() == kQInt8,
+        "quantized::linear_prepack_sparse: Weight tensor should be qint8");
+    const auto qtype = weight.qscheme();
+    TORCH_CHECK(
+        qtype == kPerTensorAffine || qtype == kPerChannelAffine,
+        "quantized::linear_prepack_sparse: Unsupported qscheme ",
+        toString(qtype));
+
+    const int64_t N = weight.size(0);
+    const int64_t K = weight.size(1);
+    auto weight_contig = weight.contiguous();
+    const auto* weight_ptr_int8 =
+        reinterpret_cast<int8_t*>(weight_contig.data_ptr<c10::qint8>());
+
+    std::vector<float> weight_scales_float;
+    std::vector<int32_t> weight_zero_points_int32;
+    if (qtype == kPerTensorAffine) {
+      weight_scales_float.push_back(weight.q_scale());
+      weight_zero_points_int32.push_back(weight.q_zero_point());
+    } else {
+      auto scales = weight.q_per_channel_scales().to(kFloat).contiguous();
+      auto zero_points = weight.q_per_channel_zero_points().to(kInt).contiguous();
+      weight_scales_float.assign(
+          scales.data_ptr<float>(), scales.data_ptr<float>() + N);
+      weight_zero_points_int32.assign(
+          zero_points.data_ptr<int32_t>(), zero_points.data_ptr<int32_t>() + N);
+    }
+
+    const int64_t num_col_blocks = divup(K, kSparseBlockSize);
+    std::vector<int32_t> row_offsets(N + 1, 0);
+    std::vector<int32_t> col_block_indices;
+    std::vector<int16_t> values;
+    std::vector<int32_t> col_offsets(N, 0);
+    for (int64_t n = 0; n < N; ++n) {
+      const int32_t zero_point =
+          weight_zero_points_int32[qtype == kPerTensorAffine ? 0 : n];
+      for (int64_t cb = 0; cb < num_col_blocks; ++cb) {
+        int16_t block[kSparseBlockSize] = {0};
+        bool nonzero = false;
+        for (int64_t j = 0; j < kSparseBlockSize; ++j) {
+          const int64_t k = cb * kSparseBlockSize + j;
+          if (k < K) {
+            block[j] = static_cast<int16_t>(weight_ptr_int8[n * K + k] - zero_point);
+            nonzero = nonzero || block[j] != 0;
+            col_offsets[n] += block[j];
+          }
+        }
+        if (nonzero) {
+          col_block_indices.push_back(cb);
+          values.insert(values.end(), block, block + kSparseBlockSize);
+        }
+      }
+      row_offsets[n + 1] = col_block_indices.size();
+    }
+
+    const int64_t total_blocks = N * num_col_blocks;
+    const double density = total_blocks > 0
+        ? static_cast<double>(col_block_indices.size()) / total_blocks
+        : 1.0;
+    if (density > max_density) {
+      return QLinearPackWeightInt8()(weight, bias);
+    }
+
+    c10::optional<at::Tensor> bias_contig;
+    if (bias.has_value()) {
+      Tensor bias_vec = bias.value();
+      TORCH_CHECK(bias_vec.dim() == 1, "bias should be a vector (1D Tensor)");
+      TORCH_CHECK(
+          bias_vec.size(0) == N,
+          "bias should have N elements: " + std::to_string(N));
+      bias_contig = bias->contiguous();
+    }
+    auto ret_ptr =
+        std::make_unique<PackedLinearWeightSparse>(PackedLinearWeightSparse{
+            N,
+            K,
+            std::move(row_offsets),
+            std::move(col_block_indices),
+            std::move(values),
+            std::move(col_offsets),
+            weight_contig,
+            bias_contig,
+            std::move(weight_scales_float),
+            std::move(weight_zero_points_int32),
+            qtype});
+    return cpp_custom_type_hack::create(std::move(ret_ptr), weight.options());
+  }
+};
+
 class QLinearPackWeightFp16 final : public c10::OperatorKernel {
  public:
 #ifdef USE_FBGEMM
@@ -300,6 +407,9 @@ static auto registry =
         .op("quantized::linear_prepack(Tensor W, Tensor? B=None) -> Tensor W_prepack",
             c10::RegisterOperators::options().kernel<QLinearPackWeightInt8>(
                 DispatchKey::QuantizedCPUTensorId))
+        .op("quantized::linear_prepack_sparse(Tensor W, Tensor? B=None, float max_density=0.2) -> Tensor W_prepack",
+            c10::RegisterOperators::options().kernel<QLinearPackWeightSparseInt8>(
+                DispatchKey::QuantizedCPUTensorId))
         .op("quantized::linear_prepack_fp16(Tensor W, Tensor? B=None) -> Tensor W_prepack",
             c10::RegisterOperators::options().kernel<QLinearPackWeightFp16>(
                 DispatchKey::CPUTensorId))
@@ -3,6 +3,7 @@
 #include <ATen/cpp_custom_type_hack.h>
 #include <ATen/native/quantized/cpu/fbgemm_utils.h>
 #include <ATen/native/quantized/cpu/qnnpack_utils.h>
+#include <ATen/native/quantized/cpu/sparse_utils.h>
 
 namespace at {
 namespace native {
@@ -68,6 +69,13 @@ class QLinearUnpackWeightInt8 final : public c10::OperatorKernel {
       at::Tensor packed_weight) {
     auto& ctx = at::globalContext();
 
+    // Block sparse weights are engine independent.
+    if (cpp_custom_type_hack::isa<PackedLinearWeightSparse>(packed_weight)) {
+      auto& pack_ptr =
+          cpp_custom_type_hack::cast<PackedLinearWeightSparse>(packed_weight);
+      return std::tuple<at::Tensor, c10::optional<Tensor>>(
+          pack_ptr.orig_weight, pack_ptr.bias);
+    }
 #ifdef USE_FBGEMM
     if (ctx.qEngine() == at::QEngine::FBGEMM) {
       return fbgemm_linear_unpack(packed_weight);
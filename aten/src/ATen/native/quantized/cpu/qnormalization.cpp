@@ -0,0 +1,125 @@
+#include <ATen/ATen.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/core/op_registration/op_registration.h>
+#include <ATen/native/quantized/cpu/quantized_ops.h>
+
+#include <functional>
+#include <numeric>
+#include <vector>
+
+namespace at {
+namespace native {
+
+DEFINE_DISPATCH(qlayer_norm_stub);
+
+namespace {
+
+Tensor quantized_layer_norm_impl(
+    const Tensor& input,
+    IntArrayRef normalized_shape,
+    const Tensor& weight /* optional */,
+    const Tensor& bias /* optional */,
+    double eps,
+    double output_scale,
+    int64_t output_zero_point) {
+  TORCH_CHECK(
+      input.scalar_type() == kQUInt8 || input.scalar_type() == kQInt8,
+      "quantized::layer_norm only supports quint8 and qint8 inputs.");
+  TORCH_CHECK(
+      input.qscheme() == kPerTensorAffine,
+      "quantized::layer_norm only supports per tensor quantized inputs.");
+
+  const int normalized_ndim = normalized_shape.size();
+  TORCH_CHECK(
+      normalized_ndim >= 1,
+      "Expected normalized_shape to be at least 1-dimensional, i.e., ",
+      "containing at least one element, but got normalized_shape = ",
+      normalized_shape);
+  TORCH_CHECK(
+      !weight.defined() || weight.sizes().equals(normalized_shape),
+      "Expected weight to be of same shape as normalized_shape, but got ",
+      "weight of shape ",
+      weight.sizes(),
+      " and normalized_shape = ",
+      normalized_shape);
+  TORCH_CHECK(
+      !bias.defined() || bias.sizes().equals(normalized_shape),
+      "Expected bias to be of same shape as normalized_shape, but got ",
+      "bias of shape ",
+      bias.sizes(),
+      " and normalized_shape = ",
+      normalized_shape);
+
+  const auto input_shape = input.sizes();
+  const auto input_ndim = input.dim();
+  TORCH_CHECK(
+      input_ndim >= normalized_ndim &&
+          input_shape.slice(input_ndim - normalized_ndim)
+              .equals(normalized_shape),
+      "Given normalized_shape=",
+      normalized_shape,
+      ", expected input with trailing dimensions equal to normalized_shape",
+      ", but got input of size",
+      input_shape);
+
+  const int axis = input_ndim - normalized_ndim;
+  const int64_t M = std::accumulate(
+      input_shape.cbegin(),
+      input_shape.cbegin() + axis,
+      1LL,
+      std::multiplies<int64_t>());
+  const int64_t N = std::accumulate(
+      input_shape.cbegin() + axis,
+      input_shape.cend(),
+      1LL,
+      std::multiplies<int64_t>());
+
+  Tensor X = input.contiguous();
+  Tensor gamma = weight.defined() ? weight.contiguous().to(kFloat) : weight;
+  Tensor beta = bias.defined() ? bias.contiguous().to(kFloat) : bias;
+  Tensor Y = at::_empty_affine_quantized(
+      X.sizes(),
+      at::device(kCPU).dtype(X.scalar_type()),
+      output_scale,
+      output_zero_point);
+  if (M > 0 && N > 0) {
+    qlayer_norm_stub(X.device().type(), X, gamma, beta, eps, M, N, Y);
+  }
+  return Y;
+}
+
+class QLayerNorm final : public torch::OperatorKernel {
+ public:
+  Tensor operator()(
+      Tensor input,
+      std::vector<int64_t> normalized_shape,
+      c10::optional<Tensor> weight,
+      c10::optional<Tensor> bias,
+      double eps,
+      double output_scale,
+      int64_t output_zero_point) {
+    return quantized_layer_norm_impl(
+        input,
+        normalized_shape,
+        weight.has_value() ? *weight : Tensor(),
+        bias.has_value() ? *bias : Tensor(),
+        eps,
+        output_scale,
+        output_zero_point);
+  }
+};
+
+static auto registry = torch::RegisterOperators().op(
+    "quantized::layer_norm(Tensor input, "
+    "int[] normalized_shape, "
+    "Tensor? weight, "
+    "Tensor? bias, "
+    "float eps, "
+    "float output_scale, "
+    "int output_zero_point) -> Tensor",
+    torch::RegisterOperators::options().kernel<QLayerNorm>(
+        DispatchKey::QuantizedCPUTensorId));
+
+} // namespace
+} // namespace native
+} // namespace at
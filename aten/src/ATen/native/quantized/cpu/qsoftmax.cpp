@@ -0,0 +1,55 @@
+#include <ATen/ATen.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/WrapDimUtils.h>
+#include <ATen/core/op_registration/op_registration.h>
+#include <ATen/native/quantized/cpu/quantized_ops.h>
+
+namespace at {
+namespace native {
+
+DEFINE_DISPATCH(qsoftmax_stub);
+
+namespace {
+
+class QSoftmax final : public torch::OperatorKernel {
+ public:
+  Tensor operator()(
+      Tensor qx,
+      int64_t dim,
+      double output_scale,
+      int64_t output_zero_point) {
+    TORCH_CHECK(
+        qx.qscheme() == kPerTensorAffine,
+        "quantized::softmax only supports per tensor quantized inputs.");
+    TORCH_CHECK(qx.dim() > 0, "quantized::softmax expects a non-scalar input.");
+    dim = maybe_wrap_dim(dim, qx.dim());
+    // The kernel works on the innermost dimension, other reduction
+    // dimensions are moved there and back.
+    const int64_t last_dim = qx.dim() - 1;
+    Tensor qx_contig = qx.transpose(dim, last_dim).contiguous();
+    Tensor qy = at::_empty_affine_quantized(
+        qx_contig.sizes(),
+        at::device(kCPU).dtype(qx_contig.scalar_type()),
+        output_scale,
+        output_zero_point);
+    const int64_t dim_size = qx_contig.numel() > 0 ? qx_contig.size(last_dim) : 0;
+    if (dim_size > 0) {
+      qsoftmax_stub(
+          qx_contig.device().type(),
+          qx_contig,
+          qx_contig.numel() / dim_size,
+          dim_size,
+          qy);
+    }
+    return qy.transpose(dim, last_dim);
+  }
+};
+
+static auto registry = torch::RegisterOperators().op(
+    "quantized::softmax(Tensor qx, int dim, float output_scale, int output_zero_point) -> Tensor",
+    torch::RegisterOperators::options().kernel<QSoftmax>(
+        DispatchKey::QuantizedCPUTensorId));
+
+} // namespace
+} // namespace native
+} // namespace at
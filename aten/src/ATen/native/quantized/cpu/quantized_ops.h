@@ -2,6 +2,8 @@
 #include <ATen/native/DispatchStub.h>
 #include <ATen/native/TensorIterator.h>
 
+struct PackedLinearWeightSparse;
+
 namespace at {
 namespace native {
 
@@ -114,6 +116,30 @@ using qtopk_fn = void(*)(Tensor&, Tensor&, const Tensor&, int64_t, int64_t, bool
 
 using qbatch_norm_fn = void(*)(int64_t, int64_t, int64_t, int64_t, int64_t, const Tensor&, const Tensor&, const Tensor&, Tensor&);
 
+using qlayer_norm_fn = void (*)(
+    const Tensor& /*X*/,
+    const Tensor& /*gamma*/,
+    const Tensor& /*beta*/,
+    double /*eps*/,
+    int64_t /*M*/,
+    int64_t /*N*/,
+    Tensor& /*Y*/);
+using qgelu_fn = void (*)(const at::Tensor& /*qx*/, at::Tensor& /*qy*/);
+using qsoftmax_fn = void (*)(
+    const Tensor& /*qx*/,
+    int64_t /*outer_size*/,
+    int64_t /*dim_size*/,
+    Tensor& /*qy*/);
+// Computes the int32 accumulators of an M x K uint8 input times the
+// transposed block sparse weight into an M x N output, including the input
+// zero point correction.
+using qlinear_sparse_fn = void (*)(
+    const uint8_t* /*input*/,
+    int64_t /*M*/,
+    int32_t /*input_zero_point*/,
+    const PackedLinearWeightSparse& /*packed*/,
+    int32_t* /*output*/);
+
 // using qavg_pool2d_fn
 DECLARE_DISPATCH(qrelu_fn, qrelu_stub);
 DECLARE_DISPATCH(qrelu_fn, qrelu6_stub);
@@ -135,6 +161,10 @@ DECLARE_DISPATCH(qcat_nhwc_fn, qcat_nhwc_stub);
 DECLARE_DISPATCH(qcat_nhwc_fn, qcat_relu_nhwc_stub);
 DECLARE_DISPATCH(qtopk_fn, qtopk_stub);
 DECLARE_DISPATCH(qbatch_norm_fn, qbatch_norm_stub);
+DECLARE_DISPATCH(qlayer_norm_fn, qlayer_norm_stub);
+DECLARE_DISPATCH(qgelu_fn, qgelu_stub);
+DECLARE_DISPATCH(qsoftmax_fn, qsoftmax_stub);
+DECLARE_DISPATCH(qlinear_sparse_fn, qlinear_sparse_stub);
 
 } // namespace native
 } // namespace at
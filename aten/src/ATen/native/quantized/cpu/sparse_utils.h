@@ -0,0 +1,33 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include <c10/core/QScheme.h>
+
+// Block sparse packed weight for quantized::linear on pruned models.
+//
+// The N x K int8 weight is split into 1 x kSparseBlockSize blocks along K
+// (the last block of a row is zero padded). A block is dropped when all of
+// its values equal the weight zero point, i.e. it represents real zeros.
+// The remaining blocks are stored in block compressed sparse row form:
+// the blocks of output channel n are row_offsets[n] .. row_offsets[n + 1],
+// block b starts at column col_block_indices[b] * kSparseBlockSize and its
+// values (with the zero point already subtracted) are
+// values[b * kSparseBlockSize .. (b + 1) * kSparseBlockSize).
+//
+// col_offsets[n] is the sum of (w - w_zp) over the row, used to correct for
+// the input zero point. The original weight is kept for unpacking.
+constexpr int64_t kSparseBlockSize = 4;
+
+struct CAFFE2_API PackedLinearWeightSparse {
+  int64_t N;
+  int64_t K;
+  std::vector<int32_t> row_offsets;
+  std::vector<int32_t> col_block_indices;
+  std::vector<int16_t> values;
+  std::vector<int32_t> col_offsets;
+  at::Tensor orig_weight;
+  c10::optional<at::Tensor> bias;
+  std::vector<float> w_scale;
+  std::vector<int32_t> w_zp;
+  c10::QScheme q_scheme;
+};
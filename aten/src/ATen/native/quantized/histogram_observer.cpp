@@ -0,0 +1,266 @@
+#include <ATen/ATen.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/Parallel.h>
+#include <ATen/native/quantized/histogram_observer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <tuple>
+#include <vector>
+
+// Native kernels behind torch.quantization.HistogramObserver.
+namespace at {
+namespace native {
+
+DEFINE_DISPATCH(histogram_observer_histc_stub);
+DEFINE_DISPATCH(histogram_observer_l2_error_stub);
+
+namespace {
+
+// Granularity of the quantile search, see _histogram_observer_search.
+constexpr double kStepSize = 1e-5;
+
+// Same range handling as torch.histc: a degenerate range is widened by one
+// on each side.
+void histc_accumulate(const Tensor& x, float min, float max, Tensor& hist) {
+  if (min == max) {
+    min -= 1;
+    max += 1;
+  }
+  TORCH_CHECK(
+      std::isfinite(min) && std::isfinite(max),
+      "range of [", min, ", ", max, "] is not finite");
+  histogram_observer_histc_stub(kCPU, x, min, max, hist);
+}
+
+// Adds `orig_hist`, which covers bins * upsample_rate fine cells starting at
+// cell `start_idx`, to `hist`, whose bins are downsample_rate fine cells
+// wide. The counts of an original bin are spread uniformly over its cells.
+void combine_histograms(
+    const Tensor& orig_hist,
+    int64_t upsample_rate,
+    int64_t downsample_rate,
+    int64_t start_idx,
+    Tensor& hist) {
+  const int64_t bins = hist.numel();
+  const float* orig = orig_hist.data_ptr<float>();
+  float* out = hist.data_ptr<float>();
+  const int64_t num_cells = orig_hist.numel() * upsample_rate;
+  at::parallel_for(0, bins, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t k = begin; k < end; ++k) {
+      const int64_t first = std::max<int64_t>(
+          k * downsample_rate - start_idx, 0);
+      const int64_t last = std::min<int64_t>(
+          (k + 1) * downsample_rate - start_idx, num_cells);
+      double acc = 0.0;
+      for (int64_t c = first; c < last;) {
+        const int64_t i = c / upsample_rate;
+        const int64_t next = std::min(last, (i + 1) * upsample_rate);
+        acc += static_cast<double>(orig[i]) * (next - c);
+        c = next;
+      }
+      out[k] += static_cast<float>(acc / upsample_rate);
+    }
+  });
+}
+
+} // namespace
+
+/* Adds the values of `self` to the running histogram of a histogram observer.
+Args:
+  self: Observed float tensor.
+  histogram: Running histogram, its size gives the number of bins.
+  min_val, max_val: Range of the running histogram, empty before the first
+    observation.
+  upsample_rate: Resolution factor used to resample the running histogram
+    when the range grows.
+Returns:
+  The new histogram, min_val and max_val.
+
+The range only grows. When it does, it is widened so that it is an integer
+multiple of the old bin width divided by upsample_rate and the old histogram
+is resampled onto the new bins.
+*/
+std::tuple<Tensor, Tensor, Tensor> histogram_observer_update_cpu(
+    const Tensor& self,
+    const Tensor& histogram,
+    const Tensor& min_val,
+    const Tensor& max_val,
+    int64_t upsample_rate) {
+  TORCH_CHECK(
+      self.scalar_type() == ScalarType::Float,
+      "histogram observer only supports float input.");
+  TORCH_CHECK(self.numel() > 0, "histogram observer got an empty input.");
+  TORCH_CHECK(
+      histogram.dim() == 1 && histogram.numel() > 0 &&
+          histogram.scalar_type() == ScalarType::Float,
+      "histogram must be a non-empty 1D float tensor.");
+  TORCH_CHECK(upsample_rate > 0, "upsample_rate must be positive.");
+  const int64_t bins = histogram.numel();
+  const Tensor x = self.contiguous();
+  const float new_min = x.min().item<float>();
+  const float new_max = x.max().item<float>();
+  auto hist = at::zeros({bins}, histogram.options());
+
+  if (min_val.numel() == 0 || max_val.numel() == 0) {
+    histc_accumulate(x, new_min, new_max, hist);
+    return std::make_tuple(
+        hist,
+        at::scalar_tensor(new_min, histogram.options()),
+        at::scalar_tensor(new_max, histogram.options()));
+  }
+
+  const Tensor orig_hist = histogram.contiguous();
+  const float min = min_val.item<float>();
+  const float max = max_val.item<float>();
+  float combined_min = std::min(new_min, min);
+  float combined_max = std::max(new_max, max);
+  const double hist_bin_width =
+      (static_cast<double>(max) - min) / (bins * upsample_rate);
+
+  if (hist_bin_width == 0.0) {
+    // Everything seen so far was a single value, there is nothing to
+    // resample: its count goes to the bin that holds it.
+    histc_accumulate(x, combined_min, combined_max, hist);
+    if (combined_min != combined_max) {
+      const double pos =
+          (min - combined_min) / (combined_max - combined_min) * bins;
+      const int64_t bin = std::min(static_cast<int64_t>(pos), bins - 1);
+      hist.data_ptr<float>()[bin] += orig_hist.sum().item<float>();
+    } else {
+      hist.add_(orig_hist);
+    }
+  } else {
+    // Grow the range to downsample_rate * bins fine cells of the old
+    // resolution, centered on the observed range, and locate the old
+    // histogram on that grid.
+    const double range = static_cast<double>(combined_max) - combined_min;
+    const int64_t downsample_rate = static_cast<int64_t>(
+        std::ceil(range / (bins * hist_bin_width)));
+    const double extra = downsample_rate * bins * hist_bin_width - range;
+    combined_min = static_cast<float>(combined_min - extra / 2);
+    combined_max = static_cast<float>(combined_max + extra / 2);
+    const int64_t start_idx = static_cast<int64_t>(
+        std::round((min - combined_min) / hist_bin_width));
+
+    histc_accumulate(x, combined_min, combined_max, hist);
+    if (combined_min == min && combined_max == max) {
+      hist.add_(orig_hist);
+    } else {
+      combine_histograms(
+          orig_hist, upsample_rate, downsample_rate, start_idx, hist);
+    }
+  }
+  return std::make_tuple(
+      hist,
+      at::scalar_tensor(combined_min, histogram.options()),
+      at::scalar_tensor(combined_max, histogram.options()));
+}
+
+/* Searches the range of a histogram observer for the min/max that minimize
+the L2 quantization error.
+Args:
+  histogram: Running histogram of the observer.
+  min_val, max_val: Range of the histogram.
+  dst_nbins: Number of quantization levels.
+Returns:
+  The new min_val and max_val.
+
+Follows NormMinimization::NonlinearQuantizationParamsSearch in
+caffe2/quantization/server/norm_minimization.cc: the lower and upper
+quantiles are moved inwards in steps of kStepSize, dropping outlier bins,
+until the quantization error stops decreasing.
+*/
+std::tuple<Tensor, Tensor> histogram_observer_search_cpu(
+    const Tensor& histogram,
+    const Tensor& min_val,
+    const Tensor& max_val,
+    int64_t dst_nbins) {
+  TORCH_CHECK(
+      histogram.dim() == 1 && histogram.numel() > 0 &&
+          histogram.scalar_type() == ScalarType::Float,
+      "histogram must be a non-empty 1D float tensor.");
+  TORCH_CHECK(
+      min_val.numel() == 1 && max_val.numel() == 1,
+      "min_val and max_val must have one element.");
+  TORCH_CHECK(dst_nbins > 0, "dst_nbins must be positive.");
+  const int64_t bins = histogram.numel();
+  const double min = min_val.item<float>();
+  const double max = max_val.item<float>();
+  const double bin_width = (max - min) / bins;
+  if (bin_width == 0.0) {
+    return std::make_tuple(
+        at::scalar_tensor(min, histogram.options()),
+        at::scalar_tensor(max, histogram.options()));
+  }
+
+  const Tensor hist_contig = histogram.contiguous();
+  const float* hist = hist_contig.data_ptr<float>();
+  std::vector<double> density(bins);
+  std::vector<double> cumsum(bins);
+  double total = 0.0;
+  for (int64_t i = 0; i < bins; ++i) {
+    density[i] = hist[i] / bin_width;
+    total += hist[i];
+    cumsum[i] = total;
+  }
+
+  double alpha = 0.0;
+  double beta = 1.0;
+  int64_t start_bin = 0;
+  int64_t end_bin = bins - 1;
+  // alpha only grows, beta only shrinks and the window only narrows, so the
+  // quantile bins found in one step are valid starting points for the next.
+  int64_t l = start_bin;
+  int64_t r = end_bin;
+  double norm_min = std::numeric_limits<double>::infinity();
+  while (alpha < beta) {
+    const double next_alpha = alpha + kStepSize;
+    const double next_beta = beta - kStepSize;
+
+    l = std::min(std::max(l, start_bin), end_bin);
+    while (l < end_bin && cumsum[l] < next_alpha * total) {
+      ++l;
+    }
+    r = std::max(std::min(r, end_bin), start_bin);
+    while (r > start_bin && cumsum[r] > next_beta * total) {
+      --r;
+    }
+
+    int64_t next_start_bin = start_bin;
+    int64_t next_end_bin = end_bin;
+    if ((l - start_bin) > (end_bin - r)) {
+      next_start_bin = l;
+      alpha = next_alpha;
+    } else {
+      next_end_bin = r;
+      beta = next_beta;
+    }
+    if (next_start_bin == start_bin && next_end_bin == end_bin) {
+      continue;
+    }
+
+    const double norm = histogram_observer_l2_error_stub(
+        kCPU,
+        density.data(),
+        bins,
+        bin_width,
+        next_start_bin,
+        next_end_bin,
+        dst_nbins);
+    if (norm > norm_min) {
+      break;
+    }
+    norm_min = norm;
+    start_bin = next_start_bin;
+    end_bin = next_end_bin;
+  }
+
+  return std::make_tuple(
+      at::scalar_tensor(min + bin_width * start_bin, histogram.options()),
+      at::scalar_tensor(min + bin_width * (end_bin + 1), histogram.options()));
+}
+
+} // namespace native
+} // namespace at
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at {
+namespace native {
+
+// Adds the histc-style counts of the contiguous float tensor `input` over
+// [min, max] to the float tensor `histogram`. Values outside the range are
+// ignored and values equal to `max` go to the last bin.
+using histogram_observer_histc_fn = void (*)(
+    const Tensor& input,
+    float min,
+    float max,
+    Tensor& histogram);
+
+// L2 quantization error of mapping source bins [start_bin, end_bin] of a
+// histogram with the given per-bin `density` (count / bin_width) onto
+// `dst_nbins` equally sized quantization bins.
+using histogram_observer_l2_error_fn = double (*)(
+    const double* density,
+    int64_t nbins,
+    double bin_width,
+    int64_t start_bin,
+    int64_t end_bin,
+    int64_t dst_nbins);
+
+DECLARE_DISPATCH(histogram_observer_histc_fn, histogram_observer_histc_stub);
+DECLARE_DISPATCH(
+    histogram_observer_l2_error_fn,
+    histogram_observer_l2_error_stub);
+
+} // namespace native
+} // namespace at
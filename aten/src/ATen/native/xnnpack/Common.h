@@ -57,6 +57,36 @@ struct ContextConv2D final {
   static constexpr float kMax = std::numeric_limits<float>::infinity();
 };
 
+struct ContextConvTranspose2D final {
+  Operator op;
+  std::array<int64_t, 4> weight_size_;
+  std::array<int64_t, 2> padding_;
+  std::array<int64_t, 2> output_padding_;
+  std::array<int64_t, 2> stride_;
+  std::array<int64_t, 2> dilation_;
+  int64_t groups_;
+
+  ContextConvTranspose2D() = delete;
+
+  ContextConvTranspose2D(
+      Operator&& o,
+      std::array<int64_t, 4> weight_size,
+      std::array<int64_t, 2> padding,
+      std::array<int64_t, 2> output_padding,
+      std::array<int64_t, 2> stride,
+      std::array<int64_t, 2> dilation,
+      int64_t groups)
+      :  op(std::move(o)),
+         weight_size_(weight_size),
+         padding_(padding),
+         output_padding_(output_padding),
+         stride_(stride),
+         dilation_(dilation),
+         groups_(groups) {}
+  static constexpr float kMin = -std::numeric_limits<float>::infinity();
+  static constexpr float kMax = std::numeric_limits<float>::infinity();
+};
+
 namespace internal {
 
 struct Layout final {
@@ -0,0 +1,299 @@
+#ifdef USE_XNNPACK
+
+#include <ATen/native/xnnpack/Common.h>
+#include <ATen/native/utils/ParamUtils.h>
+#include <ATen/native/xnnpack/Factory.h>
+#include <ATen/native/xnnpack/ConvolutionTranspose.h>
+
+namespace at {
+namespace native {
+namespace xnnpack {
+namespace internal {
+namespace convolution_transpose2d {
+
+namespace {
+
+// Transposed convolution weights are laid out as
+// [input_channels, output_channels / groups, height, width].
+struct TransposedFilter final {
+  static constexpr size_t input = 0u;
+  static constexpr size_t output = 1u;
+  static constexpr size_t height = 2u;
+  static constexpr size_t width = 3u;
+};
+
+// Supports NHWC and NCHW FP32 transposed convolutions with any valid
+//  - kernel size
+//  - padding
+//  - output padding smaller than the stride
+//  - stride
+//  - dilation
+//  - grouping
+
+// TODO: Decouple and improve error handling and messages.
+bool available(
+    const Tensor& weight,
+    const c10::optional<Tensor>& bias,
+    const IntArrayRef padding,
+    const IntArrayRef output_padding,
+    const IntArrayRef stride,
+    const IntArrayRef dilation,
+    const int64_t groups,
+    const float output_min,
+    const float output_max) {
+         // XNNPACK
+  return xnnpack::internal::available() &&
+         // Weight
+         (4 == weight.ndimension()) &&
+         (weight.size(TransposedFilter::height) > 0) &&
+         (weight.size(TransposedFilter::width) > 0) &&
+         (c10::DeviceType::CPU == weight.device().type()) &&
+         (kFloat == weight.scalar_type()) &&
+         // Bias
+         ((bias && bias->defined()) ? ((1 == bias->ndimension()) &&
+                                      (c10::DeviceType::CPU == bias->device().type()) &&
+                                      (kFloat == bias->scalar_type()) &&
+                                      (weight.size(TransposedFilter::output) * groups) == bias->size(0))
+                                    : true) &&
+         // Padding
+         (padding[Layout::Parameter::height] >= 0) &&
+         (padding[Layout::Parameter::width] >= 0) &&
+         // Stride
+         (stride[Layout::Parameter::height] > 0) &&
+         (stride[Layout::Parameter::width] > 0) &&
+         // Output Padding
+         (output_padding[Layout::Parameter::height] >= 0) &&
+         (output_padding[Layout::Parameter::width] >= 0) &&
+         (output_padding[Layout::Parameter::height] < stride[Layout::Parameter::height]) &&
+         (output_padding[Layout::Parameter::width] < stride[Layout::Parameter::width]) &&
+         // Dilation
+         (dilation[Layout::Parameter::height] > 0) &&
+         (dilation[Layout::Parameter::width] > 0) &&
+         // Groups
+         (groups > 0) &&
+         // Input
+         (weight.size(TransposedFilter::input) > 0) &&
+         // Output
+         (weight.size(TransposedFilter::output) > 0) &&
+         // Input - Groups
+         ((weight.size(TransposedFilter::input) % groups) == 0) &&
+         // Output Min / Max
+         (output_max > output_min) &&
+         true;
+}
+
+// TODO: Decouple and improve error handling and messages.
+bool usable(const ContextConvTranspose2D& context, const Tensor& input) {
+         // Input
+  return (4 == input.ndimension()) &&
+         (c10::DeviceType::CPU == input.device().type()) &&
+         (kFloat == input.scalar_type()) &&
+         (input.size(Layout::Activation4D::batch) >= 0) &&
+         (input.size(Layout::Activation4D::channels) ==
+             context.weight_size_[TransposedFilter::input]) &&
+         (input.size(Layout::Activation4D::height) > 0) &&
+         (input.size(Layout::Activation4D::width) > 0) &&
+         true;
+}
+
+int64_t output_size(
+    const int64_t input_size,
+    const int64_t kernel_size,
+    const int64_t padding,
+    const int64_t output_padding,
+    const int64_t stride,
+    const int64_t dilation) {
+  return (input_size - 1) * stride - 2 * padding +
+      dilation * (kernel_size - 1) + output_padding + 1;
+}
+
+Tensor run(
+    const ContextConvTranspose2D& context,
+    const Tensor& input) {
+  using namespace internal;
+
+  const Tensor input_nhwc = input.contiguous(MemoryFormat::ChannelsLast);
+  const Tensor padded_input_nhwc = allocate_padded_if_needed(input_nhwc);
+
+  TORCH_CHECK(
+      usable(context, padded_input_nhwc),
+      "XNNPACK Transposed Convolution not usable! "
+      "Reason: The provided input tensor is either invalid or unsupported by XNNPACK.");
+
+  const int64_t output_height = output_size(
+      padded_input_nhwc.size(Layout::Activation4D::height),
+      context.weight_size_[TransposedFilter::height],
+      context.padding_[Layout::Parameter::height],
+      context.output_padding_[Layout::Parameter::height],
+      context.stride_[Layout::Parameter::height],
+      context.dilation_[Layout::Parameter::height]);
+  const int64_t output_width = output_size(
+      padded_input_nhwc.size(Layout::Activation4D::width),
+      context.weight_size_[TransposedFilter::width],
+      context.padding_[Layout::Parameter::width],
+      context.output_padding_[Layout::Parameter::width],
+      context.stride_[Layout::Parameter::width],
+      context.dilation_[Layout::Parameter::width]);
+  TORCH_CHECK(
+      output_height > 0 && output_width > 0,
+      "XNNPACK Transposed Convolution: computed output size is too small.");
+
+  Tensor output = empty_with_tail_padding(
+      {
+        padded_input_nhwc.size(Layout::Activation4D::batch),
+        context.weight_size_[TransposedFilter::output] * context.groups_,
+        output_height,
+        output_width,
+      },
+      padded_input_nhwc.options().dtype(),
+      MemoryFormat::ChannelsLast);
+
+  const xnn_status setup_status = xnn_setup_deconvolution2d_nhwc_f32(
+      context.op.get(),                                      // operator
+      padded_input_nhwc.size(Layout::Activation4D::batch),   // batch_size
+      padded_input_nhwc.size(Layout::Activation4D::height),  // input_height
+      padded_input_nhwc.size(Layout::Activation4D::width),   // input_width
+      context.output_padding_[Layout::Parameter::height],    // adjustment_height
+      context.output_padding_[Layout::Parameter::width],     // adjustment_width
+      padded_input_nhwc.data_ptr<float>(),                   // input
+      output.data_ptr<float>(),                              // output
+      caffe2::xnnpack_threadpool());                         // threadpool
+
+  TORCH_CHECK(
+      xnn_status_success == setup_status,
+      "xnn_setup_deconvolution2d_nhwc_f32 failed!");
+
+  const xnn_status run_status = xnn_run_operator(
+      context.op.get(),               // operator
+      caffe2::xnnpack_threadpool());  // threadpool
+
+  TORCH_INTERNAL_ASSERT(
+      xnn_status_success == run_status,
+      "xnn_run_operator failed!");
+
+  return output.contiguous(input.suggest_memory_format());
+}
+
+} // namespace
+
+ContextConvTranspose2D create(
+    const Tensor& weight,
+    const c10::optional<Tensor>& bias,
+    const IntArrayRef padding,
+    const IntArrayRef output_padding,
+    const IntArrayRef stride,
+    const IntArrayRef dilation,
+    const int64_t groups,
+    const float output_min,
+    const float output_max) {
+  const auto padding_expanded = expand_param_if_needed(padding, "padding", 2);
+  const auto output_padding_expanded =
+      expand_param_if_needed(output_padding, "output_padding", 2);
+  const auto stride_expanded = expand_param_if_needed(stride, "stride", 2);
+  const auto dilation_expanded = expand_param_if_needed(dilation, "dilation", 2);
+
+  TORCH_CHECK(
+      available(
+          weight,
+          bias,
+          padding_expanded,
+          output_padding_expanded,
+          stride_expanded,
+          dilation_expanded,
+          groups,
+          output_min,
+          output_max),
+      "xnnpack::convolution_transpose not available! "
+      "Reason: The provided (weight, bias, padding, output_padding, stride, dilation, groups, "
+      "output_min, output_max) parameters are either invalid individually or their combination "
+      "is not supported by XNNPACK.");
+
+  const int64_t group_input_channels =
+      weight.size(TransposedFilter::input) / groups;
+  const int64_t group_output_channels = weight.size(TransposedFilter::output);
+  const int64_t kernel_height = weight.size(TransposedFilter::height);
+  const int64_t kernel_width = weight.size(TransposedFilter::width);
+
+  // XNNPACK expects [groups, group_output_channels, height, width, group_input_channels].
+  const Tensor weight_reordered = weight.contiguous()
+      .view({groups, group_input_channels, group_output_channels, kernel_height, kernel_width})
+      .permute({0, 2, 3, 4, 1})
+      .contiguous();
+
+  xnn_operator_t deconvolution_op{};
+
+  const xnn_status create_status = xnn_create_deconvolution2d_nhwc_f32(
+      padding_expanded[Layout::Parameter::height],                    // output_padding_top
+      padding_expanded[Layout::Parameter::width],                     // output_padding_right
+      padding_expanded[Layout::Parameter::height],                    // output_padding_bottom
+      padding_expanded[Layout::Parameter::width],                     // output_padding_left
+      kernel_height,                                                  // kernel_height
+      kernel_width,                                                   // kernel_width
+      stride_expanded[Layout::Parameter::height],                     // stride_height
+      stride_expanded[Layout::Parameter::width],                      // stride_width
+      dilation_expanded[Layout::Parameter::height],                   // dilation_height
+      dilation_expanded[Layout::Parameter::width],                    // dilation_width
+      groups,                                                         // groups
+      group_input_channels,                                           // group_input_channels
+      group_output_channels,                                          // group_output_channels
+      group_input_channels * groups,                                  // input_pixel_stride
+      group_output_channels * groups,                                 // output_pixel_stride
+      weight_reordered.data_ptr<float>(),                             // kernel
+      (bias && bias->defined()) ? bias->data_ptr<float>() : nullptr,  // bias
+      output_min,                                                     // output_min
+      output_max,                                                     // output_max
+      0u,                                                             // flags
+      &deconvolution_op);                                             // operator
+
+  TORCH_CHECK(
+      xnn_status_success == create_status,
+      "xnn_create_deconvolution2d_nhwc_f32 failed!");
+
+  return ContextConvTranspose2D{
+      Operator(deconvolution_op),
+      {weight.sizes()[0], weight.sizes()[1],
+          weight.sizes()[2], weight.sizes()[3]},
+      {padding_expanded[0], padding_expanded[1]},
+      {output_padding_expanded[0], output_padding_expanded[1]},
+      {stride_expanded[0], stride_expanded[1]},
+      {dilation_expanded[0], dilation_expanded[1]},
+      groups
+  };
+}
+
+c10::intrusive_ptr<xnnpack::XNNPackConvTranspose2dOpContext>
+    ConvTranspose2dPrePack::operator()(
+        Tensor weight,
+        c10::optional<Tensor> bias,
+        std::vector<int64_t> stride,
+        std::vector<int64_t> padding,
+        std::vector<int64_t> output_padding,
+        int64_t groups,
+        std::vector<int64_t> dilation) {
+      return xnnpack::XNNPackConvTranspose2dOpContext::create_context(
+          std::move(weight),
+          std::move(bias),
+          std::move(padding),
+          std::move(output_padding),
+          std::move(stride),
+          std::move(dilation),
+          groups,
+          {},
+          {});
+}
+
+Tensor ConvTranspose2dPacked::operator()(
+    const Tensor& input,
+    const c10::intrusive_ptr<xnnpack::XNNPackConvTranspose2dOpContext>& op_context) {
+      return
+        xnnpack::internal::convolution_transpose2d::run(
+            (op_context.get())->get_context(), input);
+}
+
+} // namespace convolution_transpose2d
+} // namespace internal
+} // namespace xnnpack
+} // namespace native
+} // namespace at
+
+#endif /* USE_XNNPACK */
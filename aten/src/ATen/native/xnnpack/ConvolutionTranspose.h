@@ -0,0 +1,51 @@
+#pragma once
+
+#ifdef USE_XNNPACK
+
+#include <ATen/Tensor.h>
+#include <ATen/native/xnnpack/Common.h>
+#include <ATen/native/xnnpack/OpContext.h>
+
+namespace at {
+namespace native {
+namespace xnnpack {
+namespace internal {
+namespace convolution_transpose2d {
+
+class ConvTranspose2dPrePack final : public torch::OperatorKernel {
+ public:
+  c10::intrusive_ptr<xnnpack::XNNPackConvTranspose2dOpContext> operator()(
+      Tensor weight,
+      c10::optional<Tensor> bias,
+      std::vector<int64_t> stride,
+      std::vector<int64_t> padding,
+      std::vector<int64_t> output_padding,
+      int64_t groups,
+      std::vector<int64_t> dilation);
+};
+
+class ConvTranspose2dPacked final : public torch::OperatorKernel {
+ public:
+  Tensor operator()(
+      const Tensor& input,
+      const c10::intrusive_ptr<xnnpack::XNNPackConvTranspose2dOpContext>& op_context);
+};
+
+ContextConvTranspose2D create(
+    const Tensor& weight,
+    const c10::optional<Tensor>& bias,
+    const IntArrayRef padding,
+    const IntArrayRef output_padding,
+    const IntArrayRef stride,
+    const IntArrayRef dilation,
+    const int64_t groups,
+    const float output_min,
+    const float output_max);
+
+} // namespace convolution_transpose2d
+} // namespace internal
+} // namespace xnnpack
+} // namespace native
+} // namespace at
+
+#endif /* USE_XNNPACK */
@@ -0,0 +1,242 @@
+#ifdef USE_XNNPACK
+
+#include <ATen/native/xnnpack/Common.h>
+#include <ATen/native/xnnpack/Elementwise.h>
+#include <ATen/native/xnnpack/Factory.h>
+
+namespace at {
+namespace native {
+namespace xnnpack {
+namespace internal {
+namespace elementwise {
+
+namespace {
+
+constexpr float kMin = -std::numeric_limits<float>::infinity();
+constexpr float kMax = std::numeric_limits<float>::infinity();
+
+// Supports FP32 tensors of any shape and memory format. The tensor is
+// processed as a single row of numel() channels.
+
+// TODO: Decouple and improve error handling and messages.
+bool usable(const Tensor& input) {
+         // XNNPACK
+  return xnnpack::internal::available() &&
+         // Input
+         (c10::DeviceType::CPU == input.device().type()) &&
+         (kFloat == input.scalar_type()) &&
+         true;
+}
+
+// Makes the input dense in its own memory format and tail padded.
+Tensor prepare(const Tensor& input) {
+  return allocate_padded_if_needed(
+      input.contiguous(input.suggest_memory_format()));
+}
+
+Tensor allocate_output(const Tensor& padded_input) {
+  return empty_with_tail_padding(
+      padded_input.sizes(),
+      padded_input.options().dtype(),
+      padded_input.suggest_memory_format());
+}
+
+void run_operator(Operator&& op) {
+  const xnn_status run_status = xnn_run_operator(
+      op.get(),                       // operator
+      caffe2::xnnpack_threadpool());  // threadpool
+
+  TORCH_INTERNAL_ASSERT(
+      xnn_status_success == run_status,
+      "xnn_run_operator failed!");
+}
+
+Tensor run_clamp(
+    const Tensor& input,
+    const float output_min,
+    const float output_max) {
+  const Tensor padded_input = prepare(input);
+  Tensor output = allocate_output(padded_input);
+
+  xnn_operator_t clamp_op{};
+
+  const xnn_status create_status = xnn_create_clamp_nc_f32(
+      1u,          // channels
+      1u,          // input_stride
+      1u,          // output_stride
+      output_min,  // output_min
+      output_max,  // output_max
+      0u,          // flags
+      &clamp_op);  // operator
+
+  TORCH_CHECK(
+      xnn_status_success == create_status,
+      "xnn_create_clamp_nc_f32 failed!");
+
+  Operator op(clamp_op);
+
+  const xnn_status setup_status = xnn_setup_clamp_nc_f32(
+      op.get(),                         // operator
+      padded_input.numel(),             // batch_size
+      padded_input.data_ptr<float>(),   // input
+      output.data_ptr<float>(),         // output
+      caffe2::xnnpack_threadpool());    // threadpool
+
+  TORCH_CHECK(
+      xnn_status_success == setup_status,
+      "xnn_setup_clamp_nc_f32 failed!");
+
+  run_operator(std::move(op));
+  return output;
+}
+
+Tensor run_hardswish(const Tensor& input) {
+  const Tensor padded_input = prepare(input);
+  Tensor output = allocate_output(padded_input);
+
+  xnn_operator_t hardswish_op{};
+
+  const xnn_status create_status = xnn_create_hardswish_nc_f32(
+      1u,              // channels
+      1u,              // input_stride
+      1u,              // output_stride
+      0u,              // flags
+      &hardswish_op);  // operator
+
+  TORCH_CHECK(
+      xnn_status_success == create_status,
+      "xnn_create_hardswish_nc_f32 failed!");
+
+  Operator op(hardswish_op);
+
+  const xnn_status setup_status = xnn_setup_hardswish_nc_f32(
+      op.get(),                         // operator
+      padded_input.numel(),             // batch_size
+      padded_input.data_ptr<float>(),   // input
+      output.data_ptr<float>(),         // output
+      caffe2::xnnpack_threadpool());    // threadpool
+
+  TORCH_CHECK(
+      xnn_status_success == setup_status,
+      "xnn_setup_hardswish_nc_f32 failed!");
+
+  run_operator(std::move(op));
+  return output;
+}
+
+// Supports FP32 tensors of the same shape, without broadcasting. The second
+// operand is brought to the memory format of the first.
+bool usable_add(const Tensor& input, const Tensor& other) {
+  return usable(input) &&
+         usable(other) &&
+         (input.sizes() == other.sizes()) &&
+         true;
+}
+
+Tensor run_add(const Tensor& input, const Tensor& other) {
+  const Tensor padded_input = prepare(input);
+  const Tensor padded_other = allocate_padded_if_needed(
+      other.contiguous(padded_input.suggest_memory_format()));
+  Tensor output = allocate_output(padded_input);
+
+  xnn_operator_t add_op{};
+
+  const xnn_status create_status = xnn_create_add_nc_f32(
+      1u,        // channels
+      1u,        // a_stride
+      1u,        // b_stride
+      1u,        // sum_stride
+      kMin,      // sum_min
+      kMax,      // sum_max
+      0u,        // flags
+      &add_op);  // operator
+
+  TORCH_CHECK(
+      xnn_status_success == create_status,
+      "xnn_create_add_nc_f32 failed!");
+
+  Operator op(add_op);
+
+  const xnn_status setup_status = xnn_setup_add_nc_f32(
+      op.get(),                         // operator
+      padded_input.numel(),             // batch_size
+      padded_input.data_ptr<float>(),   // a
+      padded_other.data_ptr<float>(),   // b
+      output.data_ptr<float>(),         // sum
+      caffe2::xnnpack_threadpool());    // threadpool
+
+  TORCH_CHECK(
+      xnn_status_success == setup_status,
+      "xnn_setup_add_nc_f32 failed!");
+
+  run_operator(std::move(op));
+  return output;
+}
+
+} // namespace
+
+Tensor Hardswish::operator()(const Tensor& input) {
+  if (usable(input)) {
+    return run_hardswish(input);
+  }
+  return input * at::hardtanh(input + 3, 0, 6) / 6;
+}
+
+Tensor Clamp::operator()(
+    const Tensor& input,
+    c10::optional<c10::Scalar> min,
+    c10::optional<c10::Scalar> max) {
+  const float output_min = min ? min->to<float>() : kMin;
+  const float output_max = max ? max->to<float>() : kMax;
+  if (usable(input) && (output_max > output_min)) {
+    return run_clamp(input, output_min, output_max);
+  }
+  return at::clamp(input, min, max);
+}
+
+Tensor Add::operator()(const Tensor& input, const Tensor& other) {
+  if (usable_add(input, other)) {
+    return run_add(input, other);
+  }
+  return at::add(input, other);
+}
+
+} // namespace elementwise
+} // namespace internal
+
+bool use_hardswish(const Tensor& input) {
+  return internal::elementwise::usable(input);
+}
+
+Tensor hardswish(const Tensor& input) {
+  return internal::elementwise::run_hardswish(input);
+}
+
+bool use_clamp(
+    const Tensor& input,
+    const float output_min,
+    const float output_max) {
+  return internal::elementwise::usable(input) &&
+         (output_max > output_min);
+}
+
+Tensor clamp(
+    const Tensor& input,
+    const float output_min,
+    const float output_max) {
+  return internal::elementwise::run_clamp(input, output_min, output_max);
+}
+
+bool use_add(const Tensor& input, const Tensor& other) {
+  return internal::elementwise::usable_add(input, other);
+}
+
+Tensor add(const Tensor& input, const Tensor& other) {
+  return internal::elementwise::run_add(input, other);
+}
+
+} // namespace xnnpack
+} // namespace native
+} // namespace at
+
+#endif /* USE_XNNPACK */
@@ -0,0 +1,43 @@
+#pragma once
+
+#ifdef USE_XNNPACK
+
+#include <ATen/Tensor.h>
+#include <ATen/core/op_registration/op_registration.h>
+#include <ATen/native/xnnpack/Common.h>
+
+namespace at {
+namespace native {
+namespace xnnpack {
+namespace internal {
+namespace elementwise {
+
+// Elementwise operators work on the raw buffer of the input, so they preserve
+// its memory format and can sit between NHWC operators without a layout
+// conversion. Inputs XNNPACK cannot handle fall back to ATen.
+
+class Hardswish final : public torch::OperatorKernel {
+ public:
+  Tensor operator()(const Tensor& input);
+};
+
+class Clamp final : public torch::OperatorKernel {
+ public:
+  Tensor operator()(
+      const Tensor& input,
+      c10::optional<c10::Scalar> min,
+      c10::optional<c10::Scalar> max);
+};
+
+class Add final : public torch::OperatorKernel {
+ public:
+  Tensor operator()(const Tensor& input, const Tensor& other);
+};
+
+} // namespace elementwise
+} // namespace internal
+} // namespace xnnpack
+} // namespace native
+} // namespace at
+
+#endif /* USE_XNNPACK */
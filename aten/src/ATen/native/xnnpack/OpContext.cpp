@@ -1,5 +1,6 @@
 #ifdef USE_XNNPACK
 #include <ATen/native/xnnpack/Convolution.h>
+#include <ATen/native/xnnpack/ConvolutionTranspose.h>
 #include <ATen/native/xnnpack/Linear.h>
 #include <ATen/native/xnnpack/OpContext.h>
 
@@ -57,6 +58,40 @@ XNNPackConv2dOpContext::create_context(at::Tensor&& weight,
   return conv2d_op_context;
 }
 
+c10::intrusive_ptr<XNNPackConvTranspose2dOpContext>
+XNNPackConvTranspose2dOpContext::create_context(at::Tensor&& weight,
+    c10::optional<at::Tensor>&& bias,
+    std::vector<int64_t>&& padding,
+    std::vector<int64_t>&& output_padding,
+    std::vector<int64_t>&& stride,
+    std::vector<int64_t>&& dilation,
+    int64_t groups,
+    const c10::optional<double> output_min,
+    const c10::optional<double> output_max) {
+  auto op_context =
+      xnnpack::internal::convolution_transpose2d::create(
+          weight,
+          bias,
+          padding,
+          output_padding,
+          stride,
+          dilation,
+          groups,
+          output_min ? *output_min : xnnpack::ContextConvTranspose2D::kMin,
+          output_max ? *output_max : xnnpack::ContextConvTranspose2D::kMax);
+  auto conv_transpose2d_op_context =
+      c10::make_intrusive<XNNPackConvTranspose2dOpContext>(
+          std::move(weight),
+          std::move(bias),
+          std::move(padding),
+          std::move(output_padding),
+          std::move(stride),
+          std::move(dilation),
+          groups,
+          std::move(op_context));
+  return conv_transpose2d_op_context;
+}
+
 } // xnnpack
 } // native
 } // at
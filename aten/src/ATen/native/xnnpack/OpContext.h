@@ -14,6 +14,10 @@ using SerializationTypeLinearPrePack = std::tuple<Tensor, c10::optional<Tensor>>
 using SerializationTypeConv2dPrePack =
   std::tuple<Tensor, c10::optional<Tensor>,
   std::vector<int64_t>, std::vector<int64_t>, std::vector<int64_t>, int64_t>;
+using SerializationTypeConvTranspose2dPrePack =
+  std::tuple<Tensor, c10::optional<Tensor>,
+  std::vector<int64_t>, std::vector<int64_t>, std::vector<int64_t>,
+  std::vector<int64_t>, int64_t>;
 
 class XNNPackLinearOpContext : public torch::jit::CustomClassHolder {
   private:
@@ -88,6 +92,56 @@ class XNNPackConv2dOpContext : public torch::jit::CustomClassHolder {
         const c10::optional<double> output_min,
         const c10::optional<double> output_max);
 };
+
+class XNNPackConvTranspose2dOpContext : public torch::jit::CustomClassHolder {
+  private:
+    Tensor orig_weight_;
+    c10::optional<Tensor> orig_bias_;
+    std::vector<int64_t> padding_;
+    std::vector<int64_t> output_padding_;
+    std::vector<int64_t> stride_;
+    std::vector<int64_t> dilation_;
+    int64_t groups_;
+    ContextConvTranspose2D op_context_;
+
+  public:
+    XNNPackConvTranspose2dOpContext(Tensor&& weight,
+        c10::optional<Tensor>&& bias,
+        std::vector<int64_t>&& padding,
+        std::vector<int64_t>&& output_padding,
+        std::vector<int64_t>&& stride,
+        std::vector<int64_t>&& dilation,
+        int64_t groups,
+        ContextConvTranspose2D&& op_context
+        ) :
+        orig_weight_(std::move(weight)),
+        orig_bias_(std::move(bias)),
+        padding_(std::move(padding)),
+        output_padding_(std::move(output_padding)),
+        stride_(std::move(stride)),
+        dilation_(std::move(dilation)),
+        groups_(groups),
+        op_context_(std::move(op_context)) {}
+
+    const ContextConvTranspose2D& get_context() const {
+      return op_context_;
+    }
+
+    SerializationTypeConvTranspose2dPrePack unpack() {
+      return std::make_tuple(orig_weight_, orig_bias_, padding_,
+          output_padding_, stride_, dilation_, groups_);
+    }
+
+    static c10::intrusive_ptr<XNNPackConvTranspose2dOpContext> create_context(Tensor&& weight,
+        c10::optional<Tensor>&& bias,
+        std::vector<int64_t>&& padding,
+        std::vector<int64_t>&& output_padding,
+        std::vector<int64_t>&& stride,
+        std::vector<int64_t>&& dilation,
+        int64_t groups,
+        const c10::optional<double> output_min,
+        const c10::optional<double> output_max);
+};
 } // xnnpack
 
 } // native
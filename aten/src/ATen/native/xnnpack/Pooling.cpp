@@ -0,0 +1,431 @@
+#ifdef USE_XNNPACK
+
+#include <ATen/native/xnnpack/Common.h>
+#include <ATen/native/Pool.h>
+#include <ATen/native/utils/ParamUtils.h>
+#include <ATen/native/xnnpack/Factory.h>
+#include <ATen/native/xnnpack/Pooling.h>
+
+namespace at {
+namespace native {
+namespace xnnpack {
+namespace internal {
+namespace pooling {
+
+namespace {
+
+constexpr float kMin = -std::numeric_limits<float>::infinity();
+constexpr float kMax = std::numeric_limits<float>::infinity();
+
+struct Parameters final {
+  std::vector<int64_t> kernel;
+  std::vector<int64_t> padding;
+  std::vector<int64_t> stride;
+  std::vector<int64_t> dilation;
+
+  Parameters(
+      const IntArrayRef kernel_size,
+      const IntArrayRef padding_,
+      const IntArrayRef stride_,
+      const IntArrayRef dilation_)
+    : kernel(expand_param_if_needed(kernel_size, "kernel_size", 2)),
+      padding(expand_param_if_needed(padding_, "padding", 2)),
+      // An empty stride defaults to the kernel size.
+      stride(stride_.empty() ? kernel : expand_param_if_needed(stride_, "stride", 2)),
+      dilation(expand_param_if_needed(dilation_, "dilation", 2)) {}
+};
+
+// TODO: Decouple and improve error handling and messages.
+bool usable_input(const Tensor& input) {
+         // XNNPACK
+  return xnnpack::internal::available() &&
+         // Input
+         (4 == input.ndimension()) &&
+         (c10::DeviceType::CPU == input.device().type()) &&
+         (kFloat == input.scalar_type()) &&
+         (input.size(Layout::Activation4D::batch) >= 0) &&
+         (input.size(Layout::Activation4D::channels) > 0) &&
+         (input.size(Layout::Activation4D::height) > 0) &&
+         (input.size(Layout::Activation4D::width) > 0) &&
+         true;
+}
+
+// TODO: Decouple and improve error handling and messages.
+bool usable_parameters(const Parameters& parameters) {
+         // Kernel - XNNPACK rejects 1x1 pooling
+  return (parameters.kernel[Layout::Parameter::height] > 0) &&
+         (parameters.kernel[Layout::Parameter::width] > 0) &&
+         ((parameters.kernel[Layout::Parameter::height] *
+               parameters.kernel[Layout::Parameter::width]) > 1) &&
+         // Padding - at most half of the kernel, as in ATen
+         (parameters.padding[Layout::Parameter::height] >= 0) &&
+         (parameters.padding[Layout::Parameter::width] >= 0) &&
+         ((parameters.padding[Layout::Parameter::height] * 2) <=
+              parameters.kernel[Layout::Parameter::height]) &&
+         ((parameters.padding[Layout::Parameter::width] * 2) <=
+              parameters.kernel[Layout::Parameter::width]) &&
+         // Stride
+         (parameters.stride[Layout::Parameter::height] > 0) &&
+         (parameters.stride[Layout::Parameter::width] > 0) &&
+         // Dilation
+         (parameters.dilation[Layout::Parameter::height] > 0) &&
+         (parameters.dilation[Layout::Parameter::width] > 0) &&
+         true;
+}
+
+int64_t pooled_size(
+    const Tensor& input,
+    const Parameters& parameters,
+    const size_t input_dim,
+    const size_t parameter_dim,
+    const bool ceil_mode) {
+  return pooling_output_shape<int64_t>(
+      input.size(input_dim),
+      parameters.kernel[parameter_dim],
+      parameters.padding[parameter_dim],
+      parameters.stride[parameter_dim],
+      parameters.dilation[parameter_dim],
+      ceil_mode);
+}
+
+// Runs a pooling operator created for NHWC input and returns the output in
+// the memory format of the input.
+Tensor run(
+    Operator&& op,
+    xnn_status (*setup)(
+        xnn_operator_t,
+        size_t,
+        size_t,
+        size_t,
+        const float*,
+        float*,
+        pthreadpool_t),
+    const char* const setup_name,
+    const Tensor& input,
+    const Tensor& padded_input_nhwc,
+    const int64_t output_height,
+    const int64_t output_width) {
+  Tensor output = empty_with_tail_padding(
+      {
+        padded_input_nhwc.size(Layout::Activation4D::batch),
+        padded_input_nhwc.size(Layout::Activation4D::channels),
+        output_height,
+        output_width,
+      },
+      padded_input_nhwc.options().dtype(),
+      MemoryFormat::ChannelsLast);
+
+  const xnn_status setup_status = setup(
+      op.get(),                                              // operator
+      padded_input_nhwc.size(Layout::Activation4D::batch),   // batch_size
+      padded_input_nhwc.size(Layout::Activation4D::height),  // input_height
+      padded_input_nhwc.size(Layout::Activation4D::width),   // input_width
+      padded_input_nhwc.data_ptr<float>(),                   // input
+      output.data_ptr<float>(),                              // output
+      caffe2::xnnpack_threadpool());                         // threadpool
+
+  TORCH_CHECK(
+      xnn_status_success == setup_status,
+      setup_name, " failed!");
+
+  const xnn_status run_status = xnn_run_operator(
+      op.get(),                       // operator
+      caffe2::xnnpack_threadpool());  // threadpool
+
+  TORCH_INTERNAL_ASSERT(
+      xnn_status_success == run_status,
+      "xnn_run_operator failed!");
+
+  return output.contiguous(input.suggest_memory_format());
+}
+
+// Supports NHWC and NCHW FP32 max pooling with any valid
+//  - kernel size other than 1x1
+//  - padding
+//  - stride
+//  - dilation
+//  - ceil mode
+bool usable_max_pool2d(
+    const Tensor& input,
+    const Parameters& parameters,
+    const bool ceil_mode) {
+  return usable_input(input) &&
+         usable_parameters(parameters) &&
+         (pooled_size(input, parameters, Layout::Activation4D::height,
+              Layout::Parameter::height, ceil_mode) > 0) &&
+         (pooled_size(input, parameters, Layout::Activation4D::width,
+              Layout::Parameter::width, ceil_mode) > 0) &&
+         true;
+}
+
+Tensor max_pool2d(
+    const Tensor& input,
+    const Parameters& parameters,
+    const bool ceil_mode) {
+  const Tensor padded_input_nhwc =
+      allocate_padded_if_needed(input.contiguous(MemoryFormat::ChannelsLast));
+
+  const int64_t output_height = pooled_size(
+      padded_input_nhwc, parameters, Layout::Activation4D::height,
+      Layout::Parameter::height, ceil_mode);
+  const int64_t output_width = pooled_size(
+      padded_input_nhwc, parameters, Layout::Activation4D::width,
+      Layout::Parameter::width, ceil_mode);
+
+  // XNNPACK has no ceil mode. Padding the bottom and right edges so that the
+  // last, partial windows fit gives the same result, as padded values never
+  // win a max.
+  const auto extra_padding = [&](const size_t input_dim, const size_t parameter_dim,
+                                 const int64_t output_size) {
+    const int64_t needed = (output_size - 1) * parameters.stride[parameter_dim] +
+        parameters.dilation[parameter_dim] * (parameters.kernel[parameter_dim] - 1) + 1;
+    const int64_t available =
+        padded_input_nhwc.size(input_dim) + 2 * parameters.padding[parameter_dim];
+    return std::max<int64_t>(needed - available, 0);
+  };
+  const int64_t padding_bottom = parameters.padding[Layout::Parameter::height] +
+      extra_padding(Layout::Activation4D::height, Layout::Parameter::height, output_height);
+  const int64_t padding_right = parameters.padding[Layout::Parameter::width] +
+      extra_padding(Layout::Activation4D::width, Layout::Parameter::width, output_width);
+
+  const int64_t channels = padded_input_nhwc.size(Layout::Activation4D::channels);
+  xnn_operator_t max_pooling_op{};
+
+  const xnn_status create_status = xnn_create_max_pooling2d_nhwc_f32(
+      parameters.padding[Layout::Parameter::height],    // input_padding_top
+      padding_right,                                    // input_padding_right
+      padding_bottom,                                   // input_padding_bottom
+      parameters.padding[Layout::Parameter::width],     // input_padding_left
+      parameters.kernel[Layout::Parameter::height],     // pooling_height
+      parameters.kernel[Layout::Parameter::width],      // pooling_width
+      parameters.stride[Layout::Parameter::height],     // stride_height
+      parameters.stride[Layout::Parameter::width],      // stride_width
+      parameters.dilation[Layout::Parameter::height],   // dilation_height
+      parameters.dilation[Layout::Parameter::width],    // dilation_width
+      channels,                                         // channels
+      channels,                                         // input_pixel_stride
+      channels,                                         // output_pixel_stride
+      kMin,                                             // output_min
+      kMax,                                             // output_max
+      0u,                                               // flags
+      &max_pooling_op);                                 // operator
+
+  TORCH_CHECK(
+      xnn_status_success == create_status,
+      "xnn_create_max_pooling2d_nhwc_f32 failed!");
+
+  return run(
+      Operator(max_pooling_op),
+      &xnn_setup_max_pooling2d_nhwc_f32,
+      "xnn_setup_max_pooling2d_nhwc_f32",
+      input,
+      padded_input_nhwc,
+      output_height,
+      output_width);
+}
+
+// Supports NHWC and NCHW FP32 average pooling without padding, in floor mode,
+// with any valid
+//  - kernel size other than 1x1
+//  - stride
+bool usable_avg_pool2d(const Tensor& input, const Parameters& parameters) {
+  return usable_input(input) &&
+         usable_parameters(parameters) &&
+         (pooled_size(input, parameters, Layout::Activation4D::height,
+              Layout::Parameter::height, false) > 0) &&
+         (pooled_size(input, parameters, Layout::Activation4D::width,
+              Layout::Parameter::width, false) > 0) &&
+         true;
+}
+
+Tensor avg_pool2d(const Tensor& input, const Parameters& parameters) {
+  const Tensor padded_input_nhwc =
+      allocate_padded_if_needed(input.contiguous(MemoryFormat::ChannelsLast));
+
+  const int64_t channels = padded_input_nhwc.size(Layout::Activation4D::channels);
+  xnn_operator_t average_pooling_op{};
+
+  const xnn_status create_status = xnn_create_average_pooling2d_nhwc_f32(
+      0u,                                            // input_padding_top
+      0u,                                            // input_padding_right
+      0u,                                            // input_padding_bottom
+      0u,                                            // input_padding_left
+      parameters.kernel[Layout::Parameter::height],  // pooling_height
+      parameters.kernel[Layout::Parameter::width],   // pooling_width
+      parameters.stride[Layout::Parameter::height],  // stride_height
+      parameters.stride[Layout::Parameter::width],   // stride_width
+      channels,                                      // channels
+      channels,                                      // input_pixel_stride
+      channels,                                      // output_pixel_stride
+      kMin,                                          // output_min
+      kMax,                                          // output_max
+      0u,                                            // flags
+      &average_pooling_op);                          // operator
+
+  TORCH_CHECK(
+      xnn_status_success == create_status,
+      "xnn_create_average_pooling2d_nhwc_f32 failed!");
+
+  return run(
+      Operator(average_pooling_op),
+      &xnn_setup_average_pooling2d_nhwc_f32,
+      "xnn_setup_average_pooling2d_nhwc_f32",
+      input,
+      padded_input_nhwc,
+      pooled_size(padded_input_nhwc, parameters, Layout::Activation4D::height,
+          Layout::Parameter::height, false),
+      pooled_size(padded_input_nhwc, parameters, Layout::Activation4D::width,
+          Layout::Parameter::width, false));
+}
+
+// Average over the whole spatial extent, i.e. adaptive_avg_pool2d to 1x1.
+Tensor global_avg_pool2d(const Tensor& input) {
+  const Tensor padded_input_nhwc =
+      allocate_padded_if_needed(input.contiguous(MemoryFormat::ChannelsLast));
+
+  const int64_t channels = padded_input_nhwc.size(Layout::Activation4D::channels);
+  xnn_operator_t global_average_pooling_op{};
+
+  const xnn_status create_status = xnn_create_global_average_pooling_nwc_f32(
+      channels,                     // channels
+      channels,                     // input stride
+      channels,                     // output stride
+      kMin,                         // output_min
+      kMax,                         // output_max
+      0u,                           // flags
+      &global_average_pooling_op);  // operator
+
+  TORCH_CHECK(
+      xnn_status_success == create_status,
+      "xnn_create_global_average_pooling_nwc_f32 failed!");
+
+  Operator op(global_average_pooling_op);
+
+  Tensor output = empty_with_tail_padding(
+      {
+        padded_input_nhwc.size(Layout::Activation4D::batch),
+        channels,
+        1,
+        1,
+      },
+      padded_input_nhwc.options().dtype(),
+      MemoryFormat::ChannelsLast);
+
+  const xnn_status setup_status = xnn_setup_global_average_pooling_nwc_f32(
+      op.get(),                                                 // operator
+      padded_input_nhwc.size(Layout::Activation4D::batch),      // batch_size
+      padded_input_nhwc.size(Layout::Activation4D::height) *
+          padded_input_nhwc.size(Layout::Activation4D::width),  // width
+      padded_input_nhwc.data_ptr<float>(),                      // input
+      output.data_ptr<float>(),                                 // output
+      caffe2::xnnpack_threadpool());                            // threadpool
+
+  TORCH_CHECK(
+      xnn_status_success == setup_status,
+      "xnn_setup_global_average_pooling_nwc_f32 failed!");
+
+  const xnn_status run_status = xnn_run_operator(
+      op.get(),                       // operator
+      caffe2::xnnpack_threadpool());  // threadpool
+
+  TORCH_INTERNAL_ASSERT(
+      xnn_status_success == run_status,
+      "xnn_run_operator failed!");
+
+  return output.contiguous(input.suggest_memory_format());
+}
+
+} // namespace
+
+Tensor MaxPool2d::operator()(
+    const Tensor& input,
+    std::vector<int64_t> kernel_size,
+    std::vector<int64_t> stride,
+    std::vector<int64_t> padding,
+    std::vector<int64_t> dilation,
+    bool ceil_mode) {
+  const Parameters parameters(kernel_size, padding, stride, dilation);
+  if (usable_max_pool2d(input, parameters, ceil_mode)) {
+    return max_pool2d(input, parameters, ceil_mode);
+  }
+  return at::max_pool2d(input, kernel_size, stride, padding, dilation, ceil_mode);
+}
+
+Tensor AvgPool2d::operator()(
+    const Tensor& input,
+    std::vector<int64_t> kernel_size,
+    std::vector<int64_t> stride) {
+  const Parameters parameters(kernel_size, {0}, stride, {1});
+  if (usable_avg_pool2d(input, parameters)) {
+    return avg_pool2d(input, parameters);
+  }
+  return at::avg_pool2d(input, kernel_size, stride);
+}
+
+Tensor GlobalAvgPool2d::operator()(const Tensor& input) {
+  if (usable_input(input)) {
+    return global_avg_pool2d(input);
+  }
+  return at::adaptive_avg_pool2d(input, {1, 1});
+}
+
+} // namespace pooling
+} // namespace internal
+
+bool use_max_pool2d(
+    const Tensor& input,
+    const IntArrayRef kernel_size,
+    const IntArrayRef stride,
+    const IntArrayRef padding,
+    const IntArrayRef dilation,
+    const bool ceil_mode) {
+  return internal::pooling::usable_max_pool2d(
+      input,
+      internal::pooling::Parameters(kernel_size, padding, stride, dilation),
+      ceil_mode);
+}
+
+Tensor max_pool2d(
+    const Tensor& input,
+    const IntArrayRef kernel_size,
+    const IntArrayRef stride,
+    const IntArrayRef padding,
+    const IntArrayRef dilation,
+    const bool ceil_mode) {
+  return internal::pooling::max_pool2d(
+      input,
+      internal::pooling::Parameters(kernel_size, padding, stride, dilation),
+      ceil_mode);
+}
+
+bool use_avg_pool2d(
+    const Tensor& input,
+    const IntArrayRef kernel_size,
+    const IntArrayRef stride) {
+  return internal::pooling::usable_avg_pool2d(
+      input,
+      internal::pooling::Parameters(kernel_size, {0}, stride, {1}));
+}
+
+Tensor avg_pool2d(
+    const Tensor& input,
+    const IntArrayRef kernel_size,
+    const IntArrayRef stride) {
+  return internal::pooling::avg_pool2d(
+      input,
+      internal::pooling::Parameters(kernel_size, {0}, stride, {1}));
+}
+
+bool use_global_avg_pool2d(const Tensor& input) {
+  return internal::pooling::usable_input(input);
+}
+
+Tensor global_avg_pool2d(const Tensor& input) {
+  return internal::pooling::global_avg_pool2d(input);
+}
+
+} // namespace xnnpack
+} // namespace native
+} // namespace at
+
+#endif /* USE_XNNPACK */
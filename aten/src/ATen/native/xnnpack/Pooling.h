@@ -0,0 +1,48 @@
+#pragma once
+
+#ifdef USE_XNNPACK
+
+#include <ATen/Tensor.h>
+#include <ATen/core/op_registration/op_registration.h>
+#include <ATen/native/xnnpack/Common.h>
+
+namespace at {
+namespace native {
+namespace xnnpack {
+namespace internal {
+namespace pooling {
+
+// Pooling operators hold no weights, so there is nothing to prepack. Inputs
+// XNNPACK cannot handle fall back to the corresponding ATen operator.
+
+class MaxPool2d final : public torch::OperatorKernel {
+ public:
+  Tensor operator()(
+      const Tensor& input,
+      std::vector<int64_t> kernel_size,
+      std::vector<int64_t> stride,
+      std::vector<int64_t> padding,
+      std::vector<int64_t> dilation,
+      bool ceil_mode);
+};
+
+class AvgPool2d final : public torch::OperatorKernel {
+ public:
+  Tensor operator()(
+      const Tensor& input,
+      std::vector<int64_t> kernel_size,
+      std::vector<int64_t> stride);
+};
+
+class GlobalAvgPool2d final : public torch::OperatorKernel {
+ public:
+  Tensor operator()(const Tensor& input);
+};
+
+} // namespace pooling
+} // namespace internal
+} // namespace xnnpack
+} // namespace native
+} // namespace at
+
+#endif /* USE_XNNPACK */
@@ -2,8 +2,11 @@
 
 #include <ATen/core/op_registration/op_registration.h>
 #include <ATen/native/xnnpack/Convolution.h>
+#include <ATen/native/xnnpack/ConvolutionTranspose.h>
+#include <ATen/native/xnnpack/Elementwise.h>
 #include <ATen/native/xnnpack/Linear.h>
 #include <ATen/native/xnnpack/OpContext.h>
+#include <ATen/native/xnnpack/Pooling.h>
 #include <ATen/Tensor.h>
 #include <torch/custom_class.h>
 
@@ -66,8 +69,37 @@ torch::jit::class_<XNNPackConv2dOpContext> register_xnnpack_conv2d_op_context_cl
   return register_conv2d_op_context_class;
 }
 
+torch::jit::class_<XNNPackConvTranspose2dOpContext> register_xnnpack_conv_transpose2d_op_context_class() {
+  static auto register_conv_transpose2d_op_context_class =
+      torch::jit::class_<XNNPackConvTranspose2dOpContext>("xnnpack", "XNNPackConvTranspose2dOpContext")
+          .def_pickle(
+              [](const c10::intrusive_ptr<XNNPackConvTranspose2dOpContext>& op_context)
+                  -> SerializationTypeConvTranspose2dPrePack { // __getstate__
+                return op_context->unpack();
+              },
+              [](SerializationTypeConvTranspose2dPrePack state)
+                  -> c10::intrusive_ptr<
+                      XNNPackConvTranspose2dOpContext> { // __setstate__
+                return XNNPackConvTranspose2dOpContext::create_context(
+                    std::move(std::get<0>(state)),
+                    std::move(std::get<1>(state)),
+                    std::move(std::get<2>(state)),
+                    std::move(std::get<3>(state)),
+                    std::move(std::get<4>(state)),
+                    std::move(std::get<5>(state)),
+                    std::move(std::get<6>(state)),
+                    {},
+                    {}
+                    );
+              }
+              );
+  return register_conv_transpose2d_op_context_class;
+}
+
 static auto xnnpack_linear_op_context_class = register_xnnpack_linear_op_context_class();
 static auto xnnpack_conv2d_op_context_class = register_xnnpack_conv2d_op_context_class();
+static auto xnnpack_conv_transpose2d_op_context_class =
+    register_xnnpack_conv_transpose2d_op_context_class();
 
 // Op registeration
 static auto registry =
@@ -96,6 +128,50 @@ static auto registry =
             torch::RegisterOperators::options()
             .aliasAnalysis(at::AliasAnalysisKind::PURE_FUNCTION)
             .kernel<internal::convolution2d::Conv2dPacked>(
+                DispatchKey::CPUTensorId))
+        .op("_xnnpack::conv2d_transpose_prepack(Tensor W, Tensor? B, int[2] stride, "
+            "int[2] padding, int[2] output_padding, int groups, int[2] dilation) "
+            "-> __torch__.torch.classes.xnnpack.XNNPackConvTranspose2dOpContext",
+            torch::RegisterOperators::options()
+            .aliasAnalysis(at::AliasAnalysisKind::PURE_FUNCTION)
+            .kernel<internal::convolution_transpose2d::ConvTranspose2dPrePack>(
+                DispatchKey::CPUTensorId))
+        .op("_xnnpack::conv2d_transpose_packed(Tensor X, "
+            "__torch__.torch.classes.xnnpack.XNNPackConvTranspose2dOpContext W_prepack) -> Tensor Y",
+            torch::RegisterOperators::options()
+            .aliasAnalysis(at::AliasAnalysisKind::PURE_FUNCTION)
+            .kernel<internal::convolution_transpose2d::ConvTranspose2dPacked>(
+                DispatchKey::CPUTensorId))
+        .op("_xnnpack::max_pool2d(Tensor X, int[2] kernel_size, int[2] stride, "
+            "int[2] padding, int[2] dilation, bool ceil_mode) -> Tensor Y",
+            torch::RegisterOperators::options()
+            .aliasAnalysis(at::AliasAnalysisKind::PURE_FUNCTION)
+            .kernel<internal::pooling::MaxPool2d>(
+                DispatchKey::CPUTensorId))
+        .op("_xnnpack::avg_pool2d(Tensor X, int[2] kernel_size, int[2] stride) -> Tensor Y",
+            torch::RegisterOperators::options()
+            .aliasAnalysis(at::AliasAnalysisKind::PURE_FUNCTION)
+            .kernel<internal::pooling::AvgPool2d>(
+                DispatchKey::CPUTensorId))
+        .op("_xnnpack::global_avg_pool2d(Tensor X) -> Tensor Y",
+            torch::RegisterOperators::options()
+            .aliasAnalysis(at::AliasAnalysisKind::PURE_FUNCTION)
+            .kernel<internal::pooling::GlobalAvgPool2d>(
+                DispatchKey::CPUTensorId))
+        .op("_xnnpack::hardswish(Tensor X) -> Tensor Y",
+            torch::RegisterOperators::options()
+            .aliasAnalysis(at::AliasAnalysisKind::PURE_FUNCTION)
+            .kernel<internal::elementwise::Hardswish>(
+                DispatchKey::CPUTensorId))
+        .op("_xnnpack::clamp(Tensor X, Scalar? min=None, Scalar? max=None) -> Tensor Y",
+            torch::RegisterOperators::options()
+            .aliasAnalysis(at::AliasAnalysisKind::PURE_FUNCTION)
+            .kernel<internal::elementwise::Clamp>(
+                DispatchKey::CPUTensorId))
+        .op("_xnnpack::add(Tensor X, Tensor other) -> Tensor Y",
+            torch::RegisterOperators::options()
+            .aliasAnalysis(at::AliasAnalysisKind::PURE_FUNCTION)
+            .kernel<internal::elementwise::Add>(
                 DispatchKey::CPUTensorId));
 } // namespace
 
@@ -56,6 +56,82 @@ Tensor linear(
   TORCH_CHECK(false, internal::kError);
 }
 
+bool use_max_pool2d(
+    const Tensor&,
+    const IntArrayRef,
+    const IntArrayRef,
+    const IntArrayRef,
+    const IntArrayRef,
+    const bool) {
+  return false;
+}
+
+Tensor max_pool2d(
+    const Tensor&,
+    const IntArrayRef,
+    const IntArrayRef,
+    const IntArrayRef,
+    const IntArrayRef,
+    const bool) {
+  TORCH_CHECK(false, internal::kError);
+}
+
+bool use_avg_pool2d(
+    const Tensor&,
+    const IntArrayRef,
+    const IntArrayRef) {
+  return false;
+}
+
+Tensor avg_pool2d(
+    const Tensor&,
+    const IntArrayRef,
+    const IntArrayRef) {
+  TORCH_CHECK(false, internal::kError);
+}
+
+bool use_global_avg_pool2d(const Tensor&) {
+  return false;
+}
+
+Tensor global_avg_pool2d(const Tensor&) {
+  TORCH_CHECK(false, internal::kError);
+}
+
+bool use_hardswish(const Tensor&) {
+  return false;
+}
+
+Tensor hardswish(const Tensor&) {
+  TORCH_CHECK(false, internal::kError);
+}
+
+bool use_clamp(
+    const Tensor&,
+    const float,
+    const float) {
+  return false;
+}
+
+Tensor clamp(
+    const Tensor&,
+    const float,
+    const float) {
+  TORCH_CHECK(false, internal::kError);
+}
+
+bool use_add(
+    const Tensor&,
+    const Tensor&) {
+  return false;
+}
+
+Tensor add(
+    const Tensor&,
+    const Tensor&) {
+  TORCH_CHECK(false, internal::kError);
+}
+
 } // namespace xnnpack
 
 } // namespace native
@@ -6,6 +6,7 @@
 #include <ATen/Dispatch.h>
 #include <ATen/NativeFunctions.h>
 #include <ATen/native/TensorFactories.h>
+#include <ATen/native/quantized/affine_quantizer.h>
 #include <ATen/native/utils/Allocator.h>
 #include <ATen/quantized/QTensorImpl.h>
 #include <ATen/core/Tensor.h>
@@ -396,8 +397,40 @@ requantize_from_int<quint8>(double, int64_t, int64_t);
 template CAFFE2_API qint32
 requantize_from_int<qint32>(double, int64_t, int64_t);
 
-// TODO: add fbgemm for per channel
-template <typename T>
+namespace native {
+DEFINE_DISPATCH(quantize_tensor_per_channel_affine_stub);
+DEFINE_DISPATCH(dequantize_tensor_per_channel_affine_stub);
+} // namespace native
+
+namespace {
+
+void checkPerChannelParams(
+    const char* fn_name,
+    const Tensor& tensor,
+    const Tensor& scales,
+    const Tensor& zero_points,
+    int64_t axis) {
+  TORCH_CHECK(0 <= axis && axis < tensor.dim(),
+              fn_name,
+              ": channel axis out of range.");
+  int64_t channel = tensor.size(axis);
+  TORCH_CHECK(channel == int64_t(scales.numel()),
+              "length of scales must equal to channel");
+  TORCH_CHECK(channel == int64_t(zero_points.numel()),
+              "length of zero_points must equal to channel");
+}
+
+// Per channel tensors are kept channels last only when the channel axis is
+// the innermost dimension in memory, which is the layout the NHWC kernels
+// vectorize over; everything else is processed contiguously.
+MemoryFormat per_channel_memory_format(const Tensor& tensor, int64_t axis) {
+  if (axis == 1 && tensor.dim() == 4 &&
+      tensor.suggest_memory_format() == MemoryFormat::ChannelsLast) {
+    return MemoryFormat::ChannelsLast;
+  }
+  return MemoryFormat::Contiguous;
+}
+
 Tensor quantize_tensor_per_channel_affine(Tensor rtensor,
                                           Tensor qtensor,
                                           Tensor scales,
@@ -405,32 +438,16 @@ Tensor quantize_tensor_per_channel_affine(Tensor rtensor,
                                           int64_t axis) {
   auto fn_name = "quantize_tensor_per_channel_affine";
   checkFloatCPUTensor(fn_name, rtensor);
-  checkQuantizedCPUTensor<T>(fn_name, qtensor);
-  checkZeroPoints<typename T::underlying>(fn_name, zero_points);
-  TORCH_CHECK(0 <= axis && axis < rtensor.dim(), "Channel axis out of range in per channel affine quantization.");
-  int64_t batches = size_to_dim_(axis, rtensor.sizes());
-  int64_t elements_per_channel = size_from_dim_(axis + 1, rtensor.sizes());
-  int64_t channel = rtensor.size(axis);
-  auto scales_data = scales.data_ptr<double>();
-  auto zero_points_data = zero_points.data_ptr<int64_t>();
-  TORCH_CHECK(channel == int64_t(scales.numel()),
-              "length of scales must equal to channel");
-  TORCH_CHECK(channel == int64_t(zero_points.numel()),
-              "length of zero_points must equal to channel");
-  const float* rdata = rtensor.data_ptr<float>();
-  auto qdata = qtensor.data_ptr<T>();
-  for (auto b = 0; b < batches; ++b) {
-    for (auto c = 0; c < channel; ++c) {
-      for (auto e = 0; e < elements_per_channel; ++e) {
-        auto i = b * channel * elements_per_channel + c * elements_per_channel + e;
-        qdata[i] = quantize_val<T>(scales_data[c], zero_points_data[c], rdata[i]);
-      }
-    }
-  }
+  AT_DISPATCH_QINT_TYPES(qtensor.scalar_type(), fn_name, [&]() {
+    checkQuantizedCPUTensor<scalar_t>(fn_name, qtensor);
+    checkZeroPoints<underlying_t>(fn_name, zero_points);
+  });
+  checkPerChannelParams(fn_name, rtensor, scales, zero_points, axis);
+  native::quantize_tensor_per_channel_affine_stub(
+      rtensor.device().type(), rtensor, qtensor, scales, zero_points, axis);
   return qtensor;
 }
 
-template <typename T>
 Tensor dequantize_tensor_per_channel_affine(Tensor qtensor,
                                             Tensor rtensor,
                                             Tensor scales,
@@ -438,34 +455,18 @@ Tensor dequantize_tensor_per_channel_affine(Tensor qtensor,
                                             int64_t axis) {
   auto fn_name = "dequantize_tensor_per_channel_affine";
   checkFloatCPUTensor(fn_name, rtensor);
-  checkQuantizedCPUTensor<T>(fn_name, qtensor);
-  checkZeroPoints<typename T::underlying>(fn_name, zero_points);
-  TORCH_CHECK(0 <= axis && axis < qtensor.dim(),
-              "Channel axis out of range in per channel affine dequantization.");
-  int64_t batches = size_to_dim_(axis, rtensor.sizes());
-  int64_t elements_per_channel = size_from_dim_(axis + 1, rtensor.sizes());
-  int64_t channel = rtensor.size(axis);
-  auto scales_data = scales.data_ptr<double>();
-  auto zero_points_data = zero_points.data_ptr<int64_t>();
-  TORCH_CHECK(channel == int64_t(scales.numel()),
-              "length of scales must equal to channel");
-  TORCH_CHECK(channel == int64_t(zero_points.numel()),
-              "length of zero_points must equal to channel");
-  const auto* qd = qtensor.data_ptr<T>();
-  float* rd = rtensor.data_ptr<float>();
-  for (auto b = 0; b < batches; ++b) {
-    for (auto c = 0; c < channel; ++c) {
-      for (auto e = 0; e < elements_per_channel; ++e) {
-        auto i = b * channel * elements_per_channel + c * elements_per_channel + e;
-        // We need to convert the qint8 value to float to ensure the subtraction
-        // subexpression returns a float
-        rd[i] = (static_cast<float>(qd[i].val_) - zero_points_data[c]) * scales_data[c];
-      }
-    }
-  }
+  AT_DISPATCH_QINT_TYPES(qtensor.scalar_type(), fn_name, [&]() {
+    checkQuantizedCPUTensor<scalar_t>(fn_name, qtensor);
+    checkZeroPoints<underlying_t>(fn_name, zero_points);
+  });
+  checkPerChannelParams(fn_name, qtensor, scales, zero_points, axis);
+  native::dequantize_tensor_per_channel_affine_stub(
+      qtensor.device().type(), qtensor, rtensor, scales, zero_points, axis);
   return rtensor;
 }
 
+} // namespace
+
 QuantizerPtr make_per_tensor_affine_quantizer(
     double scale,
     int64_t zero_point,
@@ -599,19 +600,15 @@ Tensor PerChannelAffineQuantizer::quantize(Tensor rtensor) {
       "quantize only works for CPU backend right now.");
   // Here we need a std::intrusive_ptr<Quantizer>.. but actually "this" is the
   // quantizer that can be reused, so I'm using intrusive_from_this here
+  auto memory_format = per_channel_memory_format(rtensor, axis_);
   Tensor qtensor = new_qtensor_cpu(
       rtensor.sizes(),
-      rtensor.options().dtype(scalar_type_),
+      rtensor.options().dtype(scalar_type_).memory_format(memory_format),
       intrusive_from_this());
 
-  rtensor = rtensor.contiguous();
-  AT_DISPATCH_QINT_TYPES(qtensor.scalar_type(),
-                         "quantize_tensor_per_channel_affine",
-                         [&]() {
-    qtensor = quantize_tensor_per_channel_affine<scalar_t>(
-        rtensor, qtensor, scales_, zero_points_, axis_);
-  });
-  return qtensor;
+  rtensor = rtensor.contiguous(memory_format);
+  return quantize_tensor_per_channel_affine(
+      rtensor, qtensor, scales_, zero_points_, axis_);
 }
 
 Tensor PerChannelAffineQuantizer::dequantize(Tensor qtensor) {
@@ -620,17 +617,14 @@ Tensor PerChannelAffineQuantizer::dequantize(Tensor qtensor) {
   TORCH_CHECK(
       qtensor.device() == kCPU,
       "dequantize only works for CPU backend right now.");
-  Tensor rtensor = at::empty(qtensor.sizes(), qtensor.options().dtype(at::kFloat));
-  qtensor = qtensor.contiguous();
-
-  AT_DISPATCH_QINT_TYPES(qtensor.scalar_type(),
-                         "dequantize_tensor_per_channel_affine",
-                         [&]() {
-    rtensor = dequantize_tensor_per_channel_affine<scalar_t>(
-        qtensor, rtensor, scales_, zero_points_, axis_);
-  });
-
-  return rtensor;
+  auto memory_format = per_channel_memory_format(qtensor, axis_);
+  Tensor rtensor = at::empty(
+      qtensor.sizes(),
+      qtensor.options().dtype(at::kFloat).memory_format(memory_format));
+  qtensor = qtensor.contiguous(memory_format);
+
+  return dequantize_tensor_per_channel_affine(
+      qtensor, rtensor, scales_, zero_points_, axis_);
 }
 
 Quantizer::~Quantizer() {}
@@ -36,6 +36,16 @@ qlinear_configs = op_bench.config_list(
     tags=["short"],
 )
 
+# Configs for qlinear with block sparse weights
+qlinear_sparse_configs = op_bench.cross_product_configs(
+    N=[1, 16, 64],
+    IN=[256, 1024],
+    OUT=[256, 1024],
+    DENSITY=[0.05, 0.2],
+    SPARSE=[True, False],
+    tags=["short"],
+)
+
 
 class _QLinearBenchmarkBase(op_bench.TorchBenchmarkBase):
     def init(self, N, IN, OUT, linear_under_test):
@@ -70,8 +80,43 @@ class QDynamicLinearBenchmark(_QLinearBenchmarkBase):
         self.set_module_name("QDynamicLinear")
 
 
+class QDynamicLinearPerTokenBenchmark(op_bench.TorchBenchmarkBase):
+    """Dynamic linear with one quantization range per input row, to compare
+    against the per-tensor QDynamicLinear above."""
+    def init(self, N, IN, OUT):
+        self.X = torch.randn(N, IN, dtype=torch.float32)
+        W = torch.randn(OUT, IN, dtype=torch.float32)
+        qW = torch.quantize_per_tensor(W, scale=1.0 / 255, zero_point=0, dtype=torch.qint8)
+        self.W_prepack = torch.ops.quantized.linear_prepack(qW, None)
+        self.set_module_name("QDynamicLinearPerToken")
+
+    def forward(self):
+        return torch.ops.quantized.linear_dynamic_per_token(self.X, self.W_prepack)
+
+
+class QLinearSparseBenchmark(op_bench.TorchBenchmarkBase):
+    """quantized::linear with a weight that keeps DENSITY of its 1x4 blocks.
+    The same pruned weight is packed sparse or, with SPARSE=False, dense, so
+    the two packings can be compared config by config."""
+    def init(self, N, IN, OUT, DENSITY, SPARSE):
+        X = torch.randn(N, IN, dtype=torch.float32)
+        self.qX = torch.quantize_per_tensor(X, scale=1.0 / 255, zero_point=0, dtype=torch.quint8)
+        mask = (torch.rand(OUT, (IN + 3) // 4) < DENSITY).float()
+        W = torch.randn(OUT, IN, dtype=torch.float32) * mask.repeat_interleave(4, dim=1)[:, :IN]
+        qW = torch.quantize_per_tensor(W, scale=1.0 / 255, zero_point=0, dtype=torch.qint8)
+        if SPARSE:
+            self.W_prepack = torch.ops.quantized.linear_prepack_sparse(qW, None, 1.0)
+        else:
+            self.W_prepack = torch.ops.quantized.linear_prepack(qW, None)
+        self.set_module_name("QLinearSparse" if SPARSE else "QLinearPrunedDense")
+
+    def forward(self):
+        return torch.ops.quantized.linear(self.qX, self.W_prepack, 1.0 / 255, 0)
+
 op_bench.generate_pt_test(qlinear_configs, QLinearBenchmark)
 op_bench.generate_pt_test(qlinear_configs, QDynamicLinearBenchmark)
+op_bench.generate_pt_test(qlinear_configs, QDynamicLinearPerTokenBenchmark)
+op_bench.generate_pt_test(qlinear_sparse_configs, QLinearSparseBenchmark)
 
 
 if __name__ == "__main__":
@@ -0,0 +1,68 @@
+import argparse
+
+import torch
+from torch.utils import ThroughputBenchmark
+
+
+class DeepWide(torch.nn.Module):
+    """
+    Small ranking-style model: a few linear layers over dense features
+    concatenated with a pooled embedding. Small enough that executor overhead
+    is a visible fraction of the latency.
+    """
+    def __init__(self, num_features, embedding_dim, hidden):
+        super(DeepWide, self).__init__()
+        self.mu = torch.nn.Parameter(torch.randn(1, num_features))
+        self.sigma = torch.nn.Parameter(torch.randn(1, num_features))
+        self.fc1 = torch.nn.Linear(num_features + embedding_dim, hidden)
+        self.fc2 = torch.nn.Linear(hidden, 1)
+
+    def forward(self, user_emb, ad_emb, features):
+        wide = (features - self.mu) * self.sigma
+        dot = torch.bmm(ad_emb, user_emb.transpose(1, 2)).view(ad_emb.size(0), -1)
+        x = torch.cat([wide, dot], dim=1)
+        x = torch.relu(self.fc1(x))
+        return torch.sigmoid(self.fc2(x))
+
+
+def run(bench, args, inputs):
+    for inp in inputs:
+        bench.add_input(*inp)
+    return bench.benchmark(
+        num_calling_threads=args.num_threads,
+        num_warmup_iters=args.warmup,
+        num_iters=args.iters)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Static runtime benchmark")
+    parser.add_argument("--batch-size", type=int, default=1)
+    parser.add_argument("--num-features", type=int, default=50)
+    parser.add_argument("--embedding-dim", type=int, default=32)
+    parser.add_argument("--hidden", type=int, default=64)
+    parser.add_argument("--num-threads", type=int, default=1)
+    parser.add_argument("--warmup", type=int, default=100)
+    parser.add_argument("--iters", type=int, default=10000)
+    args = parser.parse_args()
+
+    model = DeepWide(args.num_features, args.embedding_dim, args.hidden).eval()
+    inputs = [(
+        torch.randn(args.batch_size, 1, args.embedding_dim),
+        torch.randn(args.batch_size, 1, args.embedding_dim),
+        torch.randn(args.batch_size, args.num_features),
+    )]
+    scripted = torch.jit.script(model)
+    scripted.eval()
+    static = torch._C._jit_to_static_module(scripted._c)
+
+    expected = scripted(*inputs[0])
+    torch.testing.assert_allclose(static(*inputs[0]), expected)
+
+    print("ScriptModule:")
+    print(run(ThroughputBenchmark(scripted), args, inputs))
+    print("StaticModule:")
+    print(run(ThroughputBenchmark(static), args, inputs))
+
+
+if __name__ == "__main__":
+    main()
@@ -46,6 +46,9 @@ int main(int argc, char** argv) {
       LOG(INFO) << "Converted " << count << " items so far.";
     }
   }
+  // Dbs like indexed_minidb only write their index when they are closed.
+  transaction.reset();
+  out_db->Close();
   LOG(INFO) << "A total of " << count << " items processed.";
   return 0;
 }
@@ -15,6 +15,7 @@
  */
 
 #include <cstdio>
+#include <random>
 #include <thread>
 #include <vector>
 
@@ -28,6 +29,16 @@ C10_DEFINE_string(input_db_type, "", "The input db type.");
 C10_DEFINE_int(report_interval, 1000, "The report interval.");
 C10_DEFINE_int(repeat, 10, "The number to repeat the throughput test.");
 C10_DEFINE_bool(use_reader, false, "If true, use the reader interface.");
+C10_DEFINE_bool(
+    random_access,
+    false,
+    "If true, read records at random positions. The db needs to support "
+    "random access, e.g. indexed_minidb.");
+C10_DEFINE_bool(
+    use_value_view,
+    false,
+    "If true, read values through Cursor::value_view(), which does not copy "
+    "them for dbs that keep their values in memory.");
 C10_DEFINE_int(
     num_read_threads,
     1,
@@ -42,15 +53,32 @@ void TestThroughputWithDB() {
   std::unique_ptr<DB> in_db(caffe2::db::CreateDB(
       FLAGS_input_db_type, FLAGS_input_db, caffe2::db::READ));
   std::unique_ptr<Cursor> cursor(in_db->NewCursor());
+  CAFFE_ENFORCE(
+      !FLAGS_random_access || cursor->SupportsRandomAccess(),
+      "The db does not support random access.");
+  std::mt19937 gen;
+  std::uniform_int_distribution<size_t> position(
+      0, FLAGS_random_access ? cursor->NumRecords() - 1 : 0);
+  size_t bytes = 0;
   for (int iter_id = 0; iter_id < FLAGS_repeat; ++iter_id) {
     caffe2::Timer timer;
     for (int i = 0; i < FLAGS_report_interval; ++i) {
+      if (FLAGS_random_access) {
+        cursor->SeekToPosition(position(gen));
+      }
       string key = cursor->key();
-      string value = cursor->value();
+      if (FLAGS_use_value_view) {
+        bytes += cursor->value_view().size();
+      } else {
+        string value = cursor->value();
+        bytes += value.size();
+      }
       //VLOG(1) << "Key " << key;
-      cursor->Next();
-      if (!cursor->Valid()) {
-        cursor->SeekToFirst();
+      if (!FLAGS_random_access) {
+        cursor->Next();
+        if (!cursor->Valid()) {
+          cursor->SeekToFirst();
+        }
       }
     }
     double elapsed_seconds = timer.Seconds();
@@ -60,6 +88,7 @@ void TestThroughputWithDB() {
         elapsed_seconds,
         FLAGS_report_interval / elapsed_seconds);
   }
+  VLOG(1) << "Read " << bytes << " bytes of values.";
 }
 
 void TestThroughputWithReaderWorker(const DBReader* reader, int thread_id) {
@@ -6,14 +6,18 @@
 #include <torch/csrc/jit/serialization/import.h>
 #include "torch/script.h"
 
+#include <chrono>
+
 C10_DEFINE_string(model, "", "The given bytecode model to check if it is supported by lite_interpreter.");
+C10_DEFINE_int(iter, 0, "The number of times to load the model to measure load time.");
 
 int main(int argc, char** argv) {
   c10::SetUsageMessage(
     "Check if exported bytecode model is runnable by lite_interpreter.\n"
     "Example usage:\n"
     "./lite_interpreter_model_load"
-    " --model=<model_file>");
+    " --model=<model_file>"
+    " [--iter=<load_iterations>]");
 
   if (!c10::ParseCommandLineFlags(&argc, &argv)) {
     std::cerr << "Failed to parse command line flags!" << std::endl;
@@ -29,5 +33,16 @@ int main(int argc, char** argv) {
   // interpreter.
   torch::AutoNonVariableTypeMode non_var_guard{true};
   torch::jit::mobile::Module bc = torch::jit::_load_for_mobile(FLAGS_model);
+
+  if (FLAGS_iter > 0) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < FLAGS_iter; ++i) {
+      bc = torch::jit::_load_for_mobile(FLAGS_model);
+    }
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    std::cout << "Average load time: " << elapsed.count() / FLAGS_iter
+              << " ms over " << FLAGS_iter << " iterations" << std::endl;
+  }
   return 0;
 }
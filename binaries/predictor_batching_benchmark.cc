@@ -0,0 +1,141 @@
+/**
+ * Copyright (c) 2016-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Load generator for BatchingPredictor. A number of clients send requests
+// concurrently, each waiting for its response before sending the next one,
+// and the latency percentiles and throughput are reported. Running it with
+// --max_batch_size=1 gives the numbers without batching.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/init.h"
+#include "caffe2/core/logging.h"
+#include "caffe2/core/timer.h"
+#include "caffe2/predictor/batching_predictor.h"
+#include "caffe2/utils/math.h"
+#include "caffe2/utils/proto_utils.h"
+#include "caffe2/utils/string_utils.h"
+
+C10_DEFINE_string(init_net, "", "The given net to initialize any parameters.");
+C10_DEFINE_string(net, "", "The given net to benchmark.");
+C10_DEFINE_string(
+    input_dims,
+    "",
+    "The dimensions of a single row of each float input of the predictor, "
+    "as comma separated numbers, with the inputs separated by semicolons.");
+C10_DEFINE_int(rows_per_request, 1, "The number of rows of each request.");
+C10_DEFINE_int(num_clients, 16, "The number of concurrent clients.");
+C10_DEFINE_int(requests_per_client, 100, "The requests each client sends.");
+C10_DEFINE_int(warmup, 10, "The requests each client sends to warm up.");
+C10_DEFINE_int(max_batch_size, 32, "The maximal number of rows in a batch.");
+C10_DEFINE_int(max_wait_us, 1000, "The longest a request waits for a batch.");
+C10_DEFINE_int(num_workers, 1, "The number of workspaces running batches.");
+
+using caffe2::BatchingPredictor;
+using caffe2::TensorCPU;
+
+namespace {
+
+std::vector<TensorCPU> makeInputs() {
+  std::vector<TensorCPU> inputs;
+  caffe2::CPUContext context;
+  for (const auto& dims_str : caffe2::split(';', FLAGS_input_dims)) {
+    std::vector<int64_t> dims{FLAGS_rows_per_request};
+    for (const auto& dim : caffe2::split(',', dims_str)) {
+      dims.push_back(c10::stoi(dim));
+    }
+    TensorCPU input(dims, caffe2::CPU);
+    caffe2::math::RandUniform<float, caffe2::CPUContext>(
+        input.numel(), -1.0, 1.0, input.mutable_data<float>(), &context);
+    inputs.push_back(std::move(input));
+  }
+  return inputs;
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+  const size_t index = std::min(
+      sorted.size() - 1, static_cast<size_t>(p * sorted.size()));
+  return sorted[index];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  caffe2::GlobalInit(&argc, &argv);
+  CAFFE_ENFORCE(!FLAGS_input_dims.empty(), "--input_dims is required.");
+  CAFFE_ENFORCE_GT(FLAGS_requests_per_client, 0);
+
+  caffe2::NetDef init_net, predict_net;
+  CAFFE_ENFORCE(caffe2::ReadProtoFromFile(FLAGS_init_net, &init_net));
+  CAFFE_ENFORCE(caffe2::ReadProtoFromFile(FLAGS_net, &predict_net));
+  BatchingPredictor::Options options;
+  options.max_batch_size = FLAGS_max_batch_size;
+  options.max_wait = std::chrono::microseconds(FLAGS_max_wait_us);
+  options.num_workers = FLAGS_num_workers;
+  BatchingPredictor predictor(
+      caffe2::makePredictorConfig(init_net, predict_net), options);
+
+  std::vector<std::vector<double>> latencies(FLAGS_num_clients);
+  auto client = [&](int client_id) {
+    const std::vector<TensorCPU> inputs = makeInputs();
+    BatchingPredictor::TensorList outputs;
+    for (int i = 0; i < FLAGS_warmup; ++i) {
+      CAFFE_ENFORCE(predictor(inputs, &outputs));
+    }
+    for (int i = 0; i < FLAGS_requests_per_client; ++i) {
+      caffe2::Timer timer;
+      CAFFE_ENFORCE(predictor(inputs, &outputs));
+      latencies[client_id].push_back(timer.MilliSeconds());
+    }
+  };
+
+  caffe2::Timer timer;
+  std::vector<std::thread> clients;
+  for (int i = 0; i < FLAGS_num_clients; ++i) {
+    clients.emplace_back(client, i);
+  }
+  for (auto& thread : clients) {
+    thread.join();
+  }
+  const double elapsed_seconds = timer.Seconds();
+
+  std::vector<double> all;
+  for (const auto& client_latencies : latencies) {
+    all.insert(all.end(), client_latencies.begin(), client_latencies.end());
+  }
+  std::sort(all.begin(), all.end());
+  const int num_requests =
+      FLAGS_num_clients * (FLAGS_warmup + FLAGS_requests_per_client);
+  printf(
+      "%d clients, max batch size %d, max wait %d us, %d workers:\n"
+      "  latency p50 %.3f ms, p90 %.3f ms, p99 %.3f ms\n"
+      "  throughput %.1f requests/sec, %.1f rows/sec\n",
+      FLAGS_num_clients,
+      FLAGS_max_batch_size,
+      FLAGS_max_wait_us,
+      FLAGS_num_workers,
+      percentile(all, 0.5),
+      percentile(all, 0.9),
+      percentile(all, 0.99),
+      num_requests / elapsed_seconds,
+      num_requests * FLAGS_rows_per_request / elapsed_seconds);
+  return 0;
+}
@@ -1,4 +1,5 @@
 #include <c10/core/CPUAllocator.h>
+#include <c10/core/CPUCachingAllocator.h>
 #include <c10/core/DeviceType.h>
 
 // TODO: rename flags to C10
@@ -36,6 +37,19 @@ void memset_junk(void* data, size_t num) {
   }
 }
 
+// Applies the zero-fill or junk-fill flag to a freshly handed out buffer.
+static void fill_cpu(void* data, size_t nbytes) {
+  CHECK(
+      !FLAGS_caffe2_cpu_allocator_do_zero_fill ||
+      !FLAGS_caffe2_cpu_allocator_do_junk_fill)
+    << "Cannot request both zero-fill and junk-fill at the same time";
+  if (FLAGS_caffe2_cpu_allocator_do_zero_fill) {
+    memset(data, 0, nbytes);
+  } else if (FLAGS_caffe2_cpu_allocator_do_junk_fill) {
+    memset_junk(data, nbytes);
+  }
+}
+
 void* alloc_cpu(size_t nbytes) {
   if (nbytes == 0) {
     return nullptr;
@@ -73,15 +87,7 @@ void* alloc_cpu(size_t nbytes) {
 
   // move data to a thread's NUMA node
   NUMAMove(data, nbytes, GetCurrentNUMANode());
-  CHECK(
-      !FLAGS_caffe2_cpu_allocator_do_zero_fill ||
-      !FLAGS_caffe2_cpu_allocator_do_junk_fill)
-    << "Cannot request both zero-fill and junk-fill at the same time";
-  if (FLAGS_caffe2_cpu_allocator_do_zero_fill) {
-    memset(data, 0, nbytes);
-  } else if (FLAGS_caffe2_cpu_allocator_do_junk_fill) {
-    memset_junk(data, nbytes);
-  }
+  fill_cpu(data, nbytes);
 
   return data;
 }
@@ -112,6 +118,21 @@ struct C10_API DefaultCPUAllocator final : at::Allocator {
   DefaultCPUAllocator() {}
   ~DefaultCPUAllocator() override {}
   at::DataPtr allocate(size_t nbytes) const override {
+    auto* caching_allocator = GetThreadLocalCachingAllocator();
+    if (caching_allocator && nbytes > 0) {
+      void* block = caching_allocator->allocate(nbytes);
+      void* data = CPUCachingAllocator::data(block);
+      // A reused block holds whatever its last user left in it.
+      fill_cpu(data, nbytes);
+      if (FLAGS_caffe2_report_cpu_memory_usage) {
+        getMemoryAllocationReporter().New(block, nbytes);
+        return {data,
+                block,
+                &ReportAndFreeCached,
+                at::Device(at::DeviceType::CPU)};
+      }
+      return {data, block, &FreeCached, at::Device(at::DeviceType::CPU)};
+    }
     void* data = alloc_cpu(nbytes);
     if (FLAGS_caffe2_report_cpu_memory_usage && nbytes > 0) {
       getMemoryAllocationReporter().New(data, nbytes);
@@ -120,6 +141,21 @@ struct C10_API DefaultCPUAllocator final : at::Allocator {
     return {data, data, &free_cpu, at::Device(at::DeviceType::CPU)};
   }
 
+  // Blocks from a caching allocator go back to the pool of the thread that
+  // frees them, or to the system if that thread has no pool.
+  static void FreeCached(void* block) {
+    if (auto* caching_allocator = GetThreadLocalCachingAllocator()) {
+      caching_allocator->free(block);
+    } else {
+      CPUCachingAllocator::free_to_system(block);
+    }
+  }
+
+  static void ReportAndFreeCached(void* block) {
+    getMemoryAllocationReporter().Delete(block);
+    FreeCached(block);
+  }
+
   static void ReportAndDelete(void* ptr) {
     if (!ptr) {
       return;
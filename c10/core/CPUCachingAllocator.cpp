@@ -0,0 +1,97 @@
+#include <c10/core/CPUCachingAllocator.h>
+
+#include <c10/core/CPUAllocator.h>
+#include <c10/util/Exception.h>
+
+namespace c10 {
+
+namespace {
+thread_local CPUCachingAllocator* caching_allocator_ptr{nullptr};
+
+// The block size is stored in front of the data, padded so that the data
+// keeps the alignment of alloc_cpu.
+constexpr size_t kHeaderBytes = gAlignment;
+static_assert(
+    kHeaderBytes >= sizeof(size_t),
+    "The block header must hold the block size");
+
+size_t& blockSize(void* block) {
+  return *static_cast<size_t*>(block);
+}
+} // namespace
+
+CPUCachingAllocator::CPUCachingAllocator(size_t max_cached_bytes)
+    : max_cached_bytes_(max_cached_bytes) {}
+
+CPUCachingAllocator::~CPUCachingAllocator() {
+  free_cached();
+}
+
+void* CPUCachingAllocator::allocate(size_t bytes) {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = available_.find(bytes);
+    if (it != available_.end() && !it->second.empty()) {
+      void* block = it->second.back();
+      it->second.pop_back();
+      cached_bytes_ -= bytes;
+      return block;
+    }
+  }
+  void* block = alloc_cpu(kHeaderBytes + bytes);
+  blockSize(block) = bytes;
+  return block;
+}
+
+void CPUCachingAllocator::free(void* block) {
+  size_t bytes = blockSize(block);
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (bytes <= max_cached_bytes_ - cached_bytes_) {
+      available_[bytes].push_back(block);
+      cached_bytes_ += bytes;
+      return;
+    }
+  }
+  free_to_system(block);
+}
+
+void CPUCachingAllocator::free_cached() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  for (auto& entry : available_) {
+    for (void* block : entry.second) {
+      free_cpu(block);
+    }
+  }
+  available_.clear();
+  cached_bytes_ = 0;
+}
+
+size_t CPUCachingAllocator::cached_bytes() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return cached_bytes_;
+}
+
+void* CPUCachingAllocator::data(void* block) {
+  return static_cast<char*>(block) + kHeaderBytes;
+}
+
+void CPUCachingAllocator::free_to_system(void* block) {
+  free_cpu(block);
+}
+
+CPUCachingAllocator* GetThreadLocalCachingAllocator() {
+  return caching_allocator_ptr;
+}
+
+WithCPUCachingAllocatorGuard::WithCPUCachingAllocatorGuard(
+    CPUCachingAllocator* allocator)
+    : prev_(caching_allocator_ptr) {
+  caching_allocator_ptr = allocator;
+}
+
+WithCPUCachingAllocatorGuard::~WithCPUCachingAllocatorGuard() {
+  caching_allocator_ptr = prev_;
+}
+
+} // namespace c10
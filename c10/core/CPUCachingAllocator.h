@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <c10/macros/Macros.h>
+
+namespace c10 {
+
+/*
+ * A pool of CPU blocks keyed by their exact size.
+ *
+ * While a WithCPUCachingAllocatorGuard is active on a thread, the default CPU
+ * allocator serves requests from the guarded pool first, and blocks freed on
+ * that thread go back into the pool instead of to the system. Workloads that
+ * run the same shapes over and over (e.g. a model's forward) then stop
+ * calling malloc/free after the first run.
+ *
+ * The pool keeps at most `max_cached_bytes` of free blocks; blocks freed
+ * beyond that go back to the system. free_cached() releases every cached
+ * block. A block allocated from a pool and freed while no guard is active
+ * (e.g. a returned tensor that outlives the pool) goes back to the system.
+ *
+ * Each block records its size in a header in front of the data, so only the
+ * pool's own lock is taken per allocation.
+ */
+class C10_API CPUCachingAllocator {
+ public:
+  explicit CPUCachingAllocator(
+      size_t max_cached_bytes = std::numeric_limits<size_t>::max());
+  ~CPUCachingAllocator();
+
+  // Returns a block of at least `bytes` usable bytes, starting at data().
+  void* allocate(size_t bytes);
+  // Returns `block` to the pool. `block` must have been allocated by a pool.
+  void free(void* block);
+  // Releases every cached block.
+  void free_cached();
+  // The total size of the free blocks held by the pool.
+  size_t cached_bytes() const;
+
+  // The usable memory of a pooled block.
+  static void* data(void* block);
+  // Frees a pooled block to the system.
+  static void free_to_system(void* block);
+
+ private:
+  const size_t max_cached_bytes_;
+  mutable std::mutex mutex_;
+  size_t cached_bytes_ = 0;
+  // size -> cached blocks of exactly that size
+  std::unordered_map<size_t, std::vector<void*>> available_;
+};
+
+// The pool set by the innermost active guard on this thread, or nullptr.
+C10_API CPUCachingAllocator* GetThreadLocalCachingAllocator();
+
+class C10_API WithCPUCachingAllocatorGuard {
+ public:
+  explicit WithCPUCachingAllocatorGuard(CPUCachingAllocator* allocator);
+  ~WithCPUCachingAllocatorGuard();
+
+ private:
+  CPUCachingAllocator* prev_;
+};
+
+} // namespace c10
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+#include <c10/core/CPUAllocator.h>
+#include <c10/core/CPUCachingAllocator.h>
+
+TEST(CPUCachingAllocatorTest, ReusesFreedBlocksOfTheSameSize) {
+  c10::CPUCachingAllocator caching_allocator;
+  c10::WithCPUCachingAllocatorGuard guard(&caching_allocator);
+  auto* allocator = c10::GetDefaultCPUAllocator();
+
+  void* first = nullptr;
+  {
+    auto data = allocator->allocate(1024);
+    first = data.get();
+  }
+  auto same_size = allocator->allocate(1024);
+  EXPECT_EQ(same_size.get(), first);
+  auto other_size = allocator->allocate(2048);
+  EXPECT_NE(other_size.get(), first);
+}
+
+TEST(CPUCachingAllocatorTest, OnlyActiveWithinGuard) {
+  c10::CPUCachingAllocator caching_allocator;
+  auto* allocator = c10::GetDefaultCPUAllocator();
+  at::DataPtr escaped;
+  {
+    c10::WithCPUCachingAllocatorGuard guard(&caching_allocator);
+    EXPECT_EQ(c10::GetThreadLocalCachingAllocator(), &caching_allocator);
+    escaped = allocator->allocate(512);
+  }
+  EXPECT_EQ(c10::GetThreadLocalCachingAllocator(), nullptr);
+  // Freed outside of the guard, so the block goes back to the system.
+  escaped.clear();
+  auto data = allocator->allocate(512);
+  EXPECT_NE(data.get(), nullptr);
+}
+
+TEST(CPUCachingAllocatorTest, KeepsAtMostMaxCachedBytes) {
+  c10::CPUCachingAllocator caching_allocator(/*max_cached_bytes=*/1536);
+  c10::WithCPUCachingAllocatorGuard guard(&caching_allocator);
+  auto* allocator = c10::GetDefaultCPUAllocator();
+  {
+    auto first = allocator->allocate(1024);
+    auto second = allocator->allocate(1024);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(first.get()) % c10::gAlignment, 0);
+  }
+  // Only one of the two blocks fits in the pool.
+  EXPECT_EQ(caching_allocator.cached_bytes(), 1024);
+  caching_allocator.free_cached();
+  EXPECT_EQ(caching_allocator.cached_bytes(), 0);
+}
+
+TEST(CPUCachingAllocatorTest, ZeroFillsReusedBlocks) {
+  c10::CPUCachingAllocator caching_allocator;
+  c10::WithCPUCachingAllocatorGuard guard(&caching_allocator);
+  auto* allocator = c10::GetDefaultCPUAllocator();
+  {
+    auto data = allocator->allocate(64);
+    std::memset(data.get(), 0xff, 64);
+  }
+  FLAGS_caffe2_cpu_allocator_do_zero_fill = true;
+  auto reused = allocator->allocate(64);
+  FLAGS_caffe2_cpu_allocator_do_zero_fill = false;
+  const auto* bytes = static_cast<const uint8_t*>(reused.get());
+  for (size_t i = 0; i < 64; ++i) {
+    EXPECT_EQ(bytes[i], 0);
+  }
+}
+
+TEST(CPUCachingAllocatorTest, ReportsCachedBlocks) {
+  c10::CPUCachingAllocator caching_allocator;
+  c10::WithCPUCachingAllocatorGuard guard(&caching_allocator);
+  auto* allocator = c10::GetDefaultCPUAllocator();
+  auto unreported = allocator->allocate(128);
+  FLAGS_caffe2_report_cpu_memory_usage = true;
+  auto reported = allocator->allocate(128);
+  FLAGS_caffe2_report_cpu_memory_usage = false;
+  // Reported blocks are freed through the reporter, which checks that they
+  // were reported when they were handed out.
+  EXPECT_NE(reported.get_deleter(), unreported.get_deleter());
+}
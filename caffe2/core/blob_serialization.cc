@@ -26,6 +26,19 @@ C10_DEFINE_bool(
     false,
     "Serialize BOOL, UINT8, INT8, UINT16, INT16, INT64, FLOAT16 tensors using byte_data field instead of int32");
 
+C10_DEFINE_bool(
+    caffe2_serialize_as_raw_data,
+    false,
+    "Serialize tensors of fixed size types as little-endian bytes in the "
+    "raw_data field instead of the typed fields. Raw data is copied as a "
+    "whole on deserialization rather than element by element.");
+
+C10_DEFINE_int(
+    caffe2_max_tensor_deserializer_threads,
+    16,
+    "Maximal number of threads that can be used for loading the chunks of "
+    "serialized tensors");
+
 #ifdef _MSC_VER
 // It's MSVC, so we just have to guess ... and allow an override
 #ifdef FOLLY_ENDIAN_BE
@@ -218,6 +231,50 @@ static bool EnableByteEncoding(
   return ret;
 }
 
+static bool EnableRawEncoding(
+    const TensorProto::DataType& dataType,
+    const size_t& typeSize) {
+  if (!FLAGS_caffe2_serialize_as_raw_data ||
+      !(typeSize == 1 || kIsLittleEndian)) {
+    return false;
+  }
+  switch (dataType) {
+    case TensorProto_DataType_FLOAT:
+    case TensorProto_DataType_INT32:
+    case TensorProto_DataType_BOOL:
+    case TensorProto_DataType_UINT8:
+    case TensorProto_DataType_INT8:
+    case TensorProto_DataType_UINT16:
+    case TensorProto_DataType_INT16:
+    case TensorProto_DataType_INT64:
+    case TensorProto_DataType_FLOAT16:
+    case TensorProto_DataType_DOUBLE:
+      return true;
+    default:
+      return false;
+  }
+}
+
+static void SerializeAsRawData(
+    const Tensor& input,
+    size_t chunkBegin,
+    int32_t chunkSize,
+    BaseContext* context,
+    TensorProto& proto) {
+  proto.set_storage_type(TensorProto_StorageType_RAW);
+  const size_t nbytes = chunkSize * input.itemsize();
+  std::string* rawData = proto.mutable_raw_data();
+  rawData->resize(nbytes);
+  if (nbytes > 0) {
+    context->CopyBytesToCPU(
+        nbytes,
+        static_cast<const char*>(input.raw_data()) +
+            chunkBegin * input.itemsize(),
+        &(*rawData)[0]);
+    context->FinishDeviceComputation();
+  }
+}
+
 template <typename T, typename S = T>
 static void SerializeUsingBytesOrInt32(
     const Tensor& input,
@@ -287,6 +344,10 @@ void TensorSerializer::Serialize(
   // TODO: use CUDAGuard here instead of context and employ explicit sync
   // copy
   auto uniq_ptr = CreateContext(input.GetDevice());
+  if (EnableRawEncoding(data_type, input.itemsize())) {
+    SerializeAsRawData(input, chunkBegin, chunkSize, uniq_ptr.get(), proto);
+    return;
+  }
   // A lot of copypaste is error prone. Should we create a macro for this?
   switch (data_type) {
     case TensorProto_DataType_FLOAT:
@@ -573,6 +634,31 @@ void TensorDeserializer::DeserializeToTensor(
       tensor->numel());
   auto chunkSize = chunkEnd - chunkBegin;
 
+  if (tensor_proto.storage_type() == TensorProto_StorageType_RAW) {
+    // The raw data is copied as a whole into the tensor's storage.
+    const TypeMeta dtype = DataTypeToTypeMeta(tensor_proto.data_type());
+    CAFFE_ENFORCE(
+        dtype.copy() == nullptr,
+        "Raw data can only hold tensors of fundamental types, got ",
+        dtype.name());
+    CAFFE_ENFORCE(
+        kIsLittleEndian || dtype.itemsize() == 1,
+        "Serialization with raw data not supported on big endian platform.");
+    CAFFE_ENFORCE_EQ(
+        chunkSize * dtype.itemsize(),
+        tensor_proto.raw_data().size(),
+        "Incorrect proto field size.");
+    if (chunkSize > 0) {
+      context->CopyBytesFromCPU(
+          tensor_proto.raw_data().size(),
+          tensor_proto.raw_data().data(),
+          static_cast<char*>(tensor->raw_mutable_data(dtype)) +
+              chunkBegin * dtype.itemsize());
+    }
+    context->FinishDeviceComputation();
+    return;
+  }
+
   switch (tensor_proto.data_type()) {
     case TensorProto_DataType_FLOAT:
       detail::CopyFromProtoAsIs(
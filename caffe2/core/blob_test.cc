@@ -926,6 +926,70 @@ TYPED_TEST(TypedTensorTest, BigTensorSerialization) {
   }
 }
 
+TYPED_TEST(TypedTensorTest, RawDataSerialization) {
+  const int64_t d1 = 3;
+  const int64_t d2 = 1000;
+  const int chunk_size = 128;
+  string db_source = (string)std::tmpnam(nullptr);
+  FLAGS_caffe2_serialize_as_raw_data = true;
+
+  Blob blob;
+  Tensor* tensor = BlobGetMutableTensor(&blob, CPU);
+  tensor->Resize(d1, d2);
+  auto mutableData = tensor->mutable_data<TypeParam>();
+  for (int64_t i = 0; i < d1 * d2; ++i) {
+    mutableData[i] = static_cast<TypeParam>(i);
+  }
+  StringMap data;
+  std::mutex mutex;
+  auto acceptor = [&](const std::string& key, const std::string& value) {
+    std::lock_guard<std::mutex> guard(mutex);
+    data.emplace_back(key, value);
+  };
+  SerializeBlob(blob, "test", acceptor, chunk_size);
+  FLAGS_caffe2_serialize_as_raw_data = false;
+  EXPECT_EQ(data.size(), (d1 * d2 + chunk_size - 1) / chunk_size);
+  for (const auto& chunk : data) {
+    BlobProto proto;
+    CHECK(proto.ParseFromString(chunk.second));
+    const TensorProto& tensor_proto = proto.tensor();
+    EXPECT_EQ(tensor_proto.storage_type(), TensorProto_StorageType_RAW);
+    EXPECT_EQ(
+        tensor_proto.raw_data().size(),
+        (tensor_proto.segment().end() - tensor_proto.segment().begin()) *
+            sizeof(TypeParam));
+    EXPECT_EQ(tensor_proto.int32_data_size(), 0);
+  }
+  VectorDB::registerData(db_source, std::move(data));
+
+  // The chunks are loaded in parallel.
+  DeviceOption option;
+  option.set_device_type(PROTO_CPU);
+  Argument db_type_arg = MakeArgument<string>("db_type", "vector_db");
+  Argument absolute_path_arg = MakeArgument<bool>("absolute_path", true);
+  Argument db_source_arg = MakeArgument<string>("db", db_source);
+  auto op_def = CreateOperatorDef(
+      "Load",
+      "",
+      std::vector<string>{},
+      std::vector<string>({"test"}),
+      std::vector<Argument>{db_type_arg, db_source_arg, absolute_path_arg},
+      option,
+      "DUMMY_ENGINE");
+  Workspace ws;
+  auto load_op = CreateOperator(op_def, &ws);
+  EXPECT_TRUE(load_op != nullptr);
+  load_op->Run();
+  auto new_blob = ws.GetBlob("test");
+  EXPECT_TRUE(BlobIsTensorType(*new_blob, CPU));
+  const auto& new_tensor = new_blob->Get<TensorCPU>();
+  EXPECT_EQ(new_tensor.size(0), d1);
+  EXPECT_EQ(new_tensor.size(1), d2);
+  for (int64_t i = 0; i < d1 * d2; ++i) {
+    EXPECT_EQ(static_cast<TypeParam>(i), new_tensor.data<TypeParam>()[i]);
+  }
+}
+
 struct DummyType {
   /* This struct is used to test serialization and deserialization of huge
    * blobs, that are not tensors.
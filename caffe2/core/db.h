@@ -4,6 +4,7 @@
 #include <mutex>
 
 #include "c10/util/Registry.h"
+#include "c10/util/string_view.h"
 #include "caffe2/core/blob_serialization.h"
 #include "caffe2/proto/caffe2_pb.h"
 
@@ -46,11 +47,48 @@ class CAFFE2_API Cursor {
    * Returns the current value.
    */
   virtual string value() = 0;
+  /**
+   * Returns the current value without copying it, for dbs that keep their
+   * values in memory. The view is only valid until the cursor moves. In
+   * default, the value is copied into a buffer owned by the cursor.
+   */
+  virtual c10::string_view value_view() {
+    value_buffer_ = value();
+    return value_buffer_;
+  }
   /**
    * Returns whether the current location is valid - for example, if we have
    * reached the end of the database, return false.
    */
   virtual bool Valid() = 0;
+  /**
+   * Constant time access to the records by their position, in the order
+   * Next() visits them. This is optional for dbs, and in default,
+   * SupportsRandomAccess() returns false and the functions below throw.
+   */
+  virtual bool SupportsRandomAccess() { return false; }
+  /**
+   * Returns the number of records in the database.
+   */
+  virtual size_t NumRecords() {
+    CAFFE_THROW("This db does not support random access.");
+  }
+  /**
+   * Returns the position of the current record.
+   */
+  virtual size_t Position() {
+    CAFFE_THROW("This db does not support random access.");
+  }
+  /**
+   * Seek to the record at the given position. Seeking to NumRecords() makes
+   * the cursor invalid.
+   */
+  virtual void SeekToPosition(size_t /*position*/) {
+    CAFFE_THROW("This db does not support random access.");
+  }
+
+ private:
+  string value_buffer_;
 
   C10_DISABLE_COPY_AND_ASSIGN(Cursor);
 };
@@ -231,6 +269,11 @@ class CAFFE2_API DBReader {
     *key = cursor_->key();
     *value = cursor_->value();
 
+    if (cursor_->SupportsRandomAccess()) {
+      const size_t next = cursor_->Position() + 1;
+      cursor_->SeekToPosition(next < range_end_ ? next : range_begin_);
+      return;
+    }
     // In sharded mode, each read skips num_shards_ records
     for (uint32_t s = 0; s < num_shards_; s++) {
       cursor_->Next();
@@ -241,6 +284,39 @@ class CAFFE2_API DBReader {
     }
   }
 
+  /**
+   * Returns whether the db supports random access, see ReadAt().
+   */
+  bool SupportsRandomAccess() const {
+    CAFFE_ENFORCE(cursor_ != nullptr, "Reader not initialized.");
+    return cursor_->SupportsRandomAccess();
+  }
+
+  /**
+   * Returns the number of records in the shard of this reader. Only for dbs
+   * supporting random access.
+   */
+  size_t ShardSize() const {
+    CAFFE_ENFORCE(
+        SupportsRandomAccess(), "The db does not support random access.");
+    return range_end_ - range_begin_;
+  }
+
+  /**
+   * Reads the record at the given position within the shard of this reader,
+   * e.g. for random sampling, without moving the reader. Only for dbs
+   * supporting random access. Thread safe.
+   */
+  void ReadAt(size_t position, string* key, string* value) const {
+    CAFFE_ENFORCE_LT(position, ShardSize());
+    std::unique_lock<std::mutex> mutex_lock(reader_mutex_);
+    const size_t current = cursor_->Position();
+    cursor_->SeekToPosition(range_begin_ + position);
+    *key = cursor_->key();
+    *value = cursor_->value();
+    cursor_->SeekToPosition(current);
+  }
+
   /**
    * @brief Seeks to the first key. Thread safe.
    */
@@ -271,10 +347,28 @@ class CAFFE2_API DBReader {
     num_shards_ = num_shards;
     shard_id_ = shard_id;
     cursor_ = db_->NewCursor();
+    // Dbs with random access are sharded by contiguous ranges of records
+    // instead of by striding over them.
+    if (cursor_->SupportsRandomAccess()) {
+      const size_t num_records = cursor_->NumRecords();
+      range_begin_ = num_records * shard_id / num_shards;
+      range_end_ = num_records * (shard_id + 1) / num_shards;
+      // An empty db gives an empty range, and the cursor is just invalid.
+      CAFFE_ENFORCE(
+          num_records == 0 || range_begin_ < range_end_,
+          "Db has fewer rows than shards: ",
+          num_records,
+          " ",
+          num_shards);
+    }
     SeekToFirst();
   }
 
   void MoveToBeginning() const {
+    if (cursor_->SupportsRandomAccess()) {
+      cursor_->SeekToPosition(range_begin_);
+      return;
+    }
     cursor_->SeekToFirst();
     for (uint32_t s = 0; s < shard_id_; s++) {
       cursor_->Next();
@@ -290,6 +384,9 @@ class CAFFE2_API DBReader {
   mutable std::mutex reader_mutex_;
   uint32_t num_shards_{};
   uint32_t shard_id_{};
+  // the records of this shard, for dbs with random access
+  size_t range_begin_{};
+  size_t range_end_{};
 
   C10_DISABLE_COPY_AND_ASSIGN(DBReader);
 };
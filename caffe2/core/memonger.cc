@@ -1,8 +1,11 @@
 #include "caffe2/core/memonger.h"
 
+#include <algorithm>
 #include <set>
+#include <tuple>
 #include <unordered_set>
 
+#include "caffe2/core/types.h"
 #include "caffe2/utils/proto_utils.h"
 
 namespace caffe2 {
@@ -123,6 +126,208 @@ NetDef optimize_inference_net(
   return optim_net;
 }
 
+namespace {
+
+// Returns the bytes of a blob of the given shape, or -1 if unknown.
+int64_t blob_bytes(const TensorShape& shape) {
+  if (shape.unknown_shape() || shape.unknown_dims_size() > 0 ||
+      shape.data_type() == TensorProto::UNDEFINED) {
+    return -1;
+  }
+  int64_t numel = 1;
+  for (const auto dim : shape.dims()) {
+    if (dim < 0) {
+      return -1;
+    }
+    numel *= dim;
+  }
+  try {
+    return numel * DataTypeToTypeMeta(shape.data_type()).itemsize();
+  } catch (const std::runtime_error&) {
+    return -1;
+  }
+}
+
+// Sums up the bytes of the blobs the ops of the optimized net write, each
+// holding as many bytes as the largest blob of the original net it stands
+// for. The optimized net has the same ops as the original one.
+int64_t planned_bytes(
+    const NetDef& net,
+    const NetDef& optim_net,
+    const std::set<string>& static_blobs,
+    const std::unordered_map<std::string, int64_t>& sizes) {
+  CAFFE_ENFORCE_EQ(net.op_size(), optim_net.op_size());
+  std::unordered_map<std::string, int64_t> shared_sizes;
+  for (int i = 0; i < net.op_size(); i++) {
+    for (int j = 0; j < net.op(i).output_size(); j++) {
+      const auto& outp = net.op(i).output(j);
+      auto sit = sizes.find(outp);
+      if (static_blobs.count(outp) || sit == sizes.end()) {
+        continue;
+      }
+      auto& shared_size = shared_sizes[optim_net.op(i).output(j)];
+      shared_size = std::max(shared_size, sit->second);
+    }
+  }
+  int64_t total = 0;
+  for (const auto& shared_size : shared_sizes) {
+    total += shared_size.second;
+  }
+  return total;
+}
+
+} // namespace
+
+NetDef optimize_inference_net_size_aware(
+    const NetDef& net,
+    const std::set<string>& static_blobs,
+    const std::unordered_map<string, TensorShape>& blob_shapes,
+    MemoryPlanStats* stats) {
+  if (net.type() != "" && net.type() != "simple") {
+    LOG(INFO) << "Cannot optimize memory for nets of type: " << net.type();
+    return net;
+  }
+  for (auto& op : net.op()) {
+    if (op.type() == "RecurrentNetwork") {
+      LOG(INFO) << "Memonger does not support RecurrentNetwork yet";
+      return net;
+    }
+  }
+
+  // Step 1: find the live range of each blob, from the first op writing it
+  // to the last op reading or writing it, and its size
+  std::unordered_set<std::string> all_blobs;
+  std::unordered_map<std::string, std::pair<int, int>> ranges;
+  std::unordered_map<std::string, int64_t> sizes;
+  std::unordered_map<std::string, DeviceOption> devices;
+  for (int i = 0; i < net.op_size(); i++) {
+    const auto& op = net.op(i);
+    for (auto& inp : op.input()) {
+      all_blobs.insert(inp);
+      auto rit = ranges.find(inp);
+      if (rit != ranges.end()) {
+        rit->second.second = i;
+      }
+    }
+    for (auto& outp : op.output()) {
+      all_blobs.insert(outp);
+      if (static_blobs.find(outp) != static_blobs.end()) {
+        continue;
+      }
+      auto rit = ranges.find(outp);
+      if (rit != ranges.end()) {
+        rit->second.second = i;
+        continue;
+      }
+      ranges[outp] = std::make_pair(i, i);
+      devices[outp] =
+          op.has_device_option() ? op.device_option() : net.device_option();
+      auto sit = blob_shapes.find(outp);
+      if (sit != blob_shapes.end() && blob_bytes(sit->second) >= 0) {
+        sizes[outp] = blob_bytes(sit->second);
+      }
+    }
+  }
+
+  // Step 2: assign the blobs of known size to shared blobs, largest first.
+  // Each shared blob is as large as the first blob assigned to it, so a
+  // blob goes to the smallest shared blob it does not overlap with.
+  std::vector<std::string> blobs;
+  for (const auto& size : sizes) {
+    blobs.push_back(size.first);
+  }
+  std::sort(
+      blobs.begin(),
+      blobs.end(),
+      [&](const std::string& a, const std::string& b) {
+        return std::make_tuple(-sizes[a], ranges[a].first, a) <
+            std::make_tuple(-sizes[b], ranges[b].first, b);
+      });
+
+  struct SharedBlob {
+    int64_t size;
+    DeviceOption device;
+    std::vector<std::pair<int, int>> ranges;
+  };
+  std::vector<SharedBlob> shared_blobs;
+  std::unordered_map<std::string, int> mapping;
+  for (const auto& blob : blobs) {
+    const auto& range = ranges[blob];
+    const auto& device = devices[blob];
+    int best = -1;
+    for (int k = 0; k < (int)shared_blobs.size(); k++) {
+      const auto& shared_blob = shared_blobs[k];
+      if (!IsSameDevice(shared_blob.device, device) ||
+          (best >= 0 && shared_blobs[best].size <= shared_blob.size)) {
+        continue;
+      }
+      bool overlaps = false;
+      for (const auto& other : shared_blob.ranges) {
+        if (other.first <= range.second && range.first <= other.second) {
+          overlaps = true;
+          break;
+        }
+      }
+      if (!overlaps) {
+        best = k;
+      }
+    }
+    if (best < 0) {
+      best = shared_blobs.size();
+      shared_blobs.push_back(SharedBlob{sizes[blob], device, {}});
+    }
+    shared_blobs[best].ranges.push_back(range);
+    mapping[blob] = best;
+  }
+
+  std::vector<std::string> renaming;
+  for (size_t k = 0; k < shared_blobs.size(); k++) {
+    // Safety check to prevent double-memongering nets.
+    std::string shared_blob = "__m" + c10::to_string(k) + "_shared";
+    if (all_blobs.find(shared_blob) != all_blobs.end()) {
+      LOG(INFO) << "Net was already memongered!";
+      return net;
+    }
+    renaming.push_back(shared_blob);
+  }
+
+  // Step 3: rename inputs and outputs within the live ranges
+  NetDef optim_net = net;
+  for (int i = 0; i < optim_net.op_size(); i++) {
+    auto* op = optim_net.mutable_op(i);
+    for (int j = 0; j < op->input_size(); j++) {
+      auto mit = mapping.find(op->input(j));
+      if (mit != mapping.end() && ranges[op->input(j)].first <= i) {
+        op->set_input(j, renaming[mit->second]);
+      }
+    }
+    for (int j = 0; j < op->output_size(); j++) {
+      auto mit = mapping.find(op->output(j));
+      if (mit != mapping.end()) {
+        op->set_output(j, renaming[mit->second]);
+      }
+    }
+  }
+
+  MemoryPlanStats plan_stats;
+  for (const auto& size : sizes) {
+    plan_stats.unshared_bytes += size.second;
+  }
+  plan_stats.baseline_bytes = planned_bytes(
+      net, optimize_inference_net(net, static_blobs), static_blobs, sizes);
+  plan_stats.planned_bytes =
+      planned_bytes(net, optim_net, static_blobs, sizes);
+  LOG(INFO) << "Size-aware memonger shares " << mapping.size() << " of "
+            << ranges.size() << " blobs using " << shared_blobs.size()
+            << " shared blobs, planned " << plan_stats.planned_bytes
+            << " bytes, liveness-only " << plan_stats.baseline_bytes
+            << " bytes, unshared " << plan_stats.unshared_bytes << " bytes.";
+  if (stats) {
+    *stats = plan_stats;
+  }
+  return optim_net;
+}
+
 class ComputeBlobRecyclingForDag {
  public:
   explicit ComputeBlobRecyclingForDag(const int size)
@@ -1,6 +1,7 @@
 #ifndef CAFFE2_CORE_MEMONGER_H_
 #define CAFFE2_CORE_MEMONGER_H_
 
+#include <set>
 #include <unordered_set>
 
 #include "caffe2/core/common.h"
@@ -14,6 +15,29 @@ CAFFE2_API NetDef optimize_inference_net(
     const NetDef& net,
     const std::set<string>& static_blobs);
 
+// Bytes held by the blobs the ops of an inference net write, where shared
+// blobs hold as many bytes as the largest blob they stand for. Blobs of
+// unknown size are not counted.
+struct CAFFE2_API MemoryPlanStats {
+  // without sharing blobs
+  int64_t unshared_bytes = 0;
+  // sharing blobs by liveness only, as optimize_inference_net does
+  int64_t baseline_bytes = 0;
+  // sharing blobs by liveness and size
+  int64_t planned_bytes = 0;
+};
+
+// Like optimize_inference_net, but takes the shapes of the blobs into
+// account: blobs are assigned to shared blobs largest first, each going to
+// the smallest shared blob that is free during its whole live range, so
+// small blobs do not end up growing large ones. Blobs without a known shape
+// are not shared.
+CAFFE2_API NetDef optimize_inference_net_size_aware(
+    const NetDef& net,
+    const std::set<string>& static_blobs,
+    const std::unordered_map<string, TensorShape>& blob_shapes,
+    MemoryPlanStats* stats = nullptr);
+
 CAFFE2_API NetDef compute_blob_recycling_for_dag(
     const NetDef& net,
     const std::vector<string>& heads,
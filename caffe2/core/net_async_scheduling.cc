@@ -1,13 +1,28 @@
 #include "caffe2/core/net_async_scheduling.h"
 
+#include <algorithm>
+
 #include "caffe2/core/net_async_tracing.h"
+#include "caffe2/core/operator_schema.h"
 
 namespace caffe2 {
 
+namespace {
+// runs between updates of the priorities from measured op times
+constexpr int64_t kPriorityUpdateInterval = 100;
+} // namespace
+
 AsyncSchedulingNet::AsyncSchedulingNet(
     const std::shared_ptr<const NetDef>& net_def,
     Workspace* ws)
-    : AsyncNetBase(net_def, ws), running_(false) {}
+    : AsyncNetBase(net_def, ws),
+      op_costs_final_(false),
+      successful_runs_(0),
+      running_(false) {
+  if (options_.use_critical_path_scheduling_) {
+    updateTaskPriorities();
+  }
+}
 
 void AsyncSchedulingNet::reset() {
   AsyncNetBase::reset();
@@ -174,8 +189,132 @@ void AsyncSchedulingNet::schedule(int task_id, bool run_inline) noexcept {
     schedule_func();
   } else {
     const auto& device_option = event(task_id).GetDeviceOption();
-    pool(device_option)->run(schedule_func);
+    if (options_.use_critical_path_scheduling_) {
+      runByPriority(pool(device_option), task_id, schedule_func);
+    } else {
+      pool(device_option)->run(schedule_func);
+    }
+  }
+}
+
+void AsyncSchedulingNet::runByPriority(
+    TaskThreadPoolBase* pool,
+    int task_id,
+    std::function<void()> func) {
+  ReadyQueue* queue = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(ready_queues_mutex_);
+    auto& queue_ptr = ready_queues_[pool];
+    if (!queue_ptr) {
+      queue_ptr = std::make_unique<ReadyQueue>();
+    }
+    queue = queue_ptr.get();
+  }
+  {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    queue->tasks.push_back(
+        ReadyTask{task_priorities_[task_id], task_id, std::move(func)});
+    std::push_heap(queue->tasks.begin(), queue->tasks.end());
+  }
+  // the pool runs one function per queued task, each taking the task with
+  // the highest priority at the time the function runs
+  pool->run([queue]() {
+    std::function<void()> task_func;
+    {
+      std::lock_guard<std::mutex> lock(queue->mutex);
+      std::pop_heap(queue->tasks.begin(), queue->tasks.end());
+      task_func = std::move(queue->tasks.back().func);
+      queue->tasks.pop_back();
+    }
+    task_func();
+  });
+}
+
+void AsyncSchedulingNet::updateTaskPriorities() {
+  std::vector<float> op_costs;
+  if (options_.report_stats_) {
+    // measured op times are used once the prof_dag counters have them
+    op_costs = counters_.GetPerOperatorMeanTime();
+  }
+  if (op_costs.empty()) {
+    if (op_costs_final_) {
+      return;
+    }
+    // shapes of intermediate blobs are usually only known after a run, in
+    // which case the estimate is refined after the next run
+    op_costs_final_ = estimateOpCosts(&op_costs);
+  }
+  computeTaskPriorities(op_costs);
+}
+
+bool AsyncSchedulingNet::estimateOpCosts(std::vector<float>* op_costs) const {
+  bool all_shapes_known = true;
+  op_costs->clear();
+  op_costs->reserve(operators_.size());
+  for (const auto* op : operators_) {
+    // each op counts for one, so that ops without cost inference still add
+    // to the length of a path
+    float cost = 1.0;
+    const OpSchema* schema = op->has_debug_def()
+        ? OpSchemaRegistry::Schema(op->debug_def().type())
+        : nullptr;
+    if (schema && schema->HasCostInferenceFunction() &&
+        op->isLegacyOperator()) {
+      const auto shapes = op->InputTensorShapes();
+      const bool shapes_known = std::none_of(
+          shapes.begin(), shapes.end(), [](const TensorShape& shape) {
+            return shape.unknown_shape();
+          });
+      if (shapes_known) {
+        try {
+          cost += schema->InferCost(op->debug_def(), shapes).flops;
+        } catch (const std::exception& e) {
+          VLOG(1) << "Failed to infer the cost of " << op->type() << ": "
+                  << e.what();
+        }
+      } else {
+        all_shapes_known = false;
+      }
+    }
+    op_costs->push_back(cost);
+  }
+  return all_shapes_known;
+}
+
+void AsyncSchedulingNet::computeTaskPriorities(
+    const std::vector<float>& op_costs) {
+  CAFFE_ENFORCE_EQ(op_costs.size(), operators_.size());
+  const int tasks_num = tasksNum();
+  std::vector<float> priorities(tasks_num, 0.0);
+  // visit the tasks in reverse topological order, starting from the ones
+  // without children
+  std::vector<int> pending_children(tasks_num);
+  std::vector<int> ready;
+  for (int task_id = 0; task_id < tasks_num; ++task_id) {
+    pending_children[task_id] = children(task_id).size();
+    if (pending_children[task_id] == 0) {
+      ready.push_back(task_id);
+    }
+  }
+  while (!ready.empty()) {
+    const int task_id = ready.back();
+    ready.pop_back();
+    float longest_child_path = 0.0;
+    for (auto child_id : children(task_id)) {
+      longest_child_path = std::max(longest_child_path, priorities[child_id]);
+    }
+    float cost = 0.0;
+    for (auto op_id : chains_[task_id]) {
+      cost += op_costs[op_id];
+    }
+    priorities[task_id] = cost + longest_child_path;
+    for (auto parent_id : parents(task_id)) {
+      if (--pending_children[parent_id] == 0) {
+        ready.push_back(parent_id);
+      }
+    }
   }
+  task_priorities_ = std::move(priorities);
 }
 
 void AsyncSchedulingNet::parentCallback(int parent_id) {
@@ -218,6 +357,22 @@ void AsyncSchedulingNet::finishRun() {
   if (options_.report_stats_) {
     counters_.ReportRunEnd();
   }
+  // all tasks are done, so the priorities can be updated before the next
+  // run: once after the first run, which knows the shapes of intermediate
+  // blobs, and then every kPriorityUpdateInterval runs if op times are
+  // measured, so that most runs do not pay for it
+  if (options_.use_critical_path_scheduling_ && success_) {
+    ++successful_runs_;
+    if (successful_runs_ == 1 ||
+        (options_.report_stats_ &&
+         successful_runs_ % kPriorityUpdateInterval == 0)) {
+      try {
+        updateTaskPriorities();
+      } catch (const std::exception& e) {
+        LOG(ERROR) << "Failed to update task priorities: " << e.what();
+      }
+    }
+  }
   // notify observers and waiters
   StopAllObservers();
   running_ = false;
@@ -251,11 +406,21 @@ bool AsyncSchedulingNet::RunAsync() {
 
   // schedule() is not expected to throw, at this moment all the initial tasks
   // will be scheduled and the full graph of tasks will be executed
+  std::vector<int> root_tasks;
   for (auto task_id = 0; task_id < tasksNum(); ++task_id) {
     if (parents(task_id).empty()) {
-      schedule(task_id, options_.run_root_tasks_inline_);
+      root_tasks.push_back(task_id);
     }
   }
+  if (options_.use_critical_path_scheduling_) {
+    std::stable_sort(
+        root_tasks.begin(), root_tasks.end(), [this](int a, int b) {
+          return task_priorities_[a] > task_priorities_[b];
+        });
+  }
+  for (auto task_id : root_tasks) {
+    schedule(task_id, options_.run_root_tasks_inline_);
+  }
 
   if (tasksNum() == 0) {
     finishRun();
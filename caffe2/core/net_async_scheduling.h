@@ -16,6 +16,10 @@ class CAFFE2_API AsyncSchedulingNet : public AsyncNetBase {
 
   void Cancel();
 
+  const std::vector<float>& TEST_task_priorities() const {
+    return task_priorities_;
+  }
+
  protected:
   bool RunAsync() override;
 
@@ -28,6 +32,43 @@ class CAFFE2_API AsyncSchedulingNet : public AsyncNetBase {
 
   void CancelAndFinishAsyncTasks();
 
+  // Critical path scheduling: a task's priority is the cost of the longest
+  // path from its start to the end of the net. Ready tasks wait in a queue
+  // per pool and pool threads take the task with the highest priority.
+  struct ReadyTask {
+    float priority;
+    int task_id;
+    std::function<void()> func;
+
+    bool operator<(const ReadyTask& other) const {
+      // ties go to the task that comes first in the net
+      return priority < other.priority ||
+          (priority == other.priority && task_id > other.task_id);
+    }
+  };
+  struct ReadyQueue {
+    std::mutex mutex;
+    std::vector<ReadyTask> tasks; // max heap
+  };
+
+  void runByPriority(
+      TaskThreadPoolBase* pool,
+      int task_id,
+      std::function<void()> func);
+  void updateTaskPriorities();
+  bool estimateOpCosts(std::vector<float>* op_costs) const;
+  void computeTaskPriorities(const std::vector<float>& op_costs);
+
+  std::vector<float> task_priorities_;
+  // set once all input shapes were known when estimating op costs
+  bool op_costs_final_;
+  // successful runs with critical path scheduling, only accessed in
+  // finishRun under running_mutex_
+  int64_t successful_runs_;
+  std::mutex ready_queues_mutex_;
+  std::unordered_map<TaskThreadPoolBase*, std::unique_ptr<ReadyQueue>>
+      ready_queues_;
+
   std::mutex running_mutex_;
   std::condition_variable running_cv_;
   std::atomic<bool> running_;
@@ -45,10 +45,22 @@ class NetTestDummyOp final : public OperatorBase {
   const bool fail_;
 };
 
+// Stores the order in which it started in its output.
+class NetTestOrderOp final : public OperatorBase {
+ public:
+  using OperatorBase::OperatorBase;
+
+  bool Run(int /* unused */ /*stream_id*/) override {
+    *OperatorBase::Output<int>(0) = counter.fetch_add(1);
+    return true;
+  }
+};
+
 REGISTER_CPU_OPERATOR(NetTestDummy, NetTestDummyOp);
 REGISTER_CUDA_OPERATOR(NetTestDummy, NetTestDummyOp);
 REGISTER_CPU_OPERATOR(NetTestDummy2, NetTestDummyOp);
 REGISTER_CUDA_OPERATOR(NetTestDummy2, NetTestDummyOp);
+REGISTER_CPU_OPERATOR(NetTestOrder, NetTestOrderOp);
 
 OPERATOR_SCHEMA(NetTestDummy)
     .NumInputs(0, INT_MAX)
@@ -58,6 +70,7 @@ OPERATOR_SCHEMA(NetTestDummy2)
     .NumInputs(0, INT_MAX)
     .NumOutputs(0, INT_MAX)
     .AllowInplace({{1, 0}});
+OPERATOR_SCHEMA(NetTestOrder).NumInputs(0, INT_MAX).NumOutputs(1);
 
 unique_ptr<NetBase> CreateNetTestHelper(
     Workspace* ws,
@@ -697,6 +710,69 @@ TEST(NetTest, AsyncEmptyNet) {
   }
 }
 
+TEST(NetTest, CriticalPathScheduling) {
+  const auto spec = R"DOC(
+        name: "example"
+        type: "async_scheduling"
+        external_input: "in"
+        arg {
+          name: "critical_path_scheduling"
+          i: 1
+        }
+        op {
+          input: "in"
+          output: "short"
+          type: "NetTestOrder"
+        }
+        op {
+          input: "in"
+          output: "hidden1"
+          type: "NetTestOrder"
+        }
+        op {
+          input: "hidden1"
+          output: "hidden2"
+          type: "NetTestOrder"
+        }
+        op {
+          input: "hidden2"
+          output: "long"
+          type: "NetTestOrder"
+        }
+)DOC";
+
+  Workspace ws;
+  ws.CreateBlob("in");
+  NetDef net_def;
+  CAFFE_ENFORCE(TextFormat::ParseFromString(spec, &net_def));
+  net_def.set_num_workers(1);
+
+  std::unique_ptr<NetBase> net(CreateNet(net_def, &ws));
+  auto* async_net = dynamic_cast_if_rtti<AsyncSchedulingNet*>(net.get());
+  ASSERT_TRUE(async_net != nullptr);
+
+  // without cost inference every op costs one, the priority of a task is
+  // the number of ops from its start to the end of the net
+  const auto& priorities = async_net->TEST_task_priorities();
+  int task_id = 0;
+  for (const auto& chain : async_net->TEST_execution_chains()) {
+    const int first_op = chain.second.front();
+    const float expected = first_op == 0 ? 1.0 : 4.0 - first_op;
+    EXPECT_EQ(expected, priorities.at(task_id));
+    ++task_id;
+  }
+
+  // with one worker the root task of the longer chain starts first, also
+  // after the priorities were refreshed by the first run
+  for (int run = 0; run < 2; ++run) {
+    counter.exchange(0);
+    ASSERT_TRUE(net->Run());
+    ASSERT_EQ(4, counter.load());
+    EXPECT_LT(
+        ws.GetBlob("hidden1")->Get<int>(), ws.GetBlob("short")->Get<int>());
+  }
+}
+
 TEST(NetTest, DISABLED_RunAsyncFailure) {
   const auto spec = R"DOC(
         name: "example"
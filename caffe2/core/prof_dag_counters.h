@@ -105,6 +105,10 @@ class ProfDAGCounters {
   void AddPerOpAsyncEndTime(size_t op_id);
   ProfDAGReport GetReport() const;
 
+  // Mean execution time of each operator in ms, empty if there are no
+  // stats yet
+  std::vector<float> GetPerOperatorMeanTime() const;
+
  private:
   Timer timer_;
 
@@ -1,5 +1,8 @@
 #include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <iomanip>
+#include <iterator>
 #include <sstream>
 #include <thread>
 
@@ -89,6 +92,120 @@ TEST(DBSeekTest, LMDB) {
   DBSeekTestWrapper("lmdb");
 }
 
+TEST(DBSeekTest, IndexedMiniDB) {
+  DBSeekTestWrapper("indexed_minidb");
+}
+
+TEST(IndexedMiniDBTest, RandomAccess) {
+  std::string name = std::tmpnam(nullptr);
+  // Records are iterated in the order they are put, not in key order.
+  {
+    std::unique_ptr<DB> db(CreateDB("indexed_minidb", name, NEW));
+    std::unique_ptr<Transaction> trans(db->NewTransaction());
+    trans->Put("b", "value_b");
+    trans->Put("a", "value_a");
+  }
+  // Appending keeps the existing records.
+  {
+    std::unique_ptr<DB> db(CreateDB("indexed_minidb", name, WRITE));
+    std::unique_ptr<Transaction> trans(db->NewTransaction());
+    trans->Put("c", "");
+  }
+  std::unique_ptr<DB> db(CreateDB("indexed_minidb", name, READ));
+  std::unique_ptr<Cursor> cursor(db->NewCursor());
+  EXPECT_TRUE(cursor->SupportsRandomAccess());
+  EXPECT_EQ(cursor->NumRecords(), 3);
+  EXPECT_EQ(cursor->key(), "b");
+  EXPECT_EQ(cursor->value_view(), "value_b");
+  cursor->Next();
+  EXPECT_EQ(cursor->key(), "a");
+  EXPECT_EQ(cursor->Position(), 1);
+  cursor->SeekToPosition(2);
+  EXPECT_EQ(cursor->key(), "c");
+  EXPECT_EQ(cursor->value(), "");
+  cursor->Next();
+  EXPECT_FALSE(cursor->Valid());
+  cursor->Seek("a");
+  EXPECT_EQ(cursor->Position(), 1);
+  EXPECT_EQ(cursor->value(), "value_a");
+}
+
+TEST(IndexedMiniDBTest, RejectsCorruptedIndex) {
+  std::string name = std::tmpnam(nullptr);
+  {
+    std::unique_ptr<DB> db(CreateDB("indexed_minidb", name, NEW));
+    std::unique_ptr<Transaction> trans(db->NewTransaction());
+    trans->Put("a", "value_a");
+    trans->Put("b", "value_b");
+  }
+  std::string contents;
+  {
+    std::ifstream in(name, std::ios::binary);
+    contents.assign(
+        std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+  // the footer is {num_records, index_offset, magic}, and each index entry
+  // {offset, key_len, value_len}
+  const size_t footer = contents.size() - 3 * sizeof(uint64_t);
+  uint64_t index_offset;
+  memcpy(&index_offset, &contents[footer + sizeof(uint64_t)], sizeof(uint64_t));
+  auto check_corrupted = [&](size_t position, uint64_t value) {
+    std::string corrupted = contents;
+    memcpy(&corrupted[position], &value, sizeof(uint64_t));
+    {
+      std::ofstream out(name, std::ios::binary | std::ios::trunc);
+      out.write(corrupted.data(), corrupted.size());
+    }
+    EXPECT_THROW(CreateDB("indexed_minidb", name, READ), EnforceNotMet);
+    EXPECT_THROW(CreateDB("indexed_minidb", name, WRITE), EnforceNotMet);
+  };
+  // num_records * index entry size overflows back to the right size
+  check_corrupted(footer, (uint64_t(1) << 59) + 2);
+  // a value running into the index
+  check_corrupted(index_offset + 2 * sizeof(uint64_t), index_offset);
+  // a sorted position past the last record, only checked when reading
+  std::string corrupted = contents;
+  const uint64_t position = 2;
+  memcpy(
+      &corrupted[index_offset + 2 * 3 * sizeof(uint64_t)],
+      &position,
+      sizeof(uint64_t));
+  {
+    std::ofstream out(name, std::ios::binary | std::ios::trunc);
+    out.write(corrupted.data(), corrupted.size());
+  }
+  EXPECT_THROW(CreateDB("indexed_minidb", name, READ), EnforceNotMet);
+}
+
+TEST(IndexedMiniDBTest, CloseWithLiveTransaction) {
+  std::string name = std::tmpnam(nullptr);
+  std::unique_ptr<DB> db(CreateDB("indexed_minidb", name, NEW));
+  std::unique_ptr<Transaction> trans(db->NewTransaction());
+  trans->Put("a", "value_a");
+  // Closing does not wait for a transaction that has not committed.
+  db->Close();
+  trans->Put("b", "value_b");
+  trans->Commit();
+  // Once committed, the db can be closed while the transaction is alive.
+  db->Close();
+  trans.reset();
+  db.reset();
+
+  db = CreateDB("indexed_minidb", name, READ);
+  std::unique_ptr<Cursor> cursor(db->NewCursor());
+  EXPECT_EQ(cursor->NumRecords(), 2);
+  cursor->Seek("b");
+  EXPECT_EQ(cursor->value(), "value_b");
+}
+
+TEST(IndexedMiniDBTest, EmptyDb) {
+  std::string name = std::tmpnam(nullptr);
+  CreateDB("indexed_minidb", name, NEW).reset();
+  DBReader reader("indexed_minidb", name);
+  EXPECT_EQ(reader.ShardSize(), 0);
+  EXPECT_FALSE(reader.cursor()->Valid());
+}
+
 TEST(DBReaderTest, Reader) {
   std::string name = std::tmpnam(nullptr);
   CreateAndFill("leveldb", name);
@@ -200,5 +317,35 @@ TEST(DBReaderShardedTest, Reader) {
   EXPECT_EQ(value, "05");
 }
 
+TEST(DBReaderShardedTest, RandomAccessReader) {
+  std::string name = std::tmpnam(nullptr);
+  CreateAndFill("indexed_minidb", name);
+
+  // Dbs with random access are sharded by contiguous ranges of records.
+  std::unique_ptr<DBReader> reader0(
+      new DBReader("indexed_minidb", name, 3, 0));
+  EXPECT_EQ(reader0->ShardSize(), 3);
+  string key;
+  string value;
+  for (const char* expected : {"00", "01", "02", "00"}) {
+    reader0->Read(&key, &value);
+    EXPECT_EQ(key, expected);
+    EXPECT_EQ(value, expected);
+  }
+
+  std::unique_ptr<DBReader> reader2(
+      new DBReader("indexed_minidb", name, 3, 2));
+  EXPECT_EQ(reader2->ShardSize(), 4);
+  reader2->Read(&key, &value);
+  EXPECT_EQ(key, "06");
+  // Random reads within the shard do not move the reader.
+  reader2->ReadAt(3, &key, &value);
+  EXPECT_EQ(key, "09");
+  EXPECT_EQ(value, "09");
+  EXPECT_THROW(reader2->ReadAt(4, &key, &value), EnforceNotMet);
+  reader2->Read(&key, &value);
+  EXPECT_EQ(key, "07");
+}
+
 } // namespace db
 } // namespace caffe2
@@ -0,0 +1,463 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <numeric>
+#include <string>
+
+#include "caffe2/core/db.h"
+#include "caffe2/core/logging.h"
+
+namespace caffe2 {
+namespace db {
+
+// IndexedMiniDB stores its records like MiniDB, one after the other in the
+// order they are put, and appends an index of their offsets when the db is
+// closed. The file layout is
+//
+//   magic                                   8 bytes
+//   key and value bytes of each record      back to back, unpadded
+//   zero padding                            up to a multiple of 8 bytes
+//   {offset, key length, value length}      3 x uint64 per record
+//   positions of the records in key order   uint64 per record
+//   number of records, offset of the index  2 x uint64
+//   magic                                   8 bytes
+//
+// Readers map the file into memory, so a record is found in constant time
+// by its position and values can be read without copying them. Iteration
+// follows the order records were put in, while Seek() does a binary search
+// over the keys. As the index is only written on Close(), a db being
+// written cannot be read at the same time.
+//
+// A transaction holds the db from its creation, and from any Put() after a
+// commit, until Commit(), so only one transaction writes at a time. Close()
+// does not wait for a transaction that has not committed: it logs an error
+// and leaves the db open, and the index is written by a later Close() or the
+// destructor. Transactions must not outlive their db.
+
+namespace {
+
+constexpr char kMagic[8] = {'I', 'M', 'I', 'N', 'I', 'D', 'B', '1'};
+
+struct IndexEntry {
+  uint64_t offset;
+  uint64_t key_len;
+  uint64_t value_len;
+};
+
+struct Footer {
+  uint64_t num_records;
+  uint64_t index_offset;
+  char magic[8];
+};
+
+static_assert(sizeof(IndexEntry) == 24, "Unexpected IndexEntry padding.");
+static_assert(sizeof(Footer) == 24, "Unexpected Footer padding.");
+
+size_t AlignTo8(size_t size) {
+  return (size + 7) & ~static_cast<size_t>(7);
+}
+
+} // namespace
+
+class IndexedMiniDBCursor : public Cursor {
+ public:
+  IndexedMiniDBCursor(
+      const char* data,
+      const IndexEntry* index,
+      const uint64_t* sorted,
+      size_t num_records)
+      : data_(data),
+        index_(index),
+        sorted_(sorted),
+        num_records_(num_records),
+        position_(0) {}
+  ~IndexedMiniDBCursor() override {}
+
+  void Seek(const string& key) override {
+    // Finds the first record whose key is not less than the given key.
+    const uint64_t* found = std::lower_bound(
+        sorted_,
+        sorted_ + num_records_,
+        key,
+        [this](uint64_t position, const string& k) {
+          return key_view(position) < c10::string_view(k);
+        });
+    position_ = found == sorted_ + num_records_ ? num_records_ : *found;
+  }
+
+  bool SupportsSeek() override { return true; }
+
+  void SeekToFirst() override { position_ = 0; }
+
+  void Next() override {
+    if (position_ < num_records_) {
+      ++position_;
+    }
+  }
+
+  string key() override {
+    CAFFE_ENFORCE(Valid(), "Cursor is at invalid location!");
+    const c10::string_view k = key_view(position_);
+    return string(k.data(), k.size());
+  }
+
+  string value() override {
+    const c10::string_view v = value_view();
+    return string(v.data(), v.size());
+  }
+
+  c10::string_view value_view() override {
+    CAFFE_ENFORCE(Valid(), "Cursor is at invalid location!");
+    const IndexEntry& entry = index_[position_];
+    return c10::string_view(
+        data_ + entry.offset + entry.key_len, entry.value_len);
+  }
+
+  bool Valid() override { return position_ < num_records_; }
+
+  bool SupportsRandomAccess() override { return true; }
+
+  size_t NumRecords() override { return num_records_; }
+
+  size_t Position() override { return position_; }
+
+  void SeekToPosition(size_t position) override {
+    CAFFE_ENFORCE_LE(position, num_records_);
+    position_ = position;
+  }
+
+ private:
+  c10::string_view key_view(size_t position) const {
+    const IndexEntry& entry = index_[position];
+    return c10::string_view(data_ + entry.offset, entry.key_len);
+  }
+
+  const char* data_;
+  const IndexEntry* index_;
+  const uint64_t* sorted_;
+  size_t num_records_;
+  size_t position_;
+
+  C10_DISABLE_COPY_AND_ASSIGN(IndexedMiniDBCursor);
+};
+
+class IndexedMiniDBTransaction : public Transaction {
+ public:
+  IndexedMiniDBTransaction(
+      FILE* f,
+      std::mutex* mutex,
+      std::atomic<bool>* writing,
+      vector<IndexEntry>* index,
+      vector<string>* keys)
+      : file_(f),
+        lock_(*mutex, std::defer_lock),
+        writing_(writing),
+        index_(index),
+        keys_(keys) {
+    Acquire();
+  }
+  ~IndexedMiniDBTransaction() override {
+    if (lock_.owns_lock()) {
+      if (fflush(file_) != 0) {
+        LOG(ERROR) << "Cannot flush IndexedMiniDB records.";
+      }
+      *writing_ = false;
+    }
+  }
+
+  void Put(const string& key, const string& value) override {
+    if (!lock_.owns_lock()) {
+      Acquire();
+    }
+    const long offset = ftell(file_);
+    CAFFE_ENFORCE_GE(offset, 0);
+    CAFFE_ENFORCE_EQ(
+        fwrite(key.data(), sizeof(char), key.size(), file_), key.size());
+    CAFFE_ENFORCE_EQ(
+        fwrite(value.data(), sizeof(char), value.size(), file_), value.size());
+    index_->push_back(
+        {static_cast<uint64_t>(offset), key.size(), value.size()});
+    keys_->push_back(key);
+  }
+
+  // Records stay visible to readers only once the db is closed, so unlike
+  // MiniDB, the transaction can still be used after a commit. Committing
+  // releases the db, so that it can be closed, until the next Put().
+  void Commit() override {
+    if (lock_.owns_lock()) {
+      CAFFE_ENFORCE_EQ(fflush(file_), 0);
+      *writing_ = false;
+      lock_.unlock();
+    }
+  }
+
+ private:
+  void Acquire() {
+    lock_.lock();
+    *writing_ = true;
+  }
+
+  FILE* file_;
+  std::unique_lock<std::mutex> lock_;
+  std::atomic<bool>* writing_;
+  vector<IndexEntry>* index_;
+  vector<string>* keys_;
+
+  C10_DISABLE_COPY_AND_ASSIGN(IndexedMiniDBTransaction);
+};
+
+class IndexedMiniDB : public DB {
+ public:
+  IndexedMiniDB(const string& source, Mode mode)
+      : DB(source, mode), file_(nullptr), data_(nullptr), size_(0) {
+    switch (mode) {
+      case NEW:
+        file_ = fopen(source.c_str(), "wb");
+        CAFFE_ENFORCE(file_, "Cannot open file: " + source);
+        CAFFE_ENFORCE_EQ(fwrite(kMagic, sizeof(kMagic), 1, file_), 1);
+        break;
+      case WRITE:
+        file_ = fopen(source.c_str(), "r+b");
+        CAFFE_ENFORCE(file_, "Cannot open file: " + source);
+        LoadIndexForAppend();
+        break;
+      case READ:
+        MapForRead();
+        break;
+    }
+    VLOG(1) << "Opened IndexedMiniDB " << source;
+  }
+  ~IndexedMiniDB() override {
+    Close();
+    if (file_) {
+      LOG(ERROR) << "IndexedMiniDB " << source_
+                 << " is destroyed before its transaction, it has no index.";
+      fclose(file_);
+    }
+  }
+
+  void Close() override {
+    if (file_) {
+      // Waiting for the lock would deadlock if the transaction is on this
+      // thread.
+      if (writing_) {
+        LOG(ERROR) << "Cannot close IndexedMiniDB " << source_
+                   << " while a transaction has uncommitted records, commit"
+                   << " it first.";
+        return;
+      }
+      std::lock_guard<std::mutex> lock(file_access_mutex_);
+      WriteIndex();
+      fclose(file_);
+      file_ = nullptr;
+    }
+    if (data_) {
+      munmap(data_, size_);
+      data_ = nullptr;
+    }
+  }
+
+  unique_ptr<Cursor> NewCursor() override {
+    CAFFE_ENFORCE_EQ(this->mode_, READ);
+    CAFFE_ENFORCE(data_, "Db is closed: ", source_);
+    const char* data = static_cast<const char*>(data_);
+    return make_unique<IndexedMiniDBCursor>(
+        data,
+        reinterpret_cast<const IndexEntry*>(data + footer_.index_offset),
+        reinterpret_cast<const uint64_t*>(
+            data + footer_.index_offset +
+            footer_.num_records * sizeof(IndexEntry)),
+        footer_.num_records);
+  }
+
+  unique_ptr<Transaction> NewTransaction() override {
+    CAFFE_ENFORCE(this->mode_ == NEW || this->mode_ == WRITE);
+    return make_unique<IndexedMiniDBTransaction>(
+        file_, &file_access_mutex_, &writing_, &index_, &keys_);
+  }
+
+ private:
+  static void CheckFooter(const Footer& footer, size_t size) {
+    CAFFE_ENFORCE_EQ(
+        memcmp(footer.magic, kMagic, sizeof(kMagic)),
+        0,
+        "Not an IndexedMiniDB file, or it was not closed after writing.");
+    CAFFE_ENFORCE_EQ(footer.index_offset % 8, 0);
+    // size is at least sizeof(kMagic) + sizeof(Footer), checked by callers.
+    // Compared without multiplying num_records, which could overflow.
+    CAFFE_ENFORCE(
+        footer.index_offset >= sizeof(kMagic) &&
+            footer.index_offset <= size - sizeof(Footer),
+        "Corrupted IndexedMiniDB file.");
+    const uint64_t index_size = size - sizeof(Footer) - footer.index_offset;
+    constexpr uint64_t kRecordIndexSize = sizeof(IndexEntry) + sizeof(uint64_t);
+    CAFFE_ENFORCE(
+        index_size % kRecordIndexSize == 0 &&
+            footer.num_records == index_size / kRecordIndexSize,
+        "Corrupted IndexedMiniDB file.");
+  }
+
+  // Checks that every record lies between the magic and the index, and that
+  // the sorted positions, if given, are valid record positions.
+  static void CheckIndex(
+      const IndexEntry* index,
+      const uint64_t* sorted,
+      const Footer& footer) {
+    const uint64_t end = footer.index_offset;
+    for (uint64_t i = 0; i < footer.num_records; ++i) {
+      const IndexEntry& entry = index[i];
+      CAFFE_ENFORCE(
+          entry.offset >= sizeof(kMagic) && entry.offset <= end &&
+              entry.key_len <= end - entry.offset &&
+              entry.value_len <= end - entry.offset - entry.key_len,
+          "Corrupted IndexedMiniDB file: record ",
+          i,
+          " is out of bounds.");
+      if (sorted) {
+        CAFFE_ENFORCE_LT(
+            sorted[i], footer.num_records, "Corrupted IndexedMiniDB file.");
+      }
+    }
+  }
+
+  void MapForRead() {
+    const int fd = open(source_.c_str(), O_RDONLY);
+    CAFFE_ENFORCE_GE(fd, 0, "Cannot open file: " + source_);
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      close(fd);
+      CAFFE_THROW("Cannot stat file: " + source_);
+    }
+    size_ = st.st_size;
+    if (size_ < sizeof(kMagic) + sizeof(Footer)) {
+      close(fd);
+      CAFFE_THROW("Not an IndexedMiniDB file: " + source_);
+    }
+    data_ = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping stays valid after the file is closed.
+    close(fd);
+    CAFFE_ENFORCE(data_ != MAP_FAILED, "Cannot map file: " + source_);
+    memcpy(
+        &footer_,
+        static_cast<const char*>(data_) + size_ - sizeof(Footer),
+        sizeof(Footer));
+    try {
+      CheckFooter(footer_, size_);
+      const char* data = static_cast<const char*>(data_);
+      CheckIndex(
+          reinterpret_cast<const IndexEntry*>(data + footer_.index_offset),
+          reinterpret_cast<const uint64_t*>(
+              data + footer_.index_offset +
+              footer_.num_records * sizeof(IndexEntry)),
+          footer_);
+    } catch (...) {
+      // The destructor does not run when the constructor throws.
+      munmap(data_, size_);
+      data_ = nullptr;
+      throw;
+    }
+  }
+
+  void LoadIndexForAppend() {
+    CAFFE_ENFORCE_EQ(fseek(file_, 0, SEEK_END), 0);
+    const long size = ftell(file_);
+    CAFFE_ENFORCE_GE(
+        size,
+        static_cast<long>(sizeof(kMagic) + sizeof(Footer)),
+        "Not an IndexedMiniDB file: " + source_);
+    CAFFE_ENFORCE_EQ(
+        fseek(file_, -static_cast<long>(sizeof(Footer)), SEEK_END), 0);
+    CAFFE_ENFORCE_EQ(fread(&footer_, sizeof(Footer), 1, file_), 1);
+    CheckFooter(footer_, size);
+
+    index_.resize(footer_.num_records);
+    CAFFE_ENFORCE_EQ(fseek(file_, footer_.index_offset, SEEK_SET), 0);
+    CAFFE_ENFORCE_EQ(
+        fread(index_.data(), sizeof(IndexEntry), index_.size(), file_),
+        index_.size());
+    CheckIndex(index_.data(), nullptr, footer_);
+    keys_.reserve(index_.size());
+    for (const auto& entry : index_) {
+      string key(entry.key_len, '\0');
+      CAFFE_ENFORCE_EQ(fseek(file_, entry.offset, SEEK_SET), 0);
+      CAFFE_ENFORCE_EQ(
+          fread(&key[0], sizeof(char), entry.key_len, file_), entry.key_len);
+      keys_.push_back(std::move(key));
+    }
+    // New records overwrite the old index, which is written again on Close().
+    CAFFE_ENFORCE_EQ(fseek(file_, footer_.index_offset, SEEK_SET), 0);
+  }
+
+  // Appends the index and the footer. Failures are logged rather than
+  // thrown, as this runs from the destructor; the file is then left without
+  // a valid footer, which readers reject. Must be called with
+  // file_access_mutex_ held.
+  void WriteIndex() {
+    auto fail = [this](const char* what) {
+      LOG(ERROR) << "Cannot write the index of IndexedMiniDB " << source_
+                 << ": " << what << " failed.";
+    };
+    const long end = ftell(file_);
+    if (end < 0) {
+      return fail("ftell");
+    }
+    const uint64_t index_offset = AlignTo8(end);
+    const char padding[8] = {};
+    if (fwrite(padding, sizeof(char), index_offset - end, file_) !=
+            index_offset - end ||
+        fwrite(index_.data(), sizeof(IndexEntry), index_.size(), file_) !=
+            index_.size()) {
+      return fail("writing the records index");
+    }
+
+    vector<uint64_t> sorted(index_.size());
+    std::iota(sorted.begin(), sorted.end(), 0);
+    std::stable_sort(
+        sorted.begin(), sorted.end(), [this](uint64_t a, uint64_t b) {
+          return keys_[a] < keys_[b];
+        });
+    if (fwrite(sorted.data(), sizeof(uint64_t), sorted.size(), file_) !=
+        sorted.size()) {
+      return fail("writing the key order");
+    }
+
+    Footer footer;
+    footer.num_records = index_.size();
+    footer.index_offset = index_offset;
+    memcpy(footer.magic, kMagic, sizeof(kMagic));
+    if (fwrite(&footer, sizeof(Footer), 1, file_) != 1 || fflush(file_) != 0) {
+      return fail("writing the footer");
+    }
+    // Drops what is left of an index that was overwritten when appending.
+    if (ftruncate(fileno(file_), ftell(file_)) != 0) {
+      return fail("truncating the file");
+    }
+  }
+
+  FILE* file_;
+  // the mapped file, in READ mode
+  void* data_;
+  size_t size_;
+  Footer footer_;
+  // the index of the records written so far, in NEW and WRITE mode
+  vector<IndexEntry> index_;
+  vector<string> keys_;
+  // access mutex makes sure we don't have multiple transactions writing the
+  // same file, held by a transaction until it commits.
+  std::mutex file_access_mutex_;
+  // whether a transaction holds file_access_mutex_
+  std::atomic<bool> writing_{false};
+};
+
+REGISTER_CAFFE2_DB(IndexedMiniDB, IndexedMiniDB);
+REGISTER_CAFFE2_DB(indexed_minidb, IndexedMiniDB);
+
+} // namespace db
+} // namespace caffe2
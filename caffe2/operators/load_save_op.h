@@ -212,7 +212,8 @@ class LoadOp final : public Operator<Context> {
       std::unordered_map<string, load_save_op_util::BlobState>* blob_states,
       int* total_loaded_blobs) {
     CAFFE_ENFORCE(cursor, "cursor is not valid");
-    int loaded_blobs = 0;
+    load_save_op_util::BlobLoader loader(
+        blob_states, prepareProto(), numLoaderThreads());
     for (; cursor->Valid(); cursor->Next()) {
       const auto key = load_save_op_util::buildBlobNameFromDbKey(
           cursor->key(), strip_prefix_, add_prefix_);
@@ -222,19 +223,11 @@ class LoadOp final : public Operator<Context> {
         key_to_dbid_[key] = db_id;
       }
 
-      BlobProto proto;
-      CAFFE_ENFORCE(
-          proto.ParseFromString(cursor->value()), "Couldn't parse Proto");
-      if (!keep_device_) {
-        // If we are not keeping the device as the one specified in the
-        // proto, we will set the current device.
-        SetCurrentDevice(&proto);
-      }
       Blob* blob = ws_->CreateBlob(key);
-      load_save_op_util::ProcessBlob(
-          blob, proto, blob_states, key, &loaded_blobs);
+      loader.Load(blob, key, cursor->value());
     }
-    *total_loaded_blobs += loaded_blobs;
+    loader.Wait();
+    *total_loaded_blobs += loader.loaded_blobs();
   }
 
   void extractFrom(
@@ -244,7 +237,8 @@ class LoadOp final : public Operator<Context> {
       std::unordered_map<string, load_save_op_util::BlobState>* blob_states,
       int* total_loaded_blobs) {
     CAFFE_ENFORCE(cursor);
-    int loaded_blobs = 0;
+    load_save_op_util::BlobLoader loader(
+        blob_states, prepareProto(), numLoaderThreads());
     for (; cursor->Valid(); cursor->Next()) {
       const auto key = load_save_op_util::buildBlobNameFromDbKey(
           cursor->key(), strip_prefix_, add_prefix_);
@@ -258,25 +252,38 @@ class LoadOp final : public Operator<Context> {
         }
 
         VLOG(2) << "Deserializing blob " << key;
-        BlobProto proto;
-        CAFFE_ENFORCE(proto.ParseFromString(cursor->value()));
-        if (!keep_device_) {
-          // If we are not keeping the device as the one specified in the
-          // proto, we will set the current device.
-          SetCurrentDevice(&proto);
-        }
         auto blobIndex = output_indices_[key];
         Blob* blob = outputs.at(blobIndex);
-        load_save_op_util::ProcessBlob(
-            blob, proto, blob_states, key, &loaded_blobs);
+        loader.Load(blob, key, cursor->value());
 
-        if (*total_loaded_blobs + loaded_blobs == OutputSize()) {
+        // Blobs may still be loading in the background, in which case a few
+        // more records are read before this stops.
+        if (*total_loaded_blobs + loader.loaded_blobs() == OutputSize()) {
           break;
         }
       }
     }
 
-    *total_loaded_blobs += loaded_blobs;
+    loader.Wait();
+    *total_loaded_blobs += loader.loaded_blobs();
+  }
+
+  int numLoaderThreads() const {
+    // SetCurrentDevice() uses the current device of the calling thread, so
+    // only CPU blobs are loaded on other threads.
+    return std::is_same<Context, CPUContext>::value
+        ? FLAGS_caffe2_max_tensor_deserializer_threads
+        : 1;
+  }
+
+  // Returns the function that sets the device of the protos to be loaded.
+  std::function<void(BlobProto*)> prepareProto() {
+    if (keep_device_) {
+      return nullptr;
+    }
+    // If we are not keeping the device as the one specified in the
+    // proto, we will set the current device.
+    return [this](BlobProto* proto) { SetCurrentDevice(proto); };
   }
 
  private:
@@ -18,22 +18,15 @@ std::string buildBlobNameFromDbKey(
   return key;
 }
 
-void ProcessBlob(
-    Blob* blob,
+namespace {
+
+// Checks and updates the state of a blob after one of its parts was read.
+void UpdateBlobState(
     const BlobProto& proto,
     std::unordered_map<std::string, BlobState>* blob_states_ptr,
     const std::string& key,
     int* loaded_blobs) {
   auto& blob_states = *blob_states_ptr;
-  if (blob_states.count(key) == 0) {
-    // We reset the blob so that any existing content is destroyed. This
-    // is to guarantee correct device placement: if we are deserializing
-    // into a TensorCUDA, without explicit Reset we might be loading data
-    // into an existing TensorCUDA that has pre-allocated memory on a
-    // different GPU.
-    blob->Reset();
-  }
-  DeserializeBlob(proto, blob);
   if (proto.has_content_num_chunks()) {
     if (!blob_states.count(key)) {
       blob_states[key] = BlobState(proto.content_num_chunks());
@@ -109,6 +102,156 @@ void ProcessBlob(
   }
 }
 
+} // namespace
+
+void ProcessBlob(
+    Blob* blob,
+    const BlobProto& proto,
+    std::unordered_map<std::string, BlobState>* blob_states_ptr,
+    const std::string& key,
+    int* loaded_blobs) {
+  if (blob_states_ptr->count(key) == 0) {
+    // We reset the blob so that any existing content is destroyed. This
+    // is to guarantee correct device placement: if we are deserializing
+    // into a TensorCUDA, without explicit Reset we might be loading data
+    // into an existing TensorCUDA that has pre-allocated memory on a
+    // different GPU.
+    blob->Reset();
+  }
+  DeserializeBlob(proto, blob);
+  UpdateBlobState(proto, blob_states_ptr, key, loaded_blobs);
+}
+
+BlobLoader::BlobLoader(
+    std::unordered_map<std::string, BlobState>* blob_states,
+    std::function<void(BlobProto*)> prepare_proto,
+    int num_threads)
+    : blob_states_(blob_states),
+      prepare_proto_(std::move(prepare_proto)),
+      num_threads_(num_threads) {}
+
+BlobLoader::~BlobLoader() {
+  {
+    std::lock_guard<std::mutex> guard(queue_mutex_);
+    // Blobs not loaded yet are dropped, e.g. after an error.
+    pending_ -= queue_.size();
+    queue_.clear();
+    stop_ = true;
+  }
+  queue_cv_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void BlobLoader::Load(
+    Blob* blob,
+    const std::string& key,
+    std::string serialized) {
+  Task task{blob, key, std::move(serialized)};
+  if (num_threads_ <= 1) {
+    LoadBlob(task);
+    return;
+  }
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  if (error_) {
+    // Wait() rethrows the error.
+    return;
+  }
+  if (threads_.size() < static_cast<size_t>(num_threads_)) {
+    threads_.emplace_back([this]() { Run(); });
+  }
+  // Bounds the memory held by serialized blobs waiting to be loaded.
+  queue_cv_.wait(lock, [this]() {
+    return queue_.size() < 2 * static_cast<size_t>(num_threads_);
+  });
+  queue_.push_back(std::move(task));
+  ++pending_;
+  lock.unlock();
+  queue_cv_.notify_all();
+}
+
+void BlobLoader::Wait() {
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  queue_cv_.wait(lock, [this]() { return pending_ == 0; });
+  if (error_) {
+    std::exception_ptr error = error_;
+    error_ = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+int BlobLoader::loaded_blobs() {
+  std::lock_guard<std::mutex> guard(state_mutex_);
+  return loaded_blobs_;
+}
+
+void BlobLoader::Run() {
+  while (true) {
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      queue_cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return;
+      }
+      task = std::move(queue_.front());
+      queue_.pop_front();
+      if (error_) {
+        --pending_;
+        continue;
+      }
+    }
+    queue_cv_.notify_all();
+    std::exception_ptr error;
+    try {
+      LoadBlob(task);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    {
+      std::lock_guard<std::mutex> guard(queue_mutex_);
+      if (error && !error_) {
+        error_ = error;
+      }
+      --pending_;
+    }
+    queue_cv_.notify_all();
+  }
+}
+
+void BlobLoader::LoadBlob(const Task& task) {
+  BlobProto proto;
+  CAFFE_ENFORCE(
+      proto.ParseFromString(task.serialized), "Couldn't parse Proto");
+  if (prepare_proto_) {
+    prepare_proto_(&proto);
+  }
+  if (proto.type() != kTensorBlobType || proto.has_content_num_chunks()) {
+    std::lock_guard<std::mutex> guard(state_mutex_);
+    ProcessBlob(task.blob, proto, blob_states_, task.key, &loaded_blobs_);
+    return;
+  }
+
+  // Tensors are allocated on their first part, and each part then fills in
+  // its own segment of the tensor, without holding the lock.
+  Tensor tensor;
+  {
+    std::lock_guard<std::mutex> guard(state_mutex_);
+    const bool first = blob_states_->count(task.key) == 0;
+    UpdateBlobState(proto, blob_states_, task.key, &loaded_blobs_);
+    if (first) {
+      // See ProcessBlob() for why the blob is reset.
+      task.blob->Reset();
+      BlobSetTensor(task.blob, EmptyTensorFromProto(proto.tensor()));
+    }
+    tensor = task.blob->Get<Tensor>().UnsafeSharedInstance();
+  }
+  if (tensor.numel() > 0) {
+    TensorDeserializer().DeserializeToTensor(proto.tensor(), &tensor);
+  }
+}
+
 void validateBlobStates(
     const std::unordered_map<std::string, BlobState>& blob_states) {
   for (const auto& iter : blob_states) {
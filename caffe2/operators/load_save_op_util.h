@@ -1,9 +1,16 @@
 #ifndef CAFFE2_OPERATORS_LOAD_SAVE_OP_UTIL_H_
 #define CAFFE2_OPERATORS_LOAD_SAVE_OP_UTIL_H_
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
 #include <set>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "caffe2/core/blob.h"
 #include "caffe2/core/blob_serialization.h"
@@ -40,6 +47,59 @@ CAFFE2_API void ProcessBlob(
     const std::string& key,
     int* loaded_blobs);
 
+/**
+ * Loads blobs from their serialized form on a pool of threads, so that the
+ * protos of different blobs, and of the chunks of a big tensor, are parsed
+ * and copied in parallel. Book keeping of the blob states and allocation of
+ * the tensors are serialized, after which each chunk is copied straight
+ * into its segment of the tensor. With a single thread, blobs are loaded
+ * synchronously by Load().
+ */
+class CAFFE2_API BlobLoader {
+ public:
+  // prepare_proto, if given, is called on each proto before it is loaded.
+  BlobLoader(
+      std::unordered_map<std::string, BlobState>* blob_states,
+      std::function<void(BlobProto*)> prepare_proto,
+      int num_threads);
+  ~BlobLoader();
+
+  void Load(Blob* blob, const std::string& key, std::string serialized);
+
+  // Waits for the blobs passed to Load() so far, and rethrows the first
+  // error they raised.
+  void Wait();
+
+  // The number of blobs fully loaded so far.
+  int loaded_blobs();
+
+ private:
+  struct Task {
+    Blob* blob;
+    std::string key;
+    std::string serialized;
+  };
+
+  void Run();
+  void LoadBlob(const Task& task);
+
+  std::unordered_map<std::string, BlobState>* blob_states_;
+  std::function<void(BlobProto*)> prepare_proto_;
+  const int num_threads_;
+  std::vector<std::thread> threads_;
+
+  std::mutex queue_mutex_;
+  std::condition_variable queue_cv_;
+  std::deque<Task> queue_;
+  int pending_ = 0;
+  bool stop_ = false;
+  std::exception_ptr error_;
+
+  // guards blob_states_ and loaded_blobs_
+  std::mutex state_mutex_;
+  int loaded_blobs_ = 0;
+};
+
 CAFFE2_API void validateBlobStates(
     const std::unordered_map<std::string, BlobState>& blob_states);
 
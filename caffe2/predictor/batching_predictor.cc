@@ -0,0 +1,325 @@
+#include "caffe2/predictor/batching_predictor.h"
+
+#include <unordered_set>
+
+#include "caffe2/core/context.h"
+
+namespace caffe2 {
+
+namespace {
+
+// Returns whether two requests can run in the same batch.
+bool batchable(
+    const BatchingPredictor::TensorList& a,
+    const BatchingPredictor::TensorList& b) {
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (a[i].dtype() != b[i].dtype() ||
+        a[i].sizes().slice(1) != b[i].sizes().slice(1)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns a view of `rows` rows of a tensor, starting at `begin`.
+Tensor narrowRows(const Tensor& tensor, int64_t begin, int64_t rows) {
+  Tensor view = tensor.Alias();
+  std::vector<int64_t> sizes = tensor.sizes().vec();
+  sizes[0] = rows;
+  auto* impl = view.unsafeGetTensorImpl();
+  impl->set_storage_offset(
+      impl->storage_offset() + begin * tensor.size_from_dim(1));
+  impl->set_sizes_contiguous(sizes);
+  return view;
+}
+
+} // namespace
+
+BatchingPredictor::BatchingPredictor(PredictorConfig config, Options options)
+    : config_(std::move(config)), options_(options) {
+  CAFFE_ENFORCE_GT(options_.max_batch_size, 0);
+  CAFFE_ENFORCE_GT(options_.num_workers, 0);
+  const NetDef& net = *config_.predict_net;
+
+  input_names_ = config_.input_names;
+  if (input_names_.empty()) {
+    // Without input names, the inputs are the external inputs that were not
+    // initialized by the init net.
+    for (const auto& name : net.external_input()) {
+      if (!config_.ws->HasBlob(name)) {
+        input_names_.push_back(name);
+      }
+    }
+  }
+  CAFFE_ENFORCE(!input_names_.empty(), "The predict net has no inputs.");
+  output_names_ = config_.output_names;
+  if (output_names_.empty()) {
+    output_names_.assign(
+        net.external_output().begin(), net.external_output().end());
+  }
+
+  for (int i = 0; i < options_.num_workers; ++i) {
+    auto worker = make_unique<Worker>();
+    worker->ws = make_unique<Workspace>(config_.ws.get());
+    // The blobs the net writes are local to each worker, even where the
+    // shared workspace has blobs of the same names.
+    for (const auto& name : input_names_) {
+      BlobGetMutableTensor(worker->ws->CreateLocalBlob(name), CPU);
+      worker->buffers.emplace_back(CPU);
+    }
+    std::unordered_set<std::string> local_blobs(
+        input_names_.begin(), input_names_.end());
+    for (const auto& op : net.op()) {
+      for (const auto& output : op.output()) {
+        if (!local_blobs.insert(output).second) {
+          continue;
+        }
+        Blob* blob = worker->ws->CreateLocalBlob(output);
+        if (!config_.ws->HasBlob(output)) {
+          continue;
+        }
+        // Ops that update a blob of the shared workspace in place, like
+        // state kept across runs, get a private copy of it.
+        const Blob* shared = config_.ws->GetBlob(output);
+        CAFFE_ENFORCE(
+            BlobIsTensorType(*shared, CPU),
+            "The predict net writes ",
+            output,
+            ", a blob of the shared workspace that is not a CPU tensor ",
+            "and can not be made local to the workers.");
+        const auto& tensor = shared->Get<TensorCPU>();
+        if (tensor.dtype_initialized()) {
+          BlobGetMutableTensor(blob, CPU)->CopyFrom(tensor);
+        }
+        worker->state_blobs.insert(output);
+      }
+    }
+    CAFFE_ENFORCE(worker->ws->CreateNet(config_.predict_net));
+    workers_.push_back(std::move(worker));
+  }
+  for (auto& worker : workers_) {
+    Worker* w = worker.get();
+    worker->thread = std::thread([this, w]() { run(w); });
+  }
+}
+
+BatchingPredictor::~BatchingPredictor() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stop_ = true;
+  }
+  queue_cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker->thread.join();
+  }
+}
+
+bool BatchingPredictor::operator()(
+    const TensorList& inputs,
+    TensorList* outputs) {
+  CAFFE_ENFORCE_EQ(inputs.size(), input_names_.size());
+  for (const auto& input : inputs) {
+    CAFFE_ENFORCE_GE(input.dim(), 1, "Inputs need a batch dimension.");
+    CAFFE_ENFORCE_EQ(
+        input.size(0),
+        inputs[0].size(0),
+        "The inputs of a request need the same size in dim 0.");
+  }
+
+  Request request;
+  request.inputs = &inputs;
+  request.outputs = outputs;
+  request.rows = inputs[0].size(0);
+  request.deadline = std::chrono::steady_clock::now() + options_.max_wait;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  CAFFE_ENFORCE(!stop_, "The predictor is stopped.");
+  queue_.push_back(&request);
+  queued_rows_ += request.rows;
+  queue_cv_.notify_all();
+  done_cv_.wait(lock, [&request]() { return request.done; });
+  if (request.error) {
+    std::rethrow_exception(request.error);
+  }
+  return request.success;
+}
+
+void BatchingPredictor::run(Worker* worker) {
+  while (true) {
+    std::vector<Request*> batch;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      batch = takeBatch(lock);
+    }
+    if (batch.empty()) {
+      return;
+    }
+
+    bool success = false;
+    std::exception_ptr error;
+    try {
+      success = runBatch(worker, batch);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      for (Request* request : batch) {
+        request->success = success;
+        request->error = error;
+        request->done = true;
+      }
+    }
+    done_cv_.notify_all();
+  }
+}
+
+std::vector<BatchingPredictor::Request*> BatchingPredictor::takeBatch(
+    std::unique_lock<std::mutex>& lock) {
+  while (true) {
+    queue_cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      return {};
+    }
+    // Waits for the batch to fill up, or for its oldest request to time out.
+    // Other workers may take the requests in the meantime.
+    const auto deadline = queue_.front()->deadline;
+    queue_cv_.wait_until(lock, deadline, [this]() {
+      return stop_ || queued_rows_ >= options_.max_batch_size;
+    });
+    if (queue_.empty()) {
+      continue;
+    }
+
+    std::vector<Request*> batch;
+    int64_t rows = 0;
+    while (!queue_.empty()) {
+      Request* request = queue_.front();
+      if (!batch.empty() &&
+          (rows + request->rows > options_.max_batch_size ||
+           !batchable(*batch[0]->inputs, *request->inputs))) {
+        break;
+      }
+      batch.push_back(request);
+      rows += request->rows;
+      queued_rows_ -= request->rows;
+      queue_.pop_front();
+    }
+    if (!queue_.empty()) {
+      queue_cv_.notify_one();
+    }
+    return batch;
+  }
+}
+
+bool BatchingPredictor::runBatch(
+    Worker* worker,
+    const std::vector<Request*>& batch) {
+  Workspace* ws = worker->ws.get();
+  int64_t rows = 0;
+  for (const Request* request : batch) {
+    rows += request->rows;
+  }
+
+  CPUContext context;
+  for (size_t i = 0; i < input_names_.size(); ++i) {
+    Blob* blob = ws->GetBlob(input_names_[i]);
+    const Tensor& first = (*batch[0]->inputs)[i];
+    if (batch.size() == 1) {
+      // This is evil and shares the same underlying tensor
+      BlobSetTensor(blob, first.UnsafeSharedInstance());
+      continue;
+    }
+    Tensor& buffer = worker->buffers[i];
+    std::vector<int64_t> sizes = first.sizes().vec();
+    sizes[0] = rows;
+    buffer.Resize(sizes);
+    char* dst = static_cast<char*>(buffer.raw_mutable_data(first.dtype()));
+    for (const Request* request : batch) {
+      const Tensor& input = (*request->inputs)[i];
+      if (input.numel() > 0) {
+        context.CopyItemsSameDevice(
+            input.dtype(), input.numel(), input.raw_data(), dst);
+        dst += input.nbytes();
+      }
+    }
+    BlobSetTensor(blob, buffer.UnsafeSharedInstance());
+  }
+
+  if (!ws->RunNet(config_.predict_net->name())) {
+    return false;
+  }
+
+  TensorList outputs;
+  for (const auto& name : output_names_) {
+    Blob* blob = ws->GetBlob(name);
+    CAFFE_ENFORCE(blob, "Blob does not exist: ", name);
+    CAFFE_ENFORCE(
+        BlobIsTensorType(*blob, CPU), "Blob is not a CPU Tensor: ", name);
+    outputs.push_back(blob->Get<Tensor>().UnsafeSharedInstance());
+  }
+  // The requests keep the outputs, so the next batch must not write into
+  // their memory. Blobs sharing it, the outputs themselves and e.g. the
+  // intermediates they are views of, are reset to get new memory. Outputs
+  // sharing memory with state kept across batches are copied instead.
+  std::vector<std::pair<Blob*, Tensor>> local_tensors;
+  for (const auto& local : ws->LocalBlobs()) {
+    Blob* blob = ws->GetBlob(local);
+    if (BlobIsTensorType(*blob, CPU) &&
+        blob->Get<Tensor>().storage_initialized() &&
+        !worker->state_blobs.count(local)) {
+      local_tensors.emplace_back(
+          blob, blob->Get<Tensor>().UnsafeSharedInstance());
+    }
+  }
+  for (auto& output : outputs) {
+    if (!output.storage_initialized()) {
+      continue;
+    }
+    for (const auto& name : worker->state_blobs) {
+      const Blob* blob = ws->GetBlob(name);
+      if (BlobIsTensorType(*blob, CPU) &&
+          blob->Get<Tensor>().storage_initialized() &&
+          output.storage().is_alias_of(blob->Get<Tensor>().storage())) {
+        output = output.Clone();
+        break;
+      }
+    }
+    for (const auto& local : local_tensors) {
+      if (output.storage().is_alias_of(local.second.storage())) {
+        local.first->Reset();
+      }
+    }
+    for (auto& buffer : worker->buffers) {
+      if (buffer.storage_initialized() &&
+          output.storage().is_alias_of(buffer.storage())) {
+        buffer = Tensor(CPU);
+      }
+    }
+  }
+
+  for (Request* request : batch) {
+    request->outputs->clear();
+  }
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    const auto& name = output_names_[i];
+    Tensor& output = outputs[i];
+    if (batch.size() == 1) {
+      batch[0]->outputs->push_back(std::move(output));
+      continue;
+    }
+    CAFFE_ENFORCE(
+        output.dim() >= 1 && output.size(0) == rows,
+        "Output ",
+        name,
+        " is not batched along dim 0.");
+    int64_t begin = 0;
+    for (Request* request : batch) {
+      request->outputs->push_back(narrowRows(output, begin, request->rows));
+      begin += request->rows;
+    }
+  }
+  return true;
+}
+
+} // namespace caffe2
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+#include "caffe2/core/net.h"
+#include "caffe2/core/tensor.h"
+#include "caffe2/predictor/predictor_config.h"
+
+namespace caffe2 {
+
+/**
+ * BatchingPredictor runs concurrent requests together as batches.
+ *
+ * Requests queue up until their rows add up to max_batch_size, or until the
+ * oldest one has waited for max_wait. A worker then concatenates the inputs
+ * of the requests along dim 0 into buffers it reuses across batches, runs
+ * the predict net once, and hands each request a view of its rows of the
+ * outputs, without copying them.
+ *
+ * Each worker runs the net in its own workspace, which shares the
+ * parameters of the config's workspace, so batches run in parallel on up to
+ * num_workers threads. Blobs of the config's workspace that the net writes
+ * are copied into each worker's workspace when the predictor is created.
+ */
+class CAFFE2_API BatchingPredictor {
+ public:
+  using TensorList = std::vector<TensorCPU>;
+
+  struct Options {
+    // Batches are closed once their requests have this many rows. A single
+    // request bigger than this is run as a batch of its own.
+    int64_t max_batch_size = 32;
+    // The longest a request waits for the batch to fill up.
+    std::chrono::microseconds max_wait{1000};
+    // The number of workspaces, and threads running batches.
+    int num_workers = 1;
+  };
+
+  BatchingPredictor(PredictorConfig config, Options options);
+  ~BatchingPredictor();
+
+  // Runs the predict net on the inputs as part of a batch, blocking until
+  // the batch finished. Thread safe.
+  //
+  // Inputs are given in the order of input_names() and share their size in
+  // dim 0, the number of rows of the request. Requests are batched with
+  // others of the same types and sizes in the other dims.
+  //
+  // Outputs, in the order of output_names(), are views of the request's rows
+  // of the batch outputs, which have to be batched along dim 0 too. Unlike
+  // for Predictor, they stay valid after later requests: blobs sharing memory
+  // with an output, like an intermediate it is an alias of, get new memory in
+  // the next batch, and outputs sharing memory with state kept across
+  // batches are copied.
+  //
+  // Returns true on success.
+  bool operator()(const TensorList& inputs, TensorList* outputs);
+
+  const std::vector<std::string>& input_names() const {
+    return input_names_;
+  }
+
+  const std::vector<std::string>& output_names() const {
+    return output_names_;
+  }
+
+ private:
+  struct Request {
+    const TensorList* inputs;
+    TensorList* outputs;
+    int64_t rows;
+    std::chrono::steady_clock::time_point deadline;
+    bool done = false;
+    bool success = false;
+    std::exception_ptr error;
+  };
+
+  struct Worker {
+    std::unique_ptr<Workspace> ws;
+    // the batched inputs, kept to reuse their memory
+    TensorList buffers;
+    // blobs of the shared workspace that the net writes, copied into ws and
+    // kept across batches
+    std::unordered_set<std::string> state_blobs;
+    std::thread thread;
+  };
+
+  void run(Worker* worker);
+  // Takes the next batch off the queue, or returns an empty batch once the
+  // predictor is stopped. Expects mutex_ to be held.
+  std::vector<Request*> takeBatch(std::unique_lock<std::mutex>& lock);
+  bool runBatch(Worker* worker, const std::vector<Request*>& batch);
+
+  PredictorConfig config_;
+  Options options_;
+  std::vector<std::string> input_names_;
+  std::vector<std::string> output_names_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  std::mutex mutex_;
+  // signals workers of new requests
+  std::condition_variable queue_cv_;
+  // signals requests done
+  std::condition_variable done_cv_;
+  std::deque<Request*> queue_;
+  int64_t queued_rows_ = 0;
+  bool stop_ = false;
+};
+
+} // namespace caffe2
@@ -0,0 +1,277 @@
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/tensor.h"
+#include "caffe2/predictor/batching_predictor.h"
+#include "caffe2/predictor/predictor.h"
+#include "caffe2/utils/math.h"
+
+#include <gtest/gtest.h>
+
+namespace caffe2 {
+
+namespace {
+
+const char* predictSpec = R"DOC(
+        name: "predict"
+        type: "dag"
+        external_input: "data"
+        external_input: "W"
+        external_input: "b"
+        external_output: "y"
+        op {
+          input: "data"
+          input: "W"
+          input: "b"
+          output: "y"
+          type: "FC"
+        }
+)DOC";
+
+// Overwrites the shared bias b with 3 before using it.
+const char* overwriteSpec = R"DOC(
+        name: "predict"
+        type: "dag"
+        external_input: "data"
+        external_input: "W"
+        external_input: "b"
+        external_output: "y"
+        op {
+          output: "b"
+          type: "ConstantFill"
+          arg {
+            name: "shape"
+            ints: 10
+          }
+          arg {
+            name: "value"
+            f: 3.0
+          }
+        }
+        op {
+          input: "data"
+          input: "W"
+          input: "b"
+          output: "y"
+          type: "FC"
+        }
+)DOC";
+
+// Returns an alias of the intermediate h, which the next batch overwrites.
+const char* aliasSpec = R"DOC(
+        name: "predict"
+        type: "dag"
+        external_input: "data"
+        external_input: "W"
+        external_input: "b"
+        external_output: "y"
+        op {
+          input: "data"
+          input: "W"
+          input: "b"
+          output: "h"
+          type: "FC"
+        }
+        op {
+          input: "h"
+          output: "y"
+          type: "Alias"
+        }
+)DOC";
+
+const char* initSpec = R"DOC(
+        name: "init"
+        type: "dag"
+        op {
+          type: "GaussianFill"
+          output: "W"
+          arg {
+            name: "shape"
+            ints: 10
+            ints: 4
+          }
+        }
+        op {
+          type: "ConstantFill"
+          output: "b"
+          arg {
+            name: "shape"
+            ints: 10
+          }
+          arg {
+            name: "value"
+            f: 2.0
+          }
+        }
+)DOC";
+
+TensorCPU randomTensor(const std::vector<int64_t>& dims, CPUContext* ctx) {
+  TensorCPU t(dims, CPU);
+  math::RandUniform<float, CPUContext>(
+      t.numel(), -1.0, 1.0, t.template mutable_data<float>(), ctx);
+  return t;
+}
+
+NetDef parseNetDef(const std::string& value) {
+  NetDef def;
+  CAFFE_ENFORCE(
+      TextFormat::ParseFromString(value, &def),
+      "Failed to parse NetDef with value: ",
+      value);
+  return def;
+}
+
+} // namespace
+
+class BatchingPredictorTest : public testing::Test {
+ public:
+  void SetUp() override {
+    DeviceOption op;
+    op.set_random_seed(1701);
+    ctx_ = std::make_unique<CPUContext>(op);
+    config_ = makePredictorConfig(
+        parseNetDef(initSpec), parseNetDef(predictSpec));
+  }
+
+  // Runs the request on a plain predictor sharing the same parameters.
+  TensorCPU expected(const TensorCPU& input) {
+    PredictorConfig config = config_;
+    config.ws = std::make_shared<Workspace>(config_.ws.get());
+    Predictor predictor(config);
+    Predictor::TensorList outputs;
+    EXPECT_TRUE(predictor({input.UnsafeSharedInstance()}, &outputs));
+    return outputs[0].Clone();
+  }
+
+  void expectNear(const TensorCPU& a, const TensorCPU& b) {
+    ASSERT_EQ(a.sizes(), b.sizes());
+    for (int64_t i = 0; i < a.numel(); ++i) {
+      EXPECT_NEAR(a.data<float>()[i], b.data<float>()[i], 1E-5);
+    }
+  }
+
+  std::unique_ptr<CPUContext> ctx_;
+  PredictorConfig config_;
+};
+
+TEST_F(BatchingPredictorTest, SingleRequest) {
+  BatchingPredictor::Options options;
+  options.max_wait = std::chrono::microseconds(0);
+  BatchingPredictor predictor(config_, options);
+  EXPECT_EQ(predictor.input_names(), std::vector<std::string>({"data"}));
+  EXPECT_EQ(predictor.output_names(), std::vector<std::string>({"y"}));
+
+  TensorCPU input = randomTensor({3, 4}, ctx_.get());
+  BatchingPredictor::TensorList outputs;
+  EXPECT_TRUE(predictor({input.UnsafeSharedInstance()}, &outputs));
+  ASSERT_EQ(outputs.size(), 1);
+  expectNear(outputs[0], expected(input));
+
+  // Outputs stay valid after later requests.
+  TensorCPU other = randomTensor({3, 4}, ctx_.get());
+  BatchingPredictor::TensorList other_outputs;
+  EXPECT_TRUE(predictor({other.UnsafeSharedInstance()}, &other_outputs));
+  expectNear(outputs[0], expected(input));
+  expectNear(other_outputs[0], expected(other));
+}
+
+TEST_F(BatchingPredictorTest, ConcurrentRequests) {
+  const int kRequests = 16;
+  BatchingPredictor::Options options;
+  options.max_batch_size = 8;
+  options.max_wait = std::chrono::milliseconds(10);
+  options.num_workers = 2;
+  BatchingPredictor predictor(config_, options);
+
+  std::vector<TensorCPU> inputs;
+  for (int i = 0; i < kRequests; ++i) {
+    inputs.push_back(randomTensor({1 + i % 3, 4}, ctx_.get()));
+  }
+  std::vector<BatchingPredictor::TensorList> outputs(kRequests);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kRequests; ++i) {
+    threads.emplace_back([&, i]() {
+      EXPECT_TRUE(
+          predictor({inputs[i].UnsafeSharedInstance()}, &outputs[i]));
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (int i = 0; i < kRequests; ++i) {
+    ASSERT_EQ(outputs[i].size(), 1);
+    expectNear(outputs[i][0], expected(inputs[i]));
+  }
+}
+
+TEST_F(BatchingPredictorTest, WorkerLocalParameters) {
+  const int kRequests = 8;
+  PredictorConfig config = config_;
+  config.predict_net =
+      std::make_shared<NetDef>(parseNetDef(overwriteSpec));
+  BatchingPredictor::Options options;
+  options.max_batch_size = 2;
+  options.num_workers = 2;
+  BatchingPredictor predictor(config, options);
+
+  std::vector<TensorCPU> inputs;
+  for (int i = 0; i < kRequests; ++i) {
+    inputs.push_back(randomTensor({2, 4}, ctx_.get()));
+  }
+  std::vector<BatchingPredictor::TensorList> outputs(kRequests);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kRequests; ++i) {
+    threads.emplace_back([&, i]() {
+      EXPECT_TRUE(
+          predictor({inputs[i].UnsafeSharedInstance()}, &outputs[i]));
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // The workers wrote their own copies of b, the shared one is still 2.
+  const auto& shared_b = config.ws->GetBlob("b")->Get<TensorCPU>();
+  for (int64_t i = 0; i < shared_b.numel(); ++i) {
+    EXPECT_EQ(shared_b.data<float>()[i], 2.0f);
+  }
+  for (int i = 0; i < kRequests; ++i) {
+    ASSERT_EQ(outputs[i].size(), 1);
+    TensorCPU shifted = expected(inputs[i]);
+    float* data = shifted.mutable_data<float>();
+    for (int64_t j = 0; j < shifted.numel(); ++j) {
+      data[j] += 1.0f;
+    }
+    expectNear(outputs[i][0], shifted);
+  }
+}
+
+TEST_F(BatchingPredictorTest, OutputAliasesIntermediate) {
+  PredictorConfig config = config_;
+  config.predict_net = std::make_shared<NetDef>(parseNetDef(aliasSpec));
+  BatchingPredictor::Options options;
+  options.max_wait = std::chrono::microseconds(0);
+  BatchingPredictor predictor(config, options);
+
+  TensorCPU input = randomTensor({3, 4}, ctx_.get());
+  BatchingPredictor::TensorList outputs;
+  EXPECT_TRUE(predictor({input.UnsafeSharedInstance()}, &outputs));
+  ASSERT_EQ(outputs.size(), 1);
+  // The same sizes, so h would be computed into the same memory.
+  TensorCPU other = randomTensor({3, 4}, ctx_.get());
+  BatchingPredictor::TensorList other_outputs;
+  EXPECT_TRUE(predictor({other.UnsafeSharedInstance()}, &other_outputs));
+  expectNear(outputs[0], expected(input));
+  expectNear(other_outputs[0], expected(other));
+}
+
+TEST_F(BatchingPredictorTest, InvalidInputs) {
+  BatchingPredictor predictor(config_, BatchingPredictor::Options());
+  BatchingPredictor::TensorList outputs;
+  EXPECT_THROW(predictor({}, &outputs), EnforceNotMet);
+  TensorCPU scalar(std::vector<int64_t>{}, CPU);
+  scalar.mutable_data<float>();
+  EXPECT_THROW(
+      predictor({scalar.UnsafeSharedInstance()}, &outputs), EnforceNotMet);
+}
+
+} // namespace caffe2
@@ -832,6 +832,42 @@ def optimize_inference_fast(net, static_blobs):
     return optim
 
 
+def optimize_inference_size_aware(net, static_blobs, input_shapes,
+                                  max_batch_size=1, max_seq_size=1,
+                                  input_types=None):
+    """
+    Like optimize_inference_fast, but shares blobs by their sizes as well as
+    their liveness, so that small blobs do not end up growing large ones.
+    The sizes come from bound shape inference, starting from the shapes of
+    the inputs in input_shapes and of the external inputs in the workspace.
+    The types of the inputs in input_shapes are taken from input_types
+    (caffe2_pb2.TensorProto data types), else from the workspace blobs of
+    the same names, else they are float.
+
+    Returns the optimized net and a dict with the bytes held by the blobs
+    the net writes without sharing ('unshared_bytes'), with sharing by
+    liveness only ('baseline_bytes') and with the size-aware sharing
+    ('planned_bytes').
+    """
+    optim = caffe2_pb2.NetDef()
+    optim_str, unshared, baseline, planned = \
+        C.memonger_optimize_inference_net_size_aware(
+            net.SerializeToString(),
+            [str(s).encode('utf-8') for s in static_blobs],
+            {str(k): list(v) for k, v in viewitems(input_shapes)},
+            {str(k): int(v) for k, v in viewitems(input_types or {})},
+            max_batch_size,
+            max_seq_size,
+        )
+    optim.ParseFromString(optim_str)
+    stats = {
+        'unshared_bytes': unshared,
+        'baseline_bytes': baseline,
+        'planned_bytes': planned,
+    }
+    return optim, stats
+
+
 def optimize_interference(net, static_blobs,
                           ordering_function=topological_sort_traversal,
                           blob_sizes=None,
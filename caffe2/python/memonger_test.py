@@ -152,6 +152,102 @@ class MemongerTest(hu.HypothesisTestCase):
         for op in optimized_net.op:
             self.assertEqual(len(op.output), len(set(op.output)), str(op))
 
+    @given(input_dim=st.integers(min_value=1, max_value=10),
+           hidden_dim=st.integers(min_value=1, max_value=64),
+           batch_size=st.integers(min_value=1, max_value=10))
+    @settings(max_examples=5, timeout=120)
+    def test_size_aware_memonger(self, input_dim, hidden_dim, batch_size):
+        m = model_helper.ModelHelper()
+        fc1 = brew.fc(m, "data", "fc1", dim_in=input_dim, dim_out=hidden_dim)
+        relu1 = brew.relu(m, fc1, "relu1")
+        fc2 = brew.fc(m, relu1, "fc2", dim_in=hidden_dim, dim_out=2)
+        relu2 = brew.relu(m, fc2, "relu2")
+        fc3 = brew.fc(m, relu2, "fc3", dim_in=2, dim_out=hidden_dim)
+        brew.relu(m, fc3, "out")
+        static_blobs = \
+            [o for op in m.param_init_net.Proto().op for o in op.output] + \
+            ["data", "out"]
+
+        workspace.ResetWorkspace()
+        workspace.RunNetOnce(m.param_init_net)
+        data = np.random.randn(batch_size, input_dim).astype(np.float32)
+        workspace.FeedBlob("data", data)
+        optimized_net, stats = memonger.optimize_inference_size_aware(
+            m.Proto(), static_blobs, {"data": [batch_size, input_dim]},
+            max_batch_size=batch_size)
+
+        workspace.RunNetOnce(m.net)
+        out = workspace.FetchBlob("out")
+        workspace.RunNetOnce(optimized_net)
+        optimized_out = workspace.FetchBlob("out")
+        np.testing.assert_almost_equal(out, optimized_out)
+
+        self.assertLess(count_blobs(optimized_net), count_blobs(m.Proto()))
+        self.assertEqual(
+            stats['unshared_bytes'],
+            batch_size * (3 * hidden_dim + 2 * 2) * 4)
+        self.assertLessEqual(stats['planned_bytes'], stats['baseline_bytes'])
+        self.assertLess(stats['planned_bytes'], stats['unshared_bytes'])
+
+    @given(input_dim=st.integers(min_value=1, max_value=10),
+           hidden_dim=st.integers(min_value=8, max_value=64),
+           batch_size=st.integers(min_value=1, max_value=10))
+    @settings(max_examples=5, timeout=120)
+    def test_size_aware_memonger_avoids_growing(
+            self, input_dim, hidden_dim, batch_size):
+        # Sharing by liveness only maps small2 onto the freed big1 and then
+        # big2 onto the freed small1, which ends up with two large blobs.
+        # big1 and big2 never overlap, so sizes allow one large and two
+        # small blobs.
+        m = model_helper.ModelHelper()
+        big1 = brew.fc(m, "data", "big1", dim_in=input_dim, dim_out=hidden_dim)
+        small1 = brew.fc(m, big1, "small1", dim_in=hidden_dim, dim_out=2)
+        small2 = brew.relu(m, small1, "small2")
+        big2 = brew.fc(m, small2, "big2", dim_in=2, dim_out=hidden_dim)
+        brew.fc(m, big2, "out", dim_in=hidden_dim, dim_out=2)
+        static_blobs = \
+            [o for op in m.param_init_net.Proto().op for o in op.output] + \
+            ["data", "out"]
+
+        workspace.ResetWorkspace()
+        workspace.RunNetOnce(m.param_init_net)
+        data = np.random.randn(batch_size, input_dim).astype(np.float32)
+        workspace.FeedBlob("data", data)
+        optimized_net, stats = memonger.optimize_inference_size_aware(
+            m.Proto(), static_blobs, {"data": [batch_size, input_dim]},
+            max_batch_size=batch_size)
+
+        workspace.RunNetOnce(m.net)
+        out = workspace.FetchBlob("out")
+        workspace.RunNetOnce(optimized_net)
+        optimized_out = workspace.FetchBlob("out")
+        np.testing.assert_almost_equal(out, optimized_out)
+
+        self.assertEqual(
+            stats['baseline_bytes'], batch_size * 2 * hidden_dim * 4)
+        self.assertEqual(
+            stats['planned_bytes'], batch_size * (hidden_dim + 2 + 2) * 4)
+        self.assertLess(stats['planned_bytes'], stats['baseline_bytes'])
+
+    def test_size_aware_memonger_input_types(self):
+        m = model_helper.ModelHelper()
+        relu = brew.relu(m, "data", "relu")
+        brew.relu(m, relu, "out")
+        shapes = {"data": [3, 5]}
+
+        # The type of data comes from the workspace blob...
+        workspace.ResetWorkspace()
+        workspace.FeedBlob("data", np.zeros((3, 5), dtype=np.float64))
+        _, stats = memonger.optimize_inference_size_aware(
+            m.Proto(), ["data", "out"], shapes, max_batch_size=3)
+        self.assertEqual(stats['unshared_bytes'], 3 * 5 * 8)
+
+        # ...unless it is given.
+        _, stats = memonger.optimize_inference_size_aware(
+            m.Proto(), ["data", "out"], shapes, max_batch_size=3,
+            input_types={"data": caffe2_pb2.TensorProto.FLOAT16})
+        self.assertEqual(stats['unshared_bytes'], 3 * 5 * 2)
+
     @given(input_dim=st.integers(min_value=1, max_value=4),
            output_dim=st.integers(min_value=1, max_value=4),
            batch_size=st.integers(min_value=1, max_value=4))
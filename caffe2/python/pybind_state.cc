@@ -20,6 +20,7 @@
 #include "caffe2/onnx/backend.h"
 #include "caffe2/onnx/helper.h"
 #include "caffe2/onnx/onnx_exporter.h"
+#include "caffe2/opt/bound_shape_inferencer.h"
 #include "caffe2/opt/converter.h"
 #include "caffe2/opt/fusion.h"
 #include "caffe2/opt/mobile.h"
@@ -1454,6 +1455,71 @@ void addGlobalMethods(py::module& m) {
         CAFFE_ENFORCE(optimized.SerializeToString(&protob));
         return py::bytes(protob);
       });
+  m.def(
+      "memonger_optimize_inference_net_size_aware",
+      [](const py::bytes& net_def,
+         const std::vector<std::string>& static_blobs,
+         const std::unordered_map<std::string, std::vector<int>>& shapes,
+         const std::unordered_map<std::string, int>& types,
+         int max_batch_size,
+         int max_seq_size) {
+        NetDef def;
+        CAFFE_ENFORCE(
+            ParseProtoFromLargeString(net_def.cast<std::string>(), &def));
+        std::string protob;
+        caffe2::memonger::MemoryPlanStats stats;
+        {
+          py::gil_scoped_release g;
+          // Bound shapes of the blobs, from the given input shapes and the
+          // external inputs in the workspace. The type of an input is the
+          // given one, else that of the workspace blob, else float.
+          Workspace* curr_ws = GetCurrentWorkspace();
+          ShapeInfoMap shape_map;
+          for (const auto& it : shapes) {
+            auto type = TensorProto::FLOAT;
+            auto tit = types.find(it.first);
+            if (tit != types.end()) {
+              type = static_cast<TensorProto::DataType>(tit->second);
+            } else if (curr_ws->HasBlob(it.first)) {
+              const auto blob_type =
+                  getShapeInfoFromBlob(curr_ws->GetBlob(it.first))
+                      .shape.data_type();
+              if (blob_type != TensorProto::UNDEFINED) {
+                type = blob_type;
+              }
+            }
+            shape_map.emplace(
+                it.first,
+                constructShapeInfoWithDefaultDimType(
+                    CreateTensorShape(it.second, type)));
+          }
+          for (const auto& name : def.external_input()) {
+            if (!shape_map.count(name) && curr_ws->HasBlob(name)) {
+              shape_map.emplace(
+                  name, getShapeInfoFromBlob(curr_ws->GetBlob(name)));
+            }
+          }
+          BoundShapeInferencer inferencer(
+              BoundShapeSpec(max_batch_size, max_seq_size));
+          inferencer.InferBoundShapeAndType(def, shape_map, curr_ws);
+          std::unordered_map<std::string, TensorShape> blob_shapes;
+          for (const auto& it : inferencer.shape_info()) {
+            blob_shapes.emplace(it.first, it.second.shape);
+          }
+
+          std::set<string> static_blobs_set(
+              static_blobs.begin(), static_blobs.end());
+          NetDef optimized =
+              caffe2::memonger::optimize_inference_net_size_aware(
+                  def, static_blobs_set, blob_shapes, &stats);
+          CAFFE_ENFORCE(optimized.SerializeToString(&protob));
+        }
+        return py::make_tuple(
+            py::bytes(protob),
+            stats.unshared_bytes,
+            stats.baseline_bytes,
+            stats.planned_bytes);
+      });
   m.def(
       "infer_shapes_and_types_from_workspace",
       [](const std::vector<py::bytes>& net_protos) {
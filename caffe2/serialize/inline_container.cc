@@ -225,6 +225,25 @@ std::tuple<at::DataPtr, size_t> PyTorchStreamReader::getRecord(const std::string
   return std::make_tuple(std::move(retval), stat.m_uncomp_size);
 }
 
+std::tuple<const char*, size_t> PyTorchStreamReader::getRecordInPlace(
+    const std::string& name) {
+  const char* base = in_->data();
+  if (base == nullptr) {
+    return std::make_tuple(nullptr, 0);
+  }
+  mz_zip_archive_file_stat stat;
+  mz_zip_reader_file_stat(ar_.get(), getRecordID(name), &stat);
+  valid("retrieving file meta-data for ", name.c_str());
+  if (stat.m_method != 0 || stat.m_comp_size != stat.m_uncomp_size) {
+    return std::make_tuple(nullptr, 0);
+  }
+  size_t offset = getRecordOffset(name);
+  if (offset > in_->size() || stat.m_uncomp_size > in_->size() - offset) {
+    CAFFE_THROW("record ", name, " extends past the end of the archive");
+  }
+  return std::make_tuple(base + offset, stat.m_uncomp_size);
+}
+
 static int64_t read_le_16(uint8_t* buf) {
   return buf[0] + (buf[1] << 8);
 }
@@ -105,6 +105,10 @@ class CAFFE2_API PyTorchStreamReader final {
 
   // return dataptr, size
   std::tuple<at::DataPtr, size_t> getRecord(const std::string& name);
+  // return a pointer to the data of an uncompressed record and its size,
+  // without copying it, if the input is in memory (see
+  // ReadAdapterInterface::data), or nullptr otherwise
+  std::tuple<const char*, size_t> getRecordInPlace(const std::string& name);
   size_t getRecordOffset(const std::string& name);
   bool hasRecord(const std::string& name);
   std::vector<std::string> getAllRecords();
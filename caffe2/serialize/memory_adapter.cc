@@ -0,0 +1,36 @@
+#include "caffe2/serialize/memory_adapter.h"
+#include <c10/util/Exception.h>
+
+#include <cstring>
+
+namespace caffe2 {
+namespace serialize {
+
+MemoryReadAdapter::MemoryReadAdapter(const void* data, size_t size)
+    : data_(static_cast<const char*>(data)), size_(size) {}
+
+size_t MemoryReadAdapter::size() const {
+  return size_;
+}
+
+size_t MemoryReadAdapter::read(
+    uint64_t pos,
+    void* buf,
+    size_t n,
+    const char* what) const {
+  AT_ASSERTM(
+      pos <= size_ && n <= size_ - pos,
+      "reading past the end of the buffer while ",
+      what);
+  std::memcpy(buf, data_ + pos, n);
+  return n;
+}
+
+const char* MemoryReadAdapter::data() const {
+  return data_;
+}
+
+MemoryReadAdapter::~MemoryReadAdapter() {}
+
+} // namespace serialize
+} // namespace caffe2
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "c10/macros/Macros.h"
+#include "caffe2/serialize/read_adapter_interface.h"
+
+namespace caffe2 {
+namespace serialize {
+
+// this is a reader over a buffer that is already in memory, e.g. an mmap of
+// a model file. The buffer is not copied and must outlive the adapter.
+class CAFFE2_API MemoryReadAdapter final : public ReadAdapterInterface {
+ public:
+  C10_DISABLE_COPY_AND_ASSIGN(MemoryReadAdapter);
+  MemoryReadAdapter(const void* data, size_t size);
+  size_t size() const override;
+  size_t read(uint64_t pos, void* buf, size_t n, const char* what = "")
+      const override;
+  const char* data() const override;
+  ~MemoryReadAdapter();
+
+ private:
+  const char* data_;
+  size_t size_;
+};
+
+} // namespace serialize
+} // namespace caffe2
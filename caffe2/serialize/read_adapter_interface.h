@@ -16,6 +16,11 @@ class CAFFE2_API ReadAdapterInterface {
   virtual size_t size() const = 0;
   virtual size_t read(uint64_t pos, void* buf, size_t n, const char* what = "")
       const = 0;
+  // Returns the whole input if it is already in memory, so records can be
+  // used in place, and nullptr otherwise.
+  virtual const char* data() const {
+    return nullptr;
+  }
   virtual ~ReadAdapterInterface();
 };
 
@@ -0,0 +1,258 @@
+#include <test/cpp/jit/test_base.h>
+#include <test/cpp/jit/test_utils.h>
+
+#include <torch/csrc/jit/passes/frozen_graph_optimizations.h>
+#include <torch/csrc/jit/runtime/interpreter.h>
+#include <torch/csrc/jit/testing/file_check.h>
+
+namespace torch {
+namespace jit {
+
+namespace {
+std::vector<at::Tensor> runGraph(
+    const std::shared_ptr<Graph>& graph,
+    const std::vector<at::Tensor>& inputs) {
+  Code code(graph, "");
+  InterpreterState interp(code);
+  Stack stack(inputs.begin(), inputs.end());
+  interp.run(stack);
+  return fmap(stack, [](const IValue& v) { return v.toTensor(); });
+}
+} // namespace
+
+void testOptimizeFrozenGraph() {
+  auto graph = std::make_shared<Graph>();
+  Value* img = graph->addInput("img");
+  Value* x = graph->addInput("x");
+
+  // conv -> batch_norm -> mul -> add -> relu, as in a frozen ResNet block
+  Value* conv = graph->insert(
+      aten::conv2d,
+      {img,
+       at::randn({4, 3, 3, 3}),
+       IValue(),
+       std::vector<int64_t>{1, 1},
+       std::vector<int64_t>{1, 1},
+       std::vector<int64_t>{1, 1},
+       1});
+  Value* bn = graph->insert(
+      aten::batch_norm,
+      {conv,
+       at::rand({4}),
+       at::randn({4}),
+       at::randn({4}),
+       at::rand({4}) + 0.5,
+       false,
+       0.1,
+       1e-5,
+       true});
+  Value* scaled = graph->insert(aten::mul, {bn, 2.0});
+  Value* shifted = graph->insert(aten::add, {scaled, at::randn({4, 1, 1})});
+  graph->registerOutput(graph->insert(aten::relu, {shifted}));
+
+  // matmul + add, as left by a scripted nn.Linear on a 3-d input
+  Value* mm = graph->insert(aten::matmul, {x, at::randn({16, 8})});
+  graph->registerOutput(graph->insert(aten::add, {mm, at::randn({8})}));
+
+  std::vector<at::Tensor> inputs = {at::randn({2, 3, 6, 6}),
+                                    at::randn({2, 5, 16})};
+  auto expected = runGraph(graph, inputs);
+
+  OptimizeFrozenGraph(graph, /*prepack_mkldnn_weights=*/false);
+  graph->lint();
+  testing::FileCheck()
+      .check_not("aten::batch_norm")
+      ->check_not("aten::mul")
+      ->check_not("aten::add")
+      ->check_not("aten::matmul")
+      ->run(*graph);
+  testing::FileCheck()
+      .check_count("aten::conv2d", 1, /*exactly*/ true)
+      ->check_count("aten::linear", 1, /*exactly*/ true)
+      ->run(*graph);
+
+  auto outputs = runGraph(graph, inputs);
+  ASSERT_EQ(outputs.size(), expected.size());
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    ASSERT_TRUE(outputs[i].allclose(expected[i], 1e-4, 1e-4));
+  }
+
+  if (at::hasMKLDNN()) {
+    PrepackFrozenMKLDNNConvWeights(graph);
+    graph->lint();
+    testing::FileCheck()
+        .check_not("aten::conv2d")
+        ->check("aten::mkldnn_convolution")
+        ->run(*graph);
+    outputs = runGraph(graph, inputs);
+    ASSERT_TRUE(outputs[0].allclose(expected[0], 1e-4, 1e-4));
+  }
+}
+
+void testFoldFrozenConvBatchNorm() {
+  for (bool shared_conv : {false, true}) {
+    auto graph = std::make_shared<Graph>();
+    Value* img = graph->addInput("img");
+    Value* conv = graph->insert(
+        aten::conv2d,
+        {img,
+         at::randn({2, 1, 1, 1}),
+         at::randn({2}),
+         std::vector<int64_t>{1, 1},
+         std::vector<int64_t>{0, 0},
+         std::vector<int64_t>{1, 1},
+         1});
+    if (shared_conv) {
+      graph->registerOutput(conv);
+    }
+    // batch_norm without affine parameters
+    graph->registerOutput(graph->insert(
+        aten::batch_norm,
+        {conv,
+         IValue(),
+         IValue(),
+         at::randn({2}),
+         at::rand({2}) + 0.5,
+         false,
+         0.1,
+         1e-5,
+         true}));
+    std::vector<at::Tensor> inputs = {at::randn({1, 1, 4, 4})};
+    auto expected = runGraph(graph, inputs);
+
+    FoldFrozenConvBatchNorm(graph);
+    graph->lint();
+    // a conv output with other uses can't absorb the batch_norm
+    testing::FileCheck()
+        .check_count("aten::batch_norm", shared_conv ? 1 : 0, /*exactly*/ true)
+        ->run(*graph);
+    auto outputs = runGraph(graph, inputs);
+    ASSERT_TRUE(outputs.back().allclose(expected.back(), 1e-4, 1e-4));
+  }
+}
+
+void testPropagateFrozenMKLDNNLayout() {
+  if (!at::hasMKLDNN()) {
+    return;
+  }
+  auto graph = std::make_shared<Graph>();
+  Value* img = graph->addInput("img");
+
+  // conv -> relu6 -> max_pool2d -> cat(x, x + c) -> flatten -> linear, with
+  // the pooled value also returned
+  Value* conv = graph->insert(
+      aten::conv2d,
+      {img,
+       at::randn({8, 3, 3, 3}),
+       at::randn({8}),
+       std::vector<int64_t>{1, 1},
+       std::vector<int64_t>{1, 1},
+       std::vector<int64_t>{1, 1},
+       1});
+  Value* relu6 = graph->insert(aten::hardtanh, {conv, 0.0, 6.0});
+  Value* pool = graph->insert(
+      aten::max_pool2d,
+      {relu6,
+       std::vector<int64_t>{2, 2},
+       std::vector<int64_t>{2, 2},
+       std::vector<int64_t>{0, 0},
+       std::vector<int64_t>{1, 1},
+       false});
+  Value* shifted = graph->insert(aten::add, {pool, at::randn({2, 8, 4, 4})});
+  Node* list =
+      graph->insertNode(graph->createList(TensorType::get(), {pool, shifted}));
+  Value* cat = graph->insert(aten::cat, {list->output(), 1});
+  Value* flat = graph->insert(aten::flatten, {cat, 1, -1});
+  graph->registerOutput(
+      graph->insert(aten::linear, {flat, at::randn({10, 256}), IValue()}));
+  graph->registerOutput(pool);
+
+  std::vector<at::Tensor> inputs = {at::randn({2, 3, 8, 8})};
+  auto expected = runGraph(graph, inputs);
+
+  PrepackFrozenMKLDNNConvWeights(graph);
+  PropagateFrozenMKLDNNLayout(graph);
+  graph->lint();
+  // one conversion into the chain, one out of it for each returned value
+  testing::FileCheck()
+      .check_count("aten::to_mkldnn", 1, /*exactly*/ true)
+      ->run(*graph);
+  testing::FileCheck()
+      .check_count("aten::to_dense", 2, /*exactly*/ true)
+      ->run(*graph);
+  testing::FileCheck()
+      .check_not("aten::linear(")
+      ->check("aten::mkldnn_linear")
+      ->run(*graph);
+
+  auto outputs = runGraph(graph, inputs);
+  ASSERT_EQ(outputs.size(), expected.size());
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    ASSERT_TRUE(outputs[i].allclose(expected[i], 1e-4, 1e-4));
+  }
+}
+
+void testPropagateFrozenMKLDNNLayoutOperands() {
+  if (!at::hasMKLDNN()) {
+    return;
+  }
+  auto conv2d = [](const std::shared_ptr<Graph>& graph, Value* input) {
+    return graph->insert(
+        aten::conv2d,
+        {input,
+         at::randn({8, 3, 3, 3}),
+         at::randn({8}),
+         std::vector<int64_t>{1, 1},
+         std::vector<int64_t>{1, 1},
+         std::vector<int64_t>{1, 1},
+         1});
+  };
+  auto check = [](std::shared_ptr<Graph>& graph,
+                  const std::vector<at::Tensor>& inputs,
+                  int to_mkldnn,
+                  int to_dense) {
+    auto expected = runGraph(graph, inputs);
+    PrepackFrozenMKLDNNConvWeights(graph);
+    PropagateFrozenMKLDNNLayout(graph);
+    graph->lint();
+    testing::FileCheck()
+        .check_count("aten::to_mkldnn", to_mkldnn, /*exactly*/ true)
+        ->run(*graph);
+    testing::FileCheck()
+        .check_count("aten::to_dense", to_dense, /*exactly*/ true)
+        ->run(*graph);
+    auto outputs = runGraph(graph, inputs);
+    ASSERT_EQ(outputs.size(), expected.size());
+    for (size_t i = 0; i < outputs.size(); ++i) {
+      ASSERT_TRUE(outputs[i].allclose(expected[i], 1e-4, 1e-4));
+    }
+  };
+
+  {
+    // An operand of unknown dtype, here an int tensor, is not converted to
+    // MKLDNN, so the add stays dense.
+    auto graph = std::make_shared<Graph>();
+    Value* img = graph->addInput("img");
+    Value* other = graph->addInput("other");
+    Value* conv = conv2d(graph, img);
+    graph->registerOutput(graph->insert(aten::add, {conv, other}));
+    check(
+        graph,
+        {at::randn({2, 3, 8, 8}), at::ones({2, 8, 8, 8}, at::kInt)},
+        /*to_mkldnn=*/1,
+        /*to_dense=*/1);
+  }
+  {
+    // Shape queries read the MKLDNN tensor, only the output is converted.
+    auto graph = std::make_shared<Graph>();
+    Value* img = graph->addInput("img");
+    Value* conv = conv2d(graph, img);
+    Value* relu = graph->insert(aten::relu, {conv});
+    Value* shape = graph->insert(aten::size, {conv});
+    graph->registerOutput(graph->insert(aten::reshape, {relu, shape}));
+    check(graph, {at::randn({2, 3, 8, 8})}, /*to_mkldnn=*/1, /*to_dense=*/1);
+  }
+}
+
+} // namespace jit
+} // namespace torch
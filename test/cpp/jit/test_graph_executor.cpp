@@ -1,7 +1,16 @@
 #include "test/cpp/jit/test_base.h"
 #include "test/cpp/jit/test_utils.h"
+#include "torch/csrc/jit/ir/irparser.h"
+#include "torch/csrc/jit/passes/pass_manager.h"
 #include "torch/csrc/jit/runtime/graph_executor.h"
 
+#include <ATen/Parallel.h>
+
+#include <atomic>
+#include <future>
+#include <limits>
+#include <stdexcept>
+
 namespace torch {
 namespace jit {
 
@@ -28,5 +37,125 @@ void testGraphExecutor() {
   ASSERT_TRUE(almostEqual(stack[1].toTensor(), r1));
 }
 
+namespace {
+
+// Restores the executor modes at the end of a test, even if it fails.
+struct ExecutorModesGuard {
+  ExecutorModesGuard()
+      : executor_mode_(getExecutorMode()),
+        profiling_mode_(getProfilingMode()) {}
+
+  ~ExecutorModesGuard() {
+    getExecutorMode() = executor_mode_;
+    getProfilingMode() = profiling_mode_;
+  }
+
+  bool executor_mode_;
+  bool profiling_mode_;
+};
+
+// Makes the optimization of graphs fail the given number of times.
+struct FailingPassGuard {
+  explicit FailingPassGuard(int failures) : failures_(failures) {
+    getCustomPreFusionPasses().push_back([this](std::shared_ptr<Graph>&) {
+      if (failures_.fetch_sub(1) > 0) {
+        throw std::runtime_error("injected compile failure");
+      }
+    });
+  }
+
+  ~FailingPassGuard() {
+    getCustomPreFusionPasses().pop_back();
+  }
+
+  std::atomic<int> failures_;
+};
+
+} // namespace
+
+void testBackgroundCompilation() {
+  ExecutorModesGuard modes_guard;
+  BackgroundCompilationGuard background_guard(true);
+  getExecutorMode() = true;
+  getProfilingMode() = true;
+
+  auto g = std::make_shared<Graph>();
+  parseIR(
+      R"IR(
+    graph(%a : Tensor, %b : Tensor):
+      %one : int = prim::Constant[value=1]()
+      %c : Tensor = aten::mul(%a, %b)
+      %d : Tensor = aten::add(%c, %a, %one)
+      return (%d))IR",
+      g.get());
+  GraphExecutor executor(g, "");
+  auto a = at::randn({4, 4});
+  auto b = at::randn({4, 4});
+
+  // waiting for the compilation from the pool it runs on could deadlock
+  std::promise<bool> refused;
+  at::launch([&]() {
+    try {
+      executor.warmup(createStack({a, b}));
+      refused.set_value(false);
+    } catch (const c10::Error&) {
+      refused.set_value(true);
+    }
+  });
+  ASSERT_TRUE(refused.get_future().get());
+
+  // runs the profiling plan until the background compilation is done
+  executor.warmup(createStack({a, b}));
+  // only succeeds once the optimized plan is installed
+  auto state = executor.getDebugState();
+  ASSERT_EQ(state.execution_plans.size(), 1);
+
+  auto stack = createStack({a, b});
+  executor.run(stack);
+  ASSERT_EQ(stack.size(), 1);
+  ASSERT_TRUE(almostEqual(stack[0].toTensor(), a * b + a));
+}
+
+void testBackgroundCompilationFailure() {
+  ExecutorModesGuard modes_guard;
+  BackgroundCompilationGuard background_guard(true);
+  getExecutorMode() = true;
+  getProfilingMode() = true;
+
+  auto g = std::make_shared<Graph>();
+  parseIR(
+      R"IR(
+    graph(%a : Tensor, %b : Tensor):
+      %one : int = prim::Constant[value=1]()
+      %c : Tensor = aten::mul(%a, %b)
+      %d : Tensor = aten::add(%c, %a, %one)
+      return (%d))IR",
+      g.get());
+  auto a = at::randn({4, 4});
+  auto b = at::randn({4, 4});
+
+  // a failed compilation is retried and the graph keeps running meanwhile
+  {
+    FailingPassGuard failing(1);
+    GraphExecutor executor(g, "");
+    executor.warmup(createStack({a, b}));
+    ASSERT_EQ(executor.getDebugState().execution_plans.size(), 1);
+    auto stack = createStack({a, b});
+    executor.run(stack);
+    ASSERT_TRUE(almostEqual(stack[0].toTensor(), a * b + a));
+  }
+
+  // a graph that never compiles ends up running unoptimized
+  {
+    FailingPassGuard failing(std::numeric_limits<int>::max());
+    GraphExecutor executor(g, "");
+    executor.warmup(createStack({a, b}));
+    ASSERT_EQ(executor.getDebugState().execution_plans.size(), 1);
+    auto stack = createStack({a, b});
+    executor.run(stack);
+    ASSERT_TRUE(almostEqual(stack[0].toTensor(), a * b + a));
+  }
+}
+
 } // namespace jit
 } // namespace torch
@@ -0,0 +1,129 @@
+#include <test/cpp/jit/test_base.h>
+#include <test/cpp/jit/test_utils.h>
+
+#include <torch/csrc/jit/passes/horizontal_fusion.h>
+#include <torch/csrc/jit/runtime/interpreter.h>
+#include <torch/csrc/jit/testing/file_check.h>
+
+namespace torch {
+namespace jit {
+
+namespace {
+std::vector<at::Tensor> runGraph(
+    const std::shared_ptr<Graph>& graph,
+    const std::vector<at::Tensor>& inputs) {
+  Code code(graph, "");
+  InterpreterState interp(code);
+  Stack stack(inputs.begin(), inputs.end());
+  interp.run(stack);
+  return fmap(stack, [](const IValue& v) { return v.toTensor(); });
+}
+} // namespace
+
+void testHorizontalFusion() {
+  auto graph = std::make_shared<Graph>();
+  Value* x = graph->addInput("x");
+  Value* img = graph->addInput("img");
+  // three heads on the same input, one without bias
+  for (int64_t features : {3, 5, 7}) {
+    auto bias = features == 5 ? IValue() : IValue(at::randn({features}));
+    graph->registerOutput(graph->insert(
+        aten::linear, {x, at::randn({features, 16}), bias}));
+  }
+  // a 1x1 convolution pair with a different input
+  for (int64_t channels : {4, 6}) {
+    graph->registerOutput(graph->insert(
+        aten::conv2d,
+        {img,
+         at::randn({channels, 3, 1, 1}),
+         at::randn({channels}),
+         std::vector<int64_t>{1, 1},
+         std::vector<int64_t>{0, 0},
+         std::vector<int64_t>{1, 1},
+         1}));
+  }
+  std::vector<at::Tensor> inputs = {at::randn({2, 16}), at::randn({1, 3, 5, 5})};
+  auto expected = runGraph(graph, inputs);
+
+  HorizontalFusion(graph);
+  graph->lint();
+  testing::FileCheck()
+      .check_count("aten::linear", 1, /*exactly*/ true)
+      ->check_count("aten::conv2d", 1, /*exactly*/ true)
+      ->run(*graph);
+  testing::FileCheck()
+      .check_count("aten::split_with_sizes", 2, /*exactly*/ true)
+      ->run(*graph);
+
+  auto outputs = runGraph(graph, inputs);
+  ASSERT_EQ(outputs.size(), expected.size());
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    ASSERT_TRUE(outputs[i].allclose(expected[i], 1e-5, 1e-5));
+    // chunks along the feature dim are copied out of the fused output
+    ASSERT_TRUE(outputs[i].is_contiguous());
+  }
+}
+
+void testHorizontalFusionViewConsumer() {
+  auto graph = std::make_shared<Graph>();
+  Value* x = graph->addInput("x");
+  // the split chunks are strided along the feature dim, which `view` rejects
+  for (int64_t features : {3, 5}) {
+    Value* head = graph->insert(
+        aten::linear, {x, at::randn({features, 16}), at::randn({features})});
+    graph->registerOutput(
+        graph->insert(aten::view, {head, std::vector<int64_t>{-1}}));
+  }
+  std::vector<at::Tensor> inputs = {at::randn({2, 16})};
+  auto expected = runGraph(graph, inputs);
+
+  HorizontalFusion(graph);
+  graph->lint();
+  testing::FileCheck()
+      .check_count("aten::linear", 1, /*exactly*/ true)
+      ->check_count("aten::contiguous", 2, /*exactly*/ true)
+      ->run(*graph);
+
+  auto outputs = runGraph(graph, inputs);
+  ASSERT_EQ(outputs.size(), expected.size());
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    ASSERT_TRUE(outputs[i].allclose(expected[i], 1e-5, 1e-5));
+  }
+}
+
+void testHorizontalFusionMutatedInput() {
+  auto graph = std::make_shared<Graph>();
+  Value* x = graph->addInput("x");
+  auto linear = [&](int64_t features) {
+    graph->registerOutput(graph->insert(
+        aten::linear,
+        {x, at::randn({features, 16}), at::randn({features})}));
+  };
+  linear(3);
+  linear(5);
+  // the third head reads x after the in-place update and must stay there
+  graph->registerOutput(graph->insert(aten::add_, {x, at::ones({2, 16})}));
+  linear(7);
+  auto input = at::randn({2, 16});
+  auto expected = runGraph(graph, {input.clone()});
+
+  HorizontalFusion(graph);
+  graph->lint();
+  testing::FileCheck()
+      .check_count("aten::linear", 2, /*exactly*/ true)
+      ->run(*graph);
+  testing::FileCheck()
+      .check("aten::linear")
+      ->check("aten::add_")
+      ->check("aten::linear")
+      ->run(*graph);
+
+  auto outputs = runGraph(graph, {input.clone()});
+  ASSERT_EQ(outputs.size(), expected.size());
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    ASSERT_TRUE(outputs[i].allclose(expected[i], 1e-5, 1e-5));
+  }
+}
+
+} // namespace jit
+} // namespace torch
@@ -1,13 +1,18 @@
 #include <c10/core/TensorOptions.h>
+#include <caffe2/serialize/inline_container.h>
+#include <caffe2/serialize/memory_adapter.h>
 #include <test/cpp/jit/test_base.h>
 #include <torch/csrc/autograd/generated/variable_factories.h>
 #include <torch/csrc/jit/api/module.h>
+#include <torch/csrc/jit/mobile/flat_bytecode.h>
 #include <torch/csrc/jit/mobile/import.h>
 #include <torch/csrc/jit/mobile/module.h>
 #include <torch/csrc/jit/serialization/import.h>
 #include <torch/custom_class.h>
 #include <torch/torch.h>
 
+#include <thread>
+
 // Tests go in torch::jit
 namespace torch {
 namespace jit {
@@ -308,6 +313,193 @@ void testLiteInterpreterSetState() {
   AT_ASSERT(resd == refd);
 }
 
+void testLiteInterpreterControlFlow() {
+  // Loops and branches jump between instructions that the loader fuses into
+  // superinstructions, so this checks jump targets inside fused pairs.
+  Module m("m");
+  m.define(R"(
+    def forward(self, x, n: int, flag: bool):
+      y = x
+      for _ in range(n):
+        if flag:
+          y = y + x
+        else:
+          y = y * x
+        z = y - x
+        y = z + y
+      return y
+  )");
+
+  std::stringstream ss;
+  m._save_for_mobile(ss);
+  mobile::Module bc = _load_for_mobile(ss);
+  for (bool flag : {true, false}) {
+    for (int64_t n : {0, 1, 4}) {
+      std::vector<IValue> inputs{2 * torch::ones({2, 2}), n, flag};
+      auto ref = m.forward(inputs);
+      auto res = bc.forward(inputs);
+      AT_ASSERT(res.toTensor().equal(ref.toTensor()));
+    }
+  }
+}
+
+void testLiteInterpreterFlatBytecode() {
+  Module m("m");
+  m.register_parameter("foo", torch::ones({2}), false);
+  m.define(R"(
+    def forward(self, x, n: int):
+      s = "unused"
+      y = self.foo + x
+      for _ in range(n):
+        y = y * x
+      return y.view([2, 1]), s
+  )");
+
+  std::stringstream ss;
+  m._save_for_mobile(ss);
+  std::stringstream archive(ss.str());
+  caffe2::serialize::PyTorchStreamReader reader(&archive);
+  AT_ASSERT(reader.hasRecord("bytecode.flat"));
+  mobile::Module bc = _load_for_mobile(ss);
+  std::vector<IValue> inputs{2 * torch::ones({2}), 3};
+  auto ref = m.forward(inputs).toTuple()->elements();
+  auto res = bc.forward(inputs).toTuple()->elements();
+  AT_ASSERT(res[0].toTensor().equal(ref[0].toTensor()));
+  AT_ASSERT(res[1].toStringRef() == ref[1].toStringRef());
+}
+
+namespace {
+// Copies the archive in `in` with its flat bytecode record passed through
+// `patch`.
+std::string patchFlatBytecode(
+    const std::string& in,
+    const std::function<void(std::string&)>& patch) {
+  std::stringstream in_stream(in);
+  caffe2::serialize::PyTorchStreamReader reader(&in_stream);
+  std::string out;
+  caffe2::serialize::PyTorchStreamWriter writer(
+      [&](const void* buf, size_t n) {
+        out.append(static_cast<const char*>(buf), n);
+        return n;
+      });
+  for (const auto& full_name : reader.getAllRecords()) {
+    auto name = full_name.substr(full_name.find('/') + 1);
+    if (name == "version") {
+      continue;
+    }
+    at::DataPtr ptr;
+    size_t size;
+    std::tie(ptr, size) = reader.getRecord(name);
+    std::string record(static_cast<const char*>(ptr.get()), size);
+    if (name == mobile::kFlatBytecodeRecord) {
+      patch(record);
+    }
+    writer.writeRecord(name, record.data(), record.size());
+  }
+  writer.writeEndOfFile();
+  return out;
+}
+} // namespace
+
+void testLiteInterpreterFlatBytecodeFallback() {
+  Module m("m");
+  m.define(R"(
+    def forward(self, x, n: int):
+      y = x
+      for _ in range(n):
+        y = y * x
+      return y
+  )");
+  std::stringstream ss;
+  m._save_for_mobile(ss);
+  const std::string archive = ss.str();
+  std::vector<IValue> inputs{2 * torch::ones({2}), 3};
+  auto ref = m.forward(inputs).toTensor();
+
+  // The record is used in place when the model is in memory.
+  mobile::Module in_memory = _load_for_mobile(
+      std::make_unique<caffe2::serialize::MemoryReadAdapter>(
+          archive.data(), archive.size()));
+  AT_ASSERT(in_memory.forward(inputs).toTensor().equal(ref));
+
+  // Records from another format version are ignored.
+  std::stringstream newer_version(patchFlatBytecode(archive, [](std::string& r) {
+    auto* header = reinterpret_cast<mobile::FlatBytecodeHeader*>(&r[0]);
+    header->version = mobile::kFlatBytecodeVersion + 1;
+  }));
+  AT_ASSERT(
+      _load_for_mobile(newer_version).forward(inputs).toTensor().equal(ref));
+
+  // So are records naming an opcode this build does not know.
+  std::stringstream unknown_opcode(patchFlatBytecode(archive, [](std::string& r) {
+    const auto* header =
+        reinterpret_cast<const mobile::FlatBytecodeHeader*>(r.data());
+    const auto* strings = reinterpret_cast<const mobile::FlatString*>(
+        r.data() + header->strings_offset);
+    const auto* opcodes =
+        reinterpret_cast<const uint32_t*>(r.data() + header->opcodes_offset);
+    bool patched = false;
+    for (size_t i = 0; i < header->num_opcodes; ++i) {
+      const auto& name = strings[opcodes[i]];
+      if (r.compare(name.offset, name.size, "RET") == 0) {
+        r.replace(name.offset, name.size, "XYZ");
+        patched = true;
+      }
+    }
+    AT_ASSERT(patched);
+  }));
+  AT_ASSERT(
+      _load_for_mobile(unknown_opcode).forward(inputs).toTensor().equal(ref));
+}
+
+void testLiteInterpreterMemoryReuse() {
+  Module m("m");
+  m.define(R"(
+    def forward(self, x):
+      y = x + x
+      z = y * y
+      return z + z
+  )");
+  std::stringstream ss;
+  m._save_for_mobile(ss);
+  mobile::Module bc = _load_for_mobile(ss);
+  std::vector<IValue> inputs{torch::ones({16})};
+  auto ref = m.forward(inputs).toTensor();
+
+  // off by default
+  bc.forward(inputs);
+  AT_ASSERT(bc.cached_memory_bytes() == 0);
+
+  bc.set_memory_reuse(true);
+  AT_ASSERT(bc.forward(inputs).toTensor().equal(ref));
+  auto cached = bc.cached_memory_bytes();
+  AT_ASSERT(cached > 0);
+  // Later runs take their intermediates from the pool, so it does not grow.
+  for (int i = 0; i < 3; ++i) {
+    AT_ASSERT(bc.forward(inputs).toTensor().equal(ref));
+    AT_ASSERT(bc.cached_memory_bytes() == cached);
+  }
+
+  bc.release_cached_memory();
+  AT_ASSERT(bc.cached_memory_bytes() == 0);
+  bc.set_memory_reuse(true, /*max_cached_bytes=*/0);
+  bc.forward(inputs);
+  AT_ASSERT(bc.cached_memory_bytes() == 0);
+
+  // Toggling reuse while another thread runs the module is safe, the run
+  // keeps the pool it started with.
+  std::thread toggler([&] {
+    for (int i = 0; i < 100; ++i) {
+      bc.set_memory_reuse(i % 2 == 0);
+      bc.release_cached_memory();
+    }
+  });
+  for (int i = 0; i < 100; ++i) {
+    AT_ASSERT(bc.forward(inputs).toTensor().equal(ref));
+  }
+  toggler.join();
+}
+
 class TorchBindLiteInterpreterTestStruct
     : public torch::jit::CustomClassHolder {
  public:
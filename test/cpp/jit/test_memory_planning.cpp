@@ -0,0 +1,81 @@
+#include <test/cpp/jit/test_base.h>
+#include <test/cpp/jit/test_utils.h>
+
+#include <torch/csrc/jit/ir/irparser.h>
+#include <torch/csrc/jit/passes/memory_planning.h>
+#include <torch/csrc/jit/runtime/static/impl.h>
+
+namespace torch {
+namespace jit {
+
+void testMemoryPlanning() {
+  const auto graph_string = R"IR(
+    graph(%x : Tensor, %y : Tensor):
+      %one : int = prim::Constant[value=1]()
+      %a : Tensor = aten::mul(%x, %y)
+      %b : Tensor = aten::add(%a, %x, %one)
+      %c : Tensor = aten::relu(%b)
+      %d : Tensor = aten::mul(%c, %y)
+      %e : Tensor = aten::add(%d, %c, %one)
+      return (%e))IR";
+  auto graph = std::make_shared<Graph>();
+  parseIR(graph_string, graph.get());
+
+  auto ranges = ComputePlannableLiveRanges(
+      graph, [](const Node* n) { return hasOutVariant(n); });
+  // %e escapes through the graph outputs
+  ASSERT_EQ(ranges.size(), 4);
+  for (const auto& e : ranges) {
+    ASSERT_NE(e.first, graph->outputs()[0]);
+  }
+
+  std::unordered_map<const Value*, size_t> sizes;
+  for (const auto& e : ranges) {
+    sizes[e.first] = 256;
+  }
+  auto plan = PlanMemory(ranges, sizes);
+  ASSERT_EQ(plan.offsets.size(), 4);
+  ASSERT_EQ(plan.unplanned_size, 4 * 256);
+  // at most two of the intermediates are live at the same time
+  ASSERT_EQ(plan.arena_size, 2 * 256);
+  for (const auto& a : plan.offsets) {
+    for (const auto& b : plan.offsets) {
+      if (a.first == b.first) {
+        continue;
+      }
+      const auto& ra = ranges.at(a.first);
+      const auto& rb = ranges.at(b.first);
+      if (ra.begin <= rb.end && rb.begin <= ra.end) {
+        ASSERT_NE(a.second, b.second);
+      }
+    }
+  }
+
+  StaticModule module(graph);
+  StaticRuntime runtime(module);
+  auto x = at::randn({4, 8});
+  auto y = at::randn({4, 8});
+  auto c = at::relu(x * y + x);
+  auto expected = c * y + c;
+  for (int i = 0; i < 3; ++i) {
+    auto outputs = runtime.run({x, y});
+    ASSERT_TRUE(outputs[0].toTensor().allclose(expected));
+  }
+  auto profile = runtime.planner().find({x, y});
+  ASSERT_TRUE(profile);
+  ASSERT_EQ(profile->plan.offsets.size(), 4);
+
+  // a new shape profile gets its own arena
+  auto x2 = at::randn({2, 3});
+  auto y2 = at::randn({2, 3});
+  ASSERT_FALSE(runtime.planner().find({x2, y2}));
+  for (int i = 0; i < 2; ++i) {
+    auto c2 = at::relu(x2 * y2 + x2);
+    auto outputs = runtime.run({x2, y2});
+    ASSERT_TRUE(outputs[0].toTensor().allclose(c2 * y2 + c2));
+  }
+  ASSERT_TRUE(runtime.planner().find({x2, y2}));
+}
+
+} // namespace jit
+} // namespace torch
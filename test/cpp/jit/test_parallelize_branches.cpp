@@ -0,0 +1,60 @@
+#include <torch/csrc/jit/ir/ir.h>
+#include <torch/csrc/jit/ir/irparser.h>
+#include <torch/csrc/jit/passes/parallelize_branches.h>
+#include <torch/csrc/jit/passes/shape_analysis.h>
+#include <torch/csrc/jit/testing/file_check.h>
+#include "test/cpp/jit/test_base.h"
+
+namespace torch {
+namespace jit {
+
+void testParallelizeBranches() {
+  const auto graph_string = R"IR(
+    graph(%x : Float(64, 64), %w1 : Float(64, 64), %w2 : Float(64, 64)):
+      %zero : int = prim::Constant[value=0]()
+      %a1 : Tensor = aten::mm(%x, %w1)
+      %a2 : Tensor = aten::relu(%a1)
+      %a3 : Tensor = aten::mm(%a2, %w1)
+      %b1 : Tensor = aten::mm(%x, %w2)
+      %b2 : Tensor = aten::tanh(%b1)
+      %b3 : Tensor = aten::mm(%b2, %w2)
+      %b4 : Tensor = aten::mm(%b3, %w2)
+      %l : Tensor[] = prim::ListConstruct(%a3, %b4)
+      %c : Tensor = aten::cat(%l, %zero)
+      return (%c))IR";
+  {
+    auto graph = std::make_shared<Graph>();
+    parseIR(graph_string, graph.get());
+    PropagateInputShapes(graph);
+    // one operation per element of the [128, 64] output of cat
+    ASSERT_EQ(EstimateFlops(graph->outputs()[0]->node()), 128 * 64);
+    ParallelizeBranches(graph, 64 * 64 * 64);
+    graph->lint();
+    // the cheaper tower is forked, the other one runs inline until the join
+    Node* fork = graph->nodes().front();
+    ASSERT_EQ(fork->kind(), prim::fork);
+    testing::FileCheck()
+        .check("prim::fork")
+        ->check("aten::tanh")
+        ->check("aten::wait")
+        ->check("aten::cat")
+        ->run(*graph);
+    testing::FileCheck()
+        .check("aten::mm")
+        ->check("aten::relu")
+        ->check("aten::mm")
+        ->check_not("aten::tanh")
+        ->run(*fork->g(attr::Subgraph));
+  }
+  {
+    // too cheap to be worth a fork
+    auto graph = std::make_shared<Graph>();
+    parseIR(graph_string, graph.get());
+    PropagateInputShapes(graph);
+    ParallelizeBranches(graph, 1 << 30);
+    testing::FileCheck().check_not("prim::fork")->run(*graph);
+  }
+}
+
+} // namespace jit
+} // namespace torch
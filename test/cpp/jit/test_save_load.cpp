@@ -3,9 +3,11 @@
 
 #include <sstream>
 
+#include <torch/csrc/jit/runtime/graph_executor.h>
 #include <torch/csrc/jit/serialization/export.h>
 #include <torch/csrc/jit/serialization/import.h>
 #include <torch/csrc/jit/serialization/import_source.h>
+#include <torch/csrc/jit/serialization/optimized_plans.h>
 #include <torch/torch.h>
 
 namespace torch {
@@ -57,6 +59,68 @@ void testSaveExtraFilesHook() {
 }
 
 
+void testSaveLoadOptimizedPlans() {
+  const bool executor_mode = getExecutorMode();
+  const bool profiling_mode = getProfilingMode();
+  getExecutorMode() = true;
+  getProfilingMode() = true;
+  getSaveOptimizedPlans() = true;
+
+  auto x = at::randn({4, 4});
+  std::stringstream ss;
+  {
+    Module m("__torch__.m");
+    m.register_parameter("w", at::randn({4, 4}), false);
+    m.define(R"(
+      def forward(self, x):
+          return x * self.w + x
+    )");
+    // profile, then optimize
+    for (size_t i = 0; i <= getNumProfiledRuns(); ++i) {
+      m.forward({x});
+    }
+    ASSERT_EQ(
+        m.get_method("forward").get_executor().getOptimizedGraphs().size(), 1);
+    m.save(ss);
+  }
+  ss.seekg(0);
+  auto loaded = jit::load(ss);
+  auto& executor = loaded.get_method("forward").get_executor();
+  // installed without running
+  auto graphs = executor.getOptimizedGraphs();
+  ASSERT_EQ(graphs.size(), 1);
+  auto w = loaded.attr("w").toTensor();
+  ASSERT_TRUE(loaded.forward({x}).toTensor().allclose(x * w + x));
+
+  // round trip of the graph encoding
+  auto copy = decodeGraph(
+      encodeGraph(*graphs[0]), *loaded._ivalue()->compilation_unit());
+  auto kinds = [](const std::shared_ptr<Graph>& g) {
+    std::vector<Symbol> result;
+    for (const Node* n : g->nodes()) {
+      result.push_back(n->kind());
+    }
+    return result;
+  };
+  ASSERT_EQ(kinds(graphs[0]), kinds(copy));
+
+  // a malformed plan fails to decode, rather than later when it runs
+  using c10::ivalue::Tuple;
+  auto empty = Tuple::create({});
+  auto node = Tuple::create({std::string("aten::relu"),
+                             Tuple::create({IValue(int64_t(5))}),
+                             empty,
+                             empty,
+                             empty});
+  auto broken = Tuple::create({empty, Tuple::create({node}), empty});
+  ASSERT_ANY_THROW(
+      decodeGraph(broken, *loaded._ivalue()->compilation_unit()));
+
+  getSaveOptimizedPlans() = false;
+  getExecutorMode() = executor_mode;
+  getProfilingMode() = profiling_mode;
+}
+
 // TODO: Re-enable when add_type_tags is true
 void testTypeTags() {
 //   auto list = c10::List<c10::List<int64_t>>();
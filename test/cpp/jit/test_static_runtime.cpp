@@ -0,0 +1,69 @@
+#include <test/cpp/jit/test_base.h>
+#include <test/cpp/jit/test_utils.h>
+
+#include <torch/csrc/jit/passes/freeze_module.h>
+#include <torch/csrc/jit/runtime/static/impl.h>
+
+namespace torch {
+namespace jit {
+
+void testStaticRuntime() {
+  Module m("m");
+  m.register_attribute("training", BoolType::get(), false);
+  m.register_parameter("weight", at::randn({16, 8}), false);
+  m.register_parameter("bias", at::randn({16}), false);
+  m.define(R"(
+    def forward(self, x, y):
+        a = torch.linear(x, self.weight, self.bias)
+        b = torch.relu(a + y)
+        c = torch.cat([b, a], 1)
+        return torch.sigmoid(c.t()), b.view([-1])
+  )");
+  auto frozen = freeze_module(m);
+  StaticModule static_module(frozen);
+  ASSERT_EQ(static_module.num_inputs(), 2);
+
+  for (int64_t batch : {1, 4, 4, 1}) {
+    auto x = at::randn({batch, 8});
+    auto y = at::randn({batch, 16});
+    auto expected = frozen.forward({x, y}).toTuple()->elements();
+    for (int i = 0; i < 2; ++i) {
+      auto outputs = static_module({x, y}).toTuple()->elements();
+      ASSERT_EQ(outputs.size(), 2);
+      ASSERT_TRUE(outputs[0].toTensor().allclose(expected[0].toTensor()));
+      ASSERT_TRUE(outputs[1].toTensor().allclose(expected[1].toTensor()));
+    }
+  }
+
+  // outputs must not be overwritten by later runs
+  auto x = at::randn({2, 8});
+  auto y = at::randn({2, 16});
+  auto first = static_module.run({x, y});
+  auto first_copy = first[0].clone();
+  static_module.run({at::randn({2, 8}), at::randn({2, 16})});
+  ASSERT_TRUE(first[0].equal(first_copy));
+}
+
+void testStaticRuntimeMixedDtypes() {
+  Module m("m");
+  m.register_attribute("training", BoolType::get(), false);
+  m.define(R"(
+    def forward(self, x, y):
+        return torch.relu(x + y) * y
+  )");
+  auto frozen = freeze_module(m);
+  StaticModule static_module(frozen);
+
+  // outputs of the previous run are only reused for the same dtype
+  for (auto dtype : {at::kFloat, at::kDouble, at::kDouble, at::kFloat}) {
+    auto x = at::randn({3, 4}, dtype);
+    auto y = at::randn({3, 4}, dtype);
+    auto expected = frozen.forward({x, y}).toTensor();
+    auto output = static_module.run({x, y})[0];
+    ASSERT_EQ(output.scalar_type(), dtype);
+    ASSERT_TRUE(output.allclose(expected));
+  }
+}
+
+} // namespace jit
+} // namespace torch
@@ -66,8 +66,22 @@ namespace jit {
   _(ProfiledTensorTypeHashing)         \
   _(ScriptObject)                      \
   _(SaveExtraFilesHook)                \
+  _(SaveLoadOptimizedPlans)            \
   _(TypeTags)                          \
   _(DCE)                               \
+  _(MemoryPlanning)                    \
+  _(StaticRuntime)                     \
+  _(StaticRuntimeMixedDtypes)          \
+  _(BackgroundCompilation)             \
+  _(BackgroundCompilationFailure)      \
+  _(ParallelizeBranches)               \
+  _(HorizontalFusion)                  \
+  _(HorizontalFusionViewConsumer)      \
+  _(HorizontalFusionMutatedInput)      \
+  _(OptimizeFrozenGraph)               \
+  _(FoldFrozenConvBatchNorm)           \
+  _(PropagateFrozenMKLDNNLayout)       \
+  _(PropagateFrozenMKLDNNLayoutOperands) \
   _(CustomFusionNestedBlocks)          \
   _(ClassDerive)                       \
   _(SaveLoadTorchbind)                 \
@@ -88,6 +102,10 @@ namespace jit {
   _(LiteInterpreterWrongMethodName)    \
   _(LiteInterpreterParams)             \
   _(LiteInterpreterSetState)           \
+  _(LiteInterpreterControlFlow)        \
+  _(LiteInterpreterFlatBytecode)       \
+  _(LiteInterpreterFlatBytecodeFallback) \
+  _(LiteInterpreterMemoryReuse)        \
   _(TorchbindIValueAPI)
 
 #define TH_FORALL_TESTS_CUDA(_) \
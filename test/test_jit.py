@@ -56,6 +56,7 @@ from torch.quantization import quantize
 from torch.testing._internal.common_quantization import SingleLayerLinearModel, AnnotatedSingleLayerLinearModel
 from torch.testing._internal.common_quantization import ConvModel, AnnotatedConvModel
 from torch.testing._internal.common_quantization import test_only_eval_fn as _test_only_eval_fn
+from torch.testing._internal.common_quantized import override_quantized_engine
 
 
 # Testing utils
@@ -1148,6 +1149,41 @@ graph(%x : Tensor,
                    .check('Observer = prim::GetAttr[name="_observer_') \
                    .run(str(get_forward_graph(m._c)))
 
+    def test_insert_observers_skip_linear_add(self):
+        class LinearAdd(torch.nn.Module):
+            def __init__(self, inplace):
+                super(LinearAdd, self).__init__()
+                self.linear = torch.nn.Linear(5, 5)
+                self.inplace = inplace
+
+            def forward(self, x, y):
+                out = self.linear(x)
+                if self.inplace:
+                    out += y
+                else:
+                    out = out + y
+                return out
+
+        def num_observers(m):
+            return sum(1 for module in [m, m.linear]
+                       for x, _ in module._modules._c.items()
+                       if x.startswith('_observer_'))
+
+        qconfig_dict = {'': script_qconfig(default_qconfig)}
+        engines = [e for e in ['fbgemm', 'qnnpack']
+                   if e in torch.backends.quantized.supported_engines]
+        for inplace in [True, False]:
+            counts = {}
+            for engine in engines:
+                with override_quantized_engine(engine):
+                    m = torch.jit.script(LinearAdd(inplace))
+                    m = wrap_cpp_module(torch._C._jit_pass_insert_observers(m._c, "forward", qconfig_dict, False))
+                    counts[engine] = num_observers(m)
+            # the output of linear is only left unobserved when it will be
+            # fused into quantized::linear_add, which needs FBGEMM
+            if len(counts) == 2:
+                self.assertEqual(counts['fbgemm'], counts['qnnpack'] - 1)
+
     def test_insert_observers_weight_dtype(self):
         class M(torch.nn.Module):
             def __init__(self):
@@ -1495,6 +1531,43 @@ graph(%packed_params_module, %a, %a_scale, %a_zero_point, %a_dtype, %r_scale, %r
             torch._C._jit_pass_quant_fusion(graph)
             FileCheck().run(input_str, graph)
 
+    @unittest.skipUnless('fbgemm' in torch.backends.quantized.supported_engines,
+                         " Quantized operations require FBGEMM. FBGEMM is only optimized for CPUs"
+                         " with instruction set support avx2 or newer.")
+    def test_quant_fusion_linear_add(self):
+        # aten::linear + aten::add(_) -> quantized::linear_add, which only
+        # has an FBGEMM kernel
+        for add_op in ["aten::add_", "aten::add"]:
+            input_str = """
+graph(%packed_params_module, %a, %other, %a_scale, %a_zero_point, %a_dtype, %r_scale, %r_zero_point, %r_dtype):
+        %alpha = prim::Constant[value=1]()
+        %a_quant = aten::quantize_per_tensor(%a, %a_scale, %a_zero_point, %a_dtype)
+        %a_dequant = aten::dequantize(%a_quant)
+        %other_quant = aten::quantize_per_tensor(%other, %a_scale, %a_zero_point, %a_dtype)
+        %packed_params = prim::GetAttr[name="_packed_params"](%packed_params_module)
+        %w_quant : Tensor, %b : Tensor? = quantized::linear_unpack(%packed_params)
+        %w_dequant = aten::dequantize(%w_quant)
+        # CHECK: quantized::linear_add
+        # CHECK-NOT: aten::linear
+        # CHECK-NOT: {add_op}(
+        %linear_out = aten::linear(%a_dequant, %w_dequant, %b)
+        %other_dequant = aten::dequantize(%other_quant)
+        %r = {add_op}(%linear_out, %other_dequant, %alpha)
+        %r_quant = aten::quantize_per_tensor(%r, %r_scale, %r_zero_point, %r_dtype)
+        %r_dequant = aten::dequantize(%r_quant)
+        return (%r_dequant)""".replace("{add_op}", add_op)
+            with override_quantized_engine('fbgemm'):
+                graph = parse_ir(input_str)
+                torch._C._jit_pass_quant_fusion(graph)
+                FileCheck().run(input_str, graph)
+            if 'qnnpack' in torch.backends.quantized.supported_engines:
+                with override_quantized_engine('qnnpack'):
+                    graph = parse_ir(input_str)
+                    torch._C._jit_pass_quant_fusion(graph)
+                    FileCheck().check_not("quantized::linear_add") \
+                               .check(add_op + "(") \
+                               .run(graph)
+
     @unittest.skipUnless('fbgemm' in torch.backends.quantized.supported_engines,
                          " Quantized operations require FBGEMM. FBGEMM is only optimized for CPUs"
                          " with instruction set support avx2 or newer.")
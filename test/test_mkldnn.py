@@ -12,6 +12,7 @@ skipIfNoTorchVision = unittest.skipIf(not HAS_TORCHVISION, "no torchvision")
 
 import torch
 import torch.jit
+import torch.nn.functional as F
 from torch.utils import mkldnn as mkldnn_utils
 from torch.testing._internal.common_utils import TestCase, run_tests, TemporaryFileName
 
@@ -122,6 +123,20 @@ class TestMkldnn(TestCase):
                 self._test_serialization(mkldnn_conv2d, (x.to_mkldnn(),))
                 self._test_tracing(mkldnn_conv2d, (x.to_mkldnn(),))
 
+    def test_conv2d_weight_update(self):
+        # reordered dense weights are cached across calls and must be
+        # refreshed after an in-place update
+        for groups in [1, 4]:
+            conv2d = torch.nn.Conv2d(8, 8, 3, padding=1, groups=groups).float()
+            x = torch.randn(1, 8, 16, 16, dtype=torch.float32)
+            with torch.no_grad():
+                with torch.backends.mkldnn.flags(enabled=False):
+                    ref = conv2d(x)
+                self.assertEqual(ref, conv2d(x))
+                self.assertEqual(ref, conv2d(x))
+                conv2d.weight.mul_(2)
+                self.assertEqual(ref * 2 - conv2d.bias.view(1, -1, 1, 1), conv2d(x))
+
     def test_conv2d_legacy_jit_model(self):
         """
         MKLDNN integration used to serialize models with 5d weight for grouped
@@ -154,6 +169,23 @@ class TestMkldnn(TestCase):
         x = torch.randn((4, 5), dtype=torch.float32) * 10
         self.assertEqual(torch.relu(x), torch.relu(x.to_mkldnn()).to_dense())
 
+    def test_hardtanh(self):
+        x = torch.randn((4, 5), dtype=torch.float32) * 10
+        for min_val, max_val in [(0., 6.), (-1., 1.)]:
+            self.assertEqual(F.hardtanh(x, min_val, max_val),
+                             F.hardtanh(x.to_mkldnn(), min_val, max_val).to_dense())
+            x2 = x.clone().to_mkldnn()
+            F.hardtanh(x2, min_val, max_val, inplace=True)
+            self.assertEqual(F.hardtanh(x, min_val, max_val), x2.to_dense())
+
+    def test_cat(self):
+        x = torch.randn(2, 3, 4, 4, dtype=torch.float32)
+        y = torch.randn(2, 5, 4, 4, dtype=torch.float32)
+        self.assertEqual(torch.cat([x, y], 1),
+                         torch.cat([x.to_mkldnn(), y.to_mkldnn()], 1).to_dense())
+        self.assertEqual(torch.cat([x, y], -3),
+                         torch.cat([x.to_mkldnn(), y.to_mkldnn()], -3).to_dense())
+
     def test_relu_(self):
         x1 = torch.randn((4, 5), dtype=torch.float32) * 10
         x2 = x1.clone().to_mkldnn()
@@ -361,6 +393,16 @@ class TestMkldnn(TestCase):
             self._test_serialization(mkldnn_linear, (x.to_mkldnn(),))
             self._test_tracing(mkldnn_linear, (x.to_mkldnn(),))
 
+    def test_linear_weight_update(self):
+        linear = torch.nn.Linear(16, 32, bias=False).float()
+        mkldnn_linear = mkldnn_utils.to_mkldnn(copy.deepcopy(linear))
+        x = torch.randn(3, 16, dtype=torch.float32)
+        with torch.no_grad():
+            self.assertEqual(linear(x), mkldnn_linear(x.to_mkldnn()).to_dense())
+            self.assertEqual(linear(x), mkldnn_linear(x.to_mkldnn()).to_dense())
+            mkldnn_linear.weight.mul_(2)
+            self.assertEqual(linear(x) * 2, mkldnn_linear(x.to_mkldnn()).to_dense())
+
     def test_softmax(self):
         x = torch.randn(3, 4, 5, dtype=torch.float32) * 10
         for dim in range(x.ndim):
@@ -1545,6 +1545,132 @@ class RecordHistogramObserverTest(QuantizationTestCase):
         self.assertEqual(myobs.bins, loaded_obs.bins)
         self.assertEqual(myobs.calculate_qparams(), loaded_obs.calculate_qparams())
 
+    @given(N=st.sampled_from([10, 1000, 100000]),
+           bins=st.sampled_from([3, 256, 2048]),
+           upsample_rate=st.sampled_from([1, 128]))
+    def test_histogram_observer_native_update(self, N, bins, upsample_rate):
+        x = torch.randn(N)
+        y = torch.randn(N) * 4 + 1
+        empty = torch.tensor([])
+        hist, min_val, max_val = torch._histogram_observer_update(
+            x, torch.zeros(bins), empty, empty, upsample_rate)
+        self.assertEqual(min_val, x.min())
+        self.assertEqual(max_val, x.max())
+        self.assertEqual(hist, torch.histc(x, bins, min=x.min(), max=x.max()))
+
+        # Growing the range resamples the histogram without losing counts
+        hist, min_val, max_val = torch._histogram_observer_update(
+            y, hist, min_val, max_val, upsample_rate)
+        self.assertLessEqual(min_val.item(), min(x.min(), y.min()).item())
+        self.assertGreaterEqual(max_val.item(), max(x.max(), y.max()).item())
+        self.assertAlmostEqual(hist.sum().item(), 2 * N, delta=1e-3 * N)
+
+        new_min, new_max = torch._histogram_observer_search(hist, min_val, max_val, 256)
+        self.assertGreaterEqual(new_min.item(), min_val.item())
+        self.assertLessEqual(new_max.item(), max_val.item() + 1e-5)
+        self.assertLess(new_min.item(), new_max.item())
+
+    def _reference_non_linear_param_search(self, histogram, min_val, max_val, dst_nbins):
+        r"""The Python search HistogramObserver used before it moved to
+        torch._histogram_observer_search, kept as the reference for it."""
+        hist = histogram.double().tolist()
+        bins = len(hist)
+        min_val = min_val.item()
+        bin_width = (max_val.item() - min_val) / bins
+
+        def _get_norm(delta_begin, delta_end, density):
+            return density * (delta_end ** 3 - delta_begin ** 3) / 3
+
+        def _compute_quantization_error(next_start_bin, next_end_bin):
+            norm = 0.0
+            dst_bin_width = bin_width * (next_end_bin - next_start_bin + 1) / dst_nbins
+            if dst_bin_width == 0.0:
+                return 0.0
+            for src_bin in range(bins):
+                src_bin_begin = (src_bin - next_start_bin) * bin_width
+                src_bin_end = src_bin_begin + bin_width
+                dst_bin_of_begin = min(
+                    dst_nbins - 1, max(0.0, math.floor(src_bin_begin / dst_bin_width)))
+                dst_bin_of_end = min(
+                    dst_nbins - 1, max(0.0, math.floor(src_bin_end / dst_bin_width)))
+                dst_bin_of_begin_center = dst_bin_of_begin * dst_bin_width + dst_bin_width / 2
+                density = hist[src_bin] / bin_width
+                if dst_bin_of_begin == dst_bin_of_end:
+                    norm += _get_norm(src_bin_begin - dst_bin_of_begin_center,
+                                      src_bin_end - dst_bin_of_begin_center, density)
+                else:
+                    norm += _get_norm(src_bin_begin - dst_bin_of_begin_center,
+                                      dst_bin_width / 2, density)
+                    norm += (dst_bin_of_end - dst_bin_of_begin - 1) * _get_norm(
+                        -dst_bin_width / 2, dst_bin_width / 2, density)
+                    dst_bin_of_end_center = dst_bin_of_end * dst_bin_width + dst_bin_width / 2
+                    norm += _get_norm(-dst_bin_width / 2,
+                                      src_bin_end - dst_bin_of_end_center, density)
+            return norm
+
+        total = sum(hist)
+        cSum = []
+        acc = 0.0
+        for h in hist:
+            acc += h
+            cSum.append(acc)
+
+        stepsize = 1e-5
+        alpha = 0.0
+        beta = 1.0
+        start_bin = 0
+        end_bin = bins - 1
+        norm_min = float("inf")
+        while alpha < beta:
+            next_alpha = alpha + stepsize
+            next_beta = beta - stepsize
+            l = start_bin
+            r = end_bin
+            while l < end_bin and cSum[l] < next_alpha * total:
+                l = l + 1
+            while r > start_bin and cSum[r] > next_beta * total:
+                r = r - 1
+            next_start_bin = start_bin
+            next_end_bin = end_bin
+            if (l - start_bin) > (end_bin - r):
+                next_start_bin = l
+                alpha = next_alpha
+            else:
+                next_end_bin = r
+                beta = next_beta
+            if next_start_bin == start_bin and next_end_bin == end_bin:
+                continue
+            norm = _compute_quantization_error(next_start_bin, next_end_bin)
+            if norm > norm_min:
+                break
+            norm_min = norm
+            start_bin = next_start_bin
+            end_bin = next_end_bin
+
+        return min_val + bin_width * start_bin, min_val + bin_width * (end_bin + 1)
+
+    def test_histogram_observer_search_matches_reference(self):
+        for seed in range(3):
+            for bins in [16, 256, 2048]:
+                torch.manual_seed(seed)
+                # a bulk with a few outliers on each side, so both quantile
+                # bounds move before the error starts to grow
+                x = torch.cat([torch.randn(10000), torch.rand(20) * 40 - 20,
+                               torch.distributions.Exponential(0.5).sample((500,))])
+                obs = HistogramObserver(bins=bins)
+                obs(x)
+                obs(x * 1.5 + 0.5)
+                ref_min, ref_max = self._reference_non_linear_param_search(
+                    obs.histogram, obs.min_val, obs.max_val, obs.dst_nbins)
+                new_min, new_max = obs._non_linear_param_search()
+                # the bounds are float32, picking another bin is off by a
+                # whole bin width
+                bin_width = (obs.max_val - obs.min_val).item() / bins
+                self.assertAlmostEqual(new_min.item(), ref_min, delta=bin_width / 2,
+                                       msg="seed {} bins {}".format(seed, bins))
+                self.assertAlmostEqual(new_max.item(), ref_max, delta=bin_width / 2,
+                                       msg="seed {} bins {}".format(seed, bins))
+
 
 if __name__ == '__main__':
     run_tests()
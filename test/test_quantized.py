@@ -1423,6 +1423,71 @@ class TestQuantizedOps(TestCase):
             quantize_ref = torch.quantize_per_tensor(float_ref, Y_scale, Y_zero_point, dtype_x)
             self.assertEqual(qy.int_repr().numpy(), quantize_ref.int_repr().numpy())
 
+    """Tests the correctness of the quantized::layer_norm op."""
+    @given(X=hu.tensor(shapes=hu.array_shapes(min_dims=2, max_dims=3,
+                                              min_side=1, max_side=40),
+                       elements=hu.floats(-1e3, 1e3, allow_nan=False, allow_infinity=False),
+                       qparams=hu.qparams(dtypes=[torch.quint8, torch.qint8])),
+           Y_scale=st.floats(0.01, 0.2),
+           Y_zero_point=st.integers(0, 5),
+           affine=st.booleans())
+    def test_qlayer_norm(self, X, Y_scale, Y_zero_point, affine):
+        X, (scale_x, zero_point_x, dtype_x) = X
+        X = torch.from_numpy(X)
+        normalized_shape = list(X.shape[1:])
+        weight = torch.rand(normalized_shape) if affine else None
+        bias = torch.rand(normalized_shape) if affine else None
+        eps = 1e-5
+
+        qx = torch.quantize_per_tensor(X, scale_x, zero_point_x, dtype_x)
+        qy = torch.ops.quantized.layer_norm(qx, normalized_shape, weight, bias, eps,
+                                            Y_scale, Y_zero_point)
+
+        float_ref = F.layer_norm(qx.dequantize(), normalized_shape, weight=weight,
+                                 bias=bias, eps=eps)
+        quantize_ref = torch.quantize_per_tensor(float_ref, Y_scale, Y_zero_point, dtype_x)
+        # The kernel computes the moments on the integer representation, so
+        # results may land on the neighbouring quantization level.
+        diff = qy.int_repr().to(torch.int32) - quantize_ref.int_repr().to(torch.int32)
+        self.assertLessEqual(diff.abs().max().item(), 1)
+
+    """Tests the correctness of the quantized::gelu op."""
+    @given(X=hu.tensor(shapes=hu.array_shapes(1, 5, 1, 5),
+                       qparams=hu.qparams(dtypes=[torch.quint8, torch.qint8])),
+           Y_scale=st.floats(0.01, 0.2),
+           Y_zero_point=st.integers(0, 5))
+    def test_qgelu(self, X, Y_scale, Y_zero_point):
+        X, (scale, zero_point, torch_type) = X
+        X = torch.from_numpy(X)
+        qX = torch.quantize_per_tensor(X, scale=scale, zero_point=zero_point,
+                                       dtype=torch_type)
+        qY = torch.ops.quantized.gelu(qX, Y_scale, Y_zero_point)
+
+        qY_hat = torch.quantize_per_tensor(F.gelu(qX.dequantize()), scale=Y_scale,
+                                           zero_point=Y_zero_point, dtype=torch_type)
+        diff = qY.int_repr().to(torch.int32) - qY_hat.int_repr().to(torch.int32)
+        self.assertLessEqual(diff.abs().max().item(), 1)
+
+    """Tests the correctness of the quantized::softmax op."""
+    @given(X=hu.tensor(shapes=hu.array_shapes(1, 4, 1, 40),
+                       qparams=hu.qparams(dtypes=[torch.quint8, torch.qint8])),
+           dim=st.integers(-1, 3))
+    def test_qsoftmax(self, X, dim):
+        X, (scale, zero_point, torch_type) = X
+        X = torch.from_numpy(X)
+        assume(dim < X.dim())
+        qX = torch.quantize_per_tensor(X, scale=scale, zero_point=zero_point,
+                                       dtype=torch_type)
+        q_min = torch.iinfo(torch_type).min
+        Y_scale = 1.0 / 256
+        Y_zero_point = q_min if torch_type == torch.qint8 else 0
+        qY = torch.ops.quantized.softmax(qX, dim, Y_scale, Y_zero_point)
+
+        qY_hat = torch.quantize_per_tensor(torch.softmax(qX.dequantize(), dim), scale=Y_scale,
+                                           zero_point=Y_zero_point, dtype=torch_type)
+        diff = qY.int_repr().to(torch.int32) - qY_hat.int_repr().to(torch.int32)
+        self.assertLessEqual(diff.abs().max().item(), 1)
+
 @unittest.skipUnless('fbgemm' in torch.backends.quantized.supported_engines,
                      " Quantized operations require FBGEMM. FBGEMM is only optimized for CPUs"
                      " with instruction set support avx2 or newer.")
@@ -1626,6 +1691,57 @@ class TestDynamicQuantizedLinear(TestCase):
         self.assertEqual(Y_fp32, Y_fp32_ref,
                          message="torch.ops.quantized.fbgemm_linear_dynamic results are off")
 
+    """Tests the dynamic quantized linear op with per-token input quantization."""
+    @given(batch_size=st.integers(1, 8),
+           input_channels=st.integers(16, 32),
+           output_channels=st.integers(4, 8),
+           use_bias=st.booleans(),
+           use_relu=st.booleans(),
+           use_channelwise=st.booleans())
+    def test_qlinear_per_token(self, batch_size, input_channels, output_channels,
+                               use_bias, use_relu, use_channelwise):
+        if 'fbgemm' not in torch.backends.quantized.supported_engines:
+            return
+        with override_quantized_engine('fbgemm'):
+            X = torch.randn(batch_size, input_channels)
+            # One outlier token, which would set the range for every row under
+            # per-tensor quantization.
+            X[0] *= 100
+            W = torch.randn(output_channels, input_channels)
+            b = torch.randn(output_channels) if use_bias else None
+            if use_channelwise:
+                W_scales = W.abs().max(dim=1)[0].double() / 127
+                W_zps = torch.zeros(output_channels, dtype=torch.long)
+                W_q = torch.quantize_per_channel(W, W_scales, W_zps, 0, torch.qint8)
+            else:
+                W_q = torch.quantize_per_tensor(W, W.abs().max().item() / 127, 0, torch.qint8)
+            W_prepack = torch.ops.quantized.linear_prepack(W_q, b)
+
+            if use_relu:
+                qlinear = torch.ops.quantized.linear_relu_dynamic_per_token
+            else:
+                qlinear = torch.ops.quantized.linear_dynamic_per_token
+            Y = qlinear(X, W_prepack)
+
+            # Reference: quantize every row with its own parameters.
+            X_dq = torch.empty_like(X)
+            for i in range(batch_size):
+                scale, zp = _calculate_dynamic_qparams(X[i], torch.quint8)
+                X_dq[i] = torch.quantize_per_tensor(X[i], scale, zp, torch.quint8).dequantize()
+            Y_ref = F.linear(X_dq, W_q.dequantize(), b)
+            if use_relu:
+                Y_ref = F.relu(Y_ref)
+            self.assertEqual(Y, Y_ref, prec=1e-3 * max(1.0, Y_ref.abs().max().item()))
+
+            # The rows without the outlier are more accurate than with a single
+            # per-tensor range.
+            if batch_size > 1 and not use_relu:
+                Y_per_tensor = torch.ops.quantized.linear_dynamic(X, W_prepack)
+                Y_fp32 = F.linear(X, W_q.dequantize(), b)
+                err_per_token = (Y[1:] - Y_fp32[1:]).abs().max()
+                err_per_tensor = (Y_per_tensor[1:] - Y_fp32[1:]).abs().max()
+                self.assertLessEqual(err_per_token.item(), err_per_tensor.item())
+
 class TestQuantizedLinear(unittest.TestCase):
     """Tests the correctness of the quantized linear and linear_relu op."""
     @given(batch_size=st.integers(1, 4),
@@ -1805,6 +1921,180 @@ class TestQuantizedLinear(unittest.TestCase):
                 np.testing.assert_equal(
                     W_q.q_zero_point(), W_q_origin.q_zero_point())
 
+    @given(batch_size=st.integers(1, 4),
+           input_channels=st.integers(16, 32),
+           output_channels=st.integers(4, 8),
+           use_relu=st.booleans())
+    @unittest.skipUnless('fbgemm' in torch.backends.quantized.supported_engines,
+                         " Quantized operations require FBGEMM. FBGEMM is only optimized for CPUs"
+                         " with instruction set support avx2 or newer.")
+    def test_qlinear_add(self, batch_size, input_channels, output_channels,
+                         use_relu):
+        with override_quantized_engine('fbgemm'):
+            # Small value ranges keep the fbgemm int16 accumulation from
+            # saturating.
+            X_scale, W_scale = 0.05, 0.01
+            X = torch.randint(0, 64, (batch_size, input_channels)).float() * X_scale
+            W = torch.randint(-64, 64, (output_channels, input_channels)).float() * W_scale
+            b = torch.rand(output_channels) - 0.5
+            other = torch.rand(batch_size, output_channels) * 4 - 2
+            X_q = torch.quantize_per_tensor(X, X_scale, 0, torch.quint8)
+            W_q = torch.quantize_per_tensor(W, W_scale, 0, torch.qint8)
+            other_q = torch.quantize_per_tensor(other, 4.0 / 255, 128, torch.quint8)
+            Y_scale, Y_zp = 0.1, 128 if not use_relu else 0
+
+            W_prepack = torch.ops.quantized.linear_prepack(W_q, b)
+            if use_relu:
+                qlinear_add = torch.ops.quantized.linear_add_relu
+            else:
+                qlinear_add = torch.ops.quantized.linear_add
+            Y_q = qlinear_add(X_q, W_prepack, other_q, Y_scale, Y_zp)
+
+            # The reference dequantizes the exact int32 accumulators like
+            # ReQuantizeForFloat does and adds the residual before the only
+            # rounding to the output scale, so any intermediate requantization
+            # shows up as a mismatch.
+            acc = torch.mm(X_q.int_repr().long(), W_q.int_repr().long().t())
+            Y_ref = acc.float() * (X_scale * W_scale) + b + other_q.dequantize()
+            if use_relu:
+                Y_ref = F.relu(Y_ref)
+            Y_ref_q = torch.quantize_per_tensor(Y_ref, Y_scale, Y_zp, torch.quint8)
+            np.testing.assert_equal(Y_q.int_repr().numpy(), Y_ref_q.int_repr().numpy())
+
+    def _sparse_block_mask(self, pattern, output_channels, n_blocks):
+        rows = torch.arange(output_channels).unsqueeze(1)
+        cols = torch.arange(n_blocks).unsqueeze(0)
+        if pattern == "random":
+            return torch.rand(output_channels, n_blocks) < 0.1
+        if pattern == "checkerboard":
+            return (rows + cols) % 2 == 0
+        if pattern == "diagonal":
+            return cols == rows % n_blocks
+        if pattern == "zero_rows":
+            return (rows % 3 == 0).expand(output_channels, n_blocks)
+        if pattern == "last_block":
+            return (cols == n_blocks - 1).expand(output_channels, n_blocks)
+        assert pattern == "empty"
+        return torch.zeros(output_channels, n_blocks, dtype=torch.bool)
+
+    """Tests quantized::linear with block sparse weights against an exact
+    integer reference and against the dense kernels of the engine."""
+    @given(batch_size=st.integers(1, 20),
+           input_channels=st.integers(1, 70),
+           output_channels=st.integers(1, 16),
+           pattern=st.sampled_from(("random", "checkerboard", "diagonal",
+                                    "zero_rows", "last_block", "empty")),
+           use_relu=st.booleans(),
+           use_channelwise=st.booleans(),
+           qengine=st.sampled_from(("qnnpack", "fbgemm")))
+    def test_qlinear_sparse(self, batch_size, input_channels, output_channels,
+                            pattern, use_relu, use_channelwise, qengine):
+        if qengine not in torch.backends.quantized.supported_engines:
+            return
+        if qengine == 'qnnpack' and use_channelwise:
+            return
+
+        with override_quantized_engine(qengine):
+            # Power of two scales keep the requantization multiplier exact,
+            # so the sparse kernel must match the integer reference bit for bit.
+            X_scale, X_zp = 2.0 ** -4, 3
+            Y_scale, Y_zp = 2.0 ** -1, 128 if not use_relu else 0
+            X_q = torch.quantize_per_tensor(
+                torch.randint(0, 64, (batch_size, input_channels)).float() * X_scale,
+                X_scale, X_zp, torch.quint8)
+            n_blocks = (input_channels + 3) // 4
+            mask = self._sparse_block_mask(pattern, output_channels, n_blocks)
+            W_int = torch.randint(-64, 64, (output_channels, input_channels))
+            W_int = W_int * mask.long().repeat_interleave(4, dim=1)[:, :input_channels]
+            if use_channelwise:
+                W_scales = 2.0 ** -torch.randint(5, 8, (output_channels,)).double()
+                W_q = torch.quantize_per_channel(
+                    (W_int.double() * W_scales.unsqueeze(1)).float(), W_scales,
+                    torch.zeros(output_channels, dtype=torch.long), 0, torch.qint8)
+            else:
+                W_scales = torch.full((output_channels,), 2.0 ** -6, dtype=torch.double)
+                W_q = torch.quantize_per_tensor(
+                    W_int.float() * 2.0 ** -6, 2.0 ** -6, 0, torch.qint8)
+
+            qlinear = torch.ops.quantized.linear_relu if use_relu else torch.ops.quantized.linear
+            W_prepack = torch.ops.quantized.linear_prepack_sparse(W_q, None, 1.0)
+            Y_q = qlinear(X_q, W_prepack, Y_scale, Y_zp)
+
+            acc = torch.mm(X_q.int_repr().long() - X_zp, W_q.int_repr().long().t())
+            Y_ref = torch.round(acc.double() * (X_scale * W_scales / Y_scale)) + Y_zp
+            Y_ref = Y_ref.clamp(Y_zp if use_relu else 0, 255)
+            np.testing.assert_equal(Y_q.int_repr().numpy(), Y_ref.byte().numpy())
+
+            # The dense kernels requantize differently, allow a rounding step.
+            b = torch.rand(output_channels) - 0.5
+            Y_sparse = qlinear(
+                X_q, torch.ops.quantized.linear_prepack_sparse(W_q, b, 1.0), Y_scale, Y_zp)
+            Y_dense = qlinear(
+                X_q, torch.ops.quantized.linear_prepack(W_q, b), Y_scale, Y_zp)
+            diff = (Y_sparse.int_repr().int() - Y_dense.int_repr().int()).abs()
+            self.assertLessEqual(diff.max().item(), 1)
+
+    """Tests that output channels without any stored block produce only the
+    bias, also when the weight zero point is not zero."""
+    @given(batch_size=st.integers(1, 10),
+           input_channels=st.integers(1, 40),
+           output_channels=st.integers(1, 16),
+           W_zp=st.integers(-10, 10))
+    def test_qlinear_sparse_zero_rows(self, batch_size, input_channels,
+                                      output_channels, W_zp):
+        X_q = torch.quantize_per_tensor(
+            torch.rand(batch_size, input_channels) * 4, 0.05, 7, torch.quint8)
+        W = torch.randn(output_channels, input_channels)
+        zero_rows = torch.arange(output_channels) % 2 == 0
+        W[zero_rows] = 0
+        W_q = torch.quantize_per_tensor(W, 0.02, W_zp, torch.qint8)
+        b = torch.rand(output_channels) * 4 - 2
+        # With a power of two scale both paths divide the bias exactly.
+        Y_scale, Y_zp = 2.0 ** -4, 100
+
+        W_prepack = torch.ops.quantized.linear_prepack_sparse(W_q, b, 1.0)
+        Y_q = torch.ops.quantized.linear(X_q, W_prepack, Y_scale, Y_zp)
+        Y_bias = torch.quantize_per_tensor(
+            b.expand(batch_size, output_channels), Y_scale, Y_zp, torch.quint8)
+        np.testing.assert_equal(Y_q.int_repr()[:, zero_rows].numpy(),
+                                Y_bias.int_repr()[:, zero_rows].numpy())
+
+        # An all-zero weight has no blocks at all.
+        W_empty = torch.quantize_per_tensor(
+            torch.zeros(output_channels, input_channels), 0.02, W_zp, torch.qint8)
+        Y_empty = torch.ops.quantized.linear(
+            X_q, torch.ops.quantized.linear_prepack_sparse(W_empty, b), Y_scale, Y_zp)
+        np.testing.assert_equal(Y_empty.int_repr().numpy(), Y_bias.int_repr().numpy())
+
+    """Tests unpacking sparse weights and the dense fallback of the prepacking."""
+    @given(input_channels=st.integers(1, 70),
+           output_channels=st.integers(1, 16),
+           qengine=st.sampled_from(("qnnpack", "fbgemm")))
+    def test_qlinear_sparse_prepack(self, input_channels, output_channels, qengine):
+        if qengine not in torch.backends.quantized.supported_engines:
+            return
+
+        with override_quantized_engine(qengine):
+            X_q = torch.quantize_per_tensor(
+                torch.rand(3, input_channels), 0.01, 0, torch.quint8)
+            W = torch.randn(output_channels, input_channels)
+            W[:, 4:] = 0
+            W_q = torch.quantize_per_tensor(W, 0.01, 0, torch.qint8)
+            b = torch.rand(output_channels)
+            W_prepack = torch.ops.quantized.linear_prepack_sparse(W_q, b, 1.0)
+            W_unpacked, b_unpacked = torch.ops.quantized.linear_unpack(W_prepack)
+            np.testing.assert_equal(W_unpacked.int_repr().numpy(), W_q.int_repr().numpy())
+            np.testing.assert_equal(b_unpacked.numpy(), b.numpy())
+
+            # Dense weights fall back to the engine's dense prepacking.
+            W_dense_q = torch.quantize_per_tensor(
+                torch.rand(output_channels, input_channels) + 0.1, 0.01, 0, torch.qint8)
+            Y_dense = torch.ops.quantized.linear(
+                X_q, torch.ops.quantized.linear_prepack_sparse(W_dense_q, b), 0.1, 0)
+            Y_dense_ref = torch.ops.quantized.linear(
+                X_q, torch.ops.quantized.linear_prepack(W_dense_q, b), 0.1, 0)
+            np.testing.assert_equal(Y_dense.int_repr().numpy(), Y_dense_ref.int_repr().numpy())
+
 class TestQuantizedConv(unittest.TestCase):
     def _test_qconv_unpack_impl(
         self, qconv_prepack_fn, qconv_unpack_fn, inputs, strides, pads,
@@ -2496,6 +2786,76 @@ class TestQNNPackOps(TestCase):
             qY = torch.mean(qX, dim)
             np.testing.assert_array_almost_equal(Y.int_repr().numpy(), qY.int_repr().numpy(), decimal=0)
 
+"""Tests the correctness of the row-wise quantized embedding_bag ops."""
+class TestQuantizedEmbeddingBag(TestCase):
+    def _packed_ops(self, bit_rate):
+        if bit_rate == 8:
+            return (torch.ops.quantized.embedding_bag_byte_prepack,
+                    torch.ops.quantized.embedding_bag_byte_unpack,
+                    torch.ops.quantized.embedding_bag_byte)
+        return (torch.ops.quantized.embedding_bag_4bit_prepack,
+                torch.ops.quantized.embedding_bag_4bit_unpack,
+                torch.ops.quantized.embedding_bag_4bit)
+
+    @given(num_embeddings=st.integers(1, 40),
+           embedding_dim=st.sampled_from([2, 4, 8, 16, 64]),
+           bit_rate=st.sampled_from([4, 8]))
+    def test_embedding_bag_prepack_unpack(self, num_embeddings, embedding_dim, bit_rate):
+        prepack, unpack, _ = self._packed_ops(bit_rate)
+        weight = torch.randn(num_embeddings, embedding_dim, dtype=torch.float)
+        packed = prepack(weight)
+        unpacked = unpack(packed)
+        self.assertEqual(unpacked.shape, weight.shape)
+        # Every element is within half a quantization step of the original.
+        row_range = weight.max(dim=1)[0] - weight.min(dim=1)[0]
+        tolerance = row_range / ((1 << bit_rate) - 1) / 2 + 1e-3
+        if bit_rate == 4:
+            # The fp16 scale and bias add their own rounding error.
+            tolerance = tolerance * 1.1 + 1e-2 * weight.abs().max(dim=1)[0]
+        error = (unpacked - weight).abs().max(dim=1)[0]
+        self.assertTrue(bool((error <= tolerance).all()))
+
+    @given(num_embeddings=st.integers(10, 50),
+           embedding_dim=st.sampled_from([4, 8, 16, 64]),
+           num_offsets=st.integers(1, 20),
+           bit_rate=st.sampled_from([4, 8]),
+           mode=st.sampled_from([0, 1]),
+           index_dtype=st.sampled_from([torch.int32, torch.int64]),
+           use_weights=st.booleans(),
+           include_last_offset=st.booleans())
+    def test_embedding_bag(self, num_embeddings, embedding_dim, num_offsets,
+                           bit_rate, mode, index_dtype, use_weights,
+                           include_last_offset):
+        assume(not (use_weights and mode != 0))
+        prepack, unpack, embedding_bag = self._packed_ops(bit_rate)
+        weight = torch.randn(num_embeddings, embedding_dim, dtype=torch.float)
+        packed = prepack(weight)
+        dequantized = unpack(packed)
+
+        lengths = torch.randint(0, 5, (num_offsets,))
+        indices = torch.randint(0, num_embeddings, (int(lengths.sum()),))
+        offsets = torch.cat((torch.zeros(1, dtype=torch.long),
+                             torch.cumsum(lengths, 0)))
+        if not include_last_offset:
+            offsets = offsets[:-1]
+        per_sample_weights = torch.rand(indices.numel()) if use_weights else None
+
+        ref = F.embedding_bag(indices, dequantized, offsets,
+                              mode=['sum', 'mean'][mode],
+                              per_sample_weights=per_sample_weights,
+                              include_last_offset=include_last_offset)
+        out = embedding_bag(packed, indices.to(index_dtype), offsets,
+                            mode=mode, per_sample_weights=per_sample_weights,
+                            include_last_offset=include_last_offset)
+        self.assertEqual(out, ref, prec=1e-4)
+
+    def test_embedding_bag_unsupported_mode(self):
+        packed = torch.ops.quantized.embedding_bag_byte_prepack(torch.randn(5, 8))
+        indices = torch.tensor([0, 1, 2])
+        offsets = torch.tensor([0, 2])
+        with self.assertRaisesRegex(RuntimeError, "only supports sum and mean"):
+            torch.ops.quantized.embedding_bag_byte(packed, indices, offsets, mode=2)
+
 """Tests the correctness of the tensor comparators."""
 class TestComparatorOps(TestCase):
     """Tests the element-wise equality ops."""
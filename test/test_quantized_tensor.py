@@ -160,6 +160,33 @@ class TestQuantizedTensor(TestCase):
         self.assertTrue(np.allclose(qr.int_repr(), quantize_c(r, scales, zero_points)))
         self.assertTrue(np.allclose(r.numpy(), rqr.numpy(), atol=2 / np.min(scales.numpy())))
 
+    def test_qtensor_quantize_per_channel_memory_format(self):
+        # Inner dimensions are large enough to go through the vectorized
+        # kernels in both the contiguous and the channels last layouts.
+        r = torch.rand(2, 37, 5, 11, dtype=torch.float) * 4 - 2
+        scales = torch.rand(37, dtype=torch.double) * 0.02 + 0.01
+        s = scales.numpy().reshape(1, -1, 1, 1)
+        for dtype, quant_min, quant_max in [(torch.quint8, 0, 255),
+                                            (torch.qint8, -128, 127),
+                                            (torch.qint32, -2 ** 31, 2 ** 31 - 1)]:
+            if dtype == torch.quint8:
+                zero_points = torch.randint(0, 20, (37,), dtype=torch.long)
+            else:
+                zero_points = torch.randint(-10, 10, (37,), dtype=torch.long)
+            zp = zero_points.numpy().reshape(1, -1, 1, 1)
+            ref = np.clip(np.round(r.numpy() / s) + zp, quant_min, quant_max)
+            for memory_format in [torch.contiguous_format, torch.channels_last]:
+                x = r.contiguous(memory_format=memory_format)
+                qx = torch.quantize_per_channel(x, scales, zero_points, 1, dtype)
+                self.assertTrue(qx.is_contiguous(memory_format=memory_format))
+                # The kernels multiply by the inverse scale, so values exactly
+                # between two levels may round to either one.
+                self.assertTrue(np.allclose(qx.int_repr().numpy(), ref, rtol=0, atol=1))
+                dqx = qx.dequantize()
+                self.assertTrue(dqx.is_contiguous(memory_format=memory_format))
+                dq_ref = (qx.int_repr().numpy().astype(np.float64) - zp) * s
+                self.assertTrue(np.allclose(dqx.numpy(), dq_ref, rtol=1e-5, atol=1e-6))
+
     def test_qtensor_permute(self):
         r = torch.rand(10, 30, 2, 2, dtype=torch.float) * 4 - 2
         scale = 0.02
@@ -87,6 +87,128 @@ class TestXNNPACKOps(TestCase):
         xnnpack_result = torch.ops._xnnpack.conv2d_packed(input_data, packed_weight_bias)
         torch.testing.assert_allclose(ref_result, xnnpack_result, rtol=1e-2, atol=1e-3)
 
+    @given(batch_size=st.integers(0, 3),
+           input_channels_per_group=st.integers(1, 16),
+           height=st.integers(2, 32),
+           width=st.integers(2, 32),
+           output_channels_per_group=st.integers(1, 16),
+           groups=st.integers(1, 4),
+           kernel_h=st.integers(1, 5),
+           kernel_w=st.integers(1, 5),
+           stride_h=st.integers(1, 2),
+           stride_w=st.integers(1, 2),
+           pad_h=st.integers(0, 2),
+           pad_w=st.integers(0, 2),
+           output_pad_h=st.integers(0, 1),
+           output_pad_w=st.integers(0, 1),
+           dilation=st.integers(1, 2),
+           use_bias=st.booleans())
+    def test_conv_transpose2d(self,
+                              batch_size,
+                              input_channels_per_group,
+                              height,
+                              width,
+                              output_channels_per_group,
+                              groups,
+                              kernel_h,
+                              kernel_w,
+                              stride_h,
+                              stride_w,
+                              pad_h,
+                              pad_w,
+                              output_pad_h,
+                              output_pad_w,
+                              dilation,
+                              use_bias):
+        assume(output_pad_h < stride_h and output_pad_w < stride_w)
+        input_channels = input_channels_per_group * groups
+        output_channels = output_channels_per_group * groups
+        kernels = (kernel_h, kernel_w)
+        strides = (stride_h, stride_w)
+        paddings = (pad_h, pad_w)
+        output_paddings = (output_pad_h, output_pad_w)
+        dilations = (dilation, dilation)
+        assume((height - 1) * stride_h - 2 * pad_h + dilation * (kernel_h - 1) + output_pad_h + 1 > 0)
+        assume((width - 1) * stride_w - 2 * pad_w + dilation * (kernel_w - 1) + output_pad_w + 1 > 0)
+
+        input_data = torch.rand((batch_size, input_channels, height, width))
+        weight = torch.rand((input_channels, output_channels_per_group, kernel_h, kernel_w))
+        bias = None
+        if use_bias:
+            bias = torch.rand((output_channels))
+
+        ref_result = F.conv_transpose2d(input_data, weight, bias,
+                                        strides, paddings, output_paddings, groups, dilations)
+        packed_weight_bias = torch.ops._xnnpack.conv2d_transpose_prepack(weight, bias,
+                                                                         strides, paddings,
+                                                                         output_paddings, groups, dilations)
+        xnnpack_result = torch.ops._xnnpack.conv2d_transpose_packed(input_data, packed_weight_bias)
+        torch.testing.assert_allclose(ref_result, xnnpack_result, rtol=1e-2, atol=1e-3)
+
+    @given(batch_size=st.integers(1, 3),
+           channels=st.integers(1, 32),
+           height=st.integers(4, 32),
+           width=st.integers(4, 32),
+           kernel=st.integers(2, 3),
+           stride=st.integers(1, 2),
+           padding=st.integers(0, 1),
+           dilation=st.integers(1, 2),
+           ceil_mode=st.booleans(),
+           channels_last=st.booleans())
+    def test_pooling(self,
+                     batch_size,
+                     channels,
+                     height,
+                     width,
+                     kernel,
+                     stride,
+                     padding,
+                     dilation,
+                     ceil_mode,
+                     channels_last):
+        input_data = torch.rand((batch_size, channels, height, width))
+        if channels_last:
+            input_data = input_data.contiguous(memory_format=torch.channels_last)
+        kernels = [kernel, kernel]
+        strides = [stride, stride]
+        paddings = [padding, padding]
+        dilations = [dilation, dilation]
+
+        ref_result = F.max_pool2d(input_data, kernels, strides, paddings, dilations, ceil_mode)
+        xnnpack_result = torch.ops._xnnpack.max_pool2d(input_data, kernels, strides, paddings, dilations, ceil_mode)
+        torch.testing.assert_allclose(ref_result, xnnpack_result, rtol=1e-2, atol=1e-3)
+
+        ref_result = F.avg_pool2d(input_data, kernels, strides)
+        xnnpack_result = torch.ops._xnnpack.avg_pool2d(input_data, kernels, strides)
+        torch.testing.assert_allclose(ref_result, xnnpack_result, rtol=1e-2, atol=1e-3)
+
+        ref_result = F.adaptive_avg_pool2d(input_data, [1, 1])
+        xnnpack_result = torch.ops._xnnpack.global_avg_pool2d(input_data)
+        torch.testing.assert_allclose(ref_result, xnnpack_result, rtol=1e-2, atol=1e-3)
+
+    @given(data_shape=hu.array_shapes(1, 4, 1, 32),
+           min_val=st.floats(-6, 0),
+           max_val=st.floats(0.5, 6))
+    def test_elementwise(self, data_shape, min_val, max_val):
+        input_data = torch.randn(data_shape) * 4
+        other_data = torch.randn(data_shape)
+
+        ref_result = input_data * F.relu6(input_data + 3) / 6
+        xnnpack_result = torch.ops._xnnpack.hardswish(input_data)
+        torch.testing.assert_allclose(ref_result, xnnpack_result, rtol=1e-2, atol=1e-3)
+
+        ref_result = torch.clamp(input_data, min_val, max_val)
+        xnnpack_result = torch.ops._xnnpack.clamp(input_data, min_val, max_val)
+        torch.testing.assert_allclose(ref_result, xnnpack_result, rtol=1e-2, atol=1e-3)
+
+        ref_result = F.relu(input_data)
+        xnnpack_result = torch.ops._xnnpack.clamp(input_data, 0., None)
+        torch.testing.assert_allclose(ref_result, xnnpack_result, rtol=1e-2, atol=1e-3)
+
+        ref_result = input_data + other_data
+        xnnpack_result = torch.ops._xnnpack.add(input_data, other_data)
+        torch.testing.assert_allclose(ref_result, xnnpack_result, rtol=1e-2, atol=1e-3)
+
 
 @unittest.skipUnless(torch.backends.xnnpack.enabled,
                      " XNNPACK must be enabled for these tests."
@@ -498,6 +620,92 @@ class TestXNNPACKRewritePass(TestCase):
         pattern_count_map["_xnnpack::linear_prepack"] = -1
         validate_transformed_module(M, pattern_count_map, data_shape, True)
 
+    def test_nhwc_chain(self):
+        def validate_transformed_module(module_name, pattern_count_map, data_shape):
+            scripted_model = torch.jit.script(module_name())
+            scripted_model.eval()
+            input_data = torch.rand(data_shape)
+            ref_result = scripted_model(input_data)
+            scripted_model._c = torch._C._freeze_module(scripted_model._c)
+            torch._C._jit_pass_insert_xnnpack_ops(scripted_model._c)
+            torch._C._jit_pass_fold_xnnpack_prepack_ops(scripted_model._c)
+
+            file_check = FileCheck()
+            for pattern, v in pattern_count_map.items():
+                if (v == -1):
+                    file_check.check_not(pattern)
+                else:
+                    file_check.check_count(pattern, v, exactly=True)
+            file_check.run(scripted_model.graph)
+            xnnpack_result = scripted_model(input_data)
+            torch.testing.assert_allclose(ref_result, xnnpack_result, rtol=1e-2, atol=1e-3)
+
+        channels = 8
+        data_shape = (2, channels, 16, 16)
+
+        class Block(torch.nn.Module):
+            def __init__(self):
+                super(Block, self).__init__()
+                self.conv1 = torch.nn.Conv2d(channels, channels, 3, padding=1)
+                self.conv2 = torch.nn.Conv2d(channels, channels, 3, padding=1, groups=channels)
+                self.deconv = torch.nn.ConvTranspose2d(channels, channels, 2, stride=2)
+
+            def forward(self, x):
+                y = F.relu(self.conv1(x))
+                y = F.max_pool2d(y, 2)
+                z = self.conv2(y)
+                z = z * F.relu6(z + 3.) / 6.
+                y = z + y
+                y = self.deconv(y)
+                return F.adaptive_avg_pool2d(y, [1, 1])
+
+        # A single conversion in and a single conversion out of the chain.
+        pattern_count_map = {"aten::conv2d": -1,
+                             "aten::conv_transpose2d": -1,
+                             "aten::max_pool2d": -1,
+                             "aten::adaptive_avg_pool2d": -1,
+                             "aten::hardtanh": -1,
+                             "_xnnpack::conv2d_prepack": -1,
+                             "_xnnpack::conv2d_transpose_prepack": -1,
+                             "_xnnpack::conv2d_packed": 2,
+                             "_xnnpack::conv2d_transpose_packed": 1,
+                             "_xnnpack::max_pool2d": 1,
+                             "_xnnpack::global_avg_pool2d": 1,
+                             "_xnnpack::hardswish": 1,
+                             "_xnnpack::clamp": 1,
+                             "_xnnpack::add": 1,
+                             "aten::contiguous": 2}
+        validate_transformed_module(Block, pattern_count_map, data_shape)
+
+        class Pool(torch.nn.Module):
+            def forward(self, x):
+                return F.avg_pool2d(F.max_pool2d(x, 2), 2)
+
+        # Pooling also takes unbatched 3D inputs, which cannot be made
+        # channels last, so a chain starting at a pooling whose input is not
+        # known to be 4D gets no conversion.
+        pattern_count_map = {"aten::max_pool2d": -1,
+                             "aten::avg_pool2d": -1,
+                             "_xnnpack::max_pool2d": 1,
+                             "_xnnpack::avg_pool2d": 1,
+                             "aten::contiguous": -1}
+        validate_transformed_module(Pool, pattern_count_map, (channels, 16, 16))
+        validate_transformed_module(Pool, pattern_count_map, data_shape)
+
+        class Conv(torch.nn.Module):
+            def __init__(self):
+                super(Conv, self).__init__()
+                self.conv = torch.nn.Conv2d(channels, channels, 3, padding=1)
+
+            def forward(self, x):
+                return self.conv(x)
+
+        # A single operator converts internally instead of getting two copies.
+        pattern_count_map = {"aten::conv2d": -1,
+                             "_xnnpack::conv2d_packed": 1,
+                             "aten::contiguous": -1}
+        validate_transformed_module(Conv, pattern_count_map, data_shape)
+
 
 if __name__ == "__main__":
     run_tests()
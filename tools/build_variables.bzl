@@ -92,6 +92,7 @@ libtorch_sources = [
     "torch/csrc/jit/runtime/graph_executor.cpp",
     "torch/csrc/jit/serialization/import.cpp",
     "torch/csrc/jit/serialization/import_legacy.cpp",
+    "torch/csrc/jit/serialization/optimized_plans.cpp",
     "torch/csrc/jit/serialization/pickle.cpp",
     "torch/csrc/jit/serialization/import_export_helpers.cpp",
     "torch/csrc/jit/runtime/instruction.cpp",
@@ -123,6 +124,7 @@ libtorch_sources = [
     "torch/csrc/jit/passes/graph_rewrite_helper.cpp",
     "torch/csrc/jit/passes/cuda_graph_fuser.cpp",
     "torch/csrc/jit/passes/guard_elimination.cpp",
+    "torch/csrc/jit/passes/horizontal_fusion.cpp",
     "torch/csrc/jit/passes/inline_autodiff_subgraphs.cpp",
     "torch/csrc/jit/passes/inliner.cpp",
     "torch/csrc/jit/passes/lift_closures.cpp",
@@ -134,6 +136,8 @@ libtorch_sources = [
     "torch/csrc/jit/passes/lower_grad_of.cpp",
     "torch/csrc/jit/passes/lower_graph.cpp",
     "torch/csrc/jit/passes/lower_tuples.cpp",
+    "torch/csrc/jit/passes/memory_planning.cpp",
+    "torch/csrc/jit/passes/parallelize_branches.cpp",
     "torch/csrc/jit/passes/peephole.cpp",
     "torch/csrc/jit/serialization/python_print.cpp",
     "torch/csrc/jit/passes/quantization.cpp",
@@ -141,6 +145,7 @@ libtorch_sources = [
     "torch/csrc/jit/passes/xnnpack_rewrite.cpp",
     "torch/csrc/jit/passes/fuse_linear.cpp",
     "torch/csrc/jit/passes/freeze_module.cpp",
+    "torch/csrc/jit/passes/frozen_graph_optimizations.cpp",
     "torch/csrc/jit/passes/remove_expands.cpp",
     "torch/csrc/jit/passes/requires_grad_analysis.cpp",
     "torch/csrc/jit/passes/shape_analysis.cpp",
@@ -186,6 +191,9 @@ libtorch_sources = [
     "torch/csrc/jit/codegen/fuser/cpu/fused_kernel.cpp",
     "torch/csrc/jit/codegen/fuser/interface.cpp",
     "torch/csrc/jit/runtime/vararg_functions.cpp",
+    "torch/csrc/jit/runtime/static/impl.cpp",
+    "torch/csrc/jit/runtime/static/memory_planner.cpp",
+    "torch/csrc/jit/runtime/static/ops.cpp",
     "torch/csrc/jit/python/update_graph_executor_opt.cpp",
     "torch/csrc/jit/mobile/function.cpp",
     "torch/csrc/jit/mobile/import.cpp",
@@ -373,6 +381,7 @@ def add_torch_libs():
         "torch/csrc/jit/frontend/concrete_module_type.cpp",
         "torch/csrc/jit/python/python_sugared_value.cpp",
         "torch/csrc/jit/python/python_tree_views.cpp",
+        "torch/csrc/jit/runtime/static/init.cpp",
         "torch/csrc/jit/runtime/register_distributed_ops.cpp",
         "torch/csrc/multiprocessing/init.cpp",
         "torch/csrc/onnx/init.cpp",
@@ -31,6 +31,10 @@ struct TORCH_API Method {
       std::vector<c10::IValue> stack,
       const Kwargs& kwargs = Kwargs());
 
+  // Runs the method on the given inputs until the executor has compiled an
+  // optimized plan for them. See GraphExecutor::warmup.
+  void warmup(std::vector<c10::IValue> stack, const Kwargs& kwargs = Kwargs());
+
   std::shared_ptr<Graph> graph() const {
     return function_->graph();
   }
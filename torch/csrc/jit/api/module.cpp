@@ -115,6 +115,12 @@ IValue Method::operator()(std::vector<IValue> stack, const Kwargs& kwargs) {
   return (*function_)(std::move(stack), kwargs);
 }
 
+void Method::warmup(std::vector<IValue> stack, const Kwargs& kwargs) {
+  stack.insert(stack.begin(), owner()._ivalue());
+  function_->getSchema().checkAndNormalizeInputs(stack, kwargs);
+  function_->get_executor().warmup(stack);
+}
+
 void Module::clone_method(
     const Module& orig,
     const Function& method,
@@ -16,6 +16,10 @@ namespace jit {
 namespace {
 
 bool tensorEqual(const at::Tensor& lhs, const at::Tensor& rhs) {
+  // MKLDNN tensors, e.g. prepacked weights, have no equal()
+  if (lhs.is_mkldnn() || rhs.is_mkldnn()) {
+    return lhs.is_same(rhs);
+  }
   return lhs.options().type_equal(rhs.options()) && lhs.equal(rhs);
 }
 
@@ -0,0 +1,122 @@
+#pragma once
+#include <torch/csrc/jit/runtime/instruction.h>
+
+#include <cstdint>
+
+// Flat bytecode format.
+//
+// An alternative to bytecode.pkl that the lite interpreter can read without
+// running the Unpickler. It is stored as the uncompressed "bytecode.flat"
+// record next to bytecode.pkl and describes the same methods.
+//
+// All integers are little endian. Offsets are in bytes from the start of the
+// record and every array starts at an 8 byte boundary, so the record can be
+// used in place from a buffer or an mmap of the model file (zip records are
+// aligned to 64 bytes). Strings (function and operator names, type strings,
+// string constants, tensor record names) are interned in one table. Tensor
+// constants reference their storage by name; these are the "bytecode/<index>"
+// records also used by bytecode.pkl, so no tensor data is written twice.
+//
+// Instructions keep the in-memory Instruction layout, but their op field is
+// an index into the opcode table, which holds the string ids of the opcode
+// names. The loader maps the names to its own OpCode values, so reordering
+// FORALL_OPCODES does not change what a record means. A record with an
+// opcode name or a version the loader does not know is ignored and
+// bytecode.pkl is read instead.
+//
+//   FlatBytecodeHeader
+//   FlatString[num_strings]       -> string bytes
+//   uint32_t[num_opcodes]         string ids of opcode names
+//   FlatFunction[num_functions]
+//     Instruction[num_instructions] (op is an opcode table index)
+//     FlatOperator[num_operators]
+//     FlatConstant[num_constants]
+//     uint32_t[num_types]         string ids of type strings
+//   FlatTensor[num_tensors]       -> int64_t sizes[dim], strides[dim]
+
+namespace torch {
+namespace jit {
+namespace mobile {
+
+constexpr char kFlatBytecodeRecord[] = "bytecode.flat";
+constexpr char kFlatBytecodeDataPrefix[] = "bytecode/";
+constexpr uint32_t kFlatBytecodeMagic = 0x43425450; // "PTBC"
+constexpr uint32_t kFlatBytecodeVersion = 2;
+
+struct FlatBytecodeHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t num_strings;
+  uint32_t strings_offset;
+  uint32_t num_functions;
+  uint32_t functions_offset;
+  uint32_t num_tensors;
+  uint32_t tensors_offset;
+  uint32_t num_opcodes;
+  uint32_t opcodes_offset;
+};
+
+struct FlatString {
+  uint32_t offset;
+  uint32_t size;
+};
+
+struct FlatFunction {
+  uint32_t name;
+  uint32_t register_size;
+  uint32_t num_instructions;
+  uint32_t instructions_offset;
+  uint32_t num_operators;
+  uint32_t operators_offset;
+  uint32_t num_constants;
+  uint32_t constants_offset;
+  uint32_t num_types;
+  uint32_t types_offset;
+};
+
+struct FlatOperator {
+  uint32_t name;
+  uint32_t overload_name;
+};
+
+enum class FlatConstantTag : uint8_t {
+  None,
+  Bool,
+  Int,
+  Double,
+  String, // payload is a string id
+  Device, // payload is a string id
+  IntList, // payload is an offset to int64_t[size]
+  Tensor, // payload is an index into the tensor table
+};
+
+struct FlatConstant {
+  FlatConstantTag tag;
+  uint8_t unused[3];
+  uint32_t size; // IntList only
+  union {
+    int64_t i;
+    double d;
+    uint64_t payload;
+  };
+};
+
+struct FlatTensor {
+  uint32_t record; // string id of the storage record
+  uint8_t scalar_type;
+  uint8_t requires_grad;
+  uint16_t dim;
+  int64_t storage_numel;
+  int64_t storage_offset;
+  uint64_t sizes_offset; // int64_t[dim] sizes followed by int64_t[dim] strides
+};
+
+static_assert(sizeof(Instruction) == 8, "Instructions are stored as 8 bytes");
+static_assert(sizeof(FlatBytecodeHeader) == 40, "Unexpected header layout");
+static_assert(sizeof(FlatFunction) == 40, "Unexpected function layout");
+static_assert(sizeof(FlatConstant) == 16, "Unexpected constant layout");
+static_assert(sizeof(FlatTensor) == 32, "Unexpected tensor layout");
+
+} // namespace mobile
+} // namespace jit
+} // namespace torch
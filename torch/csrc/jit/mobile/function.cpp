@@ -1,4 +1,5 @@
 #include "function.h"
+#include <limits>
 #include <ATen/core/op_registration/op_registration.h>
 #include <torch/csrc/jit/runtime/instruction.h>
 #include <torch/csrc/jit/runtime/vararg_functions.h>
@@ -35,10 +36,7 @@ bool Function::append_operator(const std::string& name,
   }
   // TODO: operator.h now does not depend on Node* so we can also look up operators from
   // that registry for use in mobile as a way to share implementations.
-  auto fn = [op](Stack& stack) {
-    c10::Dispatcher::singleton().callBoxed(*op, &stack);
-  };
-  code_->operators_.emplace_back(fn);
+  code_->operators_.emplace_back(*op);
   return true;
 }
 
@@ -54,6 +52,27 @@ void Function::set_register_size(size_t size) {
   code_->register_size_ = size;
 }
 
+void Function::form_superinstructions() {
+  auto& instructions = code_->instructions_;
+  size_t i = 0;
+  while (i + 1 < instructions.size()) {
+    auto& first = instructions[i];
+    const auto& second = instructions[i + 1];
+    if (first.op == OP && second.op == STORE &&
+        second.X <= std::numeric_limits<uint16_t>::max()) {
+      first = Instruction(OP_STORE, first.X, second.X);
+    } else if (
+        (first.op == LOAD || first.op == MOVE) && second.op == OP &&
+        first.X <= std::numeric_limits<uint16_t>::max()) {
+      first = Instruction(first.op == LOAD ? LOAD_OP : MOVE_OP, second.X, first.X);
+    } else {
+      ++i;
+      continue;
+    }
+    i += 2;
+  }
+}
+
 bool Function::run(Stack& stack) const {
   InterpreterState interp_state(code_);
   return interp_state.run(stack);
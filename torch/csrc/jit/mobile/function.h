@@ -24,6 +24,9 @@ class Function{
   void append_type(const c10::TypePtr& type);
 
   void set_register_size(size_t size);
+  // Fuses common instruction pairs into superinstructions. Called once all
+  // instructions and operators are appended.
+  void form_superinstructions();
 
  private:
   c10::QualifiedName name_;
@@ -2,13 +2,16 @@
 #include <ATen/core/ivalue.h>
 #include <caffe2/serialize/inline_container.h>
 #include <torch/csrc/jit/api/compilation_unit.h>
+#include <torch/csrc/jit/mobile/flat_bytecode.h>
 #include <torch/csrc/jit/mobile/type_parser.h>
 #include <torch/csrc/jit/runtime/instruction.h>
 #include <torch/csrc/jit/serialization/unpickler.h>
 #include <torch/custom_class.h>
 
+#include <cstring>
 #include <fstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 // The import process to serialize the bytecode package.
@@ -114,11 +117,75 @@ void parseMethods(
     }
 
     function->set_register_size(register_size);
+    function->form_superinstructions();
 
     mcu.register_function(std::move(function));
   }
 }
 
+// Returns `count` elements of type T at `offset` in a flat bytecode record,
+// after checking that they are aligned and inside the record.
+template <typename T>
+const T* flatArray(const char* data, size_t size, uint64_t offset, size_t count) {
+  TORCH_CHECK(
+      offset % alignof(T) == 0 && offset <= size &&
+          count <= (size - offset) / sizeof(T),
+      "Corrupted flat bytecode record");
+  return reinterpret_cast<const T*>(data + offset);
+}
+
+// Maps an opcode name to this build's OpCode. Returns false if the name is
+// unknown.
+bool lookupOpCode(const std::string& name, OpCode& op) {
+  static const std::unordered_map<std::string, OpCode> opcodes = {
+#define OPCODE_ENTRY(x, _) {#x, x},
+      FORALL_OPCODES(OPCODE_ENTRY)
+#undef OPCODE_ENTRY
+  };
+  auto it = opcodes.find(name);
+  if (it == opcodes.end()) {
+    return false;
+  }
+  op = it->second;
+  return true;
+}
+
+// Checks that the elements of a tensor with the given geometry all lie in a
+// storage of `storage_numel` elements, so set_ cannot read out of bounds.
+bool fitsInStorage(
+    const int64_t* sizes,
+    const int64_t* strides,
+    size_t dim,
+    int64_t storage_offset,
+    int64_t storage_numel) {
+  if (storage_offset < 0) {
+    return false;
+  }
+  for (size_t d = 0; d < dim; ++d) {
+    if (sizes[d] < 0 || strides[d] < 0) {
+      return false;
+    }
+  }
+  for (size_t d = 0; d < dim; ++d) {
+    if (sizes[d] == 0) {
+      return true;
+    }
+  }
+  if (storage_offset >= storage_numel) {
+    return false;
+  }
+  // the offset of the last element, which is the largest one
+  int64_t last = storage_offset;
+  for (size_t d = 0; d < dim; ++d) {
+    if (strides[d] > 0 &&
+        sizes[d] - 1 > (storage_numel - 1 - last) / strides[d]) {
+      return false;
+    }
+    last += (sizes[d] - 1) * strides[d];
+  }
+  return true;
+}
+
 // The deserializer class which loads the bytecode package from bc files.
 class BytecodeDeserializer final {
  public:
@@ -128,6 +195,10 @@ class BytecodeDeserializer final {
  private:
   c10::IValue readArchive(const std::string& archive_name,
     std::shared_ptr<mobile::CompilationUnit> mcu);
+  bool parseFlatMethods(
+      const char* data,
+      size_t size,
+      mobile::CompilationUnit& mcu);
   std::shared_ptr<CompilationUnit> compilation_unit_;
   std::unordered_set<std::string> imported_libs_;
   std::unique_ptr<PyTorchStreamReader> reader_;
@@ -140,12 +211,223 @@ BytecodeDeserializer::BytecodeDeserializer(std::unique_ptr<PyTorchStreamReader>
 mobile::Module BytecodeDeserializer::deserialize(c10::optional<at::Device> device) {
   device_ = device;
   auto mcu = std::make_shared<mobile::CompilationUnit>();
-  auto bvals = readArchive("bytecode", mcu).toTuple()->elements();
-  parseMethods(bvals, *mcu);
+  bool parsed_flat = false;
+  if (reader_->hasRecord(mobile::kFlatBytecodeRecord)) {
+    // Parse the record where it lies when the model is in memory, and only
+    // read it out of the archive otherwise.
+    const char* flat_data;
+    size_t flat_size;
+    at::DataPtr flat_ptr;
+    std::tie(flat_data, flat_size) =
+        reader_->getRecordInPlace(mobile::kFlatBytecodeRecord);
+    if (flat_data == nullptr ||
+        reinterpret_cast<uintptr_t>(flat_data) % alignof(int64_t) != 0) {
+      std::tie(flat_ptr, flat_size) =
+          reader_->getRecord(mobile::kFlatBytecodeRecord);
+      flat_data = reinterpret_cast<const char*>(flat_ptr.get());
+    }
+    parsed_flat = parseFlatMethods(flat_data, flat_size, *mcu);
+  }
+  if (!parsed_flat) {
+    auto bvals = readArchive("bytecode", mcu).toTuple()->elements();
+    parseMethods(bvals, *mcu);
+  }
 
   return mobile::Module(readArchive("data", mcu).toObject(), mcu);
 }
 
+// Reads the methods straight from a flat bytecode record (see
+// mobile/flat_bytecode.h). Only the data kept by mobile::Function is copied
+// out of `data`, so it can point into a buffer or an mmap of the model.
+// Returns false without registering anything if the record was written with
+// a version or an opcode this build does not know, so that the caller can
+// read bytecode.pkl instead.
+bool BytecodeDeserializer::parseFlatMethods(
+    const char* data,
+    size_t size,
+    mobile::CompilationUnit& mcu) {
+  using namespace mobile;
+  if (size < sizeof(uint32_t) * 2) {
+    return false;
+  }
+  uint32_t magic_and_version[2];
+  std::memcpy(magic_and_version, data, sizeof(magic_and_version));
+  if (magic_and_version[0] != kFlatBytecodeMagic ||
+      magic_and_version[1] != kFlatBytecodeVersion) {
+    return false;
+  }
+  const auto* header = flatArray<FlatBytecodeHeader>(data, size, 0, 1);
+
+  const auto* strings = flatArray<FlatString>(
+      data, size, header->strings_offset, header->num_strings);
+  auto str = [&](uint64_t id) {
+    TORCH_CHECK(id < header->num_strings, "Corrupted flat bytecode record");
+    const auto* chars =
+        flatArray<char>(data, size, strings[id].offset, strings[id].size);
+    return std::string(chars, strings[id].size);
+  };
+
+  std::vector<OpCode> opcodes;
+  const auto* opcode_names = flatArray<uint32_t>(
+      data, size, header->opcodes_offset, header->num_opcodes);
+  for (size_t i = 0; i < header->num_opcodes; ++i) {
+    OpCode op;
+    if (!lookupOpCode(str(opcode_names[i]), op)) {
+      return false;
+    }
+    opcodes.push_back(op);
+  }
+
+  // Tensors viewing the same storage share one record, read it only once.
+  std::vector<at::Tensor> tensors;
+  std::unordered_map<uint32_t, at::Storage> storages;
+  const auto* flat_tensors = flatArray<FlatTensor>(
+      data, size, header->tensors_offset, header->num_tensors);
+  for (size_t i = 0; i < header->num_tensors; ++i) {
+    const auto& t = flat_tensors[i];
+    TORCH_CHECK(
+        t.scalar_type < static_cast<uint8_t>(at::ScalarType::NumOptions),
+        "Corrupted flat bytecode record");
+    auto type = static_cast<at::ScalarType>(t.scalar_type);
+    auto it = storages.find(t.record);
+    if (it == storages.end()) {
+      at::DataPtr storage_ptr;
+      size_t storage_size;
+      std::tie(storage_ptr, storage_size) =
+          reader_->getRecord(str(t.record));
+      TORCH_CHECK(
+          t.storage_numel >= 0 &&
+              static_cast<uint64_t>(t.storage_numel) <=
+                  storage_size / c10::elementSize(type),
+          "Corrupted flat bytecode record");
+      at::Storage storage(
+          at::CPU(type).typeMeta(),
+          t.storage_numel,
+          std::move(storage_ptr),
+          /*allocator=*/nullptr,
+          /*resizable=*/false);
+      it = storages.emplace(t.record, std::move(storage)).first;
+    }
+    TORCH_CHECK(
+        it->second.dtype() == at::CPU(type).typeMeta() &&
+            it->second.numel() == t.storage_numel,
+        "Corrupted flat bytecode record");
+    const auto* sizes =
+        flatArray<int64_t>(data, size, t.sizes_offset, 2 * t.dim);
+    TORCH_CHECK(
+        fitsInStorage(sizes, sizes + t.dim, t.dim, t.storage_offset, t.storage_numel),
+        "Corrupted flat bytecode record");
+    auto tensor = at::empty({0}, at::CPU(type).options())
+                      .set_(
+                          it->second,
+                          t.storage_offset,
+                          at::IntArrayRef(sizes, t.dim),
+                          at::IntArrayRef(sizes + t.dim, t.dim));
+    if (device_ && device_->type() == at::DeviceType::CUDA) {
+      tensor = tensor.to(*device_, tensor.scalar_type());
+    } else if (device_ && device_->type() != at::DeviceType::CPU) {
+      AT_ERROR(
+          "supported devices include CPU and CUDA, however got ",
+          at::DeviceTypeName(device_->type(), false));
+    }
+    if (t.requires_grad) {
+      tensor.set_requires_grad(true);
+    }
+    tensors.push_back(std::move(tensor));
+  }
+
+  // Type strings are interned, so each distinct type is parsed once.
+  std::unordered_map<uint32_t, c10::TypePtr> types;
+  const auto* functions = flatArray<FlatFunction>(
+      data, size, header->functions_offset, header->num_functions);
+  for (size_t f = 0; f < header->num_functions; ++f) {
+    const auto& flat_function = functions[f];
+    auto function = std::unique_ptr<mobile::Function>(
+        new mobile::Function(c10::QualifiedName(str(flat_function.name))));
+
+    const auto* instructions = flatArray<Instruction>(
+        data,
+        size,
+        flat_function.instructions_offset,
+        flat_function.num_instructions);
+    for (size_t i = 0; i < flat_function.num_instructions; ++i) {
+      TORCH_CHECK(
+          static_cast<size_t>(instructions[i].op) < opcodes.size(),
+          "Corrupted flat bytecode record");
+      function->append_instruction(
+          opcodes[instructions[i].op], instructions[i].X, instructions[i].N);
+    }
+
+    std::unordered_set<std::string> unsupported_op_names;
+    const auto* operators = flatArray<FlatOperator>(
+        data, size, flat_function.operators_offset, flat_function.num_operators);
+    for (size_t i = 0; i < flat_function.num_operators; ++i) {
+      auto name = str(operators[i].name);
+      auto overload_name = str(operators[i].overload_name);
+      if (!function->append_operator(name, overload_name)) {
+        unsupported_op_names.emplace(name + "." + overload_name);
+      }
+    }
+    if (!unsupported_op_names.empty()) {
+      print_unsupported_ops_and_throw(unsupported_op_names);
+    }
+
+    const auto* constants = flatArray<FlatConstant>(
+        data, size, flat_function.constants_offset, flat_function.num_constants);
+    for (size_t i = 0; i < flat_function.num_constants; ++i) {
+      const auto& c = constants[i];
+      switch (c.tag) {
+        case FlatConstantTag::None:
+          function->append_constant(IValue());
+          break;
+        case FlatConstantTag::Bool:
+          function->append_constant(static_cast<bool>(c.i));
+          break;
+        case FlatConstantTag::Int:
+          function->append_constant(c.i);
+          break;
+        case FlatConstantTag::Double:
+          function->append_constant(c.d);
+          break;
+        case FlatConstantTag::String:
+          function->append_constant(str(c.payload));
+          break;
+        case FlatConstantTag::Device:
+          function->append_constant(c10::Device(str(c.payload)));
+          break;
+        case FlatConstantTag::IntList: {
+          const auto* values = flatArray<int64_t>(data, size, c.payload, c.size);
+          function->append_constant(
+              IValue(at::ArrayRef<int64_t>(values, c.size)));
+        } break;
+        case FlatConstantTag::Tensor:
+          TORCH_CHECK(
+              c.payload < tensors.size(), "Corrupted flat bytecode record");
+          function->append_constant(tensors[c.payload]);
+          break;
+        default:
+          TORCH_CHECK(false, "Corrupted flat bytecode record");
+      }
+    }
+
+    const auto* type_ids = flatArray<uint32_t>(
+        data, size, flat_function.types_offset, flat_function.num_types);
+    for (size_t i = 0; i < flat_function.num_types; ++i) {
+      auto it = types.find(type_ids[i]);
+      if (it == types.end()) {
+        it = types.emplace(type_ids[i], c10::parseType(str(type_ids[i]))).first;
+      }
+      function->append_type(it->second);
+    }
+
+    function->set_register_size(flat_function.register_size);
+    function->form_superinstructions();
+
+    mcu.register_function(std::move(function));
+  }
+  return true;
+}
+
 c10::IValue BytecodeDeserializer::readArchive(const std::string& archive_name,
     std::shared_ptr<mobile::CompilationUnit> mcu) {
   std::stringstream picklename;
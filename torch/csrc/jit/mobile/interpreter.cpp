@@ -19,44 +19,89 @@ InterpreterState::InterpreterState(std::shared_ptr<Code> code) : code_(std::move
   registers_.resize(code_->register_size_);
 }
 
+// Threaded dispatch jumps from the end of each handler straight to the next
+// one through a table of label addresses, which needs the labels-as-values
+// extension. Other compilers, or builds defining
+// PYTORCH_MOBILE_INTERPRETER_SWITCH_DISPATCH, use a switch instead.
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    !defined(PYTORCH_MOBILE_INTERPRETER_SWITCH_DISPATCH)
+#define MOBILE_INTERPRETER_COMPUTED_GOTO
+#endif
+
+#ifdef MOBILE_INTERPRETER_COMPUTED_GOTO
+#define INST(name) label_##name
+#define DISPATCH()           \
+  inst = instructions[pc];   \
+  goto* dispatch_table[inst.op]
+#else
+#define INST(name) case name
+#define DISPATCH() break
+#endif
+
+#if defined(PYTORCH_MOBILE_OPERATOR_OBSERVER)
+#define RECORD_OP(op_pc, op_idx)                                      \
+  if (auto debug_info = at::getThreadLocalDebugInfo()) {              \
+    if (auto* mobile_debug_info =                                     \
+            dynamic_cast<MobileDebugInfo*>(debug_info.get())) {       \
+      mobile_debug_info->setOpIdx(op_pc);                             \
+    }                                                                 \
+  }                                                                   \
+  RECORD_FUNCTION(code_->op_names_[op_idx].name, stack)
+#else
+#define RECORD_OP(op_pc, op_idx)
+#endif
+
 bool InterpreterState::run(Stack& stack) {
+  const Instruction* instructions = code_->instructions_.data();
+  const c10::OperatorHandle* operators = code_->operators_.data();
+  const c10::Dispatcher& dispatcher = c10::Dispatcher::singleton();
   size_t pc = 0;
-  while (true) {
-    Instruction inst = code_->instructions_[pc];
+  Instruction inst = instructions[pc];
 
-  //  std::cout << "RUNNING " << pc << " " << code_->instructions_[pc];
-  //  if (inst.op == OP) {
-  //    std::cout << ", " << code_->op_names_[inst.X].name << "." <<
-  //      code_->op_names_[inst.X].overload_name;
-  //  }
-  //  std::cout << std::endl;
-  //  for (auto val : stack) {
-  //    if (val.isTensor()) {
-  //      std::cout << val.toTensor().sizes() << std::endl;
-  //    } else {
-  //      std::cout << val << std::endl;
-  //    }
-  //  }
-    switch (inst.op) {
-      case OP: {
-#if defined(PYTORCH_MOBILE_OPERATOR_OBSERVER)
-        if (auto debug_info = at::getThreadLocalDebugInfo()) {
-          if (auto* mobile_debug_info = dynamic_cast<MobileDebugInfo*>(
-            debug_info.get())) {
-            mobile_debug_info->setOpIdx(pc);
-          }
-        }
-        RECORD_FUNCTION(code_->op_names_[inst.X].name, stack);
+#ifdef MOBILE_INTERPRETER_COMPUTED_GOTO
+  static void* const dispatch_table[kNumMobileOpCodes] = {
+#define DISPATCH_LABEL(op, _) &&label_##op,
+      FORALL_OPCODES(DISPATCH_LABEL)
+#undef DISPATCH_LABEL
+      &&label_OP_STORE,
+      &&label_LOAD_OP,
+      &&label_MOVE_OP,
+  };
+  goto* dispatch_table[inst.op];
+#else
+  while (true) {
+    inst = instructions[pc];
+    switch (static_cast<uint8_t>(inst.op)) {
 #endif
-        code_->operators_[inst.X](stack);
+      INST(OP): {
+        RECORD_OP(pc, inst.X);
+        dispatcher.callBoxed(operators[inst.X], &stack);
         ++pc;
-      } break;
-      case OPN: {
+      } DISPATCH();
+      INST(OPN): {
         stack.push_back(inst.N);
-        code_->operators_[inst.X](stack);
+        dispatcher.callBoxed(operators[inst.X], &stack);
         ++pc;
-      } break;
-      case INTERFACE_CALL: {
+      } DISPATCH();
+      INST(OP_STORE): {
+        RECORD_OP(pc, inst.X);
+        dispatcher.callBoxed(operators[inst.X], &stack);
+        reg(inst.N) = pop(stack);
+        pc += 2;
+      } DISPATCH();
+      INST(LOAD_OP): {
+        stack.emplace_back(reg(inst.N));
+        RECORD_OP(pc + 1, inst.X);
+        dispatcher.callBoxed(operators[inst.X], &stack);
+        pc += 2;
+      } DISPATCH();
+      INST(MOVE_OP): {
+        stack.emplace_back(std::move(reg(inst.N)));
+        RECORD_OP(pc + 1, inst.X);
+        dispatcher.callBoxed(operators[inst.X], &stack);
+        pc += 2;
+      } DISPATCH();
+      INST(INTERFACE_CALL): {
         torch::jit::Function* method =
             peek(stack, 0, inst.N)
                 .toObject()
@@ -64,44 +109,44 @@ bool InterpreterState::run(Stack& stack) {
                 ->getMethod(code_->constants_[inst.X].toStringRef());
         method->run(stack);
         ++pc;
-      } break;
-      case LOAD:
+      } DISPATCH();
+      INST(LOAD): {
         stack.emplace_back(reg(inst.X));
         ++pc;
-        break;
-      case MOVE:
+      } DISPATCH();
+      INST(MOVE): {
         stack.emplace_back(std::move(reg(inst.X)));
         ++pc;
-        break;
-      case STORE:
+      } DISPATCH();
+      INST(STORE): {
         reg(inst.X) = pop(stack);
         ++pc;
-        break;
-      case STOREN:
+      } DISPATCH();
+      INST(STOREN): {
         for (size_t i = inst.N; i > 0; --i) {
           reg(inst.X + i - 1) = pop(stack);
         }
         ++pc;
-        break;
-      case DROP:
+      } DISPATCH();
+      INST(DROP): {
         pop(stack);
         ++pc;
-        break;
-      case DROPR:
+      } DISPATCH();
+      INST(DROPR): {
         reg(inst.X) = IValue();
         ++pc;
-        break;
-      case LOADC:
+      } DISPATCH();
+      INST(LOADC): {
         stack.emplace_back(code_->constants_[inst.X]);
         ++pc;
-        break;
-      case GET_ATTR: {
+      } DISPATCH();
+      INST(GET_ATTR): {
         auto userObj = pop(stack).toObject();
         auto value = userObj->getSlot(inst.X);
         push(stack, std::move(value));
         ++pc;
-      } break;
-      case SET_ATTR: {
+      } DISPATCH();
+      INST(SET_ATTR): {
         auto v = pop(stack);
         auto userObj = pop(stack).toObject();
         // Mobile only: since the number of slots is not known, resize the numAttributes
@@ -113,14 +158,14 @@ bool InterpreterState::run(Stack& stack) {
         }
         userObj->setSlot(inst.X, std::move(v));
         ++pc;
-      } break;
-      case JF:
+      } DISPATCH();
+      INST(JF): {
         pc += (pop(stack).toBool()) ? 1 : inst.X;
-        break;
-      case JMP:
+      } DISPATCH();
+      INST(JMP): {
         pc += inst.X;
-        break;
-      case LOOP: {
+      } DISPATCH();
+      INST(LOOP): {
         // stack: iteration_count, max_iter, cond, loop_carried_deps...
         auto frame = stack.end() - (inst.N + 1);
         int64_t trip_count = frame[0].toInt();
@@ -138,30 +183,53 @@ bool InterpreterState::run(Stack& stack) {
           drop(stack, 3); // iteration_count, max_iter, cond
           pc += inst.X;
         }
-      } break;
-      case RET:
+      } DISPATCH();
+      INST(RET): {
         return false;
-      case LIST_CONSTRUCT: {
+      }
+      INST(LIST_CONSTRUCT): {
         auto type = code_->types_[inst.X]->expect<at::ListType>();
         listConstruct(stack, type, inst.N);
         ++pc;
-      } break;
-      case TUPLE_CONSTRUCT: {
+      } DISPATCH();
+      INST(TUPLE_CONSTRUCT): {
         tupleConstruct(stack, inst.X);
         ++pc;
-      } break;
-      case WARN: {
+      } DISPATCH();
+      INST(WARN): {
         drop(stack, 1);
         TORCH_WARN(pop(stack).toStringRef());
         ++pc;
-      } break;
+      } DISPATCH();
+      // Rejected by Function::append_instruction, listed so that every
+      // OpCode has a dispatch table entry.
+      INST(WAIT):
+      INST(CALL):
+      INST(GUARD):
+      INST(FAIL_GUARD):
+      INST(TAIL_CALL):
+      INST(LIST_UNPACK):
+      INST(TUPLE_SLICE):
+      INST(NAMED_TUPLE_CONSTRUCT):
+      INST(DICT_CONSTRUCT):
+      INST(CREATE_OBJECT):
+      INST(ISINSTANCE):
+      INST(FORK):
+#ifndef MOBILE_INTERPRETER_COMPUTED_GOTO
       default:
+#endif
         AT_ERROR(toString(inst.op), " is invalid.");
+#ifndef MOBILE_INTERPRETER_COMPUTED_GOTO
     }
   }
+#endif
   return false;
 }
 
+#undef RECORD_OP
+#undef DISPATCH
+#undef INST
+
 IValue& InterpreterState::reg(size_t reg) {
   return *(registers_.end() - reg);
 }
@@ -8,10 +8,30 @@ namespace torch{
 namespace jit{
 namespace mobile {
 using Stack = std::vector<c10::IValue>;
+
+#define COUNT_OPCODE(op, _) +1
+constexpr uint8_t kNumOpCodes = 0 FORALL_OPCODES(COUNT_OPCODE);
+#undef COUNT_OPCODE
+
+// Superinstructions replace the first instruction of a common pair when a
+// function is loaded (see Function::form_superinstructions). They are numbered
+// after the last OpCode and never appear in serialized bytecode. The second
+// instruction of the pair is left in place, so jump offsets do not change and
+// a jump to it still runs it on its own.
+//   OP_STORE: OP X; STORE N -> invoke operator X, store the top of the stack
+//             to register N
+//   LOAD_OP:  LOAD N; OP X -> push register N, invoke operator X
+//   MOVE_OP:  MOVE N; OP X -> push register N clearing it, invoke operator X
+constexpr OpCode OP_STORE = static_cast<OpCode>(kNumOpCodes);
+constexpr OpCode LOAD_OP = static_cast<OpCode>(kNumOpCodes + 1);
+constexpr OpCode MOVE_OP = static_cast<OpCode>(kNumOpCodes + 2);
+constexpr uint8_t kNumMobileOpCodes = kNumOpCodes + 3;
+
 struct Code {
   std::vector<Instruction> instructions_;
   std::vector<c10::OperatorName> op_names_;
-  std::vector<std::function<void(Stack&)>> operators_;
+  // Resolved once at load time and called through the dispatcher directly.
+  std::vector<c10::OperatorHandle> operators_;
   std::vector<c10::IValue> constants_;
   std::vector<c10::TypePtr> types_;
   size_t register_size_; // Aggregated output size.
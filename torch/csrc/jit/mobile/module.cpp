@@ -47,9 +47,18 @@ c10::IValue Module::run_method(const std::string& method_name, Stack stack) {
 #endif
 
   auto m = find_method(method_name);
-  stack.insert(stack.begin(), object_);
-  m->run(stack);
-  c10::IValue result = stack.front();
+  c10::IValue result;
+  {
+    // Hold the pool for the whole run, set_memory_reuse on another thread
+    // only drops the module's reference to it.
+    auto caching_allocator = std::atomic_load(&caching_allocator_);
+    c10::WithCPUCachingAllocatorGuard guard(caching_allocator.get());
+    stack.insert(stack.begin(), object_);
+    m->run(stack);
+    result = stack.front();
+    // Free the inputs and anything else left on the stack into the pool.
+    stack.clear();
+  }
 
 #if defined(PYTORCH_MOBILE_OBSERVER)
   if (observer) {
@@ -68,6 +77,26 @@ Function* Module::find_method(const std::string& basename) const {
   AT_ERROR("Method '", basename, "' is not defined.");
 }
 
+void Module::set_memory_reuse(bool enabled, size_t max_cached_bytes) {
+  std::shared_ptr<c10::CPUCachingAllocator> caching_allocator;
+  if (enabled) {
+    caching_allocator =
+        std::make_shared<c10::CPUCachingAllocator>(max_cached_bytes);
+  }
+  std::atomic_store(&caching_allocator_, std::move(caching_allocator));
+}
+
+void Module::release_cached_memory() {
+  if (auto caching_allocator = std::atomic_load(&caching_allocator_)) {
+    caching_allocator->free_cached();
+  }
+}
+
+size_t Module::cached_memory_bytes() const {
+  auto caching_allocator = std::atomic_load(&caching_allocator_);
+  return caching_allocator ? caching_allocator->cached_bytes() : 0;
+}
+
 namespace {
 void slot_params_recurse(
     const c10::intrusive_ptr<c10::ivalue::Object>& obj,
@@ -1,5 +1,6 @@
 #pragma once
 //#include <ATen/core/function_schema.h>
+#include <c10/core/CPUCachingAllocator.h>
 #include <torch/csrc/jit/mobile/function.h>
 
 namespace torch{
@@ -31,9 +32,22 @@ class TORCH_API Module {
   std::string name() {return object_->name();}
   const std::vector<at::IValue>& slots() const {return object_->slots();}
   const std::vector<at::Tensor> parameters() const;
+  // When enabled, tensor storages freed while a method runs are kept in a
+  // pool owned by the module, up to `max_cached_bytes`, and reused by later
+  // allocations of the same size. Off by default; disabling it releases the
+  // pool. It may be called while another thread runs a method, which keeps
+  // using the pool it started with until it returns.
+  void set_memory_reuse(
+      bool enabled,
+      size_t max_cached_bytes = std::numeric_limits<size_t>::max());
+  // Releases the storages cached by the pool, keeping reuse enabled.
+  void release_cached_memory();
+  // The total size of the storages cached by the pool.
+  size_t cached_memory_bytes() const;
 private:
   c10::intrusive_ptr<c10::ivalue::Object> object_;
   std::shared_ptr<CompilationUnit> cu_;
+  std::shared_ptr<c10::CPUCachingAllocator> caching_allocator_;
 };
 } // namespace mobile
 } // namespace torch
@@ -0,0 +1,615 @@
+#include <torch/csrc/jit/passes/frozen_graph_optimizations.h>
+
+#include <ATen/ATen.h>
+#include <torch/csrc/jit/ir/constants.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <torch/csrc/jit/passes/constant_pooling.h>
+#include <torch/csrc/jit/passes/dead_code_elimination.h>
+#include <torch/csrc/jit/passes/freeze_module.h>
+#include <torch/csrc/jit/passes/prepack_folding.h>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+const char* conv2d_schema =
+    "aten::conv2d(Tensor input, Tensor weight, Tensor? bias, int[] stride, int[] padding, int[] dilation, int groups) -> Tensor";
+
+c10::optional<at::Tensor> constantTensor(const Value* v) {
+  auto iv = toIValue(v);
+  if (!iv || !iv->isTensor()) {
+    return c10::nullopt;
+  }
+  return iv->toTensor();
+}
+
+// An aten::conv2d or aten::linear node with a constant weight and bias, the
+// output channels of both being along dimension 0.
+struct WeightedOp {
+  Node* node;
+  at::Tensor weight;
+  // zeros if the node has no bias
+  at::Tensor bias;
+  // dimension of the output holding the output channels, counted from the end
+  int64_t channel_dim;
+  // highest rank of a constant that broadcasts to the output without
+  // changing its shape
+  int64_t max_rank;
+};
+
+// The op producing `v`, if its weights may be changed to absorb the single
+// use of `v`.
+c10::optional<WeightedOp> weightedOp(Value* v) {
+  Node* n = v->node();
+  int64_t channel_dim = 0;
+  int64_t max_rank = 0;
+  if (n->matches(conv2d_schema)) {
+    channel_dim = -3;
+    max_rank = 4;
+  } else if (n->matches(
+                 "aten::linear(Tensor input, Tensor weight, Tensor? bias) -> Tensor")) {
+    channel_dim = -1;
+    max_rank = 1;
+  } else {
+    return c10::nullopt;
+  }
+  if (v->uses().size() != 1) {
+    return c10::nullopt;
+  }
+  auto weight = constantTensor(n->input(1));
+  if (!weight || !weight->is_floating_point() || weight->is_mkldnn() ||
+      weight->is_sparse()) {
+    return c10::nullopt;
+  }
+  at::Tensor bias;
+  if (auto b = constantTensor(n->input(2))) {
+    if (b->dim() != 1 || b->size(0) != weight->size(0) ||
+        !b->options().type_equal(weight->options())) {
+      return c10::nullopt;
+    }
+    bias = *b;
+  } else if (n->input(2)->mustBeNone()) {
+    bias = at::zeros({weight->size(0)}, weight->options());
+  } else {
+    return c10::nullopt;
+  }
+  return WeightedOp{n, *weight, bias, channel_dim, max_rank};
+}
+
+void setWeightAndBias(
+    const WeightedOp& op,
+    const at::Tensor& weight,
+    const at::Tensor& bias) {
+  Graph* graph = op.node->owningGraph();
+  WithInsertPoint guard(op.node);
+  op.node->replaceInput(1, graph->insertConstant(weight));
+  op.node->replaceInput(2, graph->insertConstant(bias));
+}
+
+// `v` as one value per output channel of `op`, `fill` if `v` is None.
+c10::optional<at::Tensor> channelConstant(
+    const Value* v,
+    const WeightedOp& op,
+    double fill) {
+  if (v->mustBeNone()) {
+    return at::full({op.weight.size(0)}, fill, op.weight.options());
+  }
+  auto t = constantTensor(v);
+  if (!t || t->dim() != 1 || t->size(0) != op.weight.size(0) ||
+      !t->options().type_equal(op.weight.options())) {
+    return c10::nullopt;
+  }
+  return t;
+}
+
+bool foldBatchNorm(Node* n) {
+  if (!n->matches(
+          "aten::batch_norm(Tensor input, Tensor? weight, Tensor? bias, Tensor? running_mean, Tensor? running_var, bool training, float momentum, float eps, bool cudnn_enabled) -> Tensor")) {
+    return false;
+  }
+  auto op = weightedOp(n->input(0));
+  if (!op || op->node->kind() != aten::conv2d) {
+    return false;
+  }
+  auto training = toIValue(n->input(5));
+  auto eps = toIValue(n->input(7));
+  // without running statistics batch_norm normalizes by the batch statistics
+  if (!training || training->toBool() || !eps ||
+      n->input(3)->mustBeNone() || n->input(4)->mustBeNone()) {
+    return false;
+  }
+  auto gamma = channelConstant(n->input(1), *op, 1);
+  auto beta = channelConstant(n->input(2), *op, 0);
+  auto mean = channelConstant(n->input(3), *op, 0);
+  auto var = channelConstant(n->input(4), *op, 1);
+  if (!gamma || !beta || !mean || !var) {
+    return false;
+  }
+
+  // Same computation as torch/nn/utils/fusion.py
+  at::Tensor scale = *gamma * at::rsqrt(*var + eps->toDouble());
+  setWeightAndBias(
+      *op,
+      op->weight * scale.reshape({-1, 1, 1, 1}),
+      (op->bias - *mean) * scale + *beta);
+  GRAPH_UPDATE("Folded aten::batch_norm into ", *op->node);
+  n->output()->replaceAllUsesWith(op->node->output());
+  n->destroy();
+  return true;
+}
+
+enum class Arithmetic { Add, Sub, Mul, Div };
+
+c10::optional<Arithmetic> arithmetic(const Node* n) {
+  static const std::vector<std::pair<const char*, Arithmetic>> schemas = {
+      {"aten::add(Tensor self, Tensor other, *, Scalar alpha) -> Tensor",
+       Arithmetic::Add},
+      {"aten::add(Tensor self, Scalar other, Scalar alpha) -> Tensor",
+       Arithmetic::Add},
+      {"aten::add_(Tensor self, Tensor other, *, Scalar alpha) -> Tensor",
+       Arithmetic::Add},
+      {"aten::add_(Tensor self, Scalar other, Scalar alpha) -> Tensor",
+       Arithmetic::Add},
+      {"aten::sub(Tensor self, Tensor other, *, Scalar alpha) -> Tensor",
+       Arithmetic::Sub},
+      {"aten::sub(Tensor self, Scalar other, Scalar alpha) -> Tensor",
+       Arithmetic::Sub},
+      {"aten::sub_(Tensor self, Tensor other, *, Scalar alpha) -> Tensor",
+       Arithmetic::Sub},
+      {"aten::sub_(Tensor self, Scalar other, Scalar alpha) -> Tensor",
+       Arithmetic::Sub},
+      {"aten::mul(Tensor self, Tensor other) -> Tensor", Arithmetic::Mul},
+      {"aten::mul(Tensor self, Scalar other) -> Tensor", Arithmetic::Mul},
+      {"aten::mul_(Tensor self, Tensor other) -> Tensor", Arithmetic::Mul},
+      {"aten::mul_(Tensor self, Scalar other) -> Tensor", Arithmetic::Mul},
+      {"aten::div(Tensor self, Tensor other) -> Tensor", Arithmetic::Div},
+      {"aten::div(Tensor self, Scalar other) -> Tensor", Arithmetic::Div},
+      {"aten::div_(Tensor self, Tensor other) -> Tensor", Arithmetic::Div},
+      {"aten::div_(Tensor self, Scalar other) -> Tensor", Arithmetic::Div},
+  };
+  if (n->kind() != aten::add && n->kind() != aten::add_ &&
+      n->kind() != aten::sub && n->kind() != aten::sub_ &&
+      n->kind() != aten::mul && n->kind() != aten::mul_ &&
+      n->kind() != aten::div && n->kind() != aten::div_) {
+    return c10::nullopt;
+  }
+  for (const auto& entry : schemas) {
+    if (n->matches(entry.first)) {
+      return entry.second;
+    }
+  }
+  return c10::nullopt;
+}
+
+bool foldArithmetic(Node* n) {
+  auto kind = arithmetic(n);
+  if (!kind) {
+    return false;
+  }
+  auto op = weightedOp(n->input(0));
+  auto other = toIValue(n->input(1));
+  if (!op || !other) {
+    return false;
+  }
+  const int64_t channels = op->weight.size(0);
+  at::Tensor c;
+  if (other->isTensor()) {
+    c = other->toTensor();
+    // a dimensioned constant of another dtype or device takes part in type
+    // promotion, or fails, at runtime
+    if (c.dim() > 0 && !c.options().type_equal(op->weight.options())) {
+      return false;
+    }
+    if (c.dim() > op->max_rank || c.is_mkldnn() || c.is_sparse()) {
+      return false;
+    }
+    for (int64_t d = 0; d < c.dim(); ++d) {
+      const bool channel_dim = d - c.dim() == op->channel_dim;
+      if (c.size(d) != 1 && !(channel_dim && c.size(d) == channels)) {
+        return false;
+      }
+    }
+  } else if (other->isDouble() || other->isInt()) {
+    c = at::scalar_tensor(other->toScalar(), op->weight.options());
+  } else {
+    return false;
+  }
+  c = c.to(op->weight.options()).reshape({-1}).expand({channels});
+
+  at::Tensor weight = op->weight;
+  at::Tensor bias = op->bias;
+  switch (*kind) {
+    case Arithmetic::Add:
+    case Arithmetic::Sub: {
+      auto alpha = toIValue(n->input(2));
+      if (!alpha) {
+        return false;
+      }
+      c = c * alpha->toScalar();
+      bias = *kind == Arithmetic::Add ? bias + c : bias - c;
+      break;
+    }
+    case Arithmetic::Mul:
+    case Arithmetic::Div: {
+      if (*kind == Arithmetic::Div) {
+        c = c.reciprocal();
+      }
+      // 0 * inf in the folded weights would turn into nan
+      if (!at::isfinite(c).all().item<bool>()) {
+        return false;
+      }
+      std::vector<int64_t> shape(weight.dim(), 1);
+      shape[0] = -1;
+      weight = weight * c.reshape(shape);
+      bias = bias * c;
+      break;
+    }
+  }
+  setWeightAndBias(*op, weight, bias);
+  GRAPH_UPDATE("Folded ", n->kind().toQualString(), " into ", *op->node);
+  n->output()->replaceAllUsesWith(op->node->output());
+  n->destroy();
+  return true;
+}
+
+// Rewrites aten::matmul and aten::mm by a constant matrix, and aten::addmm
+// with a constant matrix and bias, to aten::linear.
+bool rewriteAsLinear(Node* n) {
+  Value* input = nullptr;
+  at::Tensor weight;
+  IValue bias;
+  if (n->matches("aten::matmul(Tensor self, Tensor other) -> Tensor") ||
+      n->matches("aten::mm(Tensor self, Tensor mat2) -> Tensor")) {
+    auto w = constantTensor(n->input(1));
+    if (!w || w->dim() != 2 || !w->is_floating_point() || w->is_mkldnn() ||
+        w->is_sparse()) {
+      return false;
+    }
+    input = n->input(0);
+    weight = w->t().contiguous();
+  } else if (n->matches(
+                 "aten::addmm(Tensor self, Tensor mat1, Tensor mat2, *, Scalar beta, Scalar alpha) -> Tensor")) {
+    auto w = constantTensor(n->input(2));
+    auto b = constantTensor(n->input(0));
+    auto beta = toIValue(n->input(3));
+    auto alpha = toIValue(n->input(4));
+    if (!w || w->dim() != 2 || !w->is_floating_point() || w->is_mkldnn() ||
+        w->is_sparse() || !b || b->dim() != 1 || b->size(0) != w->size(1) ||
+        !b->options().type_equal(w->options()) || !beta || !alpha) {
+      return false;
+    }
+    input = n->input(1);
+    weight = (*w * alpha->toScalar()).t().contiguous();
+    bias = *b * beta->toScalar();
+  } else {
+    return false;
+  }
+  Graph* graph = n->owningGraph();
+  WithInsertPoint guard(n);
+  Value* linear = graph->insert(aten::linear, {input, weight, bias});
+  linear->copyMetadata(n->output());
+  GRAPH_UPDATE("Rewrote ", n->kind().toQualString(), " as ", *linear->node());
+  n->output()->replaceAllUsesWith(linear);
+  n->destroy();
+  return true;
+}
+
+void foldBlock(Block* block, const std::function<bool(Node*)>& fold) {
+  for (auto it = block->nodes().begin(); it != block->nodes().end();) {
+    Node* n = *it++;
+    for (Block* sub : n->blocks()) {
+      foldBlock(sub, fold);
+    }
+    fold(n);
+  }
+}
+
+void prepackMKLDNNConvWeights(Block* block) {
+  for (auto it = block->nodes().begin(); it != block->nodes().end();) {
+    Node* n = *it++;
+    for (Block* sub : n->blocks()) {
+      prepackMKLDNNConvWeights(sub);
+    }
+    if (!n->matches(conv2d_schema)) {
+      continue;
+    }
+    auto weight = constantTensor(n->input(1));
+    auto bias = toIValue(n->input(2));
+    auto stride = toIValue(n->input(3));
+    auto padding = toIValue(n->input(4));
+    auto dilation = toIValue(n->input(5));
+    auto groups = toIValue(n->input(6));
+    // the conditions under which aten::_convolution itself picks MKLDNN,
+    // the input has the weight's dtype and device or the conv fails anyway
+    if (!weight || weight->scalar_type() != at::kFloat ||
+        !weight->device().is_cpu() || weight->is_mkldnn() ||
+        weight->is_sparse() || weight->dim() != 4 || !bias ||
+        (!bias->isNone() && !bias->isTensor()) || !stride || !padding ||
+        !dilation || !groups) {
+      continue;
+    }
+    auto dilation_vec = dilation->toIntVector();
+    if (std::any_of(dilation_vec.begin(), dilation_vec.end(), [](int64_t d) {
+          return d != 1;
+        })) {
+      continue;
+    }
+    at::Tensor reordered = at::mkldnn_reorder_conv2d_weight(
+        weight->to_mkldnn(),
+        padding->toIntVector(),
+        stride->toIntVector(),
+        dilation_vec,
+        groups->toInt());
+
+    Graph* graph = n->owningGraph();
+    WithInsertPoint guard(n);
+    Value* conv = graph->insert(
+        aten::mkldnn_convolution,
+        {n->input(0),
+         reordered,
+         n->input(2),
+         n->input(4),
+         n->input(3),
+         n->input(5),
+         n->input(6)});
+    conv->copyMetadata(n->output());
+    n->output()->replaceAllUsesWith(conv);
+    n->destroy();
+  }
+}
+
+// Ops with an MKLDNN kernel that take an MKLDNN tensor as their first input
+// and return one, under the conditions the kernel supports.
+bool hasMKLDNNKernel(Node* n) {
+  if (n->matches("aten::relu(Tensor self) -> Tensor") ||
+      n->matches("aten::sigmoid(Tensor self) -> Tensor") ||
+      n->matches(
+          "aten::hardtanh(Tensor self, Scalar min_val, Scalar max_val) -> Tensor") ||
+      n->matches(
+          "aten::max_pool2d(Tensor self, int[] kernel_size, int[] stride, int[] padding, int[] dilation, bool ceil_mode) -> Tensor") ||
+      n->matches(
+          "aten::adaptive_avg_pool2d(Tensor self, int[] output_size) -> Tensor") ||
+      n->matches("aten::reshape(Tensor self, int[] shape) -> Tensor") ||
+      n->matches(
+          "aten::flatten(Tensor self, int start_dim, int end_dim) -> Tensor") ||
+      n->matches(
+          "aten::transpose(Tensor self, int dim0, int dim1) -> Tensor")) {
+    return true;
+  }
+  // in place, only when nothing else sees the mutation
+  if (n->matches("aten::relu_(Tensor self) -> Tensor") ||
+      n->matches(
+          "aten::hardtanh_(Tensor self, Scalar min_val, Scalar max_val) -> Tensor")) {
+    return n->input(0)->uses().size() == 1;
+  }
+  if (n->matches(
+          "aten::avg_pool2d(Tensor self, int[] kernel_size, int[] stride, int[] padding, bool ceil_mode, bool count_include_pad, int? divisor_override) -> Tensor")) {
+    return n->input(6)->type()->kind() == TypeKind::NoneType;
+  }
+  if (n->matches(
+          "aten::softmax(Tensor self, int dim, ScalarType? dtype) -> Tensor")) {
+    return n->input(2)->type()->kind() == TypeKind::NoneType;
+  }
+  if (n->matches(
+          "aten::dropout(Tensor input, float p, bool train) -> Tensor")) {
+    auto train = toIValue(n->input(2));
+    return train && !train->toBool();
+  }
+  return false;
+}
+
+// Keeps maximal chains of ops with MKLDNN kernels in the MKLDNN layout. A
+// chain starts at an aten::mkldnn_convolution with a prepacked weight and
+// extends to every op with an MKLDNN kernel consuming a value of the chain,
+// as long as its other tensor operands are known to be float.
+// Values are converted to MKLDNN where they enter a chain, and back to dense
+// once, right after their producer, for their uses outside of it.
+void propagateMKLDNNLayout(Block* block) {
+  for (Node* n : block->nodes()) {
+    for (Block* sub : n->blocks()) {
+      propagateMKLDNNLayout(sub);
+    }
+  }
+
+  Graph* graph = block->owningGraph();
+  std::unordered_set<Value*> mkldnn_values;
+  std::unordered_set<Node*> mkldnn_nodes;
+  std::unordered_map<Value*, Value*> converted_inputs;
+
+  // the MKLDNN form of the tensor `v`, for a use by `user`
+  auto to_mkldnn = [&](Value* v, Node* user) -> Value* {
+    if (mkldnn_values.count(v)) {
+      return v;
+    }
+    auto it = converted_inputs.find(v);
+    if (it != converted_inputs.end()) {
+      return it->second;
+    }
+    WithInsertPoint guard(user);
+    // constants are converted once, here
+    auto constant = constantTensor(v);
+    Value* converted = constant
+        ? graph->insertConstant(constant->contiguous().to_mkldnn())
+        : graph->insert(aten::to_mkldnn, {v});
+    converted->setType(v->type());
+    converted_inputs.emplace(v, converted);
+    return converted;
+  };
+
+  auto is_mkldnn = [&](Value* v) { return mkldnn_values.count(v) > 0; };
+  // MKLDNN tensors are float only, so other operands may only join a chain
+  // when they are known to be float tensors.
+  auto can_convert = [&](Value* v) {
+    if (mkldnn_values.count(v) || converted_inputs.count(v)) {
+      return true;
+    }
+    if (auto constant = constantTensor(v)) {
+      return constant->scalar_type() == at::kFloat &&
+          constant->device().is_cpu() && !constant->is_sparse();
+    }
+    auto type = v->type()->cast<TensorType>();
+    return type && type->scalarType() == at::kFloat;
+  };
+
+  for (auto it = block->nodes().begin(); it != block->nodes().end();) {
+    Node* n = *it++;
+    if (n->matches(
+            "aten::mkldnn_convolution(Tensor self, Tensor weight, Tensor? bias, int[] padding, int[] stride, int[] dilation, int groups) -> Tensor")) {
+      auto weight = constantTensor(n->input(1));
+      if (!weight || !weight->is_mkldnn()) {
+        continue;
+      }
+      n->replaceInput(0, to_mkldnn(n->input(0), n));
+    } else if (n->matches(
+                   "aten::linear(Tensor input, Tensor weight, Tensor? bias) -> Tensor")) {
+      auto weight = constantTensor(n->input(1));
+      auto bias = toIValue(n->input(2));
+      if (!is_mkldnn(n->input(0)) || !weight || weight->dim() != 2 ||
+          weight->scalar_type() != at::kFloat || !weight->device().is_cpu() ||
+          weight->is_sparse() || !bias ||
+          (!bias->isNone() && !bias->isTensor())) {
+        continue;
+      }
+      // mkldnn_linear requires an MKLDNN weight and bias
+      at::Tensor b = bias->isTensor() ? bias->toTensor()
+                                      : at::zeros({weight->size(0)}, weight->options());
+      WithInsertPoint guard(n);
+      Value* linear = graph->insert(
+          aten::mkldnn_linear,
+          {n->input(0), weight->to_mkldnn(), b.contiguous().to_mkldnn()});
+      linear->copyMetadata(n->output());
+      n->output()->replaceAllUsesWith(linear);
+      n->destroy();
+      n = linear->node();
+    } else if (n->matches(
+                   "aten::add(Tensor self, Tensor other, *, Scalar alpha) -> Tensor")) {
+      if ((!is_mkldnn(n->input(0)) && !is_mkldnn(n->input(1))) ||
+          !can_convert(n->input(0)) || !can_convert(n->input(1))) {
+        continue;
+      }
+      n->replaceInput(0, to_mkldnn(n->input(0), n));
+      n->replaceInput(1, to_mkldnn(n->input(1), n));
+    } else if (n->matches("aten::cat(Tensor[] tensors, int dim) -> Tensor")) {
+      Node* list = n->input(0)->node();
+      if (list->kind() != prim::ListConstruct ||
+          n->input(0)->uses().size() != 1 ||
+          std::none_of(
+              list->inputs().begin(), list->inputs().end(), is_mkldnn) ||
+          !std::all_of(
+              list->inputs().begin(), list->inputs().end(), can_convert)) {
+        continue;
+      }
+      for (size_t i = 0; i < list->inputs().size(); ++i) {
+        list->replaceInput(i, to_mkldnn(list->input(i), list));
+      }
+    } else if (!hasMKLDNNKernel(n) || !is_mkldnn(n->input(0))) {
+      continue;
+    }
+    mkldnn_nodes.insert(n);
+    mkldnn_values.insert(n->output());
+  }
+
+  for (Node* n : mkldnn_nodes) {
+    Value* v = n->output();
+    std::vector<Use> dense_uses;
+    for (const Use& use : v->uses()) {
+      const bool mkldnn_list = use.user->kind() == prim::ListConstruct &&
+          use.user->output()->uses().size() == 1 &&
+          mkldnn_nodes.count(use.user->output()->uses()[0].user);
+      // MKLDNN tensors keep their sizes, so shape queries need no dense copy
+      const bool shape_query = use.user->kind() == aten::size ||
+          use.user->kind() == aten::dim;
+      if (!mkldnn_nodes.count(use.user) && !mkldnn_list && !shape_query) {
+        dense_uses.push_back(use);
+      }
+    }
+    if (dense_uses.empty()) {
+      continue;
+    }
+    WithInsertPoint guard(n->next());
+    Value* dense = graph->insert(aten::to_dense, {v});
+    dense->setType(v->type());
+    for (const Use& use : dense_uses) {
+      use.user->replaceInput(use.offset, dense);
+    }
+  }
+}
+
+bool isPrePackingOp(const Node* n) {
+  const std::string kind = n->kind().toQualString();
+  const std::string suffix = "_prepack";
+  const bool prepack = kind.size() > suffix.size() &&
+      kind.compare(kind.size() - suffix.size(), suffix.size(), suffix) == 0;
+  return prepack &&
+      (kind.rfind("quantized::", 0) == 0 || kind.rfind("_xnnpack::", 0) == 0);
+}
+
+} // namespace
+
+void FoldFrozenConvBatchNorm(std::shared_ptr<Graph>& graph) {
+  at::NoGradGuard no_grad;
+  foldBlock(graph->block(), foldBatchNorm);
+  EliminateDeadCode(graph);
+  GRAPH_DUMP("After FoldFrozenConvBatchNorm: ", graph);
+}
+
+void FoldFrozenConvAndLinearArithmetic(std::shared_ptr<Graph>& graph) {
+  at::NoGradGuard no_grad;
+  foldBlock(graph->block(), [](Node* n) {
+    return rewriteAsLinear(n) || foldArithmetic(n);
+  });
+  EliminateDeadCode(graph);
+  GRAPH_DUMP("After FoldFrozenConvAndLinearArithmetic: ", graph);
+}
+
+void PrepackFrozenMKLDNNConvWeights(std::shared_ptr<Graph>& graph) {
+  if (!at::hasMKLDNN() || !at::globalContext().userEnabledMkldnn()) {
+    return;
+  }
+  at::NoGradGuard no_grad;
+  prepackMKLDNNConvWeights(graph->block());
+  EliminateDeadCode(graph);
+  GRAPH_DUMP("After PrepackFrozenMKLDNNConvWeights: ", graph);
+}
+
+void PropagateFrozenMKLDNNLayout(std::shared_ptr<Graph>& graph) {
+  if (!at::hasMKLDNN() || !at::globalContext().userEnabledMkldnn()) {
+    return;
+  }
+  at::NoGradGuard no_grad;
+  propagateMKLDNNLayout(graph->block());
+  EliminateDeadCode(graph);
+  GRAPH_DUMP("After PropagateFrozenMKLDNNLayout: ", graph);
+}
+
+void OptimizeFrozenGraph(
+    std::shared_ptr<Graph>& graph,
+    bool prepack_mkldnn_weights) {
+  at::NoGradGuard no_grad;
+  // A single walk, so that folds enable each other in any order, e.g. the
+  // batch_norm after a conv + mul sequence.
+  foldBlock(graph->block(), [](Node* n) {
+    return rewriteAsLinear(n) || foldBatchNorm(n) || foldArithmetic(n);
+  });
+  EliminateDeadCode(graph);
+  ConstantPooling(graph);
+  if (prepack_mkldnn_weights) {
+    PrepackFrozenMKLDNNConvWeights(graph);
+    PropagateFrozenMKLDNNLayout(graph);
+  }
+  GRAPH_DUMP("After OptimizeFrozenGraph: ", graph);
+}
+
+Module freeze_and_optimize_module(
+    const Module& module,
+    bool prepack_mkldnn_weights) {
+  Module frozen = freeze_module(module);
+  auto graph = frozen.get_method("forward").graph();
+  OptimizeFrozenGraph(graph, prepack_mkldnn_weights);
+  FoldPrePackingOps(frozen, isPrePackingOp, "frozen_prepack_folding");
+  return frozen;
+}
+
+} // namespace jit
+} // namespace torch
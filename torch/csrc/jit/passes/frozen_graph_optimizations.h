@@ -0,0 +1,70 @@
+/** \brief This file defines inference optimizations for frozen graphs.
+ *
+ * Freezing a module (see passes/freeze_module.h) turns its parameters and
+ * buffers into graph constants. The passes below use that to fold the
+ * constant parts of common layer sequences into the weights of the
+ * preceding convolution or linear layer, so that they cost nothing at
+ * inference time.
+ */
+#pragma once
+
+#include <torch/csrc/jit/api/module.h>
+#include <torch/csrc/jit/ir/ir.h>
+
+namespace torch {
+namespace jit {
+
+/** \brief Fold aten::batch_norm in inference mode into the weight and bias of
+ * the aten::conv2d producing its input.
+ */
+TORCH_API void FoldFrozenConvBatchNorm(std::shared_ptr<Graph>& graph);
+
+/** \brief Fold the addition, subtraction, multiplication or division of a
+ * per-channel constant into the weight and bias of the aten::conv2d or
+ * aten::linear producing the other operand, e.g. the constant shift of a
+ * conv + add + relu sequence or the bias of a matmul + add sequence.
+ * aten::matmul, aten::mm and aten::addmm with a constant weight are rewritten
+ * to aten::linear first so that they take part in the folding.
+ */
+TORCH_API void FoldFrozenConvAndLinearArithmetic(std::shared_ptr<Graph>& graph);
+
+/** \brief Replace aten::conv2d nodes with constant float weights by
+ * aten::mkldnn_convolution on weights reordered into the MKLDNN blocked
+ * layout ahead of time, instead of on every call. Does nothing unless MKLDNN
+ * is available and enabled. The reordered weights are MKLDNN tensors, which
+ * cannot be serialized, so only use this on graphs that are run in process.
+ */
+TORCH_API void PrepackFrozenMKLDNNConvWeights(std::shared_ptr<Graph>& graph);
+
+/** \brief Keep the output of aten::mkldnn_convolution nodes with prepacked
+ * weights (see PrepackFrozenMKLDNNConvWeights) in the MKLDNN layout through
+ * the ops that follow it and have MKLDNN kernels: activations, pooling, add,
+ * cat, reshape, flatten and linear, the latter becoming aten::mkldnn_linear.
+ * Values are converted to and from the dense layout only where they enter
+ * and leave such a chain. Expects dense graph inputs and does nothing unless
+ * MKLDNN is available and enabled.
+ */
+TORCH_API void PropagateFrozenMKLDNNLayout(std::shared_ptr<Graph>& graph);
+
+/** \brief Run all of the above on a frozen graph, in order, followed by
+ * constant pooling and dead code elimination. The MKLDNN passes only run if
+ * `prepack_mkldnn_weights` is set; the graph then holds MKLDNN tensor
+ * constants and can no longer be serialized.
+ */
+TORCH_API void OptimizeFrozenGraph(
+    std::shared_ptr<Graph>& graph,
+    bool prepack_mkldnn_weights = false);
+
+/** \brief Freeze `module` and optimize the frozen forward method for CPU
+ * inference: OptimizeFrozenGraph, then fold the quantized and XNNPACK weight
+ * prepacking ops whose inputs became constants into module attributes (see
+ * passes/prepack_folding.h). Setting `prepack_mkldnn_weights` makes the
+ * returned module unserializable, since torch.jit.save cannot write the
+ * MKLDNN weights it holds.
+ */
+TORCH_API Module freeze_and_optimize_module(
+    const Module& module,
+    bool prepack_mkldnn_weights = false);
+
+} // namespace jit
+} // namespace torch
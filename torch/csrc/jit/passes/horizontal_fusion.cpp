@@ -0,0 +1,253 @@
+#include <torch/csrc/jit/passes/horizontal_fusion.h>
+
+#include <ATen/ATen.h>
+#include <torch/csrc/jit/ir/alias_analysis.h>
+#include <torch/csrc/jit/ir/constants.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <torch/csrc/jit/passes/dead_code_elimination.h>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+// Where the inputs of a fusable op are, and along which dimensions its
+// weights, biases and outputs are concatenated.
+struct FusableOp {
+  // input shared by all siblings
+  size_t shared;
+  size_t weight;
+  int64_t weight_dim;
+  int64_t weight_rank;
+  // optional 1-d input with one entry per output feature
+  c10::optional<size_t> bias;
+  int64_t output_dim;
+};
+
+c10::optional<FusableOp> fusableOp(const Node* n) {
+  if (n->matches(
+          "aten::linear(Tensor input, Tensor weight, Tensor? bias) -> Tensor")) {
+    return FusableOp{0, 1, 0, 2, 2, -1};
+  }
+  if (n->matches("aten::mm(Tensor self, Tensor mat2) -> Tensor")) {
+    return FusableOp{0, 1, 1, 2, c10::nullopt, 1};
+  }
+  if (n->matches(
+          "aten::addmm(Tensor self, Tensor mat1, Tensor mat2, *, Scalar beta, Scalar alpha) -> Tensor")) {
+    return FusableOp{1, 2, 1, 2, 0, 1};
+  }
+  if (n->matches(
+          "aten::conv2d(Tensor input, Tensor weight, Tensor? bias, int[] stride, int[] padding, int[] dilation, int groups) -> Tensor")) {
+    return FusableOp{0, 1, 0, 4, 2, 1};
+  }
+  return c10::nullopt;
+}
+
+c10::optional<at::Tensor> constantTensor(const Value* v) {
+  auto iv = toIValue(v);
+  if (!iv || !iv->isTensor()) {
+    return c10::nullopt;
+  }
+  return iv->toTensor();
+}
+
+bool sameConstant(const IValue& a, const IValue& b) {
+  if (a.isNone() || b.isNone()) {
+    return a.isNone() && b.isNone();
+  }
+  if (a.isIntList() && b.isIntList()) {
+    return a.toIntVector() == b.toIntVector();
+  }
+  if ((a.isInt() || a.isDouble()) && (b.isInt() || b.isDouble())) {
+    return a.toScalar().to<double>() == b.toScalar().to<double>();
+  }
+  if (a.isBool() && b.isBool()) {
+    return a.toBool() == b.toBool();
+  }
+  return false;
+}
+
+bool isCandidate(const Node* n, const FusableOp& op) {
+  auto weight = constantTensor(n->input(op.weight));
+  if (!weight || weight->dim() != op.weight_rank || weight->is_mkldnn() ||
+      weight->is_sparse()) {
+    return false;
+  }
+  if (op.bias) {
+    const Value* bias = n->input(*op.bias);
+    auto t = constantTensor(bias);
+    // addmm's self broadcasts, only 1-d per-feature biases can be split
+    const bool optional = n->kind() != aten::addmm;
+    if (t ? t->dim() != 1 || t->size(0) != weight->size(op.weight_dim)
+          : !(optional && bias->mustBeNone())) {
+      return false;
+    }
+  }
+  for (size_t i = 0; i < n->inputs().size(); ++i) {
+    if (i != op.shared && i != op.weight && (!op.bias || i != *op.bias) &&
+        !toIValue(n->input(i))) {
+      return false;
+    }
+  }
+  if (n->kind() == aten::conv2d && toIValue(n->input(6))->toInt() != 1) {
+    return false;
+  }
+  return true;
+}
+
+// Whether `a` and `b` can be computed by one op: all inputs but weights and
+// biases are the same and the weights only differ along op.weight_dim.
+bool compatible(const Node* a, const Node* b, const FusableOp& op) {
+  if (a->kind() != b->kind()) {
+    return false;
+  }
+  auto wa = *constantTensor(a->input(op.weight));
+  auto wb = *constantTensor(b->input(op.weight));
+  if (wa.scalar_type() != wb.scalar_type() || wa.device() != wb.device()) {
+    return false;
+  }
+  for (int64_t d = 0; d < op.weight_rank; ++d) {
+    if (d != op.weight_dim && wa.size(d) != wb.size(d)) {
+      return false;
+    }
+  }
+  if (op.bias) {
+    auto ba = constantTensor(a->input(*op.bias));
+    auto bb = constantTensor(b->input(*op.bias));
+    if (ba && bb && ba->scalar_type() != bb->scalar_type()) {
+      return false;
+    }
+  }
+  for (size_t i = 0; i < a->inputs().size(); ++i) {
+    if (i != op.shared && i != op.weight && (!op.bias || i != *op.bias) &&
+        !sameConstant(*toIValue(a->input(i)), *toIValue(b->input(i)))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void fuse(const std::vector<Node*>& siblings, const FusableOp& op) {
+  Node* first = siblings.front();
+  Graph* graph = first->owningGraph();
+  WithInsertPoint guard(first);
+
+  std::vector<at::Tensor> weights;
+  std::vector<at::Tensor> biases;
+  bool has_bias = false;
+  std::vector<int64_t> split_sizes;
+  for (Node* n : siblings) {
+    auto weight = *constantTensor(n->input(op.weight));
+    weights.push_back(weight);
+    split_sizes.push_back(weight.size(op.weight_dim));
+    if (op.bias) {
+      auto bias = constantTensor(n->input(*op.bias));
+      has_bias |= bias.has_value();
+      biases.push_back(
+          bias ? *bias : at::zeros({weight.size(op.weight_dim)}, weight.options()));
+    }
+  }
+
+  Node* fused = graph->create(first->kind(), 1);
+  for (size_t i = 0; i < first->inputs().size(); ++i) {
+    if (i == op.shared) {
+      fused->addInput(first->input(i));
+    } else if (i == op.weight) {
+      fused->addInput(graph->insertConstant(at::cat(weights, op.weight_dim)));
+    } else if (op.bias && i == *op.bias) {
+      fused->addInput(graph->insertConstant(
+          has_bias ? IValue(at::cat(biases, 0)) : IValue()));
+    } else {
+      // the original constant may be defined after `first`
+      fused->addInput(graph->insertConstant(*toIValue(first->input(i))));
+    }
+  }
+  graph->insertNode(fused);
+  fused->output()->setType(TensorType::get());
+
+  Value* outputs =
+      graph->insert(aten::split_with_sizes, {fused->output(), split_sizes, op.output_dim});
+  Node* unpack =
+      graph->insertNode(graph->createListUnpack(outputs, siblings.size()));
+  // chunks of any dim but the first are strided views that keep the whole
+  // fused output alive, so each sibling gets a dense copy of its chunk
+  for (size_t i = 0; i < siblings.size(); ++i) {
+    Value* chunk = graph->insert(aten::contiguous, {unpack->output(i)});
+    chunk->copyMetadata(siblings[i]->output());
+    siblings[i]->output()->replaceAllUsesWith(chunk);
+  }
+  for (Node* n : siblings) {
+    n->destroy();
+  }
+  GRAPH_UPDATE(
+      "Fused ", siblings.size(), " ", first->kind().toQualString(), " nodes");
+}
+
+// Groups the candidates of `block` and its sub-blocks by their shared input,
+// in block order. The fused op runs where the first sibling was, so a group
+// ends at any node that writes to the shared input or its aliases.
+void collectGroups(
+    Block* block,
+    AliasDb& aliasDb,
+    std::vector<std::vector<Node*>>& groups) {
+  std::unordered_map<Value*, size_t> open_groups;
+  for (Node* n : block->nodes()) {
+    for (Block* sub : n->blocks()) {
+      collectGroups(sub, aliasDb, groups);
+    }
+    for (auto it = open_groups.begin(); it != open_groups.end();) {
+      if (aliasDb.writesToAlias(n, {it->first})) {
+        it = open_groups.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    auto op = fusableOp(n);
+    if (!op || !isCandidate(n, *op)) {
+      continue;
+    }
+    Value* shared = n->input(op->shared);
+    auto it = open_groups.find(shared);
+    if (it == open_groups.end()) {
+      it = open_groups.emplace(shared, groups.size()).first;
+      groups.emplace_back();
+    }
+    groups[it->second].push_back(n);
+  }
+}
+
+} // namespace
+
+void HorizontalFusion(std::shared_ptr<Graph>& graph) {
+  // all groups are collected before the graph changes, which keeps the
+  // alias information valid
+  std::vector<std::vector<Node*>> groups;
+  {
+    AliasDb aliasDb(graph);
+    collectGroups(graph->block(), aliasDb, groups);
+  }
+  for (auto& candidates : groups) {
+    while (candidates.size() >= 2) {
+      auto op = *fusableOp(candidates.front());
+      std::vector<Node*> siblings;
+      std::vector<Node*> rest;
+      for (Node* n : candidates) {
+        if (compatible(candidates.front(), n, op)) {
+          siblings.push_back(n);
+        } else {
+          rest.push_back(n);
+        }
+      }
+      if (siblings.size() >= 2) {
+        fuse(siblings, op);
+      }
+      candidates = std::move(rest);
+    }
+  }
+  // the original weights are dead now
+  EliminateDeadCode(graph);
+  GRAPH_DUMP("After HorizontalFusion: ", graph);
+}
+
+} // namespace jit
+} // namespace torch
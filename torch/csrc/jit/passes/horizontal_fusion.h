@@ -0,0 +1,22 @@
+#pragma once
+
+#include <torch/csrc/jit/ir/ir.h>
+
+namespace torch {
+namespace jit {
+
+// Horizontally fuses sibling aten::linear, aten::mm, aten::addmm and
+// aten::conv2d nodes that read the same input with constant weights, as found
+// in multi-head projections and multi-task heads of frozen models. The
+// weights (and biases) of the siblings are concatenated into new constants,
+// a single op computes all outputs at once, and aten::split_with_sizes and
+// aten::contiguous hand out the individual results as dense tensors. Siblings
+// are not fused across writes to their shared input or its aliases.
+//
+// Unlike BatchMM, which batches independent aten::mm nodes at runtime, this
+// pass needs the weights to be constants, so it is meant to run on frozen
+// graphs (see passes/freeze_module.h).
+TORCH_API void HorizontalFusion(std::shared_ptr<Graph>& graph);
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,176 @@
+#include <torch/csrc/jit/passes/memory_planning.h>
+
+#include <torch/csrc/jit/ir/alias_analysis.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <torch/csrc/jit/passes/liveness.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+size_t alignUp(size_t n, size_t alignment) {
+  return (n + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+std::unordered_map<const Value*, LiveRange> ComputePlannableLiveRanges(
+    const std::shared_ptr<Graph>& graph,
+    const std::function<bool(const Node*)>& is_plannable) {
+  std::unordered_map<const Node*, size_t> node_index;
+  size_t i = 0;
+  for (Node* n : graph->nodes()) {
+    TORCH_CHECK(
+        n->blocks().empty(),
+        "Memory planning expects a graph without control flow, found ",
+        n->kind().toQualString());
+    node_index[n] = i++;
+  }
+  // graph outputs are consumed after the last node
+  const size_t return_index = i;
+
+  // last node index at which each value is live. Graph inputs are defined
+  // before the first node.
+  std::unordered_map<const Value*, size_t> last_live;
+  std::vector<Value*> values;
+  for (Value* v : graph->inputs()) {
+    last_live[v] = 0;
+    values.push_back(v);
+  }
+  for (Node* n : graph->nodes()) {
+    for (Value* v : n->outputs()) {
+      last_live[v] = node_index[n];
+      values.push_back(v);
+    }
+  }
+  for (const auto& e : BuildLivenessSets(graph)) {
+    const size_t idx = node_index.at(e.first);
+    for (Value* v : e.second) {
+      last_live[v] = std::max(last_live[v], idx);
+    }
+  }
+  for (Value* v : graph->outputs()) {
+    last_live[v] = return_index;
+  }
+
+  AliasDb alias_db(graph, /*isFrozen=*/true);
+
+  std::unordered_map<const Value*, LiveRange> ranges;
+  for (Node* n : graph->nodes()) {
+    if (n->outputs().size() != 1 || !is_plannable(n)) {
+      continue;
+    }
+    Value* v = n->output();
+    if (!v->type()->isSubtypeOf(TensorType::get()) ||
+        alias_db.mayContainAlias(v, graph->inputs()) ||
+        alias_db.mayContainAlias(v, graph->outputs())) {
+      continue;
+    }
+    // views of the value and containers holding it keep its memory alive
+    LiveRange range{node_index[n], last_live[v]};
+    for (Value* other : values) {
+      if (other != v && alias_db.mayContainAlias(v, other)) {
+        range.end = std::max(range.end, last_live[other]);
+      }
+    }
+    GRAPH_DEBUG(
+        "Plannable value %",
+        v->debugName(),
+        " live in [",
+        range.begin,
+        ", ",
+        range.end,
+        "]");
+    ranges.emplace(v, range);
+  }
+  return ranges;
+}
+
+MemoryPlan PlanMemory(
+    const std::unordered_map<const Value*, LiveRange>& ranges,
+    const std::unordered_map<const Value*, size_t>& sizes,
+    size_t alignment) {
+  struct Item {
+    const Value* value;
+    LiveRange range;
+    size_t size;
+  };
+  std::vector<Item> items;
+  MemoryPlan plan;
+  for (const auto& e : ranges) {
+    auto it = sizes.find(e.first);
+    if (it == sizes.end()) {
+      continue;
+    }
+    const size_t size = alignUp(it->second, alignment);
+    items.push_back({e.first, e.second, size});
+    plan.unplanned_size += size;
+  }
+  // Largest first, ties broken by start of the live range so that the
+  // result is deterministic.
+  std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) {
+    if (a.size != b.size) {
+      return a.size > b.size;
+    }
+    if (a.range.begin != b.range.begin) {
+      return a.range.begin < b.range.begin;
+    }
+    return a.value->unique() < b.value->unique();
+  });
+
+  struct Placed {
+    size_t offset;
+    size_t size;
+    LiveRange range;
+  };
+  std::vector<Placed> placed;
+  for (const Item& item : items) {
+    // collect the blocks already taken during this value's lifetime
+    std::vector<std::pair<size_t, size_t>> taken;
+    for (const Placed& p : placed) {
+      if (p.range.begin <= item.range.end && item.range.begin <= p.range.end) {
+        taken.emplace_back(p.offset, p.offset + p.size);
+      }
+    }
+    std::sort(taken.begin(), taken.end());
+    // best fit: the smallest gap that holds the value, or the end of the
+    // arena if there is none
+    size_t best_offset = 0;
+    size_t best_gap = std::numeric_limits<size_t>::max();
+    size_t cursor = 0;
+    bool found = false;
+    for (const auto& t : taken) {
+      if (t.first > cursor) {
+        const size_t gap = t.first - cursor;
+        if (gap >= item.size && gap < best_gap) {
+          best_gap = gap;
+          best_offset = cursor;
+          found = true;
+        }
+      }
+      cursor = std::max(cursor, t.second);
+    }
+    if (!found) {
+      best_offset = cursor;
+    }
+    placed.push_back({best_offset, item.size, item.range});
+    plan.offsets[item.value] = best_offset;
+    plan.arena_size = std::max(plan.arena_size, best_offset + item.size);
+  }
+  GRAPH_DEBUG(
+      "Planned ",
+      plan.offsets.size(),
+      " values into an arena of ",
+      plan.arena_size,
+      " bytes (",
+      plan.unplanned_size,
+      " bytes without reuse)");
+  return plan;
+}
+
+} // namespace jit
+} // namespace torch
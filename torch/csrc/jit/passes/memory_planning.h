@@ -0,0 +1,48 @@
+#pragma once
+
+#include <torch/csrc/jit/ir/ir.h>
+
+namespace torch {
+namespace jit {
+
+// Live range of a value, expressed as indices of nodes in the (flat) graph.
+// `begin` is the node that produces the value and `end` is the last node at
+// which the value, or anything that may alias it, is still live.
+struct LiveRange {
+  size_t begin;
+  size_t end;
+};
+
+// Result of static memory planning: an offset into a single arena for every
+// planned value. Values whose live ranges overlap never share bytes.
+struct TORCH_API MemoryPlan {
+  std::unordered_map<const Value*, size_t> offsets;
+  // bytes needed by the arena, i.e. the planned peak
+  size_t arena_size = 0;
+  // bytes the planned values would need if each got its own allocation
+  size_t unplanned_size = 0;
+};
+
+// Computes live ranges of the tensor values of a frozen, control-flow-free
+// graph whose storage may be served from an arena. A value is plannable if
+//  - it is produced by a node for which `is_plannable` returns true,
+//  - neither it nor anything that may alias it is a graph input or output.
+// The range of a value is extended to cover all of its aliases (e.g. views),
+// using liveness from passes/liveness.h and the alias analysis.
+TORCH_API std::unordered_map<const Value*, LiveRange> ComputePlannableLiveRanges(
+    const std::shared_ptr<Graph>& graph,
+    const std::function<bool(const Node*)>& is_plannable);
+
+// Assigns arena offsets to values given their live ranges and sizes in bytes
+// for one shape profile. Sizes are rounded up to `alignment`, and values are
+// placed largest first into the smallest gap between the values already
+// placed with an intersecting live range that holds them, or past the last
+// of those if no gap does (best-fit interval coloring).
+// Values without an entry in `sizes` are not planned.
+TORCH_API MemoryPlan PlanMemory(
+    const std::unordered_map<const Value*, LiveRange>& ranges,
+    const std::unordered_map<const Value*, size_t>& sizes,
+    size_t alignment = 64);
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,444 @@
+#include <torch/csrc/jit/passes/parallelize_branches.h>
+
+#include <torch/csrc/jit/ir/alias_analysis.h>
+#include <torch/csrc/jit/jit_log.h>
+
+#include <algorithm>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+c10::optional<std::vector<int64_t>> concreteSizes(const Value* v) {
+  if (auto tt = v->type()->cast<TensorType>()) {
+    return tt->sizes().concrete_sizes();
+  }
+  return c10::nullopt;
+}
+
+int64_t numel(const std::vector<int64_t>& sizes) {
+  int64_t n = 1;
+  for (int64_t s : sizes) {
+    n *= s;
+  }
+  return n;
+}
+
+// A set of nodes of one block connected through the values they produce.
+struct Branch {
+  std::vector<Node*> nodes;
+  int64_t flops = 0;
+  // closed branches were joined with other expensive branches and do not
+  // grow anymore
+  bool open = true;
+  // index of the branch this one was merged into, if any
+  c10::optional<size_t> merged_into;
+};
+
+class BranchParallelizer {
+ public:
+  BranchParallelizer(std::shared_ptr<Graph> graph, int64_t min_branch_flops)
+      : graph_(std::move(graph)),
+        min_branch_flops_(min_branch_flops),
+        alias_db_(graph_) {}
+
+  void run() {
+    collect(graph_->block());
+    // aliasing is checked before changing the graph, positions right before
+    // outlining since earlier outlinings move nodes around
+    std::vector<std::vector<Node*>> to_outline;
+    for (const auto& group : groups_) {
+      // the most expensive branch keeps running on the calling thread
+      auto inline_branch = std::max_element(
+          group.begin(), group.end(), [&](size_t a, size_t b) {
+            return branches_[a].flops < branches_[b].flops;
+          });
+      for (auto it = group.begin(); it != group.end(); ++it) {
+        if (it != inline_branch && safeToOutline(branches_[*it].nodes)) {
+          to_outline.push_back(branches_[*it].nodes);
+        }
+      }
+    }
+    for (const auto& nodes : to_outline) {
+      outline(nodes);
+    }
+  }
+
+ private:
+  bool isCandidate(Node* n) const {
+    if (!n->blocks().empty() || n->hasSideEffects() || n->outputs().empty()) {
+      return false;
+    }
+    switch (n->kind()) {
+      case prim::Constant:
+      case prim::GetAttr:
+      case prim::SetAttr:
+      case prim::fork:
+      case aten::wait:
+      case prim::profile:
+      case prim::BailOut:
+      case prim::BailoutTemplate:
+      case prim::Guard:
+        return false;
+      default:
+        break;
+    }
+    for (const Value* v : n->outputs()) {
+      if (v->type()->kind() == TypeKind::FutureType) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  size_t find(size_t b) const {
+    while (branches_[b].merged_into) {
+      b = *branches_[b].merged_into;
+    }
+    return b;
+  }
+
+  void addNode(size_t b, Node* n) {
+    branches_[b].nodes.push_back(n);
+    branches_[b].flops += EstimateFlops(n);
+    branch_of_[n] = b;
+  }
+
+  size_t merge(const std::vector<size_t>& bs) {
+    size_t target = bs.front();
+    for (size_t i = 1; i < bs.size(); ++i) {
+      auto& other = branches_[bs[i]];
+      auto& nodes = branches_[target].nodes;
+      nodes.insert(nodes.end(), other.nodes.begin(), other.nodes.end());
+      branches_[target].flops += other.flops;
+      other.nodes.clear();
+      other.merged_into = target;
+    }
+    // keep the nodes in block order
+    std::sort(
+        branches_[target].nodes.begin(),
+        branches_[target].nodes.end(),
+        [](Node* a, Node* b) { return a->isBefore(b); });
+    return target;
+  }
+
+  void recordGroup(const std::vector<size_t>& bs) {
+    std::vector<size_t> expensive;
+    for (size_t b : bs) {
+      if (branches_[b].flops >= min_branch_flops_) {
+        expensive.push_back(b);
+      }
+    }
+    if (expensive.size() >= 2) {
+      for (size_t b : expensive) {
+        branches_[b].open = false;
+      }
+      groups_.push_back(std::move(expensive));
+    }
+  }
+
+  // Grows branches along the data flow of `block` in topological order. A
+  // node that joins two or more expensive branches closes them (they can run
+  // concurrently up to this node) and starts a new branch; joins of cheap
+  // branches simply merge them.
+  void collect(Block* block) {
+    std::vector<size_t> block_branches;
+    for (Node* n : block->nodes()) {
+      for (Block* sub : n->blocks()) {
+        collect(sub);
+      }
+      if (!isCandidate(n)) {
+        continue;
+      }
+      std::vector<size_t> producers;
+      for (Value* v : n->inputs()) {
+        auto it = branch_of_.find(v->node());
+        // values of enclosing blocks are inputs, like graph inputs
+        if (it == branch_of_.end() || v->node()->owningBlock() != block) {
+          continue;
+        }
+        size_t b = find(it->second);
+        if (branches_[b].open &&
+            std::find(producers.begin(), producers.end(), b) ==
+                producers.end()) {
+          producers.push_back(b);
+        }
+      }
+      if (producers.size() >= 2) {
+        recordGroup(producers);
+        std::vector<size_t> still_open;
+        for (size_t b : producers) {
+          if (branches_[b].open) {
+            still_open.push_back(b);
+          }
+        }
+        producers = std::move(still_open);
+      }
+      size_t b;
+      if (producers.empty()) {
+        b = branches_.size();
+        branches_.emplace_back();
+        block_branches.push_back(b);
+      } else {
+        b = merge(producers);
+      }
+      addNode(b, n);
+    }
+
+    // branches that are still open at the end of the block are joined by its
+    // return
+    std::vector<size_t> open;
+    for (size_t b : block_branches) {
+      if (!branches_[b].merged_into && branches_[b].open) {
+        open.push_back(b);
+      }
+    }
+    recordGroup(open);
+  }
+
+  // A branch can run concurrently with the rest of the graph if it does not
+  // write to memory it may share with the outside, and nothing outside writes
+  // to the memory of the values it reads or produces.
+  bool safeToOutline(const std::vector<Node*>& nodes) {
+    std::unordered_set<const Node*> members(nodes.begin(), nodes.end());
+    ValueSet external_inputs;
+    ValueSet values;
+    for (Node* n : nodes) {
+      for (Value* v : n->inputs()) {
+        values.insert(v);
+        if (!members.count(v->node())) {
+          external_inputs.insert(v);
+        }
+      }
+      for (Value* v : n->outputs()) {
+        values.insert(v);
+      }
+    }
+    for (Node* n : nodes) {
+      if (alias_db_.writesToAlias(n, external_inputs)) {
+        return false;
+      }
+    }
+    return !writesOutside(graph_->block(), members, values);
+  }
+
+  bool writesOutside(
+      Block* block,
+      const std::unordered_set<const Node*>& members,
+      const ValueSet& values) {
+    for (Node* n : block->nodes()) {
+      if (members.count(n)) {
+        continue;
+      }
+      if (alias_db_.writesToAlias(n, values)) {
+        return true;
+      }
+      for (Block* sub : n->blocks()) {
+        if (writesOutside(sub, members, values)) {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  // the ancestor of `n` that lives in `block`, or nullptr
+  static Node* ancestorIn(Node* n, Block* block) {
+    while (n->owningBlock() != block) {
+      Node* owner = n->owningBlock()->owningNode();
+      if (!owner) {
+        return nullptr;
+      }
+      n = owner;
+    }
+    return n;
+  }
+
+  void outline(const std::vector<Node*>& nodes) {
+    Block* block = nodes.front()->owningBlock();
+    std::unordered_set<const Node*> members(nodes.begin(), nodes.end());
+
+    std::vector<Value*> inputs;
+    for (Node* n : nodes) {
+      for (Value* v : n->inputs()) {
+        if (!members.count(v->node()) &&
+            std::find(inputs.begin(), inputs.end(), v) == inputs.end()) {
+          inputs.push_back(v);
+        }
+      }
+    }
+    std::vector<Value*> outputs;
+    Node* first_use = nullptr;
+    for (Node* n : nodes) {
+      for (Value* v : n->outputs()) {
+        bool used_outside = false;
+        for (const Use& use : v->uses()) {
+          Node* user = ancestorIn(use.user, block);
+          if (members.count(user)) {
+            continue;
+          }
+          used_outside = true;
+          if (!first_use || user->isBefore(first_use)) {
+            first_use = user;
+          }
+        }
+        if (used_outside) {
+          outputs.push_back(v);
+        }
+      }
+    }
+    if (outputs.empty()) {
+      // dead code, nothing to wait for
+      return;
+    }
+
+    // the fork goes right after the last of its inputs is defined, the wait
+    // right before the first use of its outputs
+    Node* last_def = nullptr;
+    for (Value* v : inputs) {
+      if (v->node()->kind() == prim::Constant) {
+        continue;
+      }
+      Node* def = ancestorIn(v->node(), block);
+      if (def && def->kind() != prim::Param &&
+          (!last_def || last_def->isBefore(def))) {
+        last_def = def;
+      }
+    }
+    if (last_def && !last_def->isBefore(first_use)) {
+      GRAPH_DEBUG(
+          "Not forking branch starting at ",
+          *nodes.front(),
+          ", its inputs are defined after its outputs are used");
+      return;
+    }
+
+    auto subgraph = std::make_shared<Graph>();
+    std::unordered_map<Value*, Value*> env;
+    Node* fork = graph_->create(prim::fork, 1);
+    for (Value* v : inputs) {
+      if (v->node()->kind() == prim::Constant) {
+        // constants have no inputs
+        Node* constant = subgraph->appendNode(
+            subgraph->createClone(v->node(), [](Value* v) { return v; }));
+        env[v] = constant->output();
+      } else {
+        env[v] = subgraph->addInput()->copyMetadata(v);
+        fork->addInput(v);
+      }
+    }
+    for (Node* n : nodes) {
+      Node* clone = subgraph->appendNode(
+          subgraph->createClone(n, [&](Value* v) { return env.at(v); }));
+      for (size_t i = 0; i < n->outputs().size(); ++i) {
+        env[n->outputs()[i]] = clone->outputs()[i];
+      }
+    }
+    if (outputs.size() == 1) {
+      subgraph->registerOutput(env.at(outputs[0]));
+    } else {
+      std::vector<Value*> results;
+      for (Value* v : outputs) {
+        results.push_back(env.at(v));
+      }
+      subgraph->registerOutput(
+          subgraph->appendNode(subgraph->createTuple(results))->output());
+    }
+    const TypePtr result_type = subgraph->outputs()[0]->type();
+
+    fork->g_(attr::Subgraph, subgraph);
+    fork->output()->setType(FutureType::create(result_type));
+    if (last_def) {
+      fork->insertAfter(last_def);
+    } else {
+      block->prependNode(fork);
+    }
+    Node* wait = graph_->create(aten::wait, {fork->output()}, 1)
+                     ->insertBefore(first_use);
+    wait->output()->setType(result_type);
+
+    std::vector<Value*> results;
+    if (outputs.size() == 1) {
+      results.push_back(wait->output());
+    } else {
+      Node* unpack = graph_->createTupleUnpack(wait->output())->insertAfter(wait);
+      results = unpack->outputs().vec();
+    }
+    for (size_t i = 0; i < outputs.size(); ++i) {
+      results[i]->copyMetadata(outputs[i]);
+      outputs[i]->replaceAllUsesWith(results[i]);
+    }
+    for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) {
+      (*it)->destroy();
+    }
+    GRAPH_UPDATE("Forked branch into ", *fork);
+  }
+
+  std::shared_ptr<Graph> graph_;
+  int64_t min_branch_flops_;
+  AliasDb alias_db_;
+  std::vector<Branch> branches_;
+  std::unordered_map<const Node*, size_t> branch_of_;
+  // sets of branches that can run concurrently
+  std::vector<std::vector<size_t>> groups_;
+};
+
+} // namespace
+
+int64_t EstimateFlops(const Node* n) {
+  if (n->outputs().empty()) {
+    return 0;
+  }
+  auto out = concreteSizes(n->outputs()[0]);
+  if (!out) {
+    return 0;
+  }
+  const int64_t out_numel = numel(*out);
+
+  // size of the reduction of GEMM-like ops
+  c10::optional<int64_t> reduction;
+  auto lastDimOf = [&](size_t input) -> c10::optional<int64_t> {
+    auto sizes = concreteSizes(n->inputs().at(input));
+    if (!sizes || sizes->empty()) {
+      return c10::nullopt;
+    }
+    return sizes->back();
+  };
+  switch (n->kind()) {
+    case aten::mm:
+    case aten::bmm:
+    case aten::matmul:
+    case aten::linear:
+      reduction = lastDimOf(0);
+      break;
+    case aten::addmm:
+    case aten::baddbmm:
+      reduction = lastDimOf(1);
+      break;
+    case aten::conv1d:
+    case aten::conv2d:
+    case aten::conv3d:
+    case aten::_convolution: {
+      // weight is [out_channels, in_channels / groups, *kernel_size]
+      auto weight = concreteSizes(n->inputs().at(1));
+      if (weight && !weight->empty() && weight->front() > 0) {
+        reduction = numel(*weight) / weight->front();
+      }
+      break;
+    }
+    default:
+      return out_numel;
+  }
+  return reduction ? 2 * out_numel * *reduction : out_numel;
+}
+
+void ParallelizeBranches(
+    const std::shared_ptr<Graph>& graph,
+    int64_t min_branch_flops) {
+  BranchParallelizer(graph, min_branch_flops).run();
+  GRAPH_DUMP("After ParallelizeBranches: ", graph);
+}
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <torch/csrc/jit/ir/ir.h>
+
+namespace torch {
+namespace jit {
+
+// Rough number of floating point operations `n` performs, estimated from the
+// (complete) tensor types of its inputs and outputs. GEMMs and convolutions
+// count their multiply-adds, every other op one operation per output element.
+// Returns 0 when the shapes are unknown.
+TORCH_API int64_t EstimateFlops(const Node* n);
+
+// Finds independent branches of a graph (e.g. the towers of a multi-tower
+// model) that are expensive enough to be worth running concurrently, and
+// outlines all but the most expensive branch of every such set into a
+// prim::fork subgraph followed by an aten::wait, so that the interpreter runs
+// them on the inter-op thread pool. Branches whose estimated cost is below
+// `min_branch_flops` stay inline.
+//
+// The cost model relies on shape information, so this should run after shape
+// propagation on a graph with complete input types (e.g. a frozen module
+// after _jit_pass_complete_shape_analysis).
+TORCH_API void ParallelizeBranches(
+    const std::shared_ptr<Graph>& graph,
+    int64_t min_branch_flops = 1 << 20);
+
+} // namespace jit
+} // namespace torch
@@ -16,6 +16,7 @@
 #include <torch/csrc/jit/frontend/schema_matching.h>
 #include <torch/csrc/jit/ir/subgraph_matcher.h>
 
+#include <ATen/Context.h>
 #include <c10/core/QScheme.h>
 
 #include <algorithm>
@@ -544,6 +545,20 @@ graph(%input, %weight, %bias, %4):
      %first_output = aten::matmul(%input, %weight_t)
      %second_output = aten::add_(%first_output, %bias, %4)
      return (%second_output) )");
+  const PatternInfo linear_add = PatternInfo::parse_from_str(R"(
+graph(%self, %input, %other):
+     %one = prim::Constant[value=1]()
+     %first_module = match::module[name="Linear"](%self)
+     %first_output = prim::CallMethod[name="forward"](%first_module, %input)
+     %second_output = aten::add_(%first_output, %other, %one)
+     return (%second_output) )");
+  const PatternInfo linear_add_out_of_place = PatternInfo::parse_from_str(R"(
+graph(%self, %input, %other):
+     %one = prim::Constant[value=1]()
+     %first_module = match::module[name="Linear"](%self)
+     %first_output = prim::CallMethod[name="forward"](%first_module, %input)
+     %second_output = aten::add(%first_output, %other, %one)
+     return (%second_output) )");
   const PatternInfo add_module_relu = PatternInfo::parse_from_str(R"(
 graph(%self, %a, %b):
      %one = prim::Constant[value=1]()
@@ -568,6 +583,14 @@ graph(%self, %a, %b, %inplace):
     add_module_relu,
     add_functional_relu,
   };
+
+  // quantized::linear_add only has an FBGEMM kernel, so the output of
+  // Linear is only left unobserved when QuantFusion will fuse it
+  const std::vector<std::reference_wrapper<const PatternInfo>>
+      fbgemm_skip_patterns = {
+    linear_add,
+    linear_add_out_of_place,
+  };
 };
 
 // Check if `use` is an aten function of name `func_name` and if value
@@ -752,6 +775,11 @@ void InsertObserversHelper::addIntermediateValuesToSkipObserver(
   for (const auto& pattern : skip_patterns) {
     skipValuesInPattern(*graph, pattern);
   }
+  if (at::globalContext().qEngine() == at::QEngine::FBGEMM) {
+    for (const auto& pattern : fbgemm_skip_patterns) {
+      skipValuesInPattern(*graph, pattern);
+    }
+  }
 }
 
 void InsertObserversHelper::fillPassThroughValueMap(const std::shared_ptr<Graph>& graph) {
@@ -2073,7 +2101,14 @@ void SwapDeQuant(std::shared_ptr<Graph>& graph) {
 }
 
 void QuantFusion(std::shared_ptr<Graph>& graph) {
-  for (const auto& item : quant_fusion_pattern_and_replacements()) {
+  auto patterns = quant_fusion_pattern_and_replacements();
+  if (at::globalContext().qEngine() == at::QEngine::FBGEMM) {
+    // Without a fused kernel the linear + add stays in float, which rounds
+    // once like the fused FBGEMM kernel does.
+    auto fbgemm_patterns = fbgemm_quant_fusion_pattern_and_replacements();
+    patterns.insert(fbgemm_patterns.begin(), fbgemm_patterns.end());
+  }
+  for (const auto& item : patterns) {
     SubgraphRewriter rewriter;
     rewriter.RegisterRewritePattern(item.first, item.second);
     rewriter.runOnGraph(graph);
@@ -141,4 +141,48 @@ graph(%packed_params, %a_quant, %r_scale, %r_zero_point, %r_dtype):
 
 }
 
+// Patterns for ops that only have an FBGEMM kernel.
+std::unordered_map<std::string, std::string> fbgemm_quant_fusion_pattern_and_replacements() {
+  // aten::linear followed by `add_op` and, if `relu_op` is not empty,
+  // by `relu_op`
+  auto linear_add = [](const std::string& add_op, const std::string& relu_op) {
+    std::string pattern = R"(
+graph(%packed_params, %a_quant, %other_quant, %r_scale, %r_zero_point, %r_dtype):
+        %alpha = prim::Constant[value=1]()
+        %a_dequant = aten::dequantize(%a_quant)
+        %w_quant : Tensor, %b : Tensor? = quantized::linear_unpack(%packed_params)
+        %w_dequant = aten::dequantize(%w_quant)
+        %linear_out = aten::linear(%a_dequant, %w_dequant, %b)
+        %other_dequant = aten::dequantize(%other_quant)
+)";
+    if (relu_op.empty()) {
+      pattern += "        %r = " + add_op + "(%linear_out, %other_dequant, %alpha)\n";
+    } else {
+      pattern += "        %r_add = " + add_op + "(%linear_out, %other_dequant, %alpha)\n";
+      pattern += "        %r = " + relu_op + "(%r_add)\n";
+    }
+    pattern += R"(        %r_quant = aten::quantize_per_tensor(%r, %r_scale, %r_zero_point, %r_dtype)
+        return (%r_quant) )";
+    return pattern;
+  };
+
+  std::string quantized_linear_add = R"(
+graph(%packed_params, %a_quant, %other_quant, %r_scale, %r_zero_point, %r_dtype):
+        %r_quant = quantized::linear_add(%a_quant, %packed_params, %other_quant, %r_scale, %r_zero_point)
+        return (%r_quant) )";
+
+  std::string quantized_linear_add_relu = R"(
+graph(%packed_params, %a_quant, %other_quant, %r_scale, %r_zero_point, %r_dtype):
+        %r_quant = quantized::linear_add_relu(%a_quant, %packed_params, %other_quant, %r_scale, %r_zero_point)
+        return (%r_quant) )";
+
+  std::unordered_map<std::string, std::string> patterns;
+  for (const char* add_op : {"aten::add_", "aten::add"}) {
+    patterns[linear_add(add_op, "")] = quantized_linear_add;
+    patterns[linear_add(add_op, "aten::relu")] = quantized_linear_add_relu;
+    patterns[linear_add(add_op, "aten::relu_")] = quantized_linear_add_relu;
+  }
+  return patterns;
+}
+
 }} // torch::jit
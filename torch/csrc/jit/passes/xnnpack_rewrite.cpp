@@ -79,6 +79,473 @@ void insertXNNPACKConv2dOp(std::shared_ptr<Graph>& graph) {
   rewriter.runOnGraph(graph);
 }
 
+bool isXNNPACKOutput(Value* v) {
+  const std::string kind = v->node()->kind().toQualString();
+  return kind.rfind("_xnnpack::", 0) == 0;
+}
+
+bool isConstantNumber(
+    const Match& match,
+    const std::unordered_map<std::string, Value*>& vmap,
+    const std::string& name,
+    double expected) {
+  const auto value =
+      graph_rewrite_helper::getIValue(name, match.values_map, vmap);
+  return value &&
+      ((value->isDouble() && value->toDouble() == expected) ||
+       (value->isInt() && value->toInt() == expected));
+}
+
+bool isConstantFalse(
+    const Match& match,
+    const std::unordered_map<std::string, Value*>& vmap,
+    const std::string& name) {
+  const auto value =
+      graph_rewrite_helper::getIValue(name, match.values_map, vmap);
+  return value && value->isBool() && !value->toBool();
+}
+
+void insertXNNPACKConvTranspose2dOp(std::shared_ptr<Graph>& graph) {
+  std::string conv_transpose_2d_pattern = R"(
+    graph(%input, %weight, %bias, %stride:int[], %padding:int[], %output_padding:int[], %groups:int, %dilation:int[]):
+        %r = aten::conv_transpose2d(%input, %weight, %bias, %stride, %padding, %output_padding, %groups, %dilation)
+        return (%r) )";
+
+  std::string xnnpack_conv_transpose_2d_pattern = R"(
+    graph(%input, %weight, %bias, %stride:int[], %padding:int[], %output_padding:int[], %groups:int, %dilation:int[]):
+        %packed_weight_bias = _xnnpack::conv2d_transpose_prepack(%weight, %bias, %stride, %padding, %output_padding, %groups, %dilation)
+        %r = _xnnpack::conv2d_transpose_packed(%input, %packed_weight_bias)
+        return (%r) )";
+
+  SubgraphRewriter rewriter;
+  rewriter.RegisterRewritePattern(
+      conv_transpose_2d_pattern, xnnpack_conv_transpose_2d_pattern);
+  rewriter.runOnGraph(graph);
+}
+
+void insertXNNPACKPoolingOps(std::shared_ptr<Graph>& graph) {
+  std::string max_pool_2d_before_inline = R"(
+    graph(%max_pool2d, %input, %kernel_size, %stride, %padding, %dilation, %ceil_mode, %return_indices):
+        %r = prim::CallFunction(%max_pool2d, %input, %kernel_size, %stride, %padding, %dilation, %ceil_mode, %return_indices)
+        return (%r) )";
+  std::string xnnpack_max_pool_2d_before_inline = R"(
+    graph(%max_pool2d, %input, %kernel_size, %stride, %padding, %dilation, %ceil_mode, %return_indices):
+        %r = _xnnpack::max_pool2d(%input, %kernel_size, %stride, %padding, %dilation, %ceil_mode)
+        return (%r) )";
+  std::string max_pool_2d_pattern = R"(
+    graph(%input, %kernel_size, %stride, %padding, %dilation, %ceil_mode):
+        %r = aten::max_pool2d(%input, %kernel_size, %stride, %padding, %dilation, %ceil_mode)
+        return (%r) )";
+  std::string xnnpack_max_pool_2d_pattern = R"(
+    graph(%input, %kernel_size, %stride, %padding, %dilation, %ceil_mode):
+        %r = _xnnpack::max_pool2d(%input, %kernel_size, %stride, %padding, %dilation, %ceil_mode)
+        return (%r) )";
+
+  // F.max_pool2d with return_indices=False resolves to _max_pool2d, whose
+  // stride may still be None.
+  auto max_pool_2d_filter = [](const Match& match,
+                               const std::unordered_map<std::string, Value*>& vmap) {
+    const auto& match_vmap = match.values_map;
+    if (graph_rewrite_helper::getFuncName(match_vmap.at(vmap.at("max_pool2d"))) !=
+        "_max_pool2d") {
+      return false;
+    }
+    return match_vmap.at(vmap.at("stride"))->type()->kind() == TypeKind::ListType &&
+        isConstantFalse(match, vmap, "return_indices");
+  };
+
+  SubgraphRewriter max_pool_2d_call_fn_rewriter;
+  max_pool_2d_call_fn_rewriter.RegisterRewritePattern(
+      max_pool_2d_before_inline, xnnpack_max_pool_2d_before_inline);
+  max_pool_2d_call_fn_rewriter.runOnGraph(graph, max_pool_2d_filter);
+
+  SubgraphRewriter max_pool_2d_rewriter;
+  max_pool_2d_rewriter.RegisterRewritePattern(
+      max_pool_2d_pattern, xnnpack_max_pool_2d_pattern);
+  max_pool_2d_rewriter.runOnGraph(graph);
+
+  // XNNPACK average pooling has no padding and no ceil mode, and divides by
+  // the kernel size.
+  std::string avg_pool_2d_pattern = R"(
+    graph(%input, %kernel_size, %stride, %padding, %ceil_mode, %count_include_pad, %divisor_override):
+        %r = aten::avg_pool2d(%input, %kernel_size, %stride, %padding, %ceil_mode, %count_include_pad, %divisor_override)
+        return (%r) )";
+  std::string xnnpack_avg_pool_2d_pattern = R"(
+    graph(%input, %kernel_size, %stride, %padding, %ceil_mode, %count_include_pad, %divisor_override):
+        %r = _xnnpack::avg_pool2d(%input, %kernel_size, %stride)
+        return (%r) )";
+
+  auto avg_pool_2d_filter = [](const Match& match,
+                               const std::unordered_map<std::string, Value*>& vmap) {
+    const auto padding =
+        graph_rewrite_helper::getIValue("padding", match.values_map, vmap);
+    const auto divisor_override =
+        graph_rewrite_helper::getIValue("divisor_override", match.values_map, vmap);
+    if (!padding || !padding->isIntList() ||
+        !divisor_override || !divisor_override->isNone()) {
+      return false;
+    }
+    for (const int64_t p : padding->toIntListRef()) {
+      if (p != 0) {
+        return false;
+      }
+    }
+    return isConstantFalse(match, vmap, "ceil_mode");
+  };
+
+  SubgraphRewriter avg_pool_2d_rewriter;
+  avg_pool_2d_rewriter.RegisterRewritePattern(
+      avg_pool_2d_pattern, xnnpack_avg_pool_2d_pattern);
+  avg_pool_2d_rewriter.runOnGraph(graph, avg_pool_2d_filter);
+
+  // adaptive_avg_pool2d to 1x1 is a global average pooling.
+  std::string adaptive_avg_pool_2d_before_inline = R"(
+    graph(%adaptive_avg_pool2d, %input, %output_size):
+        %r = prim::CallFunction(%adaptive_avg_pool2d, %input, %output_size)
+        return (%r) )";
+  std::string xnnpack_global_avg_pool_2d_before_inline = R"(
+    graph(%adaptive_avg_pool2d, %input, %output_size):
+        %r = _xnnpack::global_avg_pool2d(%input)
+        return (%r) )";
+  std::string adaptive_avg_pool_2d_pattern = R"(
+    graph(%input, %output_size):
+        %r = aten::adaptive_avg_pool2d(%input, %output_size)
+        return (%r) )";
+  std::string xnnpack_global_avg_pool_2d_pattern = R"(
+    graph(%input, %output_size):
+        %r = _xnnpack::global_avg_pool2d(%input)
+        return (%r) )";
+
+  auto is_global = [](const Match& match,
+                      const std::unordered_map<std::string, Value*>& vmap) {
+    const auto output_size =
+        graph_rewrite_helper::getIValue("output_size", match.values_map, vmap);
+    if (!output_size || !output_size->isIntList()) {
+      return false;
+    }
+    for (const int64_t size : output_size->toIntListRef()) {
+      if (size != 1) {
+        return false;
+      }
+    }
+    return true;
+  };
+  auto adaptive_avg_pool_2d_call_fn_filter =
+      [&is_global](const Match& match,
+                   const std::unordered_map<std::string, Value*>& vmap) {
+    const auto& match_vmap = match.values_map;
+    return graph_rewrite_helper::getFuncName(
+               match_vmap.at(vmap.at("adaptive_avg_pool2d"))) ==
+        "adaptive_avg_pool2d" &&
+        is_global(match, vmap);
+  };
+
+  SubgraphRewriter adaptive_avg_pool_2d_call_fn_rewriter;
+  adaptive_avg_pool_2d_call_fn_rewriter.RegisterRewritePattern(
+      adaptive_avg_pool_2d_before_inline,
+      xnnpack_global_avg_pool_2d_before_inline);
+  adaptive_avg_pool_2d_call_fn_rewriter.runOnGraph(
+      graph, adaptive_avg_pool_2d_call_fn_filter);
+
+  SubgraphRewriter adaptive_avg_pool_2d_rewriter;
+  adaptive_avg_pool_2d_rewriter.RegisterRewritePattern(
+      adaptive_avg_pool_2d_pattern, xnnpack_global_avg_pool_2d_pattern);
+  adaptive_avg_pool_2d_rewriter.runOnGraph(graph, is_global);
+}
+
+// hardswish(x) = x * relu6(x + 3) / 6, as written out in models.
+void insertXNNPACKHardswishOp(std::shared_ptr<Graph>& graph) {
+  std::string hardswish_pattern = R"(
+    graph(%input, %three, %alpha, %zero, %six, %divisor):
+        %shifted = aten::add(%input, %three, %alpha)
+        %relu6 = aten::hardtanh(%shifted, %zero, %six)
+        %product = aten::mul(%input, %relu6)
+        %r = aten::div(%product, %divisor)
+        return (%r) )";
+  std::string xnnpack_hardswish_pattern = R"(
+    graph(%input, %three, %alpha, %zero, %six, %divisor):
+        %r = _xnnpack::hardswish(%input)
+        return (%r) )";
+  std::string hardswish_before_inline = R"(
+    graph(%relu6_fn, %input, %three, %alpha, %inplace, %divisor):
+        %shifted = aten::add(%input, %three, %alpha)
+        %relu6 = prim::CallFunction(%relu6_fn, %shifted, %inplace)
+        %product = aten::mul(%input, %relu6)
+        %r = aten::div(%product, %divisor)
+        return (%r) )";
+  std::string xnnpack_hardswish_before_inline = R"(
+    graph(%relu6_fn, %input, %three, %alpha, %inplace, %divisor):
+        %r = _xnnpack::hardswish(%input)
+        return (%r) )";
+
+  auto filter = [](const Match& match,
+                   const std::unordered_map<std::string, Value*>& vmap) {
+    return isConstantNumber(match, vmap, "three", 3) &&
+        isConstantNumber(match, vmap, "alpha", 1) &&
+        isConstantNumber(match, vmap, "zero", 0) &&
+        isConstantNumber(match, vmap, "six", 6) &&
+        isConstantNumber(match, vmap, "divisor", 6);
+  };
+  auto call_fn_filter = [](const Match& match,
+                           const std::unordered_map<std::string, Value*>& vmap) {
+    const auto& match_vmap = match.values_map;
+    return graph_rewrite_helper::getFuncName(match_vmap.at(vmap.at("relu6_fn"))) ==
+        "relu6" &&
+        isConstantNumber(match, vmap, "three", 3) &&
+        isConstantNumber(match, vmap, "alpha", 1) &&
+        isConstantNumber(match, vmap, "divisor", 6);
+  };
+
+  SubgraphRewriter hardswish_call_fn_rewriter;
+  hardswish_call_fn_rewriter.RegisterRewritePattern(
+      hardswish_before_inline, xnnpack_hardswish_before_inline);
+  hardswish_call_fn_rewriter.runOnGraph(graph, call_fn_filter);
+
+  SubgraphRewriter hardswish_rewriter;
+  hardswish_rewriter.RegisterRewritePattern(
+      hardswish_pattern, xnnpack_hardswish_pattern);
+  hardswish_rewriter.runOnGraph(graph, filter);
+}
+
+// Only adds and activations that consume the result of another XNNPACK
+// operator are rewritten, so that they extend an NHWC chain. The in-place
+// variants are rewritten only when nothing else can observe the mutation.
+void insertXNNPACKAddOp(std::shared_ptr<Graph>& graph) {
+  std::string add_pattern = R"(
+    graph(%a, %b, %alpha):
+        %r = aten::add(%a, %b, %alpha)
+        return (%r) )";
+  std::string xnnpack_add_pattern = R"(
+    graph(%a, %b, %alpha):
+        %r = _xnnpack::add(%a, %b)
+        return (%r) )";
+
+  auto filter = [](const Match& match,
+                   const std::unordered_map<std::string, Value*>& vmap) {
+    const auto& match_vmap = match.values_map;
+    Value* a = match_vmap.at(vmap.at("a"));
+    Value* b = match_vmap.at(vmap.at("b"));
+    return b->type()->isSubtypeOf(TensorType::get()) &&
+        (isXNNPACKOutput(a) || isXNNPACKOutput(b)) &&
+        isConstantNumber(match, vmap, "alpha", 1);
+  };
+
+  SubgraphRewriter rewriter;
+  rewriter.RegisterRewritePattern(add_pattern, xnnpack_add_pattern);
+  rewriter.runOnGraph(graph, filter);
+}
+
+void insertXNNPACKClampOps(std::shared_ptr<Graph>& graph) {
+  auto can_replace = [](Value* input, bool inplace) {
+    return isXNNPACKOutput(input) && (!inplace || input->uses().size() == 1);
+  };
+
+  // aten operators, both out of place and in place
+  for (const bool inplace : {false, true}) {
+    const std::string suffix = inplace ? "_" : "";
+    std::string relu_pattern = R"(
+    graph(%input):
+        %r = aten::relu)" + suffix + R"((%input)
+        return (%r) )";
+    std::string xnnpack_relu_pattern = R"(
+    graph(%input):
+        %zero : float = prim::Constant[value=0.]()
+        %none = prim::Constant()
+        %r = _xnnpack::clamp(%input, %zero, %none)
+        return (%r) )";
+    std::string hardtanh_pattern = R"(
+    graph(%input, %min, %max):
+        %r = aten::hardtanh)" + suffix + R"((%input, %min, %max)
+        return (%r) )";
+    std::string clamp_pattern = R"(
+    graph(%input, %min, %max):
+        %r = aten::clamp)" + suffix + R"((%input, %min, %max)
+        return (%r) )";
+    std::string xnnpack_clamp_pattern = R"(
+    graph(%input, %min, %max):
+        %r = _xnnpack::clamp(%input, %min, %max)
+        return (%r) )";
+
+    auto filter = [&can_replace, inplace](
+                      const Match& match,
+                      const std::unordered_map<std::string, Value*>& vmap) {
+      return can_replace(match.values_map.at(vmap.at("input")), inplace);
+    };
+
+    SubgraphRewriter rewriter;
+    rewriter.RegisterRewritePattern(relu_pattern, xnnpack_relu_pattern);
+    rewriter.RegisterRewritePattern(hardtanh_pattern, xnnpack_clamp_pattern);
+    rewriter.RegisterRewritePattern(clamp_pattern, xnnpack_clamp_pattern);
+    rewriter.runOnGraph(graph, filter);
+  }
+
+  // Functional calls before inlining
+  std::string relu_before_inline = R"(
+    graph(%relu, %input, %inplace):
+        %r = prim::CallFunction(%relu, %input, %inplace)
+        return (%r) )";
+  std::string xnnpack_relu_before_inline = R"(
+    graph(%relu, %input, %inplace):
+        %zero : float = prim::Constant[value=0.]()
+        %none = prim::Constant()
+        %r = _xnnpack::clamp(%input, %zero, %none)
+        return (%r) )";
+  std::string relu6_before_inline = R"(
+    graph(%relu6, %input, %inplace):
+        %r = prim::CallFunction(%relu6, %input, %inplace)
+        return (%r) )";
+  std::string xnnpack_relu6_before_inline = R"(
+    graph(%relu6, %input, %inplace):
+        %zero : float = prim::Constant[value=0.]()
+        %six : float = prim::Constant[value=6.]()
+        %r = _xnnpack::clamp(%input, %zero, %six)
+        return (%r) )";
+  std::string hardtanh_before_inline = R"(
+    graph(%hardtanh, %input, %min, %max, %inplace):
+        %r = prim::CallFunction(%hardtanh, %input, %min, %max, %inplace)
+        return (%r) )";
+  std::string xnnpack_hardtanh_before_inline = R"(
+    graph(%hardtanh, %input, %min, %max, %inplace):
+        %r = _xnnpack::clamp(%input, %min, %max)
+        return (%r) )";
+
+  auto call_fn_filter = [&can_replace](const std::string& fn_name) {
+    return [&can_replace, fn_name](
+               const Match& match,
+               const std::unordered_map<std::string, Value*>& vmap) {
+      const auto& match_vmap = match.values_map;
+      if (graph_rewrite_helper::getFuncName(match_vmap.at(vmap.at(fn_name))) !=
+          fn_name) {
+        return false;
+      }
+      const auto inplace =
+          graph_rewrite_helper::getIValue("inplace", match_vmap, vmap);
+      return inplace && inplace->isBool() &&
+          can_replace(match_vmap.at(vmap.at("input")), inplace->toBool());
+    };
+  };
+
+  SubgraphRewriter relu_rewriter;
+  relu_rewriter.RegisterRewritePattern(
+      relu_before_inline, xnnpack_relu_before_inline);
+  relu_rewriter.runOnGraph(graph, call_fn_filter("relu"));
+
+  SubgraphRewriter relu6_rewriter;
+  relu6_rewriter.RegisterRewritePattern(
+      relu6_before_inline, xnnpack_relu6_before_inline);
+  relu6_rewriter.runOnGraph(graph, call_fn_filter("relu6"));
+
+  SubgraphRewriter hardtanh_rewriter;
+  hardtanh_rewriter.RegisterRewritePattern(
+      hardtanh_before_inline, xnnpack_hardtanh_before_inline);
+  hardtanh_rewriter.runOnGraph(graph, call_fn_filter("hardtanh"));
+}
+
+// XNNPACK convolutions and poolings run in NHWC and convert NCHW inputs and
+// outputs on every call. Convert the input of a chain of such operators, and
+// of the layout preserving elementwise operators between them, to channels
+// last once, and convert back only where a value leaves the chain. A chain
+// only starts at an operator whose input is known to be 4D (pooling also
+// takes unbatched 3D inputs, which cannot be made channels last) and whose
+// output feeds another operator of the chain; an isolated operator is cheaper
+// left to convert internally than wrapped in two copies.
+void insertXNNPACKLayoutConversions(std::shared_ptr<Graph>& graph) {
+  const std::unordered_set<Symbol> nhwc_ops = {
+      Symbol::fromQualString("_xnnpack::conv2d_packed"),
+      Symbol::fromQualString("_xnnpack::conv2d_transpose_packed"),
+      Symbol::fromQualString("_xnnpack::max_pool2d"),
+      Symbol::fromQualString("_xnnpack::avg_pool2d"),
+      Symbol::fromQualString("_xnnpack::global_avg_pool2d"),
+  };
+  const std::unordered_set<Symbol> layout_preserving_ops = {
+      Symbol::fromQualString("_xnnpack::hardswish"),
+      Symbol::fromQualString("_xnnpack::clamp"),
+      Symbol::fromQualString("_xnnpack::add"),
+  };
+  const std::unordered_set<Symbol> conv_ops = {
+      Symbol::fromQualString("_xnnpack::conv2d_packed"),
+      Symbol::fromQualString("_xnnpack::conv2d_transpose_packed"),
+  };
+
+  auto is_4d = [&conv_ops](Node* n) {
+    if (conv_ops.count(n->kind())) {
+      // 2d convolutions only take batched inputs
+      return true;
+    }
+    auto type = n->input(0)->type()->cast<TensorType>();
+    return type && type->dim() && *type->dim() == 4;
+  };
+  auto feeds_chain = [&nhwc_ops, &layout_preserving_ops](Node* n) {
+    for (const Use& use : n->output()->uses()) {
+      if (use.offset == 0 &&
+          (nhwc_ops.count(use.user->kind()) ||
+           layout_preserving_ops.count(use.user->kind()))) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  auto insert_contiguous = [&graph](
+                               Value* v,
+                               c10::MemoryFormat memory_format,
+                               Node* insert_point) {
+    WithInsertPoint guard(insert_point);
+    Value* format = graph->insertConstant(static_cast<int64_t>(memory_format));
+    Node* contiguous =
+        graph->insertNode(graph->create(Symbol::aten("contiguous"), {v, format}));
+    contiguous->output()->setType(v->type());
+    return contiguous->output();
+  };
+
+  std::unordered_map<Value*, Value*> channels_last_inputs;
+  std::unordered_set<Value*> channels_last_values;
+  std::vector<Value*> chain_outputs;
+  const std::vector<Node*> nodes(graph->nodes().begin(), graph->nodes().end());
+  for (Node* n : nodes) {
+    if (nhwc_ops.count(n->kind())) {
+      Value* input = n->input(0);
+      if (!channels_last_values.count(input)) {
+        if (!is_4d(n) || !feeds_chain(n)) {
+          continue;
+        }
+        auto it = channels_last_inputs.find(input);
+        if (it == channels_last_inputs.end()) {
+          it = channels_last_inputs
+                   .emplace(
+                       input,
+                       insert_contiguous(input, c10::MemoryFormat::ChannelsLast, n))
+                   .first;
+        }
+        n->replaceInput(0, it->second);
+      }
+    } else if (!(layout_preserving_ops.count(n->kind()) &&
+                 channels_last_values.count(n->input(0)))) {
+      continue;
+    }
+    channels_last_values.insert(n->output());
+    chain_outputs.push_back(n->output());
+  }
+
+  for (Value* v : chain_outputs) {
+    std::vector<Use> outside_uses;
+    for (const Use& use : v->uses()) {
+      if (!nhwc_ops.count(use.user->kind()) &&
+          !layout_preserving_ops.count(use.user->kind())) {
+        outside_uses.push_back(use);
+      }
+    }
+    if (outside_uses.empty()) {
+      continue;
+    }
+    Value* contiguous =
+        insert_contiguous(v, c10::MemoryFormat::Contiguous, v->node()->next());
+    for (const Use& use : outside_uses) {
+      use.user->replaceInput(use.offset, contiguous);
+    }
+  }
+}
+
 } // namespace
 
 void insertXNNPACKOps(std::shared_ptr<Graph>& graph) {
@@ -86,6 +553,12 @@ void insertXNNPACKOps(std::shared_ptr<Graph>& graph) {
   ConstantPropagation(graph);
   insertXNNPACKLinearOp(graph);
   insertXNNPACKConv2dOp(graph);
+  insertXNNPACKConvTranspose2dOp(graph);
+  insertXNNPACKPoolingOps(graph);
+  insertXNNPACKHardswishOp(graph);
+  insertXNNPACKAddOp(graph);
+  insertXNNPACKClampOps(graph);
+  insertXNNPACKLayoutConversions(graph);
 }
 
 void insertXNNPACKOps(script::Module& module) {
@@ -102,7 +575,9 @@ void FoldXNNPACKPrePackingOps(script::Module& m) {
   PrePackingOpsFilterFn filter_fn = [](const Node* n) -> bool {
     return (
         (n->kind() == Symbol::fromQualString("_xnnpack::linear_prepack")) ||
-        n->kind() == Symbol::fromQualString("_xnnpack::conv2d_prepack"));
+        n->kind() == Symbol::fromQualString("_xnnpack::conv2d_prepack") ||
+        n->kind() ==
+            Symbol::fromQualString("_xnnpack::conv2d_transpose_prepack"));
   };
   FoldPrePackingOps(m, filter_fn, "xnnpack_prepack_folding");
 }
@@ -7,6 +7,7 @@
 #include <torch/csrc/jit/codegen/fuser/kernel_cache.h>
 #include <torch/csrc/jit/runtime/graph_executor.h>
 #include <torch/csrc/jit/serialization/import.h>
+#include <torch/csrc/jit/serialization/optimized_plans.h>
 #include <torch/csrc/jit/ir/irparser.h>
 #include <torch/csrc/jit/runtime/operator.h>
 #include <torch/csrc/jit/passes/canonicalize.h>
@@ -21,6 +22,7 @@
 #include <torch/csrc/jit/passes/fuse_linear.h>
 #include <torch/csrc/jit/passes/graph_fuser.h>
 #include <torch/csrc/jit/passes/cuda_graph_fuser.h>
+#include <torch/csrc/jit/passes/horizontal_fusion.h>
 #include <torch/csrc/jit/passes/inline_fork_wait.h>
 #include <torch/csrc/jit/passes/inliner.h>
 #include <torch/csrc/jit/passes/loop_unrolling.h>
@@ -36,6 +38,7 @@
 #include <torch/csrc/jit/passes/onnx/prepare_inplace_ops_for_onnx.h>
 #include <torch/csrc/jit/passes/onnx/scalar_type_analysis.h>
 #include <torch/csrc/jit/passes/onnx/unpack_quantized_weights.h>
+#include <torch/csrc/jit/passes/parallelize_branches.h>
 #include <torch/csrc/jit/passes/peephole.h>
 #include <torch/csrc/jit/passes/quantization.h>
 #include <torch/csrc/jit/passes/remove_expands.h>
@@ -46,8 +49,10 @@
 #include <torch/csrc/jit/passes/tensorexpr_fuser.h>
 #include <torch/csrc/jit/passes/utils/check_alias_annotation.h>
 #include <torch/csrc/jit/passes/freeze_module.h>
+#include <torch/csrc/jit/passes/frozen_graph_optimizations.h>
 #include <torch/csrc/jit/passes/xnnpack_rewrite.h>
 #include <torch/csrc/jit/runtime/print_handler.h>
+#include <torch/csrc/jit/runtime/static/init.h>
 #include <torch/csrc/jit/python/pybind_utils.h>
 #include <torch/csrc/jit/python/python_arg_flatten.h>
 #include <torch/csrc/jit/python/python_custom_class.h>
@@ -207,7 +212,29 @@ void initJITBindings(PyObject* module) {
             return freeze_module(module);
           },
           py::arg("module"))
+      .def(
+          "_freeze_and_optimize_module",
+          [](Module& module, bool prepack_mkldnn_weights) {
+            return freeze_and_optimize_module(module, prepack_mkldnn_weights);
+          },
+          py::arg("module"),
+          py::arg("prepack_mkldnn_weights") = false)
+      .def(
+          "_jit_pass_optimize_frozen_graph",
+          [](std::shared_ptr<Graph>& graph, bool prepack_mkldnn_weights) {
+            OptimizeFrozenGraph(graph, prepack_mkldnn_weights);
+          },
+          py::arg("graph"),
+          py::arg("prepack_mkldnn_weights") = false)
+      .def("_jit_pass_fold_frozen_conv_bn", &FoldFrozenConvBatchNorm)
+      .def(
+          "_jit_pass_propagate_frozen_mkldnn_layout",
+          &PropagateFrozenMKLDNNLayout)
+      .def(
+          "_jit_pass_fold_frozen_conv_linear_arithmetic",
+          &FoldFrozenConvAndLinearArithmetic)
       .def("_jit_pass_fuse_linear", &FuseLinear)
+      .def("_jit_pass_horizontal_fusion", &HorizontalFusion)
       .def(
           "_jit_pass_fold_quantize",
           [](Module& module, const std::string& method_name) {
@@ -292,6 +319,13 @@ void initJITBindings(PyObject* module) {
       .def("_jit_pass_remove_expands", RemoveExpands)
       .def("_jit_pass_erase_number_types", EraseNumberTypes)
       .def("_jit_pass_inline_fork_wait", InlineForkWait)
+      .def(
+          "_jit_pass_parallelize_branches",
+          [](const std::shared_ptr<Graph>& g, int64_t min_branch_flops) {
+            return ParallelizeBranches(g, min_branch_flops);
+          },
+          py::arg("graph"),
+          py::arg("min_branch_flops") = 1 << 20)
       .def("_jit_pass_inline", Inline)
       .def("_jit_pass_prepare_division_for_onnx", PrepareDivisionForONNX)
       .def(
@@ -392,6 +426,20 @@ void initJITBindings(PyObject* module) {
             getBailoutDepth() = depth;
             return old_depth;
           })
+      .def(
+          "_jit_set_save_optimized_plans",
+          [](bool enabled) {
+            bool old_value = getSaveOptimizedPlans();
+            getSaveOptimizedPlans() = enabled;
+            return old_value;
+          })
+      .def(
+          "_jit_set_background_compilation",
+          [](bool enabled) {
+            bool old_value = getBackgroundCompilation();
+            getBackgroundCompilation() = enabled;
+            return old_value;
+          })
       .def(
           "_jit_set_inline_everything_mode",
           [](bool enabled) { getInlineEverythingMode() = enabled; })
@@ -818,6 +866,7 @@ void initJITBindings(PyObject* module) {
   tracer::initPythonTracerBindings(module);
   initTreeViewBindings(module);
   initJitScriptBindings(module);
+  initStaticRuntimeBindings(module);
 
   setPrintHandler([](const std::string& str) {
     py::gil_scoped_acquire acquire;
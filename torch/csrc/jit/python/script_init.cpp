@@ -1043,6 +1043,24 @@ void initJitScriptBindings(PyObject* module) {
                 method, tuple_slice(std::move(args), 1), std::move(kwargs));
             END_HANDLE_TH_ERRORS_PYBIND
           })
+      .def(
+          "warmup",
+          [](py::args args, py::kwargs kwargs) {
+            HANDLE_TH_ERRORS
+            Method& method = py::cast<Method&>(args[0]);
+            auto stack = createStackForSchema(
+                method.function().getSchema(),
+                tuple_slice(std::move(args), 1),
+                std::move(kwargs),
+                method.owner()._ivalue());
+            // the stack is normalized already, without kwargs left
+            stack.erase(stack.begin());
+            {
+              pybind11::gil_scoped_release no_gil_guard;
+              method.warmup(std::move(stack));
+            }
+            END_HANDLE_TH_ERRORS_PYBIND
+          })
       .def_property_readonly("graph", &Method::graph)
       .def_property_readonly(
           "inlined_graph",
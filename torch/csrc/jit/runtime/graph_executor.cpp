@@ -481,6 +481,12 @@ void GraphExecutorImplBase::run(Stack& stack) {
   last_executed_optimized_graph = plan.graph;
 }
 
+void GraphExecutorImplBase::warmup(const Stack& inputs) {
+  // executors without profiling specialize on the first run
+  Stack stack = inputs;
+  run(stack);
+}
+
 // a Graph can be created via tracing, or via a language-based frontend
 // GraphExecutor runs it. It can run the same graph on many different sizes
 // and different requires_grad states, and handles specializations for each
@@ -632,6 +638,18 @@ void GraphExecutor::run(Stack& inputs) {
   return pImpl->run(inputs);
 }
 
+void GraphExecutor::warmup(const Stack& inputs) {
+  pImpl->warmup(inputs);
+}
+
+std::vector<std::shared_ptr<Graph>> GraphExecutor::getOptimizedGraphs() {
+  return pImpl->getOptimizedGraphs();
+}
+
+bool GraphExecutor::installOptimizedGraph(std::shared_ptr<Graph> graph) {
+  return pImpl->installOptimizedGraph(std::move(graph));
+}
+
 size_t GraphExecutor::getDefaultNumBailOuts() {
   return getProfilingMode() ? getBailoutDepth().load() : 0;
 }
@@ -55,6 +55,17 @@ struct TORCH_API GraphExecutor {
   // `GraphExecutor` will be created. This new `GraphExecutor`'s
   // remaining_bailout_depth will be reduced by 1.
   ExecutionPlan getPlanFor(Stack& inputs, size_t remaining_bailout_depth);
+  // Runs the graph on `inputs` until it is optimized for them, blocking until
+  // any background compilation has finished. Meant to be called at deploy
+  // time so that no request pays for profiling and compilation.
+  void warmup(const Stack& inputs);
+  // Graphs of the optimized plans compiled so far, e.g. to save them with the
+  // module (see serialization/optimized_plans.h).
+  std::vector<std::shared_ptr<Graph>> getOptimizedGraphs();
+  // Installs a graph returned by getOptimizedGraphs() of an executor of the
+  // same kind for the same function, so that runs skip profiling and
+  // optimization. Returns false if this executor cannot use it.
+  bool installOptimizedGraph(std::shared_ptr<Graph> graph);
   explicit operator bool() const {
     return pImpl != nullptr;
   }
@@ -78,6 +89,22 @@ TORCH_API std::atomic<bool> &getProfilingMode();
 TORCH_API std::atomic<bool>& getExecutorMode();
 TORCH_API std::atomic<size_t>& getNumProfiledRuns();
 TORCH_API std::atomic<size_t>& getBailoutDepth();
+// When set, the profiling executor optimizes a graph on a background thread
+// once profiling is done instead of on the thread of the request that
+// completed profiling. Requests keep running the profiling plan until the
+// optimized plan is ready.
+TORCH_API std::atomic<bool>& getBackgroundCompilation();
+
+struct TORCH_API BackgroundCompilationGuard {
+  BackgroundCompilationGuard(bool state)
+      : old_state_(getBackgroundCompilation().exchange(state)) {}
+
+  ~BackgroundCompilationGuard() {
+    getBackgroundCompilation() = old_state_;
+  }
+
+  bool old_state_;
+};
 
 struct TORCH_API GraphOptimizerEnabledGuard {
   GraphOptimizerEnabledGuard(bool state)
@@ -69,6 +69,13 @@ struct GraphExecutorImplBase {
       Stack& stack,
       size_t remaining_bailout_depth) = 0;
   virtual GraphExecutorState getDebugState() = 0;
+  virtual void warmup(const Stack& inputs);
+  virtual std::vector<std::shared_ptr<Graph>> getOptimizedGraphs() {
+    return {};
+  }
+  virtual bool installOptimizedGraph(std::shared_ptr<Graph> graph) {
+    return false;
+  }
   virtual ~GraphExecutorImplBase() = default;
 
  protected:
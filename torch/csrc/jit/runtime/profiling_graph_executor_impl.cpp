@@ -1,3 +1,4 @@
+#include <ATen/Parallel.h>
 #include <torch/csrc/jit/jit_log.h>
 #include <torch/csrc/jit/passes/bailout_graph.h>
 #include <torch/csrc/jit/passes/canonicalize_ops.h>
@@ -34,6 +35,9 @@ static std::atomic<bool> profiling_mode{true};
 
 static std::atomic<size_t> num_profiled_runs{1};
 static std::atomic<size_t> bailout_depth{1};
+static std::atomic<bool> background_compilation{false};
+// failed background compilations after which a graph runs unoptimized
+constexpr size_t kMaxCompileAttempts = 3;
 
 std::atomic<bool>& getProfilingMode() {
   return profiling_mode;
@@ -50,6 +54,10 @@ std::atomic<size_t>& getBailoutDepth() {
   return bailout_depth;
 }
 
+std::atomic<bool>& getBackgroundCompilation() {
+  return background_compilation;
+}
+
 static bool needsGradientInProfilingMode(Block* b) {
   for (auto n : b->nodes()) {
     if (n->kind() == prim::BailOut) {
@@ -174,6 +182,14 @@ ExecutionPlan ProfilingGraphExecutorImpl::getPlanFor(
     return *profiling_plan_;
   }
 
+  if (getBackgroundCompilation()) {
+    if (!compiling_ && compile_attempts_ < kMaxCompileAttempts) {
+      compileInBackground(remaining_bailout_depth);
+    }
+    // keep serving requests with the profiling plan in the meantime
+    return *profiling_plan_;
+  }
+
   auto copy = pr_->graph()->copy();
   runProfilingOptimizations(copy);
   // cache
@@ -181,6 +197,130 @@ ExecutionPlan ProfilingGraphExecutorImpl::getPlanFor(
   return *optimized_plan_;
 }
 
+void ProfilingGraphExecutorImpl::compileInBackground(
+    size_t remaining_bailout_depth) {
+  std::shared_ptr<Graph> copy;
+  {
+    // profiling runs may still be updating the profiled types
+    std::lock_guard<std::mutex> lock(pr_->mutex_);
+    copy = pr_->graph()->copy();
+  }
+  compiling_ = true;
+  const size_t attempt = ++compile_attempts_;
+  // the optimization toggle is thread local
+  const bool optimize = getGraphExecutorOptimize();
+  GRAPH_DEBUG("Compiling ", function_name_, " in the background");
+  at::launch([this,
+              copy,
+              optimize,
+              remaining_bailout_depth,
+              attempt]() mutable {
+    c10::optional<ExecutionPlan> plan;
+    std::string error;
+    try {
+      GraphOptimizerEnabledGuard guard(optimize);
+      runProfilingOptimizations(copy);
+      plan = ExecutionPlan(copy, function_name_, remaining_bailout_depth);
+    } catch (const std::exception& e) {
+      error = e.what();
+    } catch (...) {
+      error = "unknown error";
+    }
+    if (!plan && attempt == kMaxCompileAttempts) {
+      TORCH_WARN(
+          "Failed to optimize ",
+          function_name_,
+          " in the background, running it unoptimized: ",
+          error);
+      try {
+        GraphOptimizerEnabledGuard guard(optimize);
+        auto fallback = graph->copy();
+        runProfilingInsensitiveOptimizations(fallback);
+        plan = ExecutionPlan(fallback, function_name_);
+      } catch (...) {
+        // keep running the profiling plan
+      }
+    } else if (!plan) {
+      // the profiling plan keeps serving requests, a later one retries
+      TORCH_WARN(
+          "Failed to optimize ",
+          function_name_,
+          " in the background, will retry: ",
+          error);
+    }
+    {
+      std::lock_guard<std::mutex> lock(compile_mutex);
+      if (plan) {
+        // requests pick up the optimized plan on their next getPlanFor
+        optimized_plan_ = std::move(plan);
+      }
+      compiling_ = false;
+      // notify under the lock, the executor may be destroyed right after
+      compiled_.notify_all();
+    }
+  });
+}
+
+void ProfilingGraphExecutorImpl::waitForCompilation(
+    std::unique_lock<std::mutex>& lock) {
+  compiled_.wait(lock, [this] { return !compiling_; });
+}
+
+void ProfilingGraphExecutorImpl::warmup(const Stack& inputs) {
+  // the background compilation runs on the inter-op pool, waiting for it
+  // from one of its threads can deadlock
+  TORCH_CHECK(
+      !getBackgroundCompilation() || !at::in_interop_thread_pool(),
+      "Cannot warm up ",
+      function_name_,
+      " from a task of the inter-op thread pool");
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(compile_mutex);
+      waitForCompilation(lock);
+      // failed compilations are retried by the next runs
+      if (optimized_plan_ || compile_attempts_ == kMaxCompileAttempts) {
+        break;
+      }
+    }
+    Stack stack = inputs;
+    run(stack);
+  }
+  // run the optimized plan once so that nested executors (e.g. of
+  // differentiable graphs or fallback functions) get warmed up as well
+  Stack stack = inputs;
+  run(stack);
+}
+
+std::vector<std::shared_ptr<Graph>> ProfilingGraphExecutorImpl::
+    getOptimizedGraphs() {
+  std::lock_guard<std::mutex> lock(compile_mutex);
+  if (!optimized_plan_) {
+    return {};
+  }
+  return {optimized_plan_->graph};
+}
+
+bool ProfilingGraphExecutorImpl::installOptimizedGraph(
+    std::shared_ptr<Graph> graph) {
+  std::lock_guard<std::mutex> lock(compile_mutex);
+  if (optimized_plan_ || compiling_) {
+    return false;
+  }
+  // the graph carries its own guards, inputs it was not specialized for
+  // bail out to the unoptimized graph
+  GRAPH_DUMP("Installing optimized graph: ", graph);
+  optimized_plan_ = ExecutionPlan(
+      std::move(graph), function_name_, GraphExecutor::getDefaultNumBailOuts());
+  return true;
+}
+
+ProfilingGraphExecutorImpl::~ProfilingGraphExecutorImpl() {
+  // the background compilation refers to this executor
+  std::unique_lock<std::mutex> lock(compile_mutex);
+  compiled_.wait(lock, [this] { return !compiling_; });
+}
+
 GraphExecutorState ProfilingGraphExecutorImpl::getDebugState() {
   GraphExecutorState state;
   TORCH_INTERNAL_ASSERT(optimized_plan_);
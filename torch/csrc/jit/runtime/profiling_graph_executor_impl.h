@@ -1,6 +1,8 @@
 #pragma once
 #include <torch/csrc/jit/runtime/graph_executor_impl.h>
 
+#include <condition_variable>
+
 namespace torch {
 namespace jit {
 
@@ -10,15 +12,25 @@ struct ProfilingGraphExecutorImpl : public GraphExecutorImplBase {
   ExecutionPlan getPlanFor(Stack& stack, size_t remaining_bailout_depth)
       override;
   GraphExecutorState getDebugState() override;
-  ~ProfilingGraphExecutorImpl() override = default;
+  void warmup(const Stack& inputs) override;
+  std::vector<std::shared_ptr<Graph>> getOptimizedGraphs() override;
+  bool installOptimizedGraph(std::shared_ptr<Graph> graph) override;
+  ~ProfilingGraphExecutorImpl() override;
 
  private:
   void runProfilingInsensitiveOptimizations(std::shared_ptr<Graph>& graph);
   void runProfilingOptimizations(std::shared_ptr<Graph>& graph);
+  // Must be called with compile_mutex held
+  void compileInBackground(size_t remaining_bailout_depth);
+  void waitForCompilation(std::unique_lock<std::mutex>& lock);
   std::unique_ptr<ProfilingRecord> pr_;
   c10::optional<ExecutionPlan>
       profiling_plan_; // plan to run in order to profiling the code
   c10::optional<ExecutionPlan> optimized_plan_;
+  // state of the background compilation, guarded by compile_mutex
+  bool compiling_ = false;
+  size_t compile_attempts_ = 0;
+  std::condition_variable compiled_;
 };
 
 } // namespace jit
@@ -0,0 +1,286 @@
+#include <torch/csrc/jit/runtime/static/impl.h>
+
+#include <ATen/native/TypeProperties.h>
+#include <torch/csrc/jit/ir/constants.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <torch/csrc/jit/passes/constant_propagation.h>
+#include <torch/csrc/jit/passes/dead_code_elimination.h>
+#include <torch/csrc/jit/passes/inliner.h>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+// Whether `out`, the output tensor of an earlier run, has the dtype and the
+// device the out-variant produces for the current inputs.
+bool matchesInputs(
+    const at::Tensor& out,
+    const std::vector<const IValue*>& inputs) {
+  std::vector<at::Tensor> tensors;
+  for (const IValue* input : inputs) {
+    if (input->isTensor()) {
+      tensors.push_back(input->toTensor());
+    } else if (input->isTensorList()) {
+      auto list = input->toTensorList().vec();
+      tensors.insert(tensors.end(), list.begin(), list.end());
+    }
+  }
+  return !tensors.empty() && out.device() == tensors[0].device() &&
+      out.scalar_type() == at::native::result_type(tensors);
+}
+
+} // namespace
+
+std::shared_ptr<Graph> PrepareForStaticRuntime(std::shared_ptr<Graph> graph) {
+  Inline(*graph);
+  ConstantPropagation(graph);
+  EliminateDeadCode(graph);
+  for (Node* n : graph->nodes()) {
+    TORCH_CHECK(
+        n->blocks().empty(),
+        "Static runtime does not support control flow, found ",
+        n->kind().toQualString());
+  }
+  return graph;
+}
+
+StaticModule::StaticModule(std::shared_ptr<Graph> graph)
+    : graph_(PrepareForStaticRuntime(std::move(graph))) {
+  init();
+}
+
+StaticModule::StaticModule(const Module& module)
+    : graph_(module.get_method("forward").graph()->copy()) {
+  Value* self = graph_->inputs().at(0);
+  TORCH_CHECK(
+      !self->hasUses(),
+      "StaticModule expects a frozen module, but forward uses self");
+  graph_->eraseInput(0);
+  graph_ = PrepareForStaticRuntime(graph_);
+  init();
+}
+
+void StaticModule::init() {
+  std::unordered_map<const Value*, size_t> slots;
+  auto slot = [&](const Value* v) {
+    auto it = slots.find(v);
+    if (it != slots.end()) {
+      return it->second;
+    }
+    const size_t s = slots.size();
+    slots.emplace(v, s);
+    return s;
+  };
+
+  for (Value* v : graph_->inputs()) {
+    input_slots_.push_back(slot(v));
+  }
+  planned_ranges_ = ComputePlannableLiveRanges(
+      graph_, [](const Node* n) { return hasOutVariant(n); });
+
+  for (Node* n : graph_->nodes()) {
+    if (n->kind() == prim::Constant) {
+      constants_.emplace_back(slot(n->output()), *toIValue(n->output()));
+      continue;
+    }
+    ProcessedNode pn;
+    pn.node = n;
+    for (Value* v : n->inputs()) {
+      pn.inputs.push_back(slot(v));
+    }
+    for (Value* v : n->outputs()) {
+      pn.outputs.push_back(slot(v));
+    }
+    if (n->outputs().size() == 1 && planned_ranges_.count(n->output())) {
+      pn.kind = ProcessedNode::Kind::kOutVariant;
+      pn.out_variant = getOutVariant(n);
+      pn.op = n->getOperation();
+    } else if (hasNativeOperation(n)) {
+      pn.kind = ProcessedNode::Kind::kNative;
+      pn.native = getNativeOperation(n);
+    } else {
+      pn.kind = ProcessedNode::Kind::kBoxed;
+      pn.op = n->getOperation();
+    }
+    GRAPH_DEBUG(
+        "Static runtime runs ",
+        n->kind().toQualString(),
+        pn.kind == ProcessedNode::Kind::kOutVariant
+            ? " through an out-variant"
+            : pn.kind == ProcessedNode::Kind::kNative ? " natively" : " boxed");
+    nodes_.push_back(std::move(pn));
+  }
+  for (Value* v : graph_->outputs()) {
+    output_slots_.push_back(slot(v));
+  }
+  num_slots_ = slots.size();
+
+  // Everything but constants and reused out-variant outputs is dropped at
+  // the end of a run so that the runtime does not keep inputs, outputs or
+  // freshly allocated intermediates alive.
+  std::vector<bool> keep(num_slots_, false);
+  for (const auto& constant : constants_) {
+    keep[constant.first] = true;
+  }
+  for (const ProcessedNode& pn : nodes_) {
+    if (pn.kind == ProcessedNode::Kind::kOutVariant) {
+      keep[pn.outputs[0]] = true;
+    }
+  }
+  for (size_t s = 0; s < num_slots_; ++s) {
+    if (!keep[s]) {
+      transient_slots_.push_back(s);
+    }
+  }
+}
+
+std::unique_ptr<StaticRuntime> StaticModule::acquireRuntime() const {
+  {
+    std::lock_guard<std::mutex> guard(pool_mutex_);
+    if (!pool_.empty()) {
+      auto runtime = std::move(pool_.back());
+      pool_.pop_back();
+      return runtime;
+    }
+  }
+  return std::make_unique<StaticRuntime>(*this);
+}
+
+void StaticModule::releaseRuntime(
+    std::unique_ptr<StaticRuntime> runtime) const {
+  std::lock_guard<std::mutex> guard(pool_mutex_);
+  pool_.push_back(std::move(runtime));
+}
+
+std::vector<at::Tensor> StaticModule::run(
+    const std::vector<at::Tensor>& inputs) const {
+  std::vector<IValue> stack(inputs.begin(), inputs.end());
+  auto runtime = acquireRuntime();
+  auto outputs = runtime->run(std::move(stack));
+  releaseRuntime(std::move(runtime));
+
+  std::vector<at::Tensor> result;
+  result.reserve(outputs.size());
+  for (auto& output : outputs) {
+    result.push_back(std::move(output).toTensor());
+  }
+  return result;
+}
+
+IValue StaticModule::operator()(std::vector<IValue> inputs) const {
+  auto runtime = acquireRuntime();
+  auto outputs = runtime->run(std::move(inputs));
+  releaseRuntime(std::move(runtime));
+  if (outputs.size() == 1) {
+    return std::move(outputs[0]);
+  }
+  return c10::ivalue::Tuple::create(std::move(outputs));
+}
+
+StaticRuntime::StaticRuntime(const StaticModule& module)
+    : module_(module),
+      values_(module.num_slots_),
+      planner_(module.planned_ranges_) {
+  for (const auto& constant : module_.constants_) {
+    values_[constant.first] = constant.second;
+  }
+  for (const ProcessedNode& pn : module_.nodes_) {
+    std::vector<const IValue*> inputs;
+    for (size_t s : pn.inputs) {
+      inputs.push_back(&values_[s]);
+    }
+    std::vector<IValue*> outputs;
+    for (size_t s : pn.outputs) {
+      outputs.push_back(&values_[s]);
+    }
+    node_inputs_.push_back(std::move(inputs));
+    node_outputs_.push_back(std::move(outputs));
+  }
+}
+
+std::vector<IValue> StaticRuntime::run(std::vector<IValue> inputs) {
+  const auto& input_slots = module_.input_slots_;
+  TORCH_CHECK(
+      inputs.size() == input_slots.size(),
+      "Expected ",
+      input_slots.size(),
+      " inputs, got ",
+      inputs.size());
+  MemoryPlanner::Profile* profile = planner_.find(inputs);
+  const bool recording = !profile && planner_.canPlan(inputs);
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    values_[input_slots[i]] = inputs[i];
+  }
+
+  const auto& nodes = module_.nodes_;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    const ProcessedNode& pn = nodes[i];
+    switch (pn.kind) {
+      case ProcessedNode::Kind::kOutVariant: {
+        IValue& output = *node_outputs_[i][0];
+        if (profile) {
+          auto it = profile->tensors.find(pn.node->output());
+          if (it != profile->tensors.end()) {
+            pn.out_variant(node_inputs_[i], it->second);
+            if (!output.isTensor() ||
+                !output.toTensor().is_same(it->second)) {
+              output = it->second;
+            }
+            break;
+          }
+        }
+        // reuse the tensor of the previous run unless it lives in the
+        // (fixed size) arena of another profile or the inputs changed its
+        // dtype or device
+        if (output.isTensor() && output.toTensor().storage().resizable() &&
+            matchesInputs(output.toTensor(), node_inputs_[i])) {
+          at::Tensor out = output.toTensor();
+          pn.out_variant(node_inputs_[i], out);
+          break;
+        }
+        // no tensor to reuse
+        output = IValue();
+      }
+      // fallthrough
+      case ProcessedNode::Kind::kBoxed: {
+        for (const IValue* input : node_inputs_[i]) {
+          stack_.push_back(*input);
+        }
+        pn.op(stack_);
+        AT_ASSERT(stack_.size() == pn.outputs.size());
+        for (size_t o = 0; o < pn.outputs.size(); ++o) {
+          *node_outputs_[i][o] = std::move(stack_[o]);
+        }
+        stack_.clear();
+        break;
+      }
+      case ProcessedNode::Kind::kNative:
+        pn.native(node_inputs_[i], node_outputs_[i]);
+        break;
+    }
+  }
+
+  if (recording) {
+    std::unordered_map<const Value*, at::Tensor> produced;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      if (nodes[i].kind == ProcessedNode::Kind::kOutVariant) {
+        produced[nodes[i].node->output()] = node_outputs_[i][0]->toTensor();
+      }
+    }
+    planner_.record(inputs, produced);
+  }
+
+  std::vector<IValue> outputs;
+  outputs.reserve(module_.output_slots_.size());
+  for (size_t s : module_.output_slots_) {
+    outputs.push_back(values_[s]);
+  }
+  for (size_t s : module_.transient_slots_) {
+    values_[s] = IValue();
+  }
+  return outputs;
+}
+
+} // namespace jit
+} // namespace torch
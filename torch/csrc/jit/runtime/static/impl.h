@@ -0,0 +1,118 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <torch/csrc/jit/api/module.h>
+#include <torch/csrc/jit/ir/ir.h>
+#include <torch/csrc/jit/runtime/static/memory_planner.h>
+#include <torch/csrc/jit/runtime/static/ops.h>
+
+#include <mutex>
+
+namespace torch {
+namespace jit {
+
+// Inlines and constant-propagates `graph` and checks that it can be run by
+// the static runtime, i.e. that it has no control flow.
+TORCH_API std::shared_ptr<Graph> PrepareForStaticRuntime(
+    std::shared_ptr<Graph> graph);
+
+// A node of a StaticModule with its kernel resolved ahead of time. Inputs and
+// outputs are slots in the flat value array of a StaticRuntime.
+struct ProcessedNode {
+  enum class Kind {
+    // runs through an out-variant and reuses its output tensor across runs
+    kOutVariant,
+    // runs through an unboxed kernel that allocates its outputs
+    kNative,
+    // runs through the boxed Operation of the node
+    kBoxed,
+  };
+
+  Node* node;
+  Kind kind;
+  std::vector<size_t> inputs;
+  std::vector<size_t> outputs;
+  OutVariant out_variant;
+  NativeOperation native;
+  // Boxed operation. Also used by kOutVariant nodes whenever there is no
+  // output tensor to reuse yet.
+  Operation op;
+};
+
+class StaticRuntime;
+
+// StaticModule is an alternative executor for frozen, control-flow-free
+// TorchScript graphs. It skips the GraphExecutor and the interpreter: every
+// node is pre-resolved to an out-variant, an unboxed kernel or, as a last
+// resort, its boxed Operation, and values live in a flat array indexed by
+// slots computed once.
+//
+// A StaticModule is immutable and can be shared between threads. The state of
+// a single execution lives in a StaticRuntime; calls through the StaticModule
+// itself borrow one from an internal pool.
+class TORCH_API StaticModule {
+ public:
+  explicit StaticModule(std::shared_ptr<Graph> graph);
+  // `module` must be frozen (see passes/freeze_module.h); its forward method
+  // is run without the `self` argument.
+  explicit StaticModule(const Module& module);
+
+  std::vector<at::Tensor> run(const std::vector<at::Tensor>& inputs) const;
+  // Same calling convention as Module::forward
+  IValue operator()(std::vector<IValue> inputs) const;
+
+  const std::shared_ptr<Graph>& graph() const {
+    return graph_;
+  }
+
+  size_t num_inputs() const {
+    return input_slots_.size();
+  }
+
+ private:
+  friend class StaticRuntime;
+
+  void init();
+  std::unique_ptr<StaticRuntime> acquireRuntime() const;
+  void releaseRuntime(std::unique_ptr<StaticRuntime> runtime) const;
+
+  std::shared_ptr<Graph> graph_;
+  size_t num_slots_ = 0;
+  std::vector<std::pair<size_t, IValue>> constants_;
+  std::vector<ProcessedNode> nodes_;
+  std::vector<size_t> input_slots_;
+  std::vector<size_t> output_slots_;
+  // slots cleared at the end of every run
+  std::vector<size_t> transient_slots_;
+  std::unordered_map<const Value*, LiveRange> planned_ranges_;
+
+  mutable std::mutex pool_mutex_;
+  mutable std::vector<std::unique_ptr<StaticRuntime>> pool_;
+};
+
+// The mutable state of one StaticModule execution: the value array, the
+// tensors reused across runs and the memory planner arenas. Not thread-safe.
+class TORCH_API StaticRuntime {
+ public:
+  explicit StaticRuntime(const StaticModule& module);
+  StaticRuntime(const StaticRuntime&) = delete;
+  StaticRuntime& operator=(const StaticRuntime&) = delete;
+
+  std::vector<IValue> run(std::vector<IValue> inputs);
+
+  MemoryPlanner& planner() {
+    return planner_;
+  }
+
+ private:
+  const StaticModule& module_;
+  std::vector<IValue> values_;
+  // per node pointers into values_
+  std::vector<std::vector<const IValue*>> node_inputs_;
+  std::vector<std::vector<IValue*>> node_outputs_;
+  Stack stack_;
+  MemoryPlanner planner_;
+};
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,47 @@
+#include <torch/csrc/jit/runtime/static/init.h>
+
+#include <torch/csrc/jit/passes/freeze_module.h>
+#include <torch/csrc/jit/python/pybind_utils.h>
+#include <torch/csrc/jit/runtime/static/impl.h>
+
+namespace torch {
+namespace jit {
+
+void initStaticRuntimeBindings(PyObject* module) {
+  auto m = py::handle(module).cast<py::module>();
+  py::class_<StaticModule, std::shared_ptr<StaticModule>>(m, "StaticModule")
+      .def(
+          "run",
+          [](const StaticModule& self, const std::vector<at::Tensor>& inputs) {
+            pybind11::gil_scoped_release no_gil_guard;
+            return self.run(inputs);
+          })
+      .def("__call__", [](const StaticModule& self, py::args args) {
+        const auto& graph_inputs = self.graph()->inputs();
+        TORCH_CHECK(
+            args.size() == graph_inputs.size(),
+            "Expected ",
+            graph_inputs.size(),
+            " arguments, got ",
+            args.size());
+        std::vector<IValue> inputs;
+        for (size_t i = 0; i < args.size(); ++i) {
+          inputs.push_back(toIValue(args[i], graph_inputs[i]->type()));
+        }
+        IValue result;
+        {
+          pybind11::gil_scoped_release no_gil_guard;
+          result = self(std::move(inputs));
+        }
+        return toPyObject(std::move(result));
+      });
+  m.def("_jit_to_static_module", [](const script::Module& module) {
+    return std::make_shared<StaticModule>(freeze_module(module));
+  });
+  m.def("_jit_to_static_module", [](std::shared_ptr<Graph> graph) {
+    return std::make_shared<StaticModule>(graph->copy());
+  });
+}
+
+} // namespace jit
+} // namespace torch
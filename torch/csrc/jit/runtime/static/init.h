@@ -0,0 +1,9 @@
+#pragma once
+
+#include <torch/csrc/jit/python/pybind.h>
+
+namespace torch {
+namespace jit {
+void initStaticRuntimeBindings(PyObject* module);
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,100 @@
+#include <torch/csrc/jit/runtime/static/memory_planner.h>
+
+#include <c10/core/CPUAllocator.h>
+#include <torch/csrc/jit/jit_log.h>
+
+namespace torch {
+namespace jit {
+
+MemoryPlanner::MemoryPlanner(const std::shared_ptr<Graph>& graph)
+    : ranges_(ComputePlannableLiveRanges(graph, [](const Node* n) {
+        return hasOutVariant(n);
+      })) {}
+
+bool MemoryPlanner::profileKey(
+    at::ArrayRef<IValue> inputs,
+    ProfileKey& key) {
+  key.clear();
+  for (const IValue& input : inputs) {
+    if (input.isTensor()) {
+      const at::Tensor& t = input.toTensor();
+      if (!t.defined() || t.device().type() != at::kCPU ||
+          t.is_sparse() || t.is_mkldnn()) {
+        return false;
+      }
+      key.push_back(static_cast<int64_t>(t.scalar_type()));
+      key.push_back(t.dim());
+      key.insert(key.end(), t.sizes().begin(), t.sizes().end());
+    } else if (input.isInt()) {
+      key.push_back(input.toInt());
+    } else if (input.isBool()) {
+      key.push_back(input.toBool());
+    } else if (input.isIntList()) {
+      auto list = input.toIntVector();
+      key.push_back(list.size());
+      key.insert(key.end(), list.begin(), list.end());
+    } else if (!input.isNone() && !input.isDouble()) {
+      // anything else may determine shapes in ways we do not track
+      return false;
+    }
+  }
+  return true;
+}
+
+bool MemoryPlanner::canPlan(at::ArrayRef<IValue> inputs) const {
+  ProfileKey key;
+  return !ranges_.empty() && profileKey(inputs, key);
+}
+
+MemoryPlanner::Profile* MemoryPlanner::find(at::ArrayRef<IValue> inputs) {
+  if (profiles_.empty()) {
+    return nullptr;
+  }
+  ProfileKey key;
+  if (!profileKey(inputs, key)) {
+    return nullptr;
+  }
+  auto it = profiles_.find(key);
+  return it == profiles_.end() ? nullptr : &it->second;
+}
+
+MemoryPlanner::Profile& MemoryPlanner::record(
+    at::ArrayRef<IValue> inputs,
+    const std::unordered_map<const Value*, at::Tensor>& produced) {
+  ProfileKey key;
+  TORCH_CHECK(
+      profileKey(inputs, key), "Inputs cannot be served by a memory plan");
+
+  std::unordered_map<const Value*, size_t> sizes;
+  for (const auto& e : produced) {
+    const at::Tensor& t = e.second;
+    // only dense CPU outputs can be placed into the arena
+    if (!isPlannable(e.first) || !t.defined() ||
+        t.device().type() != at::kCPU || t.is_sparse() || t.is_mkldnn() ||
+        !t.is_contiguous()) {
+      continue;
+    }
+    sizes[e.first] = t.nbytes();
+  }
+
+  Profile profile;
+  profile.plan = PlanMemory(ranges_, sizes, c10::gAlignment);
+  profile.arena = c10::GetCPUAllocator()->allocate(profile.plan.arena_size);
+  char* start = static_cast<char*>(profile.arena.get());
+  for (const auto& e : profile.plan.offsets) {
+    const at::Tensor& t = produced.at(e.first);
+    profile.tensors[e.first] =
+        at::from_blob(start + e.second, t.sizes(), t.options());
+  }
+  GRAPH_DEBUG(
+      "Recorded shape profile with ",
+      profile.plan.offsets.size(),
+      " planned values, arena of ",
+      profile.plan.arena_size,
+      " bytes instead of ",
+      profile.plan.unplanned_size);
+  return profiles_[std::move(key)] = std::move(profile);
+}
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <torch/csrc/jit/ir/ir.h>
+#include <torch/csrc/jit/passes/memory_planning.h>
+#include <torch/csrc/jit/runtime/static/ops.h>
+
+#include <map>
+
+namespace torch {
+namespace jit {
+
+// MemoryPlanner serves the intermediate tensors of a frozen, control-flow-free
+// graph from one arena per shape profile. A shape profile is identified by
+// the dtypes and sizes of the tensor inputs and by the values of the integer
+// inputs. The first run of a profile is unplanned; the sizes of the tensors
+// it produces are used to plan the arena that later runs write into.
+class TORCH_API MemoryPlanner {
+ public:
+  struct Profile {
+    at::DataPtr arena;
+    MemoryPlan plan;
+    // arena-backed output tensor of every planned value
+    std::unordered_map<const Value*, at::Tensor> tensors;
+  };
+
+  explicit MemoryPlanner(const std::shared_ptr<Graph>& graph);
+  // `ranges` as computed by ComputePlannableLiveRanges
+  explicit MemoryPlanner(std::unordered_map<const Value*, LiveRange> ranges)
+      : ranges_(std::move(ranges)) {}
+
+  bool isPlannable(const Value* v) const {
+    return ranges_.count(v);
+  }
+
+  const std::unordered_map<const Value*, LiveRange>& ranges() const {
+    return ranges_;
+  }
+
+  // Returns the profile matching `inputs`, or nullptr if it was not recorded
+  // yet or if `inputs` cannot be planned for (e.g. non-CPU tensors).
+  Profile* find(at::ArrayRef<IValue> inputs);
+
+  // Plans the profile of `inputs` from the tensors produced for plannable
+  // values by an unplanned run.
+  Profile& record(
+      at::ArrayRef<IValue> inputs,
+      const std::unordered_map<const Value*, at::Tensor>& produced);
+
+  // Whether `record` would accept `inputs`
+  bool canPlan(at::ArrayRef<IValue> inputs) const;
+
+ private:
+  using ProfileKey = std::vector<int64_t>;
+  static bool profileKey(at::ArrayRef<IValue> inputs, ProfileKey& key);
+
+  std::unordered_map<const Value*, LiveRange> ranges_;
+  std::map<ProfileKey, Profile> profiles_;
+};
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,242 @@
+#include <torch/csrc/jit/runtime/static/ops.h>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+struct OutVariantEntry {
+  const char* schema;
+  OutVariant fn;
+};
+
+const std::vector<OutVariantEntry>& outVariants() {
+  static const std::vector<OutVariantEntry> entries = {
+      {"aten::add(Tensor self, Tensor other, *, Scalar alpha) -> Tensor",
+       [](at::ArrayRef<const IValue*> in, at::Tensor& out) {
+         at::add_out(
+             out, in[0]->toTensor(), in[1]->toTensor(), in[2]->toScalar());
+       }},
+      {"aten::sub(Tensor self, Tensor other, *, Scalar alpha) -> Tensor",
+       [](at::ArrayRef<const IValue*> in, at::Tensor& out) {
+         at::sub_out(
+             out, in[0]->toTensor(), in[1]->toTensor(), in[2]->toScalar());
+       }},
+      {"aten::mul(Tensor self, Tensor other) -> Tensor",
+       [](at::ArrayRef<const IValue*> in, at::Tensor& out) {
+         at::mul_out(out, in[0]->toTensor(), in[1]->toTensor());
+       }},
+      {"aten::div(Tensor self, Tensor other) -> Tensor",
+       [](at::ArrayRef<const IValue*> in, at::Tensor& out) {
+         at::div_out(out, in[0]->toTensor(), in[1]->toTensor());
+       }},
+      {"aten::mm(Tensor self, Tensor mat2) -> Tensor",
+       [](at::ArrayRef<const IValue*> in, at::Tensor& out) {
+         at::mm_out(out, in[0]->toTensor(), in[1]->toTensor());
+       }},
+      {"aten::bmm(Tensor self, Tensor mat2) -> Tensor",
+       [](at::ArrayRef<const IValue*> in, at::Tensor& out) {
+         at::bmm_out(out, in[0]->toTensor(), in[1]->toTensor());
+       }},
+      {"aten::addmm(Tensor self, Tensor mat1, Tensor mat2, *, Scalar beta, Scalar alpha) -> Tensor",
+       [](at::ArrayRef<const IValue*> in, at::Tensor& out) {
+         at::addmm_out(
+             out,
+             in[0]->toTensor(),
+             in[1]->toTensor(),
+             in[2]->toTensor(),
+             in[3]->toScalar(),
+             in[4]->toScalar());
+       }},
+      {"aten::relu(Tensor self) -> Tensor",
+       [](at::ArrayRef<const IValue*> in, at::Tensor& out) {
+         at::threshold_out(out, in[0]->toTensor(), 0, 0);
+       }},
+      {"aten::sigmoid(Tensor self) -> Tensor",
+       [](at::ArrayRef<const IValue*> in, at::Tensor& out) {
+         at::sigmoid_out(out, in[0]->toTensor());
+       }},
+      {"aten::tanh(Tensor self) -> Tensor",
+       [](at::ArrayRef<const IValue*> in, at::Tensor& out) {
+         at::tanh_out(out, in[0]->toTensor());
+       }},
+      {"aten::exp(Tensor self) -> Tensor",
+       [](at::ArrayRef<const IValue*> in, at::Tensor& out) {
+         at::exp_out(out, in[0]->toTensor());
+       }},
+      {"aten::cat(Tensor[] tensors, int dim) -> Tensor",
+       [](at::ArrayRef<const IValue*> in, at::Tensor& out) {
+         at::cat_out(out, in[0]->toTensorList().vec(), in[1]->toInt());
+       }},
+  };
+  return entries;
+}
+
+const OutVariantEntry* findOutVariant(const Node* n) {
+  for (const auto& entry : outVariants()) {
+    if (n->matches(entry.schema)) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+struct NativeOperationEntry {
+  const char* schema;
+  NativeOperation fn;
+};
+
+at::Tensor toOptionalTensor(const IValue* v) {
+  return v->isNone() ? at::Tensor() : v->toTensor();
+}
+
+const std::vector<NativeOperationEntry>& nativeOperations() {
+  static const std::vector<NativeOperationEntry> entries = {
+      {"aten::linear(Tensor input, Tensor weight, Tensor? bias=None) -> Tensor",
+       [](at::ArrayRef<const IValue*> in, at::ArrayRef<IValue*> out) {
+         *out[0] = at::linear(
+             in[0]->toTensor(), in[1]->toTensor(), toOptionalTensor(in[2]));
+       }},
+      {"aten::conv2d(Tensor input, Tensor weight, Tensor? bias, int[] stride, int[] padding, int[] dilation, int groups) -> Tensor",
+       [](at::ArrayRef<const IValue*> in, at::ArrayRef<IValue*> out) {
+         *out[0] = at::conv2d(
+             in[0]->toTensor(),
+             in[1]->toTensor(),
+             toOptionalTensor(in[2]),
+             in[3]->toIntVector(),
+             in[4]->toIntVector(),
+             in[5]->toIntVector(),
+             in[6]->toInt());
+       }},
+      {"aten::matmul(Tensor self, Tensor other) -> Tensor",
+       [](at::ArrayRef<const IValue*> in, at::ArrayRef<IValue*> out) {
+         *out[0] = at::matmul(in[0]->toTensor(), in[1]->toTensor());
+       }},
+      {"aten::t(Tensor self) -> Tensor",
+       [](at::ArrayRef<const IValue*> in, at::ArrayRef<IValue*> out) {
+         *out[0] = in[0]->toTensor().t();
+       }},
+      {"aten::transpose(Tensor self, int dim0, int dim1) -> Tensor",
+       [](at::ArrayRef<const IValue*> in, at::ArrayRef<IValue*> out) {
+         *out[0] = in[0]->toTensor().transpose(in[1]->toInt(), in[2]->toInt());
+       }},
+      {"aten::view(Tensor self, int[] size) -> Tensor",
+       [](at::ArrayRef<const IValue*> in, at::ArrayRef<IValue*> out) {
+         *out[0] = in[0]->toTensor().view(in[1]->toIntVector());
+       }},
+      {"aten::reshape(Tensor self, int[] shape) -> Tensor",
+       [](at::ArrayRef<const IValue*> in, at::ArrayRef<IValue*> out) {
+         *out[0] = in[0]->toTensor().reshape(in[1]->toIntVector());
+       }},
+      {"aten::flatten(Tensor self, int start_dim=0, int end_dim=-1) -> Tensor",
+       [](at::ArrayRef<const IValue*> in, at::ArrayRef<IValue*> out) {
+         *out[0] = in[0]->toTensor().flatten(in[1]->toInt(), in[2]->toInt());
+       }},
+      {"aten::softmax(Tensor self, int dim, ScalarType? dtype=None) -> Tensor",
+       [](at::ArrayRef<const IValue*> in, at::ArrayRef<IValue*> out) {
+         const auto& self = in[0]->toTensor();
+         *out[0] = in[2]->isNone()
+             ? at::softmax(self, in[1]->toInt())
+             : at::softmax(self, in[1]->toInt(), in[2]->toScalarType());
+       }},
+  };
+  return entries;
+}
+
+c10::optional<NativeOperation> primNativeOperation(const Node* n) {
+  switch (n->kind()) {
+    case prim::TupleConstruct: {
+      if (n->output()->type()->expect<TupleType>()->schema()) {
+        // named tuples need their type attached
+        return c10::nullopt;
+      }
+      return NativeOperation(
+          [](at::ArrayRef<const IValue*> in, at::ArrayRef<IValue*> out) {
+            std::vector<IValue> elements;
+            elements.reserve(in.size());
+            for (const IValue* v : in) {
+              elements.push_back(*v);
+            }
+            *out[0] = c10::ivalue::Tuple::create(std::move(elements));
+          });
+    }
+    case prim::TupleUnpack:
+      return NativeOperation(
+          [](at::ArrayRef<const IValue*> in, at::ArrayRef<IValue*> out) {
+            const auto& elements = in[0]->toTuple()->elements();
+            TORCH_INTERNAL_ASSERT(elements.size() == out.size());
+            for (size_t i = 0; i < out.size(); ++i) {
+              *out[i] = elements[i];
+            }
+          });
+    case prim::ListConstruct: {
+      const auto list_type = n->output()->type()->expect<ListType>();
+      if (list_type->getElementType()->kind() == TypeKind::TensorType) {
+        return NativeOperation(
+            [](at::ArrayRef<const IValue*> in, at::ArrayRef<IValue*> out) {
+              c10::List<at::Tensor> list;
+              list.reserve(in.size());
+              for (const IValue* v : in) {
+                list.push_back(v->toTensor());
+              }
+              *out[0] = std::move(list);
+            });
+      }
+      if (list_type->getElementType()->kind() == TypeKind::IntType) {
+        return NativeOperation(
+            [](at::ArrayRef<const IValue*> in, at::ArrayRef<IValue*> out) {
+              c10::List<int64_t> list;
+              list.reserve(in.size());
+              for (const IValue* v : in) {
+                list.push_back(v->toInt());
+              }
+              *out[0] = std::move(list);
+            });
+      }
+      return c10::nullopt;
+    }
+    default:
+      return c10::nullopt;
+  }
+}
+
+} // namespace
+
+bool hasOutVariant(const Node* n) {
+  return findOutVariant(n) != nullptr;
+}
+
+OutVariant getOutVariant(const Node* n) {
+  const OutVariantEntry* entry = findOutVariant(n);
+  TORCH_CHECK(
+      entry, "No out-variant registered for ", n->kind().toQualString());
+  return entry->fn;
+}
+
+bool hasNativeOperation(const Node* n) {
+  if (primNativeOperation(n)) {
+    return true;
+  }
+  for (const auto& entry : nativeOperations()) {
+    if (n->matches(entry.schema)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+NativeOperation getNativeOperation(const Node* n) {
+  if (auto op = primNativeOperation(n)) {
+    return *op;
+  }
+  for (const auto& entry : nativeOperations()) {
+    if (n->matches(entry.schema)) {
+      return entry.fn;
+    }
+  }
+  TORCH_CHECK(
+      false, "No native operation registered for ", n->kind().toQualString());
+}
+
+} // namespace jit
+} // namespace torch
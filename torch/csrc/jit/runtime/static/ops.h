@@ -0,0 +1,36 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <torch/csrc/jit/ir/ir.h>
+
+namespace torch {
+namespace jit {
+
+// An out-variant writes the single tensor output of a node into a tensor
+// provided by the caller instead of allocating a new one. `inputs` are the
+// node's inputs in schema order. The kernel resizes `out` if needed, so an
+// undefined `out` is not allowed but an empty tensor is.
+using OutVariant =
+    std::function<void(at::ArrayRef<const IValue*> inputs, at::Tensor& out)>;
+
+// Returns true if `n` can run through an out-variant.
+TORCH_API bool hasOutVariant(const Node* n);
+
+// Returns the out-variant for `n`. It is an error to call this for a node
+// for which hasOutVariant returns false.
+TORCH_API OutVariant getOutVariant(const Node* n);
+
+// A native operation runs a node through an unboxed kernel, reading its
+// inputs and writing its outputs in place without an interpreter stack.
+using NativeOperation = std::function<
+    void(at::ArrayRef<const IValue*> inputs, at::ArrayRef<IValue*> outputs)>;
+
+// Returns true if `n` can run through a native operation.
+TORCH_API bool hasNativeOperation(const Node* n);
+
+// Returns the native operation for `n`. It is an error to call this for a
+// node for which hasNativeOperation returns false.
+TORCH_API NativeOperation getNativeOperation(const Node* n);
+
+} // namespace jit
+} // namespace torch
@@ -1,7 +1,9 @@
 #include <torch/csrc/jit/serialization/export.h>
 
 #include <c10/util/Exception.h>
+#include <torch/csrc/jit/mobile/flat_bytecode.h>
 #include <torch/csrc/jit/serialization/import_export_helpers.h>
+#include <torch/csrc/jit/serialization/optimized_plans.h>
 #include <torch/csrc/jit/serialization/python_print.h>
 #include <torch/csrc/jit/serialization/pickle.h>
 #include <torch/csrc/jit/serialization/source_range_serialization.h>
@@ -12,7 +14,11 @@
 
 #include <ATen/ATen.h>
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace torch {
@@ -146,6 +152,210 @@ void moduleMethodsTuple(const Module& module,
   setstateTuple(module._ivalue(), elements);
 }
 
+// Builds the flat bytecode record (see mobile/flat_bytecode.h) from the
+// method tuples written to bytecode.pkl.
+class FlatBytecodeWriter {
+ public:
+  // Returns false if the function has a constant the format cannot hold.
+  bool addFunction(const IValue& function) {
+    const auto& elements = function.toTuple()->elements();
+    const auto& table = elements.at(1).toTuple()->elements();
+    auto field = [&](size_t entry) -> const std::vector<IValue>& {
+      return table.at(entry).toTuple()->elements().at(1).toTuple()->elements();
+    };
+
+    mobile::FlatFunction flat_function{};
+    flat_function.name = intern(elements.at(0).toStringRef());
+    flat_function.register_size =
+        table.at(4).toTuple()->elements().at(1).toInt();
+
+    std::vector<Instruction> instructions;
+    for (const auto& ins : field(0)) {
+      const auto& items = ins.toTuple()->elements();
+      instructions.emplace_back(
+          opcode(items.at(0).toStringRef()),
+          items.at(1).toInt(),
+          items.at(2).toInt());
+    }
+    flat_function.num_instructions = instructions.size();
+    flat_function.instructions_offset = appendArray(instructions);
+
+    std::vector<mobile::FlatOperator> operators;
+    for (const auto& op : field(1)) {
+      const auto& items = op.toTuple()->elements();
+      operators.push_back(
+          {intern(items.at(0).toStringRef()), intern(items.at(1).toStringRef())});
+    }
+    flat_function.num_operators = operators.size();
+    flat_function.operators_offset = appendArray(operators);
+
+    std::vector<mobile::FlatConstant> constants;
+    for (const auto& constant : field(2)) {
+      mobile::FlatConstant flat_constant{};
+      if (!convertConstant(constant, flat_constant)) {
+        return false;
+      }
+      constants.push_back(flat_constant);
+    }
+    flat_function.num_constants = constants.size();
+    flat_function.constants_offset = appendArray(constants);
+
+    std::vector<uint32_t> types;
+    for (const auto& type : field(3)) {
+      types.push_back(intern(type.toStringRef()));
+    }
+    flat_function.num_types = types.size();
+    flat_function.types_offset = appendArray(types);
+
+    functions_.push_back(flat_function);
+    return true;
+  }
+
+  std::string finish() {
+    mobile::FlatBytecodeHeader header{};
+    header.magic = mobile::kFlatBytecodeMagic;
+    header.version = mobile::kFlatBytecodeVersion;
+    header.num_functions = functions_.size();
+    header.functions_offset = appendArray(functions_);
+    header.num_tensors = flat_tensors_.size();
+    header.tensors_offset = appendArray(flat_tensors_);
+    header.num_opcodes = opcodes_.size();
+    header.opcodes_offset = appendArray(opcodes_);
+
+    std::vector<mobile::FlatString> strings;
+    std::string bytes;
+    for (const auto& s : strings_) {
+      strings.push_back(
+          {static_cast<uint32_t>(bytes.size()), static_cast<uint32_t>(s.size())});
+      bytes += s;
+    }
+    header.num_strings = strings.size();
+    header.strings_offset = appendArray(strings);
+    uint32_t bytes_offset = body_.size() + sizeof(header);
+    for (auto& s : strings) {
+      s.offset += bytes_offset;
+    }
+    std::memcpy(
+        &body_[header.strings_offset - sizeof(header)],
+        strings.data(),
+        strings.size() * sizeof(mobile::FlatString));
+    body_ += bytes;
+
+    std::string out(reinterpret_cast<const char*>(&header), sizeof(header));
+    return out + body_;
+  }
+
+  // The number of distinct storages referenced by tensor constants.
+  size_t numStorages() const {
+    return storage_ids_.size();
+  }
+
+ private:
+  uint32_t intern(const std::string& s) {
+    auto it = string_ids_.find(s);
+    if (it != string_ids_.end()) {
+      return it->second;
+    }
+    strings_.push_back(s);
+    return string_ids_[s] = strings_.size() - 1;
+  }
+
+  // Returns the opcode table index of the named opcode, stored in the op
+  // field of flat instructions.
+  OpCode opcode(const std::string& name) {
+    uint32_t id = intern(name);
+    auto it = std::find(opcodes_.begin(), opcodes_.end(), id);
+    if (it == opcodes_.end()) {
+      TORCH_INTERNAL_ASSERT(
+          opcodes_.size() < std::numeric_limits<uint8_t>::max(),
+          "Too many opcodes for the flat bytecode format");
+      it = opcodes_.insert(opcodes_.end(), id);
+    }
+    return static_cast<OpCode>(it - opcodes_.begin());
+  }
+
+  // Appends `values` 8-byte aligned and returns their offset in the record.
+  template <typename T>
+  uint32_t appendArray(const std::vector<T>& values) {
+    body_.resize((body_.size() + 7) / 8 * 8);
+    uint32_t offset = body_.size() + sizeof(mobile::FlatBytecodeHeader);
+    body_.append(
+        reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    return offset;
+  }
+
+  bool convertConstant(const IValue& v, mobile::FlatConstant& out) {
+    using Tag = mobile::FlatConstantTag;
+    if (v.isNone()) {
+      out.tag = Tag::None;
+    } else if (v.isBool()) {
+      out.tag = Tag::Bool;
+      out.i = v.toBool();
+    } else if (v.isInt()) {
+      out.tag = Tag::Int;
+      out.i = v.toInt();
+    } else if (v.isDouble()) {
+      out.tag = Tag::Double;
+      out.d = v.toDouble();
+    } else if (v.isString()) {
+      out.tag = Tag::String;
+      out.payload = intern(v.toStringRef());
+    } else if (v.isDevice()) {
+      out.tag = Tag::Device;
+      out.payload = intern(v.toDevice().str());
+    } else if (v.isIntList()) {
+      auto list = v.toIntVector();
+      out.tag = Tag::IntList;
+      out.size = list.size();
+      out.payload = appendArray(list);
+    } else if (v.isTensor()) {
+      const auto& t = v.toTensor();
+      if (t.is_quantized() || t.is_sparse() || t.is_mkldnn() ||
+          t.dim() > std::numeric_limits<uint16_t>::max()) {
+        return false;
+      }
+      out.tag = Tag::Tensor;
+      out.payload = flat_tensors_.size();
+      flat_tensors_.push_back(convertTensor(t));
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  mobile::FlatTensor convertTensor(const at::Tensor& t) {
+    // Storages are numbered in order of first use, like the Pickler numbers
+    // the tensor records of bytecode.pkl, so the records are shared.
+    auto storage_impl = t.storage().unsafeGetStorageImpl();
+    auto it = storage_ids_.find(storage_impl);
+    if (it == storage_ids_.end()) {
+      it = storage_ids_.emplace(storage_impl, storage_ids_.size()).first;
+    }
+    mobile::FlatTensor flat_tensor{};
+    flat_tensor.record =
+        intern(mobile::kFlatBytecodeDataPrefix + c10::to_string(it->second));
+    flat_tensor.scalar_type = static_cast<uint8_t>(t.scalar_type());
+    flat_tensor.requires_grad = t.requires_grad();
+    flat_tensor.dim = t.dim();
+    flat_tensor.storage_numel = t.storage().size();
+    flat_tensor.storage_offset = t.storage_offset();
+    std::vector<int64_t> sizes_and_strides(t.sizes().begin(), t.sizes().end());
+    sizes_and_strides.insert(
+        sizes_and_strides.end(), t.strides().begin(), t.strides().end());
+    flat_tensor.sizes_offset = appendArray(sizes_and_strides);
+    return flat_tensor;
+  }
+
+  std::string body_;
+  std::vector<uint32_t> opcodes_;
+  std::vector<mobile::FlatFunction> functions_;
+  std::vector<mobile::FlatTensor> flat_tensors_;
+  std::vector<std::string> strings_;
+  std::unordered_map<std::string, uint32_t> string_ids_;
+  // one record per storage, shared by the tensors that view it
+  std::unordered_map<const c10::StorageImpl*, size_t> storage_ids_;
+};
+
 }
 
 void SetExportModuleExtraFilesHook(ExportModuleExtraFilesHook hook) {
@@ -169,6 +379,14 @@ class ScriptModuleSerializer {
     writeExtraFiles(module, extra_files);
     // Serialize the model object
     writeArchive("data", module._ivalue());
+    if (getSaveOptimizedPlans()) {
+      // written before the code so that class types it refers to get
+      // serialized too
+      auto plans = serializeOptimizedPlans(module);
+      if (!plans.isNone()) {
+        writeArchive("optimized_plans", plans);
+      }
+    }
     // Then we werialize all code info.
     writeCode(module.type());
     // The tensor constants from the code are written to a separate archive
@@ -182,7 +400,8 @@ class ScriptModuleSerializer {
   }
 
  private:
-  void writeArchive(const std::string& archive_name, const IValue& value) {
+  // Returns the number of tensor records written for the archive.
+  size_t writeArchive(const std::string& archive_name, const IValue& value) {
     std::vector<char> data;
     // Vector to capture the run-time class types during pickling the IValues
     std::vector<c10::ClassTypePtr> memorizedClassTypes;
@@ -208,6 +427,7 @@ class ScriptModuleSerializer {
     for (const c10::ClassTypePtr& wroteType : memorizedClassTypes) {
       convertNamedType(wroteType);
     }
+    return i;
   }
 
   void writeExtraFiles(
@@ -268,8 +488,25 @@ class ScriptModuleSerializer {
   void writeByteCode(const Module& module) {
     std::vector<c10::IValue> elements;
     moduleMethodsTuple(module, elements);
+    // The lite interpreter falls back to bytecode.pkl if a function has a
+    // constant the flat format cannot hold.
+    FlatBytecodeWriter flat_writer;
+    bool write_flat = true;
+    for (const auto& function : elements) {
+      if (!flat_writer.addFunction(function)) {
+        write_flat = false;
+        break;
+      }
+    }
     auto telements = Tup(std::move(elements));
-    writeArchive("bytecode", telements);
+    size_t num_tensor_records = writeArchive("bytecode", telements);
+    // The flat record points to the tensor records of bytecode.pkl instead of
+    // writing the storages a second time.
+    if (write_flat && flat_writer.numStorages() == num_tensor_records) {
+      std::string flat = flat_writer.finish();
+      writer_.writeRecord(
+          mobile::kFlatBytecodeRecord, flat.data(), flat.size());
+    }
   }
 
   void convertNamedType(const c10::NamedTypePtr& class_type) {
@@ -6,6 +6,7 @@
 #include <torch/csrc/jit/serialization/import_legacy.h>
 #endif
 #include <torch/csrc/jit/serialization/import_source.h>
+#include <torch/csrc/jit/serialization/optimized_plans.h>
 #include <torch/csrc/jit/ir/ir.h>
 #include <torch/csrc/jit/serialization/pickle.h>
 #include <torch/csrc/jit/serialization/unpickler.h>
@@ -208,7 +209,13 @@ Module ScriptModuleDeserializer::deserialize(
   for (auto constant : tuple->elements()) {
     constants_table_.push_back(constant.toTensor());
   }
-  return Module(readArchive("data").toObject());
+  Module module(readArchive("data").toObject());
+  // Plans are specialized to the devices they were profiled on, do not
+  // install them when the tensors get remapped.
+  if (reader_->hasRecord("optimized_plans.pkl") && !device_) {
+    installOptimizedPlans(module, readArchive("optimized_plans"));
+  }
+  return module;
 }
 
 } // namespace
@@ -0,0 +1,514 @@
+#include <torch/csrc/jit/serialization/optimized_plans.h>
+
+#include <torch/csrc/jit/jit_log.h>
+#include <torch/csrc/jit/runtime/graph_executor.h>
+
+namespace torch {
+namespace jit {
+
+static std::atomic<bool> save_optimized_plans{false};
+
+std::atomic<bool>& getSaveOptimizedPlans() {
+  return save_optimized_plans;
+}
+
+namespace {
+
+// bump whenever the encoding below changes
+constexpr int64_t kOptimizedPlansVersion = 1;
+
+const std::unordered_map<std::string, TypePtr>& leafTypes() {
+  static const std::unordered_map<std::string, TypePtr> types = [] {
+    std::unordered_map<std::string, TypePtr> m;
+    for (const TypePtr& t : std::vector<TypePtr>{AnyType::get(),
+                                                 NumberType::get(),
+                                                 FloatType::get(),
+                                                 IntType::get(),
+                                                 BoolType::get(),
+                                                 StringType::get(),
+                                                 NoneType::get(),
+                                                 GeneratorType::get(),
+                                                 QSchemeType::get(),
+                                                 DeviceObjType::get(),
+                                                 LayoutType::get(),
+                                                 ScalarTypeType::get(),
+                                                 AnyListType::get(),
+                                                 AnyTupleType::get()}) {
+      m.emplace(t->str(), t);
+    }
+    return m;
+  }();
+  return types;
+}
+
+IValue encodeShape(const VaryingShape& shape) {
+  if (!shape.sizes()) {
+    return IValue();
+  }
+  std::vector<IValue> dims;
+  for (const auto& d : *shape.sizes()) {
+    dims.emplace_back(d ? IValue(*d) : IValue());
+  }
+  return c10::ivalue::Tuple::create(std::move(dims));
+}
+
+VaryingShape decodeShape(const IValue& encoded) {
+  if (encoded.isNone()) {
+    return VaryingShape();
+  }
+  VaryingShape::ListOfOptionalInts dims;
+  for (const IValue& d : encoded.toTuple()->elements()) {
+    dims.emplace_back(
+        d.isNone() ? c10::optional<int64_t>() : c10::optional<int64_t>(d.toInt()));
+  }
+  return VaryingShape(std::move(dims));
+}
+
+template <typename T>
+IValue encodeOptional(const c10::optional<T>& v) {
+  return v ? IValue(*v) : IValue();
+}
+
+IValue encodeType(const TypePtr& type) {
+  using c10::ivalue::Tuple;
+  if (auto tt = type->cast<TensorType>()) {
+    return Tuple::create(
+        {std::string("Tensor"),
+         tt->scalarType() ? IValue(static_cast<int64_t>(*tt->scalarType()))
+                          : IValue(),
+         tt->device() ? IValue(tt->device()->str()) : IValue(),
+         encodeShape(tt->sizes()),
+         encodeShape(tt->strides()),
+         encodeOptional(tt->requiresGrad()),
+         encodeOptional(tt->undefined())});
+  }
+  if (auto ct = type->cast<ClassType>()) {
+    TORCH_CHECK(ct->name(), "Cannot serialize unnamed class types");
+    return Tuple::create(
+        {std::string("Class"), ct->name()->qualifiedName()});
+  }
+  auto contained = [](const TypePtr& t) {
+    return c10::ivalue::Tuple::create(fmap(t->containedTypes(), encodeType));
+  };
+  switch (type->kind()) {
+    case TypeKind::OptionalType:
+      return Tuple::create({std::string("Optional"), contained(type)});
+    case TypeKind::ListType:
+      return Tuple::create({std::string("List"), contained(type)});
+    case TypeKind::DictType:
+      return Tuple::create({std::string("Dict"), contained(type)});
+    case TypeKind::TupleType:
+      TORCH_CHECK(
+          !type->expect<TupleType>()->schema(),
+          "Cannot serialize named tuple type ",
+          type->python_str());
+      return Tuple::create({std::string("Tuple"), contained(type)});
+    default:
+      break;
+  }
+  auto it = leafTypes().find(type->str());
+  TORCH_CHECK(
+      it != leafTypes().end() && *it->second == *type,
+      "Cannot serialize type ",
+      type->python_str());
+  return Tuple::create({std::string("Leaf"), type->str()});
+}
+
+TypePtr decodeType(const IValue& encoded, const CompilationUnit& cu) {
+  const auto& elems = encoded.toTuple()->elements();
+  const std::string& tag = elems.at(0).toStringRef();
+  if (tag == "Tensor") {
+    return TensorType::create(
+        elems[1].isNone()
+            ? c10::optional<at::ScalarType>()
+            : static_cast<at::ScalarType>(elems[1].toInt()),
+        elems[2].isNone() ? c10::optional<at::Device>()
+                          : at::Device(elems[2].toStringRef()),
+        decodeShape(elems[3]),
+        decodeShape(elems[4]),
+        elems[5].isNone() ? c10::optional<bool>() : elems[5].toBool(),
+        elems[6].isNone() ? c10::optional<bool>() : elems[6].toBool());
+  }
+  if (tag == "Class") {
+    auto cls = cu.get_class(c10::QualifiedName(elems.at(1).toStringRef()));
+    TORCH_CHECK(cls, "Unknown class ", elems.at(1).toStringRef());
+    return cls;
+  }
+  if (tag == "Leaf") {
+    return leafTypes().at(elems.at(1).toStringRef());
+  }
+  std::vector<TypePtr> contained;
+  for (const IValue& e : elems.at(1).toTuple()->elements()) {
+    contained.push_back(decodeType(e, cu));
+  }
+  if (tag == "Optional") {
+    return OptionalType::create(contained.at(0));
+  }
+  if (tag == "List") {
+    return ListType::create(contained.at(0));
+  }
+  if (tag == "Dict") {
+    return DictType::create(contained.at(0), contained.at(1));
+  }
+  TORCH_CHECK(tag == "Tuple", "Unknown type tag ", tag);
+  return TupleType::create(std::move(contained));
+}
+
+// Values are numbered in the order they are defined: block inputs, then for
+// every node its outputs followed by the values defined in its blocks.
+class GraphEncoder {
+ public:
+  IValue encode(const Graph& graph) {
+    return encodeBlock(graph.block());
+  }
+
+ private:
+  IValue define(const Value* v) {
+    ids_.emplace(v, ids_.size());
+    return c10::ivalue::Tuple::create(
+        {encodeType(v->type()),
+         v->hasDebugName() ? IValue(v->debugName()) : IValue()});
+  }
+
+  IValue use(const Value* v) const {
+    return static_cast<int64_t>(ids_.at(v));
+  }
+
+  IValue encodeBlock(const Block* b) {
+    using c10::ivalue::Tuple;
+    std::vector<IValue> inputs;
+    for (const Value* v : b->inputs()) {
+      inputs.push_back(define(v));
+    }
+    std::vector<IValue> nodes;
+    for (const Node* n : b->nodes()) {
+      nodes.push_back(encodeNode(n));
+    }
+    std::vector<IValue> outputs;
+    for (const Value* v : b->outputs()) {
+      outputs.push_back(use(v));
+    }
+    return Tuple::create(
+        {Tuple::create(std::move(inputs)),
+         Tuple::create(std::move(nodes)),
+         Tuple::create(std::move(outputs))});
+  }
+
+  IValue encodeNode(const Node* n) {
+    using c10::ivalue::Tuple;
+    TORCH_CHECK(
+        n->kind() != prim::PythonOp && n->kind() != prim::profile,
+        "Cannot serialize ",
+        n->kind().toQualString(),
+        " nodes");
+    std::vector<IValue> inputs;
+    for (const Value* v : n->inputs()) {
+      inputs.push_back(use(v));
+    }
+    std::vector<IValue> outputs;
+    for (const Value* v : n->outputs()) {
+      outputs.push_back(define(v));
+    }
+    std::vector<IValue> attributes;
+    for (Symbol name : n->attributeNames()) {
+      const AttributeKind kind = n->kindOf(name);
+      attributes.push_back(Tuple::create(
+          {std::string(name.toUnqualString()),
+           static_cast<int64_t>(kind),
+           encodeAttribute(n, name, kind)}));
+    }
+    std::vector<IValue> blocks;
+    for (const Block* b : n->blocks()) {
+      blocks.push_back(encodeBlock(b));
+    }
+    return Tuple::create(
+        {std::string(n->kind().toQualString()),
+         Tuple::create(std::move(inputs)),
+         Tuple::create(std::move(outputs)),
+         Tuple::create(std::move(attributes)),
+         Tuple::create(std::move(blocks))});
+  }
+
+  static IValue encodeAttribute(
+      const Node* n,
+      Symbol name,
+      AttributeKind kind) {
+    switch (kind) {
+      case AttributeKind::f:
+        return n->f(name);
+      case AttributeKind::fs:
+        return c10::List<double>(n->fs(name));
+      case AttributeKind::i:
+        return n->i(name);
+      case AttributeKind::is:
+        return c10::List<int64_t>(n->is(name));
+      case AttributeKind::s:
+        return n->s(name);
+      case AttributeKind::ss:
+        return c10::List<std::string>(n->ss(name));
+      case AttributeKind::t:
+        return n->t(name);
+      case AttributeKind::ts:
+        return c10::List<at::Tensor>(n->ts(name));
+      case AttributeKind::g:
+        return encodeGraph(*n->g(name));
+      case AttributeKind::gs:
+        return c10::ivalue::Tuple::create(
+            fmap(n->gs(name), [](const std::shared_ptr<Graph>& g) {
+              return encodeGraph(*g);
+            }));
+      case AttributeKind::ty:
+        return encodeType(n->ty(name));
+      case AttributeKind::tys:
+        return c10::ivalue::Tuple::create(fmap(n->tys(name), encodeType));
+      case AttributeKind::ival:
+        return n->ival(name);
+    }
+    TORCH_INTERNAL_ASSERT(false, "Unknown attribute kind");
+  }
+
+  std::unordered_map<const Value*, size_t> ids_;
+};
+
+class GraphDecoder {
+ public:
+  explicit GraphDecoder(const CompilationUnit& cu) : cu_(cu) {}
+
+  std::shared_ptr<Graph> decode(const IValue& encoded) {
+    auto graph = std::make_shared<Graph>();
+    decodeBlock(encoded, graph->block());
+    // catch broken encodings here rather than when the graph runs
+    graph->lint();
+    return graph;
+  }
+
+ private:
+  void define(Value* v, const IValue& encoded) {
+    const auto& elems = encoded.toTuple()->elements();
+    v->setType(decodeType(elems.at(0), cu_));
+    if (!elems.at(1).isNone()) {
+      v->setDebugName(elems.at(1).toStringRef());
+    }
+    values_.push_back(v);
+  }
+
+  Value* use(const IValue& id) const {
+    const int64_t index = id.toInt();
+    TORCH_CHECK(
+        index >= 0 && index < static_cast<int64_t>(values_.size()),
+        "Optimized plan refers to an undefined value ",
+        index);
+    return values_[index];
+  }
+
+  void decodeBlock(const IValue& encoded, Block* b) {
+    const auto& elems = encoded.toTuple()->elements();
+    for (const IValue& input : elems.at(0).toTuple()->elements()) {
+      define(b->addInput(), input);
+    }
+    for (const IValue& node : elems.at(1).toTuple()->elements()) {
+      decodeNode(node, b);
+    }
+    for (const IValue& output : elems.at(2).toTuple()->elements()) {
+      b->registerOutput(use(output));
+    }
+  }
+
+  void decodeNode(const IValue& encoded, Block* b) {
+    const auto& elems = encoded.toTuple()->elements();
+    Node* n = b->owningGraph()->create(
+        Symbol::fromQualString(elems.at(0).toStringRef()), 0);
+    b->appendNode(n);
+    for (const IValue& input : elems.at(1).toTuple()->elements()) {
+      n->addInput(use(input));
+    }
+    for (const IValue& output : elems.at(2).toTuple()->elements()) {
+      define(n->addOutput(), output);
+    }
+    for (const IValue& attribute : elems.at(3).toTuple()->elements()) {
+      const auto& attr = attribute.toTuple()->elements();
+      decodeAttribute(
+          n,
+          Symbol::attr(attr.at(0).toStringRef()),
+          static_cast<AttributeKind>(attr.at(1).toInt()),
+          attr.at(2));
+    }
+    for (const IValue& block : elems.at(4).toTuple()->elements()) {
+      decodeBlock(block, n->addBlock());
+    }
+  }
+
+  void decodeAttribute(
+      Node* n,
+      Symbol name,
+      AttributeKind kind,
+      const IValue& value) {
+    switch (kind) {
+      case AttributeKind::f:
+        n->f_(name, value.toDouble());
+        return;
+      case AttributeKind::fs:
+        n->fs_(name, value.toDoubleVector());
+        return;
+      case AttributeKind::i:
+        n->i_(name, value.toInt());
+        return;
+      case AttributeKind::is:
+        n->is_(name, value.toIntVector());
+        return;
+      case AttributeKind::s:
+        n->s_(name, value.toStringRef());
+        return;
+      case AttributeKind::ss: {
+        std::vector<std::string> strings;
+        for (const IValue& s : value.toListRef()) {
+          strings.push_back(s.toStringRef());
+        }
+        n->ss_(name, std::move(strings));
+        return;
+      }
+      case AttributeKind::t:
+        n->t_(name, value.toTensor());
+        return;
+      case AttributeKind::ts:
+        n->ts_(name, value.toTensorVector());
+        return;
+      case AttributeKind::g:
+        n->g_(name, decodeGraph(value, cu_));
+        return;
+      case AttributeKind::gs:
+        n->gs_(name, fmap(value.toTuple()->elements(), [&](const IValue& g) {
+          return decodeGraph(g, cu_);
+        }));
+        return;
+      case AttributeKind::ty:
+        n->ty_(name, decodeType(value, cu_));
+        return;
+      case AttributeKind::tys:
+        n->tys_(name, fmap(value.toTuple()->elements(), [&](const IValue& t) {
+          return decodeType(t, cu_);
+        }));
+        return;
+      case AttributeKind::ival:
+        n->ival_(name, value);
+        return;
+    }
+    TORCH_CHECK(false, "Unknown attribute kind");
+  }
+
+  const CompilationUnit& cu_;
+  std::vector<Value*> values_;
+};
+
+const char* executorKind() {
+  return getExecutorMode() ? "profiling" : "legacy";
+}
+
+// Checks that a plan fits the calling convention of the method it replaces:
+// it takes the method's inputs and returns outputs of the method's types.
+bool matchesSignature(const Graph& plan, const Graph& method) {
+  if (plan.inputs().size() != method.inputs().size() ||
+      plan.outputs().size() != method.outputs().size()) {
+    return false;
+  }
+  for (size_t i = 0; i < method.inputs().size(); ++i) {
+    if (!plan.inputs()[i]->type()->isSubtypeOf(method.inputs()[i]->type())) {
+      return false;
+    }
+  }
+  for (size_t i = 0; i < method.outputs().size(); ++i) {
+    if (!plan.outputs()[i]->type()->isSubtypeOf(method.outputs()[i]->type())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+IValue encodeGraph(const Graph& graph) {
+  return GraphEncoder().encode(graph);
+}
+
+std::shared_ptr<Graph> decodeGraph(
+    const IValue& encoded,
+    const CompilationUnit& cu) {
+  return GraphDecoder(cu).decode(encoded);
+}
+
+IValue serializeOptimizedPlans(const Module& module) {
+  using c10::ivalue::Tuple;
+  std::vector<IValue> plans;
+  for (const NameModule& submodule : module.named_modules()) {
+    for (const Method& method : submodule.value.get_methods()) {
+      auto graphs = method.function().get_executor().getOptimizedGraphs();
+      for (const auto& graph : graphs) {
+        try {
+          plans.push_back(Tuple::create(
+              {submodule.name, method.name(), encodeGraph(*graph)}));
+        } catch (const c10::Error& e) {
+          TORCH_WARN(
+              "Not saving the optimized plan of ",
+              method.function().qualname().qualifiedName(),
+              ": ",
+              e.what_without_backtrace());
+        }
+      }
+    }
+  }
+  if (plans.empty()) {
+    return IValue();
+  }
+  return Tuple::create(
+      {kOptimizedPlansVersion,
+       std::string(executorKind()),
+       Tuple::create(std::move(plans))});
+}
+
+void installOptimizedPlans(const Module& module, const IValue& plans) {
+  if (plans.isNone()) {
+    return;
+  }
+  const auto& elems = plans.toTuple()->elements();
+  if (elems.at(0).toInt() != kOptimizedPlansVersion ||
+      elems.at(1).toStringRef() != executorKind()) {
+    GRAPH_DEBUG("Ignoring optimized plans of another version or executor");
+    return;
+  }
+  std::unordered_map<std::string, Module> submodules;
+  for (const NameModule& submodule : module.named_modules()) {
+    submodules.emplace(submodule.name, submodule.value);
+  }
+  const auto& cu = *module._ivalue()->compilation_unit();
+  for (const IValue& entry : elems.at(2).toTuple()->elements()) {
+    const auto& plan = entry.toTuple()->elements();
+    auto it = submodules.find(plan.at(0).toStringRef());
+    if (it == submodules.end()) {
+      continue;
+    }
+    auto method = it->second.find_method(plan.at(1).toStringRef());
+    if (!method) {
+      continue;
+    }
+    std::shared_ptr<Graph> graph;
+    try {
+      graph = decodeGraph(plan.at(2), cu);
+    } catch (const std::exception& e) {
+      TORCH_WARN(
+          "Ignoring the malformed optimized plan of ",
+          method->function().qualname().qualifiedName(),
+          ": ",
+          e.what());
+      continue;
+    }
+    if (!matchesSignature(*graph, *method->graph()) ||
+        !method->function().get_executor().installOptimizedGraph(graph)) {
+      GRAPH_DEBUG(
+          "Could not install the optimized plan of ",
+          method->function().qualname().qualifiedName());
+    }
+  }
+}
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <ATen/core/ivalue.h>
+#include <torch/csrc/jit/api/module.h>
+#include <torch/csrc/jit/ir/ir.h>
+
+#include <atomic>
+
+namespace torch {
+namespace jit {
+
+// When set, saving a module also stores the graphs its executors optimized so
+// far (archive "optimized_plans"). Loading such a module installs them back
+// into the executors, so that a fresh process skips profiling and
+// optimization and starts with the plan of the process that saved it.
+//
+// Only plans of the profiling executor are stored: their guards (BailOut
+// nodes) are part of the graph, so an installed plan is correct for any input
+// and merely bails out to the unoptimized graph on inputs it was not
+// specialized for. Methods whose optimized graphs hold values that cannot be
+// serialized (e.g. Python ops) are skipped with a warning.
+TORCH_API std::atomic<bool>& getSaveOptimizedPlans();
+
+// Encodes a graph, including subgraph attributes and profiled tensor types,
+// as a tuple that can be pickled. Class types are stored by name.
+TORCH_API IValue encodeGraph(const Graph& graph);
+
+// Inverse of encodeGraph. Class types are resolved in `cu`. The decoded graph
+// is linted, a malformed encoding throws.
+TORCH_API std::shared_ptr<Graph> decodeGraph(
+    const IValue& encoded,
+    const CompilationUnit& cu);
+
+// Collects the optimized graphs of the methods of `module` and of its
+// submodules. Returns None if there are none.
+TORCH_API IValue serializeOptimizedPlans(const Module& module);
+
+// Installs plans stored by serializeOptimizedPlans into the executors of the
+// methods of `module`. Plans that do not match the current executor mode or
+// the signature of the method they were saved for are ignored, as are plans
+// that fail to decode or lint, with a warning. The ops of a plan are not
+// checked beyond that, a plan is trusted like the code of the module.
+TORCH_API void installOptimizedPlans(const Module& module, const IValue& plans);
+
+} // namespace jit
+} // namespace torch
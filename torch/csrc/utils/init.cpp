@@ -24,6 +24,7 @@ void initThroughputBenchmarkBindings(PyObject* module) {
 
   py::class_<ThroughputBenchmark>(m, "ThroughputBenchmark", py::dynamic_attr())
       .def(py::init<jit::Module>())
+      .def(py::init<std::shared_ptr<jit::StaticModule>>())
       .def(py::init<py::object>())
       .def(
           "add_input",
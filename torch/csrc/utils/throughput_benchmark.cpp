@@ -6,10 +6,24 @@
 namespace torch {
 namespace throughput_benchmark {
 
+namespace {
+
+int numInitialized(
+    const detail::ScriptModuleBenchmark& script_module,
+    const detail::StaticModuleBenchmark& static_module,
+    const detail::ModuleBenchmark& module) {
+  return script_module.initialized() + static_module.initialized() +
+      module.initialized();
+}
+
+} // namespace
+
 void ThroughputBenchmark::addInput(py::args args, py::kwargs kwargs) {
-  CHECK(script_module_.initialized() ^ module_.initialized());
+  CHECK_EQ(numInitialized(script_module_, static_module_, module_), 1);
   if (script_module_.initialized()) {
     script_module_.addInput(std::move(args), std::move(kwargs));
+  } else if (static_module_.initialized()) {
+    static_module_.addInput(std::move(args), std::move(kwargs));
   } else {
     CHECK(module_.initialized());
     module_.addInput(std::move(args), std::move(kwargs));
@@ -17,7 +31,7 @@ void ThroughputBenchmark::addInput(py::args args, py::kwargs kwargs) {
 }
 
 py::object ThroughputBenchmark::runOnce(py::args&& args, py::kwargs&& kwargs)  {
-  CHECK(script_module_.initialized() ^ module_.initialized());
+  CHECK_EQ(numInitialized(script_module_, static_module_, module_), 1);
   if (script_module_.initialized()) {
     c10::IValue result;
     {
@@ -25,6 +39,13 @@ py::object ThroughputBenchmark::runOnce(py::args&& args, py::kwargs&& kwargs)  {
       result = script_module_.runOnce(std::move(args), std::move(kwargs));
     }
     return jit::toPyObject(std::move(result));
+  } else if (static_module_.initialized()) {
+    c10::IValue result;
+    {
+      pybind11::gil_scoped_release no_gil_guard;
+      result = static_module_.runOnce(std::move(args), std::move(kwargs));
+    }
+    return jit::toPyObject(std::move(result));
   } else {
     CHECK(module_.initialized());
     return module_.runOnce(std::move(args), std::move(kwargs));
@@ -35,18 +56,24 @@ ThroughputBenchmark::ThroughputBenchmark(
     jit::Module script_module)
     : script_module_(script_module) {}
 
+ThroughputBenchmark::ThroughputBenchmark(
+    std::shared_ptr<jit::StaticModule> static_module)
+    : static_module_(std::move(static_module)) {}
+
 ThroughputBenchmark::ThroughputBenchmark(
     py::object module)
     : module_(std::move(module)) {}
 
 BenchmarkExecutionStats ThroughputBenchmark::benchmark(
     const BenchmarkConfig& config) const {
-  CHECK(script_module_.initialized() ^ module_.initialized());
+  CHECK_EQ(numInitialized(script_module_, static_module_, module_), 1);
   // Main benchmark thread doesn't hold the GIL after scheduling worker threads
   // But for now we don't release it as we will be implicitly manipulating with
   // py::object ref. counts in the case of nn.Module benchmarking.
   if (script_module_.initialized()) {
     return script_module_.benchmark(config);
+  } else if (static_module_.initialized()) {
+    return static_module_.benchmark(config);
   } else {
     CHECK(module_.initialized());
     TORCH_WARN("Starting benchmark on an nn.Module. This can be slow due "
@@ -58,6 +85,27 @@ BenchmarkExecutionStats ThroughputBenchmark::benchmark(
 
 namespace detail {
 
+namespace {
+
+ScriptModuleInput toStaticModuleInput(
+    const jit::StaticModule& module,
+    py::args&& args) {
+  const auto& graph_inputs = module.graph()->inputs();
+  TORCH_CHECK(
+      args.size() == graph_inputs.size(),
+      "Expected ",
+      graph_inputs.size(),
+      " arguments, got ",
+      args.size());
+  ScriptModuleInput stack;
+  for (size_t i = 0; i < args.size(); ++i) {
+    stack.push_back(jit::toIValue(args[i], graph_inputs[i]->type()));
+  }
+  return stack;
+}
+
+} // namespace
+
 template <>
 void ScriptModuleBenchmark::runOnce(ScriptModuleInput&& input) const {
   CHECK(initialized_);
@@ -79,6 +127,26 @@ ScriptModuleOutput ScriptModuleBenchmark::runOnce(
   return function(std::move(stack));
 }
 
+template <>
+void StaticModuleBenchmark::runOnce(ScriptModuleInput&& input) const {
+  CHECK(initialized_);
+  // StaticModule is safe to call from several threads, every caller gets
+  // its own StaticRuntime
+  (*model_)(std::move(input));
+}
+
+template <>
+ScriptModuleOutput StaticModuleBenchmark::runOnce(
+    py::args&& args,
+    py::kwargs&& kwargs) const {
+  CHECK(initialized_);
+  pybind11::gil_scoped_acquire gil_guard;
+  TORCH_CHECK(kwargs.size() == 0, "StaticModule does not take kwargs");
+  auto stack = toStaticModuleInput(*model_, std::move(args));
+  pybind11::gil_scoped_release no_gil_guard;
+  return (*model_)(std::move(stack));
+}
+
 template <>
 void ModuleBenchmark::runOnce(ModuleInput&& input) const {
   CHECK(initialized_);
@@ -104,6 +172,12 @@ void ScriptModuleBenchmark::addInput(py::args&& args, py::kwargs&& kwargs) {
   inputs_.emplace_back(std::move(stack));
 }
 
+template <>
+void StaticModuleBenchmark::addInput(py::args&& args, py::kwargs&& kwargs) {
+  TORCH_CHECK(kwargs.size() == 0, "StaticModule does not take kwargs");
+  inputs_.emplace_back(toStaticModuleInput(*model_, std::move(args)));
+}
+
 template <>
 void ModuleBenchmark::addInput(py::args&& args, py::kwargs&& kwargs) {
   inputs_.emplace_back(std::move(args), std::move(kwargs));
@@ -2,6 +2,7 @@
 
 #include <ATen/core/ivalue.h>
 #include <torch/csrc/jit/api/module.h>
+#include <torch/csrc/jit/runtime/static/impl.h>
 #include <pybind11/pybind11.h>
 
 #include <torch/csrc/jit/python/pybind_utils.h>
@@ -112,6 +113,17 @@ template <>
 inline BenchmarkHelper<ScriptModuleInput, at::IValue, jit::Module>::BenchmarkHelper()
   : model_("Module", std::make_shared<jit::CompilationUnit>()),
     initialized_(false) {}
+typedef BenchmarkHelper<
+    ScriptModuleInput,
+    at::IValue,
+    std::shared_ptr<jit::StaticModule>>
+    StaticModuleBenchmark;
+template <>
+inline BenchmarkHelper<
+    ScriptModuleInput,
+    at::IValue,
+    std::shared_ptr<jit::StaticModule>>::BenchmarkHelper()
+  : initialized_(false) {}
 typedef BenchmarkHelper<ModuleInput, py::object, py::object> ModuleBenchmark;
 template <>
 inline BenchmarkHelper<ModuleInput, py::object, py::object>::BenchmarkHelper()
@@ -126,6 +138,14 @@ ScriptModuleOutput ScriptModuleBenchmark::runOnce(
     py::args&& args,
     py::kwargs&& kwargs) const;
 
+template <>
+void StaticModuleBenchmark::runOnce(ScriptModuleInput&& input) const;
+
+template <>
+ScriptModuleOutput StaticModuleBenchmark::runOnce(
+    py::args&& args,
+    py::kwargs&& kwargs) const;
+
 template <>
 void ModuleBenchmark::runOnce(ModuleInput&& input) const;
 
@@ -136,6 +156,9 @@ ModuleOutput ModuleBenchmark::runOnce(py::args&& args, py::kwargs&& kwargs)
 template <>
 void ScriptModuleBenchmark::addInput(py::args&& args, py::kwargs&& kwargs);
 
+template <>
+void StaticModuleBenchmark::addInput(py::args&& args, py::kwargs&& kwargs);
+
 template <>
 void ModuleBenchmark::addInput(py::args&& args, py::kwargs&& kwargs);
 
@@ -151,13 +174,14 @@ void ModuleBenchmark::addInput(py::args&& args, py::kwargs&& kwargs);
  * For current available configurations refer to the BenchmkarConfig
  * documentation
  *
- * The class supports working with either nn.Module or ScriptModule.
+ * The class supports working with nn.Module, ScriptModule or StaticModule.
  * Under the hood it just dispatches to corresponding specialization of
  * class BenchmarkHelper<Input, Output, Model>
  */
 class C10_HIDDEN ThroughputBenchmark {
  public:
   explicit ThroughputBenchmark(jit::Module module);
+  explicit ThroughputBenchmark(std::shared_ptr<jit::StaticModule> module);
   explicit ThroughputBenchmark(py::object module);
 
   // Add one more input example. This input example should be in the exact
@@ -177,6 +201,7 @@ class C10_HIDDEN ThroughputBenchmark {
 
  private:
   detail::ScriptModuleBenchmark script_module_;
+  detail::StaticModuleBenchmark static_module_;
   detail::ModuleBenchmark module_;
 };
 } // namespace throughput benchmark
@@ -1,6 +1,5 @@
 from __future__ import absolute_import, division, print_function, unicode_literals
 
-import math
 import warnings
 from abc import ABCMeta, abstractmethod
 from functools import partial
@@ -635,129 +634,9 @@ class HistogramObserver(_ObserverBase):
         This follows the implementation of NormMinimization::NonlinearQuantizationParamsSearch in
         caffe2/quantization/server/norm_minimization.cc
         """
-        def _get_norm(delta_begin, delta_end, density, norm_type):
-            r"""
-            Compute the norm of the values uniformaly distributed between
-            delta_begin and delta_end.
-
-            norm = density * (integral_{begin, end} x^2)
-                 = density * (end^3 - begin^3) / 3
-            """
-            assert norm_type == "L2", "Only L2 norms are currently supported"
-            norm = 0.0
-            if norm_type == "L2":
-                norm = (
-                    delta_end * delta_end * delta_end
-                    - delta_begin * delta_begin * delta_begin
-                ) / 3
-            return density * norm
-
-        def _compute_quantization_error(next_start_bin, next_end_bin, norm_type):
-            r"""
-            Compute the quantization error if we use start_bin to end_bin as the
-            min and max to do the quantization.
-            """
-            bin_width = (self.max_val.item() - self.min_val.item()) / self.bins
-
-            norm = 0.0
-            dst_bin_width = bin_width * (next_end_bin - next_start_bin + 1) / self.dst_nbins
-            if dst_bin_width == 0.0:
-                return 0.0
-            for src_bin in range(self.bins):
-                # distances from the beginning of first dst_bin to the beginning and
-                # end of src_bin
-                src_bin_begin = (src_bin - next_start_bin) * bin_width
-                src_bin_end = src_bin_begin + bin_width
-
-                # which dst_bins the beginning and end of src_bin belong to?
-                dst_bin_of_begin = min(
-                    self.dst_nbins - 1, max(0.0, math.floor(src_bin_begin / dst_bin_width))
-                )
-                dst_bin_of_end = min(
-                    self.dst_nbins - 1, max(0.0, math.floor(src_bin_end / dst_bin_width))
-                )
-                dst_bin_of_begin_center = (
-                    dst_bin_of_begin * dst_bin_width + dst_bin_width / 2
-                )
-
-                density = self.histogram[src_bin] / bin_width
-                if dst_bin_of_begin == dst_bin_of_end:
-                    # if src_bin is entirely within 1 dst_bin
-                    delta_begin = src_bin_begin - dst_bin_of_begin_center
-                    delta_end = src_bin_end - dst_bin_of_begin_center
-                    norm = norm + _get_norm(delta_begin, delta_end, density, norm_type)
-                else:
-                    delta_begin = src_bin_begin - dst_bin_of_begin_center
-                    delta_end = dst_bin_width / 2
-                    norm = norm + _get_norm(delta_begin, delta_end, density, norm_type)
-
-                    norm = norm + (dst_bin_of_end - dst_bin_of_begin - 1) * _get_norm(
-                        -dst_bin_width / 2, dst_bin_width / 2, density, norm_type
-                    )
-
-                    dst_bin_of_end_center = (
-                        dst_bin_of_end * dst_bin_width + dst_bin_width / 2
-                    )
-
-                    delta_begin = -dst_bin_width / 2
-                    delta_end = src_bin_end - dst_bin_of_end_center
-                    norm = norm + _get_norm(delta_begin, delta_end, density, norm_type)
-            return norm
-
         assert self.histogram.size()[0] == self.bins, "bins mistmatch"
-        bin_width = (self.max_val - self.min_val) / self.bins
-
-        # cumulative sum
-        total = sum(self.histogram)
-        cSum = torch.cumsum(self.histogram, dim=0)
-
-        stepsize = 1e-5  # granularity
-        alpha = 0.0  # lower bound
-        beta = 1.0  # upper bound
-        start_bin = 0
-        end_bin = self.bins - 1
-        norm_min = float("inf")
-
-        while alpha < beta:
-            # Find the next step
-            next_alpha = alpha + stepsize
-            next_beta = beta - stepsize
-
-            # find the left and right bins between the quantile bounds
-            l = start_bin
-            r = end_bin
-            while l < end_bin and cSum[l] < next_alpha * total:
-                l = l + 1
-            while r > start_bin and cSum[r] > next_beta * total:
-                r = r - 1
-
-            # decide the next move
-            next_start_bin = start_bin
-            next_end_bin = end_bin
-            if (l - start_bin) > (end_bin - r):
-                # move the start bin
-                next_start_bin = l
-                alpha = next_alpha
-            else:
-                # move the end bin
-                next_end_bin = r
-                beta = next_beta
-
-            if next_start_bin == start_bin and next_end_bin == end_bin:
-                continue
-
-            # calculate the quantization error using next_start_bin and next_end_bin
-            norm = _compute_quantization_error(next_start_bin, next_end_bin, "L2")
-
-            if norm > norm_min:
-                break
-            norm_min = norm
-            start_bin = next_start_bin
-            end_bin = next_end_bin
-
-        new_min = self.min_val + bin_width * start_bin
-        new_max = self.min_val + bin_width * (end_bin + 1)
-        return new_min, new_max
+        return torch._histogram_observer_search(
+            self.histogram.cpu(), self.min_val.cpu(), self.max_val.cpu(), self.dst_nbins)
 
     @torch.jit.ignore
     def _adjust_min_max(self, combined_min, combined_max, upsample_rate):
@@ -804,7 +683,14 @@ class HistogramObserver(_ObserverBase):
         x = x_orig.detach()
         min_val = self.min_val
         max_val = self.max_val
-        if min_val.numel() == 0 or max_val.numel() == 0:
+        if not x.is_cuda and not self.histogram.is_cuda:
+            # Native kernel: parallel histogram accumulation and resampling
+            histogram, min_val, max_val = torch._histogram_observer_update(
+                x.float(), self.histogram, min_val, max_val, self.upsample_rate)
+            self.histogram = histogram
+            self.min_val = min_val
+            self.max_val = max_val
+        elif min_val.numel() == 0 or max_val.numel() == 0:
             min_val = torch.min(x)
             max_val = torch.max(x)
             self.min_val = min_val
@@ -62,7 +62,8 @@ class ExecutionStats(object):
 class ThroughputBenchmark(object):
     '''
     This class is a wrapper around a c++ component throughput_benchmark::ThroughputBenchmark
-    responsible for executing a PyTorch module (nn.Module or ScriptModule)
+    responsible for executing a PyTorch module (nn.Module, ScriptModule or a
+    StaticModule created by torch._C._jit_to_static_module)
     under an inference server like load. It can emulate multiple calling threads
     to a single module provided. In the future we plan to enhance this component
     to support inter and intra-op parallelism as well as multiple models